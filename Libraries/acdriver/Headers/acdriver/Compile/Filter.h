@@ -0,0 +1,84 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __acdriver_Compile_Filter_h
+#define __acdriver_Compile_Filter_h
+
+#include <xcassets/Slot/DeviceSubtype.h>
+#include <xcassets/Slot/Idiom.h>
+#include <xcassets/Slot/SystemVersion.h>
+
+#include <string>
+#include <vector>
+#include <ext/optional>
+
+namespace acdriver {
+
+class Result;
+
+namespace Compile {
+
+/*
+ * Selects the images relevant to the devices being built for, so images
+ * for other devices can be skipped before they are read. The default
+ * filter selects every image.
+ */
+class Filter {
+private:
+    ext::optional<std::vector<xcassets::Slot::Idiom>> _idioms;
+
+private:
+    bool                                              _device;
+    ext::optional<double>                             _scale;
+    ext::optional<xcassets::Slot::DeviceSubtype>      _subtype;
+    ext::optional<xcassets::Slot::SystemVersion>      _systemVersion;
+
+public:
+    Filter();
+
+public:
+    /*
+     * If images for an idiom are used by the devices.
+     */
+    bool matchesIdiom(xcassets::Slot::Idiom idiom) const;
+
+    /*
+     * If images for a device subtype, if any, are used by the device.
+     */
+    bool matchesSubtype(ext::optional<xcassets::Slot::DeviceSubtype> const &subtype) const;
+
+    /*
+     * If images requiring a minimum system version, if any, can be
+     * used by the system version of the device.
+     */
+    bool matchesSystemVersion(ext::optional<xcassets::Slot::SystemVersion> const &minimumSystemVersion) const;
+
+    /*
+     * If an image of a scale is the one the device would pick among the
+     * scales available for the same slot. This is the closest scale at
+     * least as large as the device's, otherwise the largest available.
+     */
+    bool matchesScale(double scale, std::vector<double> const &available) const;
+
+public:
+    /*
+     * Create a filter from the target device types (such as "iphone"),
+     * a specific device model (such as "iPhone9,1"), and the system
+     * version of that device. Reports invalid values to the result.
+     */
+    static ext::optional<Filter> Create(
+        std::vector<std::string> const &targetDevices,
+        ext::optional<std::string> const &deviceModel,
+        ext::optional<std::string> const &deviceSystemVersion,
+        Result *result);
+};
+
+}
+}
+
+#endif // !__acdriver_Compile_Filter_h
@@ -13,6 +13,8 @@
 #include <xcassets/Asset/ImageSet.h>
 
 #include <memory>
+#include <string>
+#include <ext/optional>
 
 namespace libutil { class Filesystem; }
 
@@ -36,9 +38,16 @@ public:
         Output *compileOutput,
         Result *result);
 
+    /*
+     * Queue the rendition for one image; the image is read and encoded
+     * later, with the other queued renditions. If compiling incrementally,
+     * the digest of the image set's description identifies renditions
+     * that can be reused.
+     */
     static bool CompileAsset(
         xcassets::Asset::ImageSet const *imageSet,
         xcassets::Asset::ImageSet::Image const &image,
+        ext::optional<std::string> const &digest,
         libutil::Filesystem *filesystem,
         Output *compileOutput,
         Result *result);
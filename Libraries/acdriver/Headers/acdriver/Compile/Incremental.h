@@ -0,0 +1,72 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __acdriver_Compile_Incremental_h
+#define __acdriver_Compile_Incremental_h
+
+#include <libutil/LookupCache.h>
+
+#include <string>
+#include <vector>
+#include <ext/optional>
+
+namespace libutil { class Filesystem; }
+
+namespace acdriver {
+namespace Compile {
+
+/*
+ * Encoded renditions kept between compilations, so images that have not
+ * changed are not read, converted, and compressed again. Each rendition
+ * is keyed by its image and a digest of the asset's description, and is
+ * valid while the image file is unchanged.
+ */
+class Incremental {
+private:
+    libutil::LookupCache _previous;
+    libutil::LookupCache _current;
+
+public:
+    Incremental();
+
+public:
+    /*
+     * Find the encoded rendition compiled from an image by a previous
+     * compilation. Found renditions are kept for the next compilation.
+     */
+    ext::optional<std::vector<uint8_t>> find(libutil::Filesystem const *filesystem, std::string const &path, std::string const &digest);
+
+    /*
+     * Store the encoded rendition compiled from an image. The stamps are
+     * of the image, taken before it was read.
+     */
+    void insert(std::string const &path, std::string const &digest, std::vector<uint8_t> const &value, libutil::LookupCache::Stamps const &stamps);
+
+public:
+    /*
+     * Load the renditions from a previous compilation. Missing or invalid
+     * manifests are treated as empty.
+     */
+    void load(libutil::Filesystem const *filesystem, std::string const &path);
+
+    /*
+     * Write the renditions used by this compilation.
+     */
+    bool save(libutil::Filesystem *filesystem, std::string const &path);
+
+public:
+    /*
+     * Digest of an asset's description, from its contents file.
+     */
+    static ext::optional<std::string> Digest(libutil::Filesystem const *filesystem, std::string const &assetPath);
+};
+
+}
+}
+
+#endif // !__acdriver_Compile_Incremental_h
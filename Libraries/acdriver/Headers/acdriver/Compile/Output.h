@@ -10,6 +10,9 @@
 #define __acdriver_Compile_Output_h
 
 #include <acdriver/NonStandard.h>
+#include <acdriver/Compile/Filter.h>
+#include <acdriver/Compile/Incremental.h>
+#include <acdriver/Compile/Renditions.h>
 #include <plist/Dictionary.h>
 #include <car/Writer.h>
 
@@ -49,9 +52,13 @@ private:
     ext::optional<std::string>         _appIcon;
     ext::optional<std::string>         _launchImage;
     NonStandard::ImageTypeSet          _allowedNonStandardImageTypes;
+    Filter                             _filter;
+    car::Rendition::Optimization       _optimization;
 
 private:
     ext::optional<car::Writer>         _car;
+    ext::optional<Incremental>         _incremental;
+    Renditions                         _renditions;
     std::vector<std::pair<std::string, std::string>> _copies;
     std::unique_ptr<plist::Dictionary> _additionalInfo;
 
@@ -100,6 +107,22 @@ public:
     NonStandard::ImageTypeSet const &allowedNonStandardImageTypes() const
     { return _allowedNonStandardImageTypes; }
 
+    /*
+     * Selects the images used by the devices being compiled for.
+     */
+    Filter const &filter() const
+    { return _filter; }
+    Filter &filter()
+    { return _filter; }
+
+    /*
+     * How renditions should be encoded.
+     */
+    car::Rendition::Optimization optimization() const
+    { return _optimization; }
+    car::Rendition::Optimization &optimization()
+    { return _optimization; }
+
 public:
     /*
      * If the format is compiled, the compiled catalog writer.
@@ -109,6 +132,22 @@ public:
     ext::optional<car::Writer> &car()
     { return _car; }
 
+    /*
+     * If compiling incrementally, renditions from the previous compilation.
+     */
+    ext::optional<Incremental> const &incremental() const
+    { return _incremental; }
+    ext::optional<Incremental> &incremental()
+    { return _incremental; }
+
+    /*
+     * Renditions queued to be compiled into the archive.
+     */
+    Renditions const &renditions() const
+    { return _renditions; }
+    Renditions &renditions()
+    { return _renditions; }
+
     /*
      * Files to copy into the output.
      */
@@ -0,0 +1,141 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __acdriver_Compile_Renditions_h
+#define __acdriver_Compile_Renditions_h
+
+#include <car/AttributeList.h>
+#include <libutil/LookupCache.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <ext/optional>
+
+namespace car { class Writer; }
+namespace libutil { class ThreadPool; }
+
+namespace acdriver {
+
+class Result;
+
+namespace Compile {
+
+class Incremental;
+
+/*
+ * Renditions queued for compilation. Assets are discovered and queue
+ * their renditions on one thread; the renditions are then read and
+ * encoded in parallel, and added to the archive in the order queued.
+ */
+class Renditions {
+public:
+    class Entry {
+    public:
+        /*
+         * Reads and encodes the rendition into the entry. Runs on a
+         * worker thread, so it must only touch the entry itself.
+         */
+        using Encode = std::function<void(Entry *entry)>;
+
+    private:
+        car::AttributeList           _attributes;
+        std::string                  _path;
+        Encode                       _encode;
+
+    private:
+        ext::optional<std::string>   _digest;
+        libutil::LookupCache::Stamps _stamps;
+
+    private:
+        ext::optional<std::vector<uint8_t>> _encoded;
+        std::vector<std::string>     _errors;
+
+    public:
+        /*
+         * A rendition encoded from the image at a path.
+         */
+        Entry(car::AttributeList const &attributes, std::string const &path, Encode const &encode);
+
+        /*
+         * A rendition that is already encoded.
+         */
+        Entry(car::AttributeList const &attributes, std::string const &path, std::vector<uint8_t> const &encoded);
+
+    public:
+        car::AttributeList const &attributes() const
+        { return _attributes; }
+        std::string const &path() const
+        { return _path; }
+
+    public:
+        /*
+         * If compiling incrementally, the digest of the asset description
+         * and the stamps of the image, taken before it was read.
+         */
+        ext::optional<std::string> const &digest() const
+        { return _digest; }
+        ext::optional<std::string> &digest()
+        { return _digest; }
+        libutil::LookupCache::Stamps const &stamps() const
+        { return _stamps; }
+        libutil::LookupCache::Stamps &stamps()
+        { return _stamps; }
+
+    public:
+        /*
+         * The encoded rendition, once encoded successfully.
+         */
+        ext::optional<std::vector<uint8_t>> const &encoded() const
+        { return _encoded; }
+        ext::optional<std::vector<uint8_t>> &encoded()
+        { return _encoded; }
+
+        /*
+         * Errors encoding the rendition, reported against its path.
+         */
+        std::vector<std::string> const &errors() const
+        { return _errors; }
+        std::vector<std::string> &errors()
+        { return _errors; }
+
+    private:
+        friend class Renditions;
+    };
+
+private:
+    std::vector<Entry> _entries;
+
+public:
+    Renditions();
+
+public:
+    /*
+     * Queued renditions, in the order they will be added.
+     */
+    std::vector<Entry> const &entries() const
+    { return _entries; }
+
+    /*
+     * Queue a rendition.
+     */
+    void add(Entry const &entry);
+
+public:
+    /*
+     * Encode the queued renditions across a thread pool, then add them
+     * to the archive and report errors in queue order. Newly encoded
+     * renditions are kept for the next incremental compilation.
+     */
+    bool compile(libutil::ThreadPool *threadPool, car::Writer *writer, Incremental *incremental, Result *result);
+};
+
+}
+}
+
+#endif // !__acdriver_Compile_Renditions_h
@@ -0,0 +1,261 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <acdriver/Compile/Filter.h>
+#include <acdriver/Result.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+using acdriver::Compile::Filter;
+using acdriver::Result;
+namespace Slot = xcassets::Slot;
+
+Filter::
+Filter() :
+    _device(false)
+{
+}
+
+bool Filter::
+matchesIdiom(Slot::Idiom idiom) const
+{
+    if (!_idioms) {
+        return true;
+    }
+
+    return std::find(_idioms->begin(), _idioms->end(), idiom) != _idioms->end();
+}
+
+bool Filter::
+matchesSubtype(ext::optional<Slot::DeviceSubtype> const &subtype) const
+{
+    /* Images without a subtype are the fallback for all devices. */
+    if (!_device || !subtype) {
+        return true;
+    }
+
+    return subtype == _subtype;
+}
+
+static int
+CompareSystemVersion(Slot::SystemVersion const &a, Slot::SystemVersion const &b)
+{
+    if (a.major() != b.major()) {
+        return a.major() < b.major() ? -1 : 1;
+    }
+    if (a.minor() != b.minor()) {
+        return a.minor() < b.minor() ? -1 : 1;
+    }
+    if (a.patch().value_or(0) != b.patch().value_or(0)) {
+        return a.patch().value_or(0) < b.patch().value_or(0) ? -1 : 1;
+    }
+    return 0;
+}
+
+bool Filter::
+matchesSystemVersion(ext::optional<Slot::SystemVersion> const &minimumSystemVersion) const
+{
+    if (!_systemVersion || !minimumSystemVersion) {
+        return true;
+    }
+
+    return CompareSystemVersion(*minimumSystemVersion, *_systemVersion) <= 0;
+}
+
+bool Filter::
+matchesScale(double scale, std::vector<double> const &available) const
+{
+    if (!_scale) {
+        return true;
+    }
+
+    ext::optional<double> larger;
+    ext::optional<double> largest;
+    for (double candidate : available) {
+        if (candidate >= *_scale && (!larger || candidate < *larger)) {
+            larger = candidate;
+        }
+        if (!largest || candidate > *largest) {
+            largest = candidate;
+        }
+    }
+
+    ext::optional<double> best = (larger ? larger : largest);
+    return !best || scale == *best;
+}
+
+/*
+ * The traits of a device model, from its identifier.
+ */
+class DeviceModel {
+public:
+    Slot::Idiom                        idiom;
+    ext::optional<double>              scale;
+    ext::optional<Slot::DeviceSubtype> subtype;
+};
+
+static ext::optional<DeviceModel>
+ParseDeviceModel(std::string const &model)
+{
+    /* Identifiers are a family name followed by "major,minor". */
+    std::string::size_type digit = model.find_first_of("0123456789");
+    std::string family = model.substr(0, digit);
+    int major = 0;
+    int minor = 0;
+    if (digit != std::string::npos) {
+        char const *start = model.c_str() + digit;
+        char *end = nullptr;
+        major = static_cast<int>(strtol(start, &end, 10));
+        if (*end == ',') {
+            minor = static_cast<int>(strtol(end + 1, &end, 10));
+        }
+        if (*end != '\0') {
+            return ext::nullopt;
+        }
+    }
+
+    DeviceModel device;
+    if (family == "iPhone") {
+        device.idiom = Slot::Idiom::Phone;
+        if (major <= 2) {
+            device.scale = 1;
+        } else if (major <= 4) {
+            device.scale = 2;
+        } else if (major <= 6 || (major == 8 && minor == 4)) {
+            device.scale = 2;
+            device.subtype = Slot::DeviceSubtype::Retina4;
+        } else if ((major == 7 && minor == 1) || (major == 8 && minor == 2) || (major == 9 && (minor == 2 || minor == 4)) || (major == 10 && (minor == 2 || minor == 5))) {
+            device.scale = 3;
+            device.subtype = Slot::DeviceSubtype::Height736;
+        } else if (major <= 10 && !(major == 10 && (minor == 3 || minor == 6))) {
+            device.scale = 2;
+            device.subtype = Slot::DeviceSubtype::Height667;
+        } else if ((major == 12 && minor == 8) || (major == 14 && minor == 6)) {
+            device.scale = 2;
+            device.subtype = Slot::DeviceSubtype::Height667;
+        } else if ((major == 11 && minor == 8) || (major == 12 && minor == 1)) {
+            device.scale = 2;
+        } else {
+            device.scale = 3;
+        }
+    } else if (family == "iPod") {
+        device.idiom = Slot::Idiom::Phone;
+        if (major <= 3) {
+            device.scale = 1;
+        } else if (major == 4) {
+            device.scale = 2;
+        } else {
+            device.scale = 2;
+            device.subtype = Slot::DeviceSubtype::Retina4;
+        }
+    } else if (family == "iPad") {
+        device.idiom = Slot::Idiom::Pad;
+        device.scale = (major <= 2 ? 1 : 2);
+    } else if (family == "AppleTV") {
+        device.idiom = Slot::Idiom::TV;
+        device.scale = (major <= 5 ? 1 : 2);
+    } else if (family == "Watch") {
+        device.idiom = Slot::Idiom::Watch;
+        device.scale = 2;
+    } else if (family.compare(0, 3, "Mac") == 0 || family == "iMac") {
+        /* Macs have displays of differing scales. */
+        device.idiom = Slot::Idiom::Desktop;
+    } else {
+        return ext::nullopt;
+    }
+
+    return device;
+}
+
+static ext::optional<Slot::Idiom>
+ParseTargetDevice(std::string const &targetDevice)
+{
+    if (targetDevice == "iphone") {
+        return Slot::Idiom::Phone;
+    } else if (targetDevice == "ipad") {
+        return Slot::Idiom::Pad;
+    } else if (targetDevice == "mac") {
+        return Slot::Idiom::Desktop;
+    } else if (targetDevice == "tv") {
+        return Slot::Idiom::TV;
+    } else if (targetDevice == "watch") {
+        return Slot::Idiom::Watch;
+    } else if (targetDevice == "car") {
+        return Slot::Idiom::Car;
+    } else {
+        return ext::nullopt;
+    }
+}
+
+ext::optional<Filter> Filter::
+Create(
+    std::vector<std::string> const &targetDevices,
+    ext::optional<std::string> const &deviceModel,
+    ext::optional<std::string> const &deviceSystemVersion,
+    Result *result)
+{
+    Filter filter;
+
+    std::vector<Slot::Idiom> idioms;
+    for (std::string const &targetDevice : targetDevices) {
+        ext::optional<Slot::Idiom> idiom = ParseTargetDevice(targetDevice);
+        if (!idiom) {
+            result->normal(Result::Severity::Error, "invalid target device: " + targetDevice);
+            return ext::nullopt;
+        }
+        idioms.push_back(*idiom);
+    }
+
+    if (deviceModel) {
+        ext::optional<DeviceModel> device = ParseDeviceModel(*deviceModel);
+        if (!device) {
+            result->normal(Result::Severity::Error, "invalid device model: " + *deviceModel);
+            return ext::nullopt;
+        }
+
+        filter._device = true;
+        filter._scale = device->scale;
+        filter._subtype = device->subtype;
+
+        bool targeted = idioms.empty() || std::find(idioms.begin(), idioms.end(), device->idiom) != idioms.end();
+        bool phoneTargeted = std::find(idioms.begin(), idioms.end(), Slot::Idiom::Phone) != idioms.end();
+        if (targeted) {
+            idioms = { device->idiom };
+        } else if (device->idiom == Slot::Idiom::Pad && phoneTargeted) {
+            /* Phone-only apps run on pads using phone images. */
+            idioms = { Slot::Idiom::Phone };
+        } else {
+            idioms.clear();
+        }
+    }
+
+    if (!targetDevices.empty() || deviceModel) {
+        /* Universal images are used everywhere; phones also drive car displays and carry marketing icons. */
+        bool phone = std::find(idioms.begin(), idioms.end(), Slot::Idiom::Phone) != idioms.end();
+        bool pad = std::find(idioms.begin(), idioms.end(), Slot::Idiom::Pad) != idioms.end();
+        idioms.push_back(Slot::Idiom::Universal);
+        if (phone) {
+            idioms.push_back(Slot::Idiom::Car);
+        }
+        if (phone || pad) {
+            idioms.push_back(Slot::Idiom::iOSMarketing);
+        }
+        filter._idioms = idioms;
+    }
+
+    if (deviceSystemVersion) {
+        filter._systemVersion = Slot::SystemVersion::Parse(*deviceSystemVersion);
+        if (!filter._systemVersion) {
+            result->normal(Result::Severity::Error, "invalid device os version: " + *deviceSystemVersion);
+            return ext::nullopt;
+        }
+    }
+
+    return filter;
+}
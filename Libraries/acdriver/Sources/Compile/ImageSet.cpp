@@ -8,7 +8,10 @@
 
 #include <acdriver/Compile/ImageSet.h>
 #include <acdriver/Compile/Convert.h>
+#include <acdriver/Compile/Filter.h>
+#include <acdriver/Compile/Incremental.h>
 #include <acdriver/Compile/Output.h>
+#include <acdriver/Compile/Renditions.h>
 #include <acdriver/Result.h>
 #include <graphics/PixelFormat.h>
 #include <graphics/Format/PNG.h>
@@ -26,11 +29,39 @@
 
 using acdriver::Compile::ImageSet;
 using acdriver::Compile::Convert;
+using acdriver::Compile::Filter;
+using acdriver::Compile::Incremental;
 using acdriver::Compile::Output;
+using acdriver::Compile::Renditions;
 using acdriver::Result;
 using libutil::Filesystem;
 using libutil::FSUtil;
 
+static bool
+SameSlot(xcassets::Asset::ImageSet::Image const &a, xcassets::Asset::ImageSet::Image const &b)
+{
+    return a.idiom() == b.idiom() &&
+        a.subtype() == b.subtype() &&
+        a.screenWidth() == b.screenWidth() &&
+        a.widthClass() == b.widthClass() &&
+        a.heightClass() == b.heightClass() &&
+        a.memory() == b.memory() &&
+        a.graphicsFeatureSet() == b.graphicsFeatureSet() &&
+        a.colorSpace() == b.colorSpace();
+}
+
+static std::vector<double>
+AvailableScales(std::vector<xcassets::Asset::ImageSet::Image const *> const &images, xcassets::Asset::ImageSet::Image const &image)
+{
+    std::vector<double> scales;
+    for (xcassets::Asset::ImageSet::Image const *other : images) {
+        if (other->fileName() && !other->unassigned() && other->scale() && SameSlot(*other, image)) {
+            scales.push_back(other->scale()->value());
+        }
+    }
+    return scales;
+}
+
 bool ImageSet::
 Compile(
     xcassets::Asset::ImageSet const *imageSet,
@@ -40,11 +71,44 @@ Compile(
 {
     bool success = true;
 
-    if (imageSet->images()) {
-        for (xcassets::Asset::ImageSet::Image const &image : *imageSet->images()) {
-            if (!CompileAsset(imageSet, image, filesystem, compileOutput, result)) {
-                success = false;
-            }
+    if (!imageSet->images()) {
+        return success;
+    }
+
+    /*
+     * Skip images for other devices before reading any of them. Scales
+     * are chosen among the images left for each slot.
+     */
+    Filter const &filter = compileOutput->filter();
+    std::vector<xcassets::Asset::ImageSet::Image const *> images;
+    for (xcassets::Asset::ImageSet::Image const &image : *imageSet->images()) {
+        if (image.idiom() && !filter.matchesIdiom(*image.idiom())) {
+            continue;
+        }
+        if (!filter.matchesSubtype(image.subtype())) {
+            continue;
+        }
+        images.push_back(&image);
+    }
+
+    /* Without a digest, renditions are compiled from scratch. */
+    ext::optional<std::string> digest;
+    if (compileOutput->incremental()) {
+        digest = Incremental::Digest(filesystem, imageSet->path());
+
+        /* Renditions encoded with another optimization are not reused. */
+        if (digest) {
+            *digest += "-" + std::to_string(static_cast<int>(compileOutput->optimization()));
+        }
+    }
+
+    for (xcassets::Asset::ImageSet::Image const *image : images) {
+        if (image->scale() && !filter.matchesScale(image->scale()->value(), AvailableScales(images, *image))) {
+            continue;
+        }
+
+        if (!CompileAsset(imageSet, *image, digest, filesystem, compileOutput, result)) {
+            success = false;
         }
     }
 
@@ -58,38 +122,19 @@ GenerateIdentifier(void) {
     return last;
 }
 
-bool ImageSet::
-CompileAsset(
-    xcassets::Asset::ImageSet const *imageSet,
+/*
+ * Read an image and encode it as a rendition. Runs on a worker thread.
+ */
+static void
+EncodeImage(
     xcassets::Asset::ImageSet::Image const &image,
-    Filesystem *filesystem,
-    Output *compileOutput,
-    Result *result)
+    double scale,
+    ext::optional<car::Rendition::Data::Format> const &nonStandardFormat,
+    car::Rendition::Optimization optimization,
+    Filesystem const *filesystem,
+    Renditions::Entry *entry)
 {
-    static std::map<std::string, uint16_t> idMap = {};
-
-    /* Skip any entry that is not attached to a file, or is explicitly unassigned. */
-    if (!image.fileName() || image.unassigned()) {
-        return true;
-    }
-
-    /* An image without an idiom is considered unassigned. */
-    if (!image.idiom()) {
-        return false;
-    }
-
-    std::string filename = FSUtil::ResolveRelativePath(*image.fileName(), imageSet->path());
-
-    std::string name = imageSet->name().string();
-
-    /* The default (0) is any scale. */
-    double scale = 0;
-    if (image.scale()) {
-        scale = image.scale()->value();
-    }
-
-    // TODO: filter by target-device / device-model / os-version
-    uint16_t idiom = Convert::IdiomAttribute(*image.idiom());
+    std::string const &filename = entry->path();
 
     std::vector<uint8_t> pixels;
     size_t width = 0;
@@ -99,17 +144,14 @@ CompileAsset(
     if (FSUtil::IsFileExtension(filename, "png", true)) {
         std::vector<uint8_t> contents;
         if (!filesystem->read(&contents, filename)) {
-            result->normal(
-                Result::Severity::Error,
-                "unable to read PNG file",
-                filename);
-            return false;
+            entry->errors().push_back("unable to read PNG file");
+            return;
         }
 
         auto png = graphics::Format::PNG::Read(contents);
         if (!png.first) {
-            result->normal(Result::Severity::Error, png.second, filename);
-            return false;
+            entry->errors().push_back(png.second);
+            return;
         }
 
         graphics::Image const &image = *png.first;
@@ -141,15 +183,87 @@ CompileAsset(
         }
     } else if (FSUtil::IsFileExtension(filename, "jpg", true) || FSUtil::IsFileExtension(filename, "jpeg", true)) {
         if (!filesystem->read(&pixels, filename)) {
-            result->normal(
-                Result::Severity::Error,
-                "unable to read JPEG file",
-                filename);
-            return false;
+            entry->errors().push_back("unable to read JPEG file");
+            return;
         }
 
         format = car::Rendition::Data::Format::JPEG;
     } else {
+        if (!filesystem->read(&pixels, filename)) {
+            entry->errors().push_back("unable to read image file");
+            return;
+        }
+
+        format = *nonStandardFormat;
+    }
+
+    auto data = ext::optional<car::Rendition::Data>(car::Rendition::Data(std::move(pixels), format));
+
+    car::Rendition rendition = car::Rendition::Create(entry->attributes(), std::move(data));
+    rendition.width() = width;
+    rendition.height() = height;
+    rendition.scale() = scale;
+    rendition.fileName() = *image.fileName();
+
+    if (image.resizing()) {
+        xcassets::Resizing const &resizing = *image.resizing();
+
+        xcassets::Resizing::Center::Mode centerMode = xcassets::Resizing::Center::Mode::Tile;
+        if (resizing.center()) {
+            xcassets::Resizing::Center const &center = *resizing.center();
+            if (center.mode()) {
+                centerMode = *center.mode();
+            }
+
+            /* TODO: center size is currently ingnored */
+        }
+
+        if (resizing.mode()) {
+            xcassets::Resizing::Mode resizingMode = *resizing.mode();
+            rendition.layout() = Convert::LayoutForResizingAndCenterMode(resizingMode, centerMode);
+            rendition.slices() = Convert::SlicesForResizingModeAndCapInsets(width, height, resizingMode, resizing.capInsets());
+        }
+    }
+
+    entry->encoded() = rendition.write(optimization);
+}
+
+bool ImageSet::
+CompileAsset(
+    xcassets::Asset::ImageSet const *imageSet,
+    xcassets::Asset::ImageSet::Image const &image,
+    ext::optional<std::string> const &digest,
+    Filesystem *filesystem,
+    Output *compileOutput,
+    Result *result)
+{
+    static std::map<std::string, uint16_t> idMap = {};
+
+    /* Skip any entry that is not attached to a file, or is explicitly unassigned. */
+    if (!image.fileName() || image.unassigned()) {
+        return true;
+    }
+
+    /* An image without an idiom is considered unassigned. */
+    if (!image.idiom()) {
+        return false;
+    }
+
+    std::string filename = FSUtil::ResolveRelativePath(*image.fileName(), imageSet->path());
+
+    std::string name = imageSet->name().string();
+
+    /* The default (0) is any scale. */
+    double scale = 0;
+    if (image.scale()) {
+        scale = image.scale()->value();
+    }
+
+    uint16_t idiom = Convert::IdiomAttribute(*image.idiom());
+
+    /* Images other than PNG and JPEG must be explicitly allowed. */
+    ext::optional<car::Rendition::Data::Format> nonStandardFormat;
+    if (!FSUtil::IsFileExtension(filename, "png", true) && !FSUtil::IsFileExtension(filename, "jpg", true) && !FSUtil::IsFileExtension(filename, "jpeg", true)) {
         ext::optional<NonStandard::ImageType> type = NonStandard::ImageTypeFromFileExtension(FSUtil::GetFileExtension(filename));
         if (!type) {
             result->normal(
@@ -165,14 +279,7 @@ CompileAsset(
                 filename);
             return false;
         }
-        if (!filesystem->read(&pixels, filename)) {
-            result->normal(
-                Result::Severity::Error,
-                "unable to read image file",
-                filename);
-            return false;
-        }
-        format = NonStandard::ImageTypeToDataFormat(*type);
+        nonStandardFormat = NonStandard::ImageTypeToDataFormat(*type);
     }
 
     bool createFacet = false;
@@ -195,7 +302,7 @@ CompileAsset(
     }
 
     /*
-     * Create rendition for the image.
+     * Queue the rendition for the image.
      */
     car::AttributeList attributes = car::AttributeList({
         { car_attribute_identifier_idiom, idiom },
@@ -203,34 +310,28 @@ CompileAsset(
         { car_attribute_identifier_identifier, facetIdentifier },
     });
 
-    auto data = ext::optional<car::Rendition::Data>(car::Rendition::Data(std::move(pixels), format));
-
-    car::Rendition rendition = car::Rendition::Create(attributes, std::move(data));
-    rendition.width() = width;
-    rendition.height() = height;
-    rendition.scale() = scale;
-    rendition.fileName() = *image.fileName();
-
-    if (image.resizing()) {
-        xcassets::Resizing const &resizing = *image.resizing();
-
-        xcassets::Resizing::Center::Mode centerMode = xcassets::Resizing::Center::Mode::Tile;
-        if (resizing.center()) {
-            xcassets::Resizing::Center const &center = *resizing.center();
-            if (center.mode()) {
-                centerMode = *center.mode();
-            }
-
-            /* TODO: center size is currently ingnored */
+    /*
+     * Reuse the rendition from the previous compilation if the image and
+     * its description are unchanged. Otherwise, stamp the image before
+     * reading it so changes made while compiling are noticed next time.
+     */
+    if (compileOutput->incremental() && digest) {
+        if (auto encoded = compileOutput->incremental()->find(filesystem, filename, *digest)) {
+            compileOutput->renditions().add(Renditions::Entry(attributes, filename, *encoded));
+            return true;
         }
+    }
 
-        if (resizing.mode()) {
-            xcassets::Resizing::Mode resizingMode = *resizing.mode();
-            rendition.layout() = Convert::LayoutForResizingAndCenterMode(resizingMode, centerMode);
-            rendition.slices() = Convert::SlicesForResizingModeAndCapInsets(width, height, resizingMode, resizing.capInsets());
-        }
+    /* The image is copied, as the asset does not outlive its catalog. */
+    car::Rendition::Optimization optimization = compileOutput->optimization();
+    Renditions::Entry entry = Renditions::Entry(attributes, filename, [image, scale, nonStandardFormat, optimization, filesystem](Renditions::Entry *entry) {
+        EncodeImage(image, scale, nonStandardFormat, optimization, filesystem, entry);
+    });
+    if (compileOutput->incremental() && digest) {
+        entry.digest() = digest;
+        entry.stamps() = libutil::LookupCache::Stamp(filesystem, { filename });
     }
+    compileOutput->renditions().add(entry);
 
-    compileOutput->car()->addRendition(std::move(rendition));
     return true;
 }
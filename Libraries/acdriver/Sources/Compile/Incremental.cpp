@@ -0,0 +1,82 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <acdriver/Compile/Incremental.h>
+#include <libutil/Filesystem.h>
+#include <libutil/md5.h>
+
+using acdriver::Compile::Incremental;
+using libutil::Filesystem;
+using libutil::LookupCache;
+
+Incremental::
+Incremental() :
+    /* Unlimited: every rendition in the catalog should be kept. */
+    _previous(0),
+    _current (0)
+{
+}
+
+ext::optional<std::vector<uint8_t>> Incremental::
+find(Filesystem const *filesystem, std::string const &path, std::string const &digest)
+{
+    std::string key = LookupCache::Key({ path, digest });
+
+    ext::optional<std::vector<std::string>> values = _previous.lookup(filesystem, key);
+    if (!values || values->size() != 1) {
+        return ext::nullopt;
+    }
+
+    _current.insert(key, *values, LookupCache::Stamp(filesystem, { path }));
+
+    std::string const &value = values->front();
+    return std::vector<uint8_t>(value.begin(), value.end());
+}
+
+void Incremental::
+insert(std::string const &path, std::string const &digest, std::vector<uint8_t> const &value, LookupCache::Stamps const &stamps)
+{
+    std::string key = LookupCache::Key({ path, digest });
+    _current.insert(key, { std::string(value.begin(), value.end()) }, stamps);
+}
+
+void Incremental::
+load(Filesystem const *filesystem, std::string const &path)
+{
+    _previous.load(filesystem, path);
+}
+
+bool Incremental::
+save(Filesystem *filesystem, std::string const &path)
+{
+    return _current.save(filesystem, path);
+}
+
+ext::optional<std::string> Incremental::
+Digest(Filesystem const *filesystem, std::string const &assetPath)
+{
+    std::vector<uint8_t> contents;
+    if (!filesystem->read(&contents, assetPath + "/Contents.json")) {
+        return ext::nullopt;
+    }
+
+    md5_state_t state;
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<md5_byte_t const *>(contents.data()), contents.size());
+
+    uint8_t digest[16];
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
+
+    static char const hex[] = "0123456789abcdef";
+    std::string result;
+    for (uint8_t byte : digest) {
+        result += hex[byte >> 4];
+        result += hex[byte & 0xf];
+    }
+    return result;
+}
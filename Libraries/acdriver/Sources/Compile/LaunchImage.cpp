@@ -8,6 +8,7 @@
 
 #include <acdriver/Compile/LaunchImage.h>
 #include <acdriver/Compile/Convert.h>
+#include <acdriver/Compile/Filter.h>
 #include <acdriver/Compile/Output.h>
 #include <acdriver/Result.h>
 #include <plist/Array.h>
@@ -16,6 +17,7 @@
 
 using acdriver::Compile::LaunchImage;
 using acdriver::Compile::Convert;
+using acdriver::Compile::Filter;
 using acdriver::Compile::Output;
 using acdriver::Result;
 
@@ -225,7 +227,13 @@ Compile(
                 continue;
             }
 
-            // TODO: skip images with idioms inappropriate for target platform
+            /*
+             * Skip images for other devices.
+             */
+            Filter const &filter = compileOutput->filter();
+            if (!filter.matchesIdiom(*image.idiom()) || !filter.matchesSubtype(image.subtype()) || !filter.matchesSystemVersion(image.minimumSystemVersion())) {
+                continue;
+            }
 
             /*
              * Get the expected size for the launch image.
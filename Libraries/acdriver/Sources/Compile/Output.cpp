@@ -35,6 +35,7 @@ Output(
     _appIcon                     (appIcon),
     _launchImage                 (launchImage),
     _allowedNonStandardImageTypes (allowedNonStandardImageTypes),
+    _optimization                (car::Rendition::Optimization::Default),
     _additionalInfo              (plist::Dictionary::New())
 {
 }
@@ -0,0 +1,78 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <acdriver/Compile/Renditions.h>
+#include <acdriver/Compile/Incremental.h>
+#include <acdriver/Result.h>
+#include <car/Writer.h>
+#include <libutil/ThreadPool.h>
+
+using acdriver::Compile::Renditions;
+using acdriver::Compile::Incremental;
+using acdriver::Result;
+using libutil::ThreadPool;
+
+Renditions::Entry::
+Entry(car::AttributeList const &attributes, std::string const &path, Encode const &encode) :
+    _attributes(attributes),
+    _path      (path),
+    _encode    (encode)
+{
+}
+
+Renditions::Entry::
+Entry(car::AttributeList const &attributes, std::string const &path, std::vector<uint8_t> const &encoded) :
+    _attributes(attributes),
+    _path      (path),
+    _encoded   (encoded)
+{
+}
+
+Renditions::
+Renditions()
+{
+}
+
+void Renditions::
+add(Entry const &entry)
+{
+    _entries.push_back(entry);
+}
+
+bool Renditions::
+compile(ThreadPool *threadPool, car::Writer *writer, Incremental *incremental, Result *result)
+{
+    threadPool->apply(_entries.size(), [this](size_t index) {
+        Entry *entry = &_entries[index];
+        if (entry->_encode) {
+            entry->_encode(entry);
+        }
+    });
+
+    bool success = true;
+
+    for (Entry const &entry : _entries) {
+        for (std::string const &error : entry._errors) {
+            result->normal(Result::Severity::Error, error, entry._path);
+        }
+
+        if (!entry._encoded) {
+            success = false;
+            continue;
+        }
+
+        if (incremental != nullptr && entry._encode && entry._digest) {
+            incremental->insert(entry._path, *entry._digest, *entry._encoded, entry._stamps);
+        }
+
+        writer->addRendition(entry._attributes, *entry._encoded);
+    }
+
+    _entries.clear();
+    return success;
+}
@@ -9,6 +9,7 @@
 #include <acdriver/CompileAction.h>
 #include <acdriver/Compile/Output.h>
 #include <acdriver/Compile/Asset.h>
+#include <acdriver/Compile/Filter.h>
 #include <acdriver/Version.h>
 #include <acdriver/Options.h>
 #include <acdriver/Output.h>
@@ -20,6 +21,7 @@
 #include <car/Writer.h>
 #include <bom/bom_format.h>
 #include <dependency/BinaryDependencyInfo.h>
+#include <graphics/Format/PNGOptimizer.h>
 #include <plist/Array.h>
 #include <plist/Boolean.h>
 #include <plist/Dictionary.h>
@@ -27,6 +29,7 @@
 #include <plist/Format/XML.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/ThreadPool.h>
 
 using acdriver::CompileAction;
 namespace Compile = acdriver::Compile;
@@ -47,6 +50,25 @@ CompileAction::
 {
 }
 
+static ext::optional<std::string>
+IntermediatePath(Options const &options, std::string const &extension)
+{
+    /*
+     * Intermediates are kept with the other intermediate outputs, since
+     * the compiled output directory is usually copied into the product.
+     */
+    ext::optional<std::string> intermediate = options.outputPartialInfoPlist();
+    if (!intermediate) {
+        intermediate = options.exportDependencyInfo();
+    }
+    if (!intermediate) {
+        return ext::nullopt;
+    }
+
+    std::string outputFilename = options.compileOutputFilename().value_or("Assets.car");
+    return FSUtil::GetDirectoryName(*intermediate) + "/" + outputFilename + "." + extension;
+}
+
 static bool
 WriteOutput(Filesystem *filesystem, Options const &options, Compile::Output const &compileOutput, Output *output, Result *result)
 {
@@ -66,9 +88,16 @@ WriteOutput(Filesystem *filesystem, Options const &options, Compile::Output cons
     }
 
     /*
-     * Copy files into output.
+     * Copy files into output. If requested, PNGs are optimized while
+     * copying, in parallel, and cached between compilations.
      */
+    std::vector<std::pair<std::string, std::string>> pngs;
     for (std::pair<std::string, std::string> const &copy : compileOutput.copies()) {
+        if (options.compressPNGs() && FSUtil::IsFileExtension(copy.first, "png", true)) {
+            pngs.push_back(copy);
+            continue;
+        }
+
         std::vector<uint8_t> contents;
 
         if (!filesystem->read(&contents, copy.first)) {
@@ -84,6 +113,14 @@ WriteOutput(Filesystem *filesystem, Options const &options, Compile::Output cons
         }
     }
 
+    if (!pngs.empty()) {
+        graphics::Format::PNGOptimizer optimizer = graphics::Format::PNGOptimizer(filesystem, IntermediatePath(options, "png-cache"));
+        for (std::pair<std::string, std::string> const &failure : optimizer.copy(&libutil::ThreadPool::Shared(), pngs)) {
+            result->normal(Result::Severity::Error, "unable to compress PNG: " + failure.second, failure.first);
+            success = false;
+        }
+    }
+
     /*
      * Write out partial info plist, if requested.
      */
@@ -165,6 +202,20 @@ DetermineOutputFormat(ext::optional<std::string> const &minimumDeploymentTarget)
     }
 }
 
+static ext::optional<car::Rendition::Optimization>
+DetermineOptimization(ext::optional<std::string> const &optimization)
+{
+    if (!optimization) {
+        return car::Rendition::Optimization::Default;
+    } else if (*optimization == "time") {
+        return car::Rendition::Optimization::Time;
+    } else if (*optimization == "space") {
+        return car::Rendition::Optimization::Space;
+    } else {
+        return ext::nullopt;
+    }
+}
+
 static ext::optional<car::Writer>
 CreateWriter(std::string const &path)
 {
@@ -188,14 +239,6 @@ WarnUnsupportedOptions(Options const &options, Result *result)
         result->normal(Result::Severity::Warning, "product type not supported");
     }
 
-    if (options.optimization()) {
-        result->normal(Result::Severity::Warning, "optimization not supported");
-    }
-
-    if (options.compressPNGs()) {
-        result->normal(Result::Severity::Warning, "compress PNGs not supported");
-    }
-
     if (options.platform()) {
         result->normal(Result::Severity::Warning, "platform not supported");
     }
@@ -213,10 +256,6 @@ WarnUnsupportedOptions(Options const &options, Result *result)
         result->normal(Result::Severity::Warning, "leaderboard set not supportd");
     }
 
-    if (!options.targetDevice().empty()) {
-        result->normal(Result::Severity::Warning, "target device not supported");
-    }
-
     if (options.targetName()) {
         result->normal(Result::Severity::Warning, "target name not supported");
     }
@@ -224,18 +263,6 @@ WarnUnsupportedOptions(Options const &options, Result *result)
     if (options.enableOnDemandResources()) {
         result->normal(Result::Severity::Warning, "on-demand resources not supported");
     }
-
-    if (options.enableIncrementalDistill()) {
-        result->normal(Result::Severity::Warning, "incremental distill not supported");
-    }
-
-    if (options.filterForDeviceModel()) {
-        result->normal(Result::Severity::Warning, "filter device model not supported");
-    }
-
-    if (options.filterForDeviceOsVersion()) {
-        result->normal(Result::Severity::Warning, "filter device os version not supported");
-    }
 }
 
 void CompileAction::
@@ -267,6 +294,29 @@ run(Filesystem *filesystem, Options const &options, Output *output, Result *resu
         options.launchImage(),
         options.nonStandardOptions().allowImageTypes());
 
+    /*
+     * Only compile images used by the devices being built for.
+     */
+    ext::optional<Compile::Filter> filter = Compile::Filter::Create(
+        options.targetDevice(),
+        options.filterForDeviceModel(),
+        options.filterForDeviceOsVersion(),
+        result);
+    if (!filter) {
+        return;
+    }
+    compileOutput.filter() = *filter;
+
+    /*
+     * Encode renditions for the build configuration: fast for debug, small for release.
+     */
+    ext::optional<car::Rendition::Optimization> optimization = DetermineOptimization(options.optimization());
+    if (!optimization) {
+        result->normal(Result::Severity::Error, "invalid optimization: " + *options.optimization());
+        return;
+    }
+    compileOutput.optimization() = *optimization;
+
     /*
      * If necessary, create output archive to write into.
      */
@@ -280,11 +330,26 @@ run(Filesystem *filesystem, Options const &options, Output *output, Result *resu
             return;
         }
 
+        writer->optimization() = compileOutput.optimization();
         compileOutput.car() = std::move(writer);
         // TODO: should only be an output if ultimately non-empty
         compileOutput.outputs().push_back(path);
     }
 
+    /*
+     * If compiling incrementally, load renditions from the previous compilation.
+     */
+    ext::optional<std::string> manifestPath;
+    if (options.enableIncrementalDistill() && compileOutput.car()) {
+        manifestPath = IntermediatePath(options, "incremental");
+        if (manifestPath) {
+            compileOutput.incremental() = Compile::Incremental();
+            compileOutput.incremental()->load(filesystem, *manifestPath);
+        } else {
+            result->normal(Result::Severity::Warning, "incremental distill requires an intermediate output path");
+        }
+    }
+
     /*
      * Compile each asset catalog into the output.
      */
@@ -313,6 +378,16 @@ run(Filesystem *filesystem, Options const &options, Output *output, Result *resu
         compileOutput.inputs().push_back(input);
     }
 
+    /*
+     * Read and encode the queued renditions in parallel, then add them
+     * to the archive in the order the assets were compiled.
+     */
+    if (compileOutput.car()) {
+        libutil::ThreadPool threadPool;
+        Compile::Incremental *incremental = (compileOutput.incremental() ? &*compileOutput.incremental() : nullptr);
+        compileOutput.renditions().compile(&threadPool, &*compileOutput.car(), incremental, result);
+    }
+
     /*
      * Write out the output.
      */
@@ -320,5 +395,14 @@ run(Filesystem *filesystem, Options const &options, Output *output, Result *resu
         /* Error already reported. */
         return;
     }
+
+    /*
+     * Keep the renditions for the next compilation.
+     */
+    if (compileOutput.incremental()) {
+        if (!compileOutput.incremental()->save(filesystem, *manifestPath)) {
+            result->normal(Result::Severity::Warning, "unable to write incremental manifest");
+        }
+    }
 }
 
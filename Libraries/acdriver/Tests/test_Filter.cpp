@@ -0,0 +1,77 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <acdriver/Compile/Filter.h>
+#include <acdriver/Result.h>
+
+using acdriver::Compile::Filter;
+using acdriver::Result;
+namespace Slot = xcassets::Slot;
+
+TEST(Filter, Default)
+{
+    Filter filter;
+    EXPECT_TRUE(filter.matchesIdiom(Slot::Idiom::Watch));
+    EXPECT_TRUE(filter.matchesSubtype(Slot::DeviceSubtype::Retina4));
+    EXPECT_TRUE(filter.matchesSystemVersion(Slot::SystemVersion::Parse("99.0")));
+    EXPECT_TRUE(filter.matchesScale(1, { 1, 2, 3 }));
+}
+
+TEST(Filter, TargetDevice)
+{
+    Result result;
+    auto filter = Filter::Create({ "iphone" }, ext::nullopt, ext::nullopt, &result);
+    ASSERT_TRUE(filter);
+    EXPECT_TRUE(filter->matchesIdiom(Slot::Idiom::Universal));
+    EXPECT_TRUE(filter->matchesIdiom(Slot::Idiom::Phone));
+    EXPECT_TRUE(filter->matchesIdiom(Slot::Idiom::Car));
+    EXPECT_FALSE(filter->matchesIdiom(Slot::Idiom::Pad));
+    EXPECT_FALSE(filter->matchesIdiom(Slot::Idiom::Watch));
+
+    /* Without a device model, every scale and subtype is kept. */
+    EXPECT_TRUE(filter->matchesSubtype(Slot::DeviceSubtype::Height736));
+    EXPECT_TRUE(filter->matchesScale(1, { 1, 2, 3 }));
+
+    EXPECT_FALSE(Filter::Create({ "toaster" }, ext::nullopt, ext::nullopt, &result));
+    EXPECT_TRUE(result.normalText(Result::Severity::Error));
+}
+
+TEST(Filter, DeviceModel)
+{
+    Result result;
+    auto filter = Filter::Create({ "iphone", "ipad" }, std::string("iPhone9,2"), std::string("10.3"), &result);
+    ASSERT_TRUE(filter);
+    EXPECT_TRUE(filter->matchesIdiom(Slot::Idiom::Phone));
+    EXPECT_FALSE(filter->matchesIdiom(Slot::Idiom::Pad));
+
+    EXPECT_TRUE(filter->matchesSubtype(ext::nullopt));
+    EXPECT_TRUE(filter->matchesSubtype(Slot::DeviceSubtype::Height736));
+    EXPECT_FALSE(filter->matchesSubtype(Slot::DeviceSubtype::Height667));
+
+    EXPECT_TRUE(filter->matchesScale(3, { 1, 2, 3 }));
+    EXPECT_FALSE(filter->matchesScale(2, { 1, 2, 3 }));
+    EXPECT_TRUE(filter->matchesScale(2, { 1, 2 }));
+
+    EXPECT_TRUE(filter->matchesSystemVersion(Slot::SystemVersion::Parse("8.0")));
+    EXPECT_TRUE(filter->matchesSystemVersion(Slot::SystemVersion::Parse("10.3")));
+    EXPECT_FALSE(filter->matchesSystemVersion(Slot::SystemVersion::Parse("11.0")));
+}
+
+TEST(Filter, PhoneAppOnPad)
+{
+    Result result;
+    auto filter = Filter::Create({ "iphone" }, std::string("iPad6,3"), ext::nullopt, &result);
+    ASSERT_TRUE(filter);
+    EXPECT_TRUE(filter->matchesIdiom(Slot::Idiom::Phone));
+    EXPECT_FALSE(filter->matchesIdiom(Slot::Idiom::Pad));
+    EXPECT_TRUE(filter->matchesScale(2, { 1, 2, 3 }));
+    EXPECT_FALSE(filter->matchesSubtype(Slot::DeviceSubtype::Retina4));
+
+    EXPECT_FALSE(Filter::Create({ }, std::string("Toaster1,1"), ext::nullopt, &result));
+}
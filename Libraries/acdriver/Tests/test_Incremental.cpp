@@ -0,0 +1,68 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <acdriver/Compile/Incremental.h>
+#include <libutil/LookupCache.h>
+#include <libutil/MemoryFilesystem.h>
+
+using acdriver::Compile::Incremental;
+using libutil::LookupCache;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+TEST(Incremental, Reuse)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("Image.imageset", {
+            MemoryFilesystem::Entry::File("Contents.json", Contents("{}")),
+            MemoryFilesystem::Entry::File("image.png", Contents("png")),
+        }),
+    });
+    std::string image = filesystem.path("Image.imageset/image.png");
+
+    /* Keep the manifest separately, as writes change every memory stamp. */
+    MemoryFilesystem intermediates = MemoryFilesystem({ });
+    std::string manifest = intermediates.path("Assets.car.incremental");
+
+    ext::optional<std::string> digest = Incremental::Digest(&filesystem, filesystem.path("Image.imageset"));
+    ASSERT_NE(ext::nullopt, digest);
+    EXPECT_EQ(ext::nullopt, Incremental::Digest(&filesystem, filesystem.path("Missing.imageset")));
+
+    /* The first compilation encodes the image. */
+    {
+        Incremental incremental;
+        incremental.load(&intermediates, manifest);
+        EXPECT_EQ(ext::nullopt, incremental.find(&filesystem, image, *digest));
+
+        incremental.insert(image, *digest, Contents("encoded"), LookupCache::Stamp(&filesystem, { image }));
+        ASSERT_TRUE(incremental.save(&intermediates, manifest));
+    }
+
+    /* Unchanged images are reused, and kept for the next compilation. */
+    {
+        Incremental incremental;
+        incremental.load(&intermediates, manifest);
+        EXPECT_EQ(ext::nullopt, incremental.find(&filesystem, image, "other"));
+        EXPECT_EQ(Contents("encoded"), incremental.find(&filesystem, image, *digest));
+        ASSERT_TRUE(incremental.save(&intermediates, manifest));
+    }
+
+    /* Changed images are not reused. */
+    ASSERT_TRUE(filesystem.write(Contents("changed"), image));
+    {
+        Incremental incremental;
+        incremental.load(&intermediates, manifest);
+        EXPECT_EQ(ext::nullopt, incremental.find(&filesystem, image, *digest));
+    }
+}
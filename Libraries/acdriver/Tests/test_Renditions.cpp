@@ -0,0 +1,76 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <acdriver/Compile/Incremental.h>
+#include <acdriver/Compile/Renditions.h>
+#include <acdriver/Result.h>
+#include <bom/bom.h>
+#include <car/Writer.h>
+#include <libutil/MemoryFilesystem.h>
+#include <libutil/ThreadPool.h>
+
+using acdriver::Compile::Incremental;
+using acdriver::Compile::Renditions;
+using acdriver::Result;
+using libutil::MemoryFilesystem;
+using libutil::ThreadPool;
+
+static car::AttributeList
+Attributes(uint16_t identifier)
+{
+    return car::AttributeList({
+        { car_attribute_identifier_idiom, car_attribute_identifier_idiom_value_universal },
+        { car_attribute_identifier_identifier, identifier },
+    });
+}
+
+TEST(Renditions, Compile)
+{
+    auto writer = car::Writer::Create(car::Writer::unique_ptr_bom(bom_alloc_empty(bom_context_memory(NULL, 0)), bom_free));
+    ASSERT_NE(ext::nullopt, writer);
+
+    Renditions renditions;
+    for (uint16_t n = 0; n < 64; n++) {
+        std::string path = "/image" + std::to_string(n) + ".png";
+        Renditions::Entry entry = Renditions::Entry(Attributes(n), path, [n](Renditions::Entry *entry) {
+            if (n % 16 == 15) {
+                entry->errors().push_back("failed " + std::to_string(n));
+            } else {
+                entry->encoded() = std::vector<uint8_t>({ static_cast<uint8_t>(n) });
+            }
+        });
+        entry.digest() = std::string("digest");
+        renditions.add(entry);
+    }
+    renditions.add(Renditions::Entry(Attributes(64), "/reused.png", std::vector<uint8_t>({ 64 })));
+
+    ThreadPool threadPool(4);
+    Incremental incremental;
+    Result result;
+    EXPECT_FALSE(renditions.compile(&threadPool, &*writer, &incremental, &result));
+    EXPECT_TRUE(renditions.entries().empty());
+
+    /* Errors are reported in queue order, regardless of which thread finished first. */
+    ext::optional<std::string> errors = result.normalText(Result::Severity::Error);
+    ASSERT_TRUE(errors);
+    size_t first = errors->find("failed 15");
+    size_t last = errors->find("failed 63");
+    ASSERT_NE(std::string::npos, first);
+    ASSERT_NE(std::string::npos, last);
+    EXPECT_LT(first, errors->find("failed 31"));
+    EXPECT_LT(errors->find("failed 47"), last);
+
+    /* Newly encoded renditions are kept for the next compilation. */
+    MemoryFilesystem filesystem = MemoryFilesystem({ });
+    ASSERT_TRUE(incremental.save(&filesystem, filesystem.path("manifest")));
+    Incremental next;
+    next.load(&filesystem, filesystem.path("manifest"));
+    EXPECT_EQ(std::vector<uint8_t>({ 3 }), next.find(&filesystem, "/image3.png", "digest"));
+    EXPECT_EQ(ext::nullopt, next.find(&filesystem, "/image15.png", "digest"));
+}
@@ -0,0 +1,118 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __builtin_Client_h
+#define __builtin_Client_h
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <ext/optional>
+
+namespace builtin {
+
+/*
+ * Runs builtin tools in a builtin server, rather than in a new process.
+ * Kept separate from the server so the client doesn't link the tools.
+ */
+class Client {
+public:
+    /*
+     * A builtin tool to run, and the process context to run it with.
+     */
+    class Request {
+    private:
+        std::string                                  _name;
+        std::string                                  _executablePath;
+        std::string                                  _workingDirectory;
+        std::vector<std::string>                     _arguments;
+        std::unordered_map<std::string, std::string> _environment;
+
+    public:
+        Request(
+            std::string const &name,
+            std::string const &executablePath,
+            std::string const &workingDirectory,
+            std::vector<std::string> const &arguments,
+            std::unordered_map<std::string, std::string> const &environment);
+
+    public:
+        std::string const &name() const
+        { return _name; }
+        std::string const &executablePath() const
+        { return _executablePath; }
+        std::string const &workingDirectory() const
+        { return _workingDirectory; }
+        std::vector<std::string> const &arguments() const
+        { return _arguments; }
+        std::unordered_map<std::string, std::string> const &environment() const
+        { return _environment; }
+
+    public:
+        std::vector<uint8_t> serialize() const;
+
+        static ext::optional<Request>
+        Deserialize(std::vector<uint8_t> const &contents);
+    };
+
+    /*
+     * The result of running a tool: its exit code, or nothing if the server
+     * doesn't have the tool, and what it wrote to its output and errors.
+     */
+    class Response {
+    private:
+        ext::optional<int> _exitCode;
+        std::string        _output;
+        std::string        _error;
+
+    public:
+        Response(ext::optional<int> const &exitCode, std::string const &output, std::string const &error);
+
+    public:
+        ext::optional<int> const &exitCode() const
+        { return _exitCode; }
+        std::string const &output() const
+        { return _output; }
+        std::string const &error() const
+        { return _error; }
+
+    public:
+        std::vector<uint8_t> serialize() const;
+
+        static ext::optional<Response>
+        Deserialize(std::vector<uint8_t> const &contents);
+    };
+
+public:
+    /*
+     * Environment variable with the path to the server socket, if any.
+     */
+    static std::string const ServerEnvironmentVariable;
+
+public:
+    /*
+     * Run a tool in the server listening at a socket. Returns nothing if
+     * the server couldn't be reached, in which case the tool should be run
+     * directly. Once the request is sent, the tool may have run, so losing
+     * the response is reported as the tool failing.
+     */
+    static ext::optional<Response>
+    Run(std::string const &socketPath, Request const &request);
+
+public:
+    /*
+     * Read or write a complete message on a socket. Messages are prefixed
+     * with their size.
+     */
+    static bool ReadMessage(int socket, std::vector<uint8_t> *contents);
+    static bool WriteMessage(int socket, std::vector<uint8_t> const &contents);
+};
+
+}
+
+#endif // !__builtin_Client_h
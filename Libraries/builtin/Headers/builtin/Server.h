@@ -0,0 +1,78 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __builtin_Server_h
+#define __builtin_Server_h
+
+#include <builtin/Registry.h>
+#include <libutil/ThreadPool.h>
+
+#include <string>
+#include <thread>
+
+namespace libutil { class Filesystem; }
+
+namespace builtin {
+
+/*
+ * Runs builtin tools for clients connecting over a Unix socket, so each
+ * tool run doesn't need a new process. Tools run in-process on a thread
+ * pool; their output is sent back for the client to write.
+ */
+class Server {
+private:
+    Registry             _registry;
+    libutil::Filesystem *_filesystem;
+    libutil::ThreadPool  _threadPool;
+
+private:
+    std::string          _socketPath;
+    int                  _socket;
+    int                  _stopPipe[2];
+    std::thread          _thread;
+
+public:
+    /*
+     * Create a server for the tools in a registry. If the number of
+     * threads is zero, one thread per available processor is used.
+     */
+    Server(Registry const &registry, libutil::Filesystem *filesystem, size_t threads = 0);
+    ~Server();
+
+    Server(Server const &) = delete;
+    Server &operator=(Server const &) = delete;
+
+public:
+    /*
+     * The path of the socket the server is listening on, if started.
+     */
+    std::string const &socketPath() const
+    { return _socketPath; }
+
+public:
+    /*
+     * Start listening for clients on a socket at the path, replacing any
+     * existing file there. Clients are handled on a background thread, and
+     * only clients running as the same user are accepted. The socket should
+     * be in a directory other users can't access.
+     */
+    bool start(std::string const &socketPath);
+
+    /*
+     * Stop listening and wait for tools already running to finish.
+     */
+    void stop();
+
+private:
+    void accept();
+    void handle(int connection);
+};
+
+}
+
+#endif // !__builtin_Server_h
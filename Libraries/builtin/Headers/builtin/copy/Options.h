@@ -43,6 +43,12 @@ private:
     ext::optional<BitcodeStripMode> _bitcodeStrip;
     ext::optional<std::string>      _bitcodeStripTool;
 
+private:
+    ext::optional<bool>             _compressPNGs;
+
+private:
+    ext::optional<std::string>      _stampFile;
+
 public:
     Options();
     ~Options();
@@ -75,6 +81,18 @@ public:
     ext::optional<std::string> const &bitcodeStripTool() const
     { return _bitcodeStripTool; }
 
+public:
+    bool compressPNGs() const
+    { return _compressPNGs.value_or(false); }
+
+public:
+    /*
+     * Records the files copied, so files unchanged since they were last
+     * copied are not copied again.
+     */
+    ext::optional<std::string> const &stampFile() const
+    { return _stampFile; }
+
 private:
     friend class libutil::Options;
     std::pair<bool, std::string>
@@ -0,0 +1,322 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <builtin/Client.h>
+
+#include <cerrno>
+#include <cstring>
+
+#if !_WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using builtin::Client;
+
+std::string const Client::ServerEnvironmentVariable = "XCBUILD_BUILTIN_SERVER";
+
+Client::Request::
+Request(
+    std::string const &name,
+    std::string const &executablePath,
+    std::string const &workingDirectory,
+    std::vector<std::string> const &arguments,
+    std::unordered_map<std::string, std::string> const &environment) :
+    _name            (name),
+    _executablePath  (executablePath),
+    _workingDirectory(workingDirectory),
+    _arguments       (arguments),
+    _environment     (environment)
+{
+}
+
+Client::Response::
+Response(ext::optional<int> const &exitCode, std::string const &output, std::string const &error) :
+    _exitCode(exitCode),
+    _output  (output),
+    _error   (error)
+{
+}
+
+/*
+ * Requests are a sequence of little-endian integers and length-prefixed
+ * strings. Responses are whether the tool was found, its exit code, and
+ * its output and errors.
+ */
+
+static void
+WriteInteger(std::vector<uint8_t> *contents, uint64_t value)
+{
+    for (size_t n = 0; n < sizeof(value); n++) {
+        contents->push_back(static_cast<uint8_t>(value >> (n * 8)));
+    }
+}
+
+static void
+WriteString(std::vector<uint8_t> *contents, std::string const &value)
+{
+    WriteInteger(contents, value.size());
+    contents->insert(contents->end(), value.begin(), value.end());
+}
+
+static bool
+ReadInteger(std::vector<uint8_t> const &contents, size_t *offset, uint64_t *value)
+{
+    if (contents.size() - *offset < sizeof(*value)) {
+        return false;
+    }
+
+    *value = 0;
+    for (size_t n = 0; n < sizeof(*value); n++) {
+        *value |= static_cast<uint64_t>(contents[*offset + n]) << (n * 8);
+    }
+    *offset += sizeof(*value);
+    return true;
+}
+
+static bool
+ReadString(std::vector<uint8_t> const &contents, size_t *offset, std::string *value)
+{
+    uint64_t size;
+    if (!ReadInteger(contents, offset, &size) || contents.size() - *offset < size) {
+        return false;
+    }
+
+    *value = std::string(reinterpret_cast<char const *>(&contents[*offset]), size);
+    *offset += size;
+    return true;
+}
+
+std::vector<uint8_t> Client::Request::
+serialize() const
+{
+    std::vector<uint8_t> contents;
+    WriteString(&contents, _name);
+    WriteString(&contents, _executablePath);
+    WriteString(&contents, _workingDirectory);
+
+    WriteInteger(&contents, _arguments.size());
+    for (std::string const &argument : _arguments) {
+        WriteString(&contents, argument);
+    }
+
+    WriteInteger(&contents, _environment.size());
+    for (auto const &variable : _environment) {
+        WriteString(&contents, variable.first);
+        WriteString(&contents, variable.second);
+    }
+
+    return contents;
+}
+
+ext::optional<Client::Request> Client::Request::
+Deserialize(std::vector<uint8_t> const &contents)
+{
+    size_t offset = 0;
+    std::string name;
+    std::string executablePath;
+    std::string workingDirectory;
+    if (!ReadString(contents, &offset, &name) || !ReadString(contents, &offset, &executablePath) || !ReadString(contents, &offset, &workingDirectory)) {
+        return ext::nullopt;
+    }
+
+    uint64_t count;
+    if (!ReadInteger(contents, &offset, &count)) {
+        return ext::nullopt;
+    }
+    std::vector<std::string> arguments;
+    for (uint64_t n = 0; n < count; n++) {
+        std::string argument;
+        if (!ReadString(contents, &offset, &argument)) {
+            return ext::nullopt;
+        }
+        arguments.push_back(argument);
+    }
+
+    if (!ReadInteger(contents, &offset, &count)) {
+        return ext::nullopt;
+    }
+    std::unordered_map<std::string, std::string> environment;
+    for (uint64_t n = 0; n < count; n++) {
+        std::string variable;
+        std::string value;
+        if (!ReadString(contents, &offset, &variable) || !ReadString(contents, &offset, &value)) {
+            return ext::nullopt;
+        }
+        environment[variable] = value;
+    }
+
+    if (offset != contents.size()) {
+        return ext::nullopt;
+    }
+
+    return Request(name, executablePath, workingDirectory, arguments, environment);
+}
+
+std::vector<uint8_t> Client::Response::
+serialize() const
+{
+    std::vector<uint8_t> contents;
+    WriteInteger(&contents, _exitCode ? 1 : 0);
+    WriteInteger(&contents, static_cast<uint32_t>(_exitCode.value_or(0)));
+    WriteString(&contents, _output);
+    WriteString(&contents, _error);
+    return contents;
+}
+
+ext::optional<Client::Response> Client::Response::
+Deserialize(std::vector<uint8_t> const &contents)
+{
+    size_t offset = 0;
+    uint64_t found;
+    uint64_t code;
+    std::string output;
+    std::string error;
+    if (!ReadInteger(contents, &offset, &found) || !ReadInteger(contents, &offset, &code) ||
+        !ReadString(contents, &offset, &output) || !ReadString(contents, &offset, &error) ||
+        offset != contents.size()) {
+        return ext::nullopt;
+    }
+
+    ext::optional<int> exitCode = (found != 0 ? ext::optional<int>(static_cast<int>(static_cast<uint32_t>(code))) : ext::nullopt);
+    return Response(exitCode, output, error);
+}
+
+/*
+ * Far larger than any real request, but avoids allocating whatever size
+ * a corrupt message claims to be.
+ */
+static uint64_t const MaximumMessageSize = 256 * 1024 * 1024;
+
+#if !_WIN32
+static bool
+ReadAll(int socket, uint8_t *data, size_t size)
+{
+    while (size > 0) {
+        ssize_t result = ::read(socket, data, size);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        } else if (result <= 0) {
+            return false;
+        }
+
+        data += result;
+        size -= result;
+    }
+    return true;
+}
+
+static bool
+WriteAll(int socket, uint8_t const *data, size_t size)
+{
+#if defined(MSG_NOSIGNAL)
+    int flags = MSG_NOSIGNAL;
+#else
+    int flags = 0;
+#endif
+
+    while (size > 0) {
+        ssize_t result = ::send(socket, data, size, flags);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        } else if (result <= 0) {
+            return false;
+        }
+
+        data += result;
+        size -= result;
+    }
+    return true;
+}
+#endif
+
+bool Client::
+ReadMessage(int socket, std::vector<uint8_t> *contents)
+{
+#if !_WIN32
+    std::vector<uint8_t> header = std::vector<uint8_t>(sizeof(uint64_t));
+    if (!ReadAll(socket, header.data(), header.size())) {
+        return false;
+    }
+
+    size_t offset = 0;
+    uint64_t size;
+    if (!ReadInteger(header, &offset, &size) || size > MaximumMessageSize) {
+        return false;
+    }
+
+    contents->resize(size);
+    return ReadAll(socket, contents->data(), contents->size());
+#else
+    return false;
+#endif
+}
+
+bool Client::
+WriteMessage(int socket, std::vector<uint8_t> const &contents)
+{
+#if !_WIN32
+#if defined(SO_NOSIGPIPE)
+    /* A peer closing the connection shouldn't terminate this process. */
+    int enable = 1;
+    (void)::setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+
+    std::vector<uint8_t> message;
+    message.reserve(sizeof(uint64_t) + contents.size());
+    WriteInteger(&message, contents.size());
+    message.insert(message.end(), contents.begin(), contents.end());
+    return WriteAll(socket, message.data(), message.size());
+#else
+    return false;
+#endif
+}
+
+ext::optional<Client::Response> Client::
+Run(std::string const &socketPath, Request const &request)
+{
+#if !_WIN32
+    struct sockaddr_un address;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        return ext::nullopt;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket < 0) {
+        return ext::nullopt;
+    }
+
+    if (::connect(socket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0) {
+        ::close(socket);
+        return ext::nullopt;
+    }
+
+    /*
+     * Past here, the server may have run the tool. Running it again could
+     * race with the first run, so failures are the tool's failure.
+     */
+    ext::optional<Response> response;
+    std::vector<uint8_t> contents;
+    if (WriteMessage(socket, request.serialize()) && ReadMessage(socket, &contents)) {
+        response = Response::Deserialize(contents);
+    }
+    ::close(socket);
+
+    if (!response) {
+        return Response(1, std::string(), "error: lost connection to builtin server running " + request.name() + "\n");
+    }
+    return response;
+#else
+    return ext::nullopt;
+#endif
+}
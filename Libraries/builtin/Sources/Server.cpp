@@ -0,0 +1,273 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <builtin/Server.h>
+#include <builtin/Client.h>
+#include <builtin/Driver.h>
+#include <process/MemoryContext.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if !_WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using builtin::Server;
+using builtin::Client;
+using libutil::Filesystem;
+
+Server::
+Server(Registry const &registry, Filesystem *filesystem, size_t threads) :
+    _registry  (registry),
+    _filesystem(filesystem),
+    _threadPool(threads),
+    _socket    (-1),
+    _stopPipe  { -1, -1 }
+{
+}
+
+Server::
+~Server()
+{
+    stop();
+}
+
+#if !_WIN32
+static void
+CloseOnExec(int descriptor)
+{
+    /* Processes started by tools, or by whoever started the server, don't need these. */
+    (void)::fcntl(descriptor, F_SETFD, ::fcntl(descriptor, F_GETFD) | FD_CLOEXEC);
+}
+
+/*
+ * If the client is running as the same user as the server. Tools run with
+ * the server's permissions, so other users can't be allowed to run them.
+ */
+static bool
+SameUser(int connection)
+{
+#if defined(__linux__)
+    struct ucred credentials;
+    socklen_t size = sizeof(credentials);
+    if (::getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &credentials, &size) != 0) {
+        return false;
+    }
+    return (credentials.uid == ::geteuid());
+#else
+    uid_t uid;
+    gid_t gid;
+    if (::getpeereid(connection, &uid, &gid) != 0) {
+        return false;
+    }
+    return (uid == ::geteuid());
+#endif
+}
+#endif
+
+bool Server::
+start(std::string const &socketPath)
+{
+#if !_WIN32
+    struct sockaddr_un address;
+    if (_socket != -1 || socketPath.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    /* A stale socket from an earlier server would stop this one binding. */
+    (void)::unlink(socketPath.c_str());
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        return false;
+    }
+    CloseOnExec(listener);
+
+    if (::bind(listener, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0 || ::listen(listener, SOMAXCONN) != 0) {
+        ::close(listener);
+        return false;
+    }
+
+    /* Written to when stopping, to wake the thread waiting for clients. */
+    if (::pipe(_stopPipe) != 0) {
+        ::close(listener);
+        (void)::unlink(socketPath.c_str());
+        return false;
+    }
+    CloseOnExec(_stopPipe[0]);
+    CloseOnExec(_stopPipe[1]);
+
+    _socket = listener;
+    _socketPath = socketPath;
+    _thread = std::thread(&Server::accept, this);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Server::
+stop()
+{
+#if !_WIN32
+    if (_socket == -1) {
+        return;
+    }
+
+    char stop = 0;
+    while (::write(_stopPipe[1], &stop, sizeof(stop)) < 0 && errno == EINTR) { }
+    _thread.join();
+
+    /* Clients already accepted still get their results. */
+    _threadPool.wait();
+
+    ::close(_socket);
+    ::close(_stopPipe[0]);
+    ::close(_stopPipe[1]);
+    (void)::unlink(_socketPath.c_str());
+
+    _socket = -1;
+    _stopPipe[0] = -1;
+    _stopPipe[1] = -1;
+    _socketPath.clear();
+#endif
+}
+
+void Server::
+accept()
+{
+#if !_WIN32
+    while (true) {
+        struct pollfd descriptors[2] = {
+            { _socket, POLLIN, 0 },
+            { _stopPipe[0], POLLIN, 0 },
+        };
+        if (::poll(descriptors, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        if (descriptors[1].revents != 0) {
+            break;
+        }
+
+        if (descriptors[0].revents != 0) {
+            int connection = ::accept(_socket, nullptr, nullptr);
+            if (connection < 0) {
+                continue;
+            }
+            CloseOnExec(connection);
+
+            if (!SameUser(connection)) {
+                ::close(connection);
+                continue;
+            }
+
+            _threadPool.dispatch([this, connection] {
+                handle(connection);
+            });
+        }
+    }
+#endif
+}
+
+#if !_WIN32
+/*
+ * Output written to a stream, kept in memory.
+ */
+class Capture {
+private:
+    char   *_buffer;
+    size_t  _size;
+    FILE   *_stream;
+
+public:
+    Capture() :
+        _buffer(nullptr),
+        _size  (0),
+        _stream(::open_memstream(&_buffer, &_size))
+    {
+    }
+
+    ~Capture()
+    {
+        if (_stream != nullptr) {
+            ::fclose(_stream);
+        }
+        ::free(_buffer);
+    }
+
+public:
+    FILE *stream() const
+    { return _stream; }
+
+    std::string contents()
+    {
+        ::fflush(_stream);
+        return std::string(_buffer, _size);
+    }
+};
+#endif
+
+void Server::
+handle(int connection)
+{
+#if !_WIN32
+    std::vector<uint8_t> contents;
+    if (Client::ReadMessage(connection, &contents)) {
+        if (ext::optional<Client::Request> request = Client::Request::Deserialize(contents)) {
+            ext::optional<int> exitCode;
+            std::string output;
+            std::string error;
+
+            if (std::shared_ptr<Driver> driver = _registry.driver(request->name())) {
+                process::MemoryContext context = process::MemoryContext(
+                    request->executablePath(),
+                    request->workingDirectory(),
+                    request->arguments(),
+                    request->environment());
+
+                /*
+                 * Output goes back to the client, so it is reported with
+                 * the tool and doesn't interleave with other tools.
+                 */
+                Capture outputCapture;
+                Capture errorCapture;
+                if (outputCapture.stream() != nullptr && errorCapture.stream() != nullptr) {
+                    context.standardOutput() = outputCapture.stream();
+                    context.standardError() = errorCapture.stream();
+                    exitCode = driver->run(&context, _filesystem);
+                    output = outputCapture.contents();
+                    error = errorCapture.contents();
+                } else {
+                    exitCode = 1;
+                    error = "error: unable to capture output of " + request->name() + "\n";
+                }
+            }
+
+            /* If the client went away, there's nobody left to tell. */
+            (void)Client::WriteMessage(connection, Client::Response(exitCode, output, error).serialize());
+        }
+    }
+
+    ::close(connection);
+#endif
+}
@@ -8,8 +8,11 @@
 
 #include <builtin/copy/Driver.h>
 #include <builtin/copy/Options.h>
+#include <graphics/Format/PNGOptimizer.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/LookupCache.h>
+#include <libutil/ThreadPool.h>
 #include <process/Context.h>
 #include <process/MemoryContext.h>
 #include <process/Launcher.h>
@@ -19,6 +22,7 @@
 using builtin::copy::Driver;
 using builtin::copy::Options;
 using libutil::Filesystem;
+using libutil::LookupCache;
 using libutil::Permissions;
 using libutil::FSUtil;
 
@@ -91,23 +95,47 @@ CopyPath(Filesystem *filesystem, std::string const &inputPath, std::string const
     abort();
 }
 
+/*
+ * Find the PNG files in a copied path.
+ */
+static void
+FindPNGs(Filesystem const *filesystem, std::string const &path, std::vector<std::pair<std::string, std::string>> *pngs)
+{
+    ext::optional<Filesystem::Type> type = filesystem->type(path);
+    if (type == Filesystem::Type::File) {
+        if (FSUtil::IsFileExtension(path, "png", true)) {
+            pngs->push_back({ path, path });
+        }
+    } else if (type == Filesystem::Type::Directory) {
+        filesystem->walkDirectory(path, true, false, [&](Filesystem::DirectoryEntry const &entry) {
+            std::string child = path + "/" + entry.path;
+            if (entry.type == Filesystem::Type::File && FSUtil::IsFileExtension(child, "png", true)) {
+                pngs->push_back({ child, child });
+            }
+            return true;
+        });
+    }
+}
+
 static int
-Run(Filesystem *filesystem, Options const &options, std::string const &workingDirectory)
+Run(process::Context const *processContext, Filesystem *filesystem, Options const &options, std::string const &temporaryDirectory)
 {
+    std::string const &workingDirectory = processContext->currentDirectory();
+
     if (!options.output()) {
-        fprintf(stderr, "error: no output path provided\n");
+        fprintf(processContext->standardError(), "error: no output path provided\n");
         return 1;
     }
 
     if (options.stripDebugSymbols() || options.bitcodeStrip() != Options::BitcodeStripMode::None) {
         // TODO(grp): Implement strip support when copying.
 #if 0
-        fprintf(stderr, "warning: strip on copy is not supported\n");
+        fprintf(processContext->standardError(), "warning: strip on copy is not supported\n");
 #endif
     }
 
     if (options.preserveHFSData()) {
-        fprintf(stderr, "warning: preserve HFS data is not supported\n");
+        fprintf(processContext->standardError(), "warning: preserve HFS data is not supported\n");
     }
 
     std::string const &output = FSUtil::ResolveRelativePath(*options.output(), workingDirectory);
@@ -120,6 +148,18 @@ Run(Filesystem *filesystem, Options const &options, std::string const &workingDi
     auto excludes = std::unordered_set<std::string>(options.excludes().begin(), options.excludes().end());
 #endif
 
+    /*
+     * Files copied before are recorded with the stamps of the input and the
+     * output. Only files are recorded; directories are always copied.
+     */
+    LookupCache previousStamps = LookupCache(0);
+    LookupCache currentStamps = LookupCache(0);
+    std::vector<std::pair<std::string, LookupCache::Stamps>> copiedFiles;
+    if (options.stampFile()) {
+        previousStamps.load(filesystem, FSUtil::ResolveRelativePath(*options.stampFile(), workingDirectory));
+    }
+
+    std::vector<std::pair<std::string, std::string>> pngs;
     for (std::string input : options.inputs()) {
         input = FSUtil::ResolveRelativePath(input, workingDirectory);
 
@@ -131,19 +171,79 @@ Run(Filesystem *filesystem, Options const &options, std::string const &workingDi
             if (options.ignoreMissingInputs()) {
                 continue;
             } else {
-                fprintf(stderr, "error: missing input '%s'\n", input.c_str());
+                fprintf(processContext->standardError(), "error: missing input '%s'\n", input.c_str());
                 return 1;
             }
         }
 
         if (options.verbose()) {
-            printf("verbose: copying %s -> %s\n", input.c_str(), output.c_str());
+            fprintf(processContext->standardOutput(), "verbose: copying %s -> %s\n", input.c_str(), output.c_str());
         }
 
         std::string outputPath = output + "/" + FSUtil::GetBaseName(input);
+
+        bool recordStamps = (options.stampFile() && filesystem->type(input) == Filesystem::Type::File);
+        std::string stampKey = LookupCache::Key({ input, outputPath, options.compressPNGs() ? "compress-pngs" : "" });
+        if (recordStamps && previousStamps.lookup(filesystem, stampKey)) {
+            /* Neither the input nor the output changed since the last copy. */
+            currentStamps.insert(stampKey, { }, LookupCache::Stamp(filesystem, { input, outputPath }));
+            continue;
+        }
+
+        /* Stamp the input before copying, so changes made while copying are not missed. */
+        LookupCache::Stamps inputStamps = (recordStamps ? LookupCache::Stamp(filesystem, { input }) : LookupCache::Stamps());
+
         if (!CopyPath(filesystem, input, outputPath)) {
             return 1;
         }
+
+        if (recordStamps) {
+            copiedFiles.push_back({ stampKey, inputStamps });
+            copiedFiles.back().second.push_back({ outputPath, ext::nullopt });
+        }
+
+        if (options.compressPNGs()) {
+            FindPNGs(filesystem, outputPath, &pngs);
+        }
+    }
+
+    /*
+     * Optimize the copied PNGs in place, in parallel. Results are cached
+     * by content, so unchanged images are only optimized once.
+     */
+    if (!pngs.empty()) {
+        /* Per user, as the cache must only be writable by the user trusting it. */
+        ext::optional<std::string> cachePath;
+        if (ext::optional<std::string> user = processContext->environmentVariable("USER")) {
+            cachePath = temporaryDirectory + "/xcbuild-png-cache-" + *user;
+        }
+
+        /* Shared, as the builtin server can run many copies at once. */
+        graphics::Format::PNGOptimizer optimizer = graphics::Format::PNGOptimizer(filesystem, cachePath);
+        auto failures = optimizer.copy(&libutil::ThreadPool::Shared(), pngs);
+        for (std::pair<std::string, std::string> const &failure : failures) {
+            fprintf(processContext->standardError(), "error: unable to compress '%s': %s\n", failure.first.c_str(), failure.second.c_str());
+        }
+        if (!failures.empty()) {
+            return 1;
+        }
+    }
+
+    /*
+     * Outputs are stamped last, as compressing PNGs rewrites them. Failing to
+     * record the stamps only means copying the files again next time.
+     */
+    if (options.stampFile()) {
+        for (std::pair<std::string, LookupCache::Stamps> &copiedFile : copiedFiles) {
+            std::pair<std::string, ext::optional<uint64_t>> &outputStamp = copiedFile.second.back();
+            outputStamp.second = filesystem->modificationTime(outputStamp.first);
+            currentStamps.insert(copiedFile.first, { }, copiedFile.second);
+        }
+
+        std::string stampFile = FSUtil::ResolveRelativePath(*options.stampFile(), workingDirectory);
+        if (filesystem->createDirectory(FSUtil::GetDirectoryName(stampFile), true)) {
+            (void)currentStamps.save(filesystem, stampFile);
+        }
     }
 
     return 0;
@@ -155,9 +255,10 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
     Options options;
     std::pair<bool, std::string> result = libutil::Options::Parse<Options>(&options, processContext->commandLineArguments());
     if (!result.first) {
-        fprintf(stderr, "error: %s\n", result.second.c_str());
+        fprintf(processContext->standardError(), "error: %s\n", result.second.c_str());
         return 1;
     }
 
-    return Run(filesystem, options, processContext->currentDirectory());
+    std::string temporaryDirectory = processContext->environmentVariable("TMPDIR").value_or("/tmp");
+    return Run(processContext, filesystem, options, temporaryDirectory);
 }
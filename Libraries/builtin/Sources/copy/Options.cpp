@@ -56,6 +56,10 @@ parseArgument(std::vector<std::string> const &args, std::vector<std::string>::co
         return result;
     } else if (arg == "-bitcode-strip-tool") {
         return libutil::Options::Next<std::string>(&_bitcodeStripTool, args, it);
+    } else if (arg == "-compress-pngs") {
+        return libutil::Options::Current<bool>(&_compressPNGs, arg);
+    } else if (arg == "-stamp-file") {
+        return libutil::Options::Next<std::string>(&_stampFile, args, it);
     } else if (!arg.empty() && arg[0] != '-') {
         if (*it == std::prev(args.end())) {
             return libutil::Options::Current<std::string>(&_output, arg);
@@ -37,11 +37,11 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
     Options options;
     std::pair<bool, std::string> result = libutil::Options::Parse<Options>(&options, processContext->commandLineArguments());
     if (!result.first) {
-        fprintf(stderr, "error: %s\n", result.second.c_str());
+        fprintf(processContext->standardError(), "error: %s\n", result.second.c_str());
         return 1;
     }
 
     // TODO(grp): Implement copy tiff builtin.
-    fprintf(stderr, "error: copy tiff not supported\n");
+    fprintf(processContext->standardError(), "error: copy tiff not supported\n");
     return 1;
 }
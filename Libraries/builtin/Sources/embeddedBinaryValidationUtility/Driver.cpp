@@ -37,11 +37,11 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
     Options options;
     std::pair<bool, std::string> result = libutil::Options::Parse<Options>(&options, processContext->commandLineArguments());
     if (!result.first) {
-        fprintf(stderr, "error: %s\n", result.second.c_str());
+        fprintf(processContext->standardError(), "error: %s\n", result.second.c_str());
         return 1;
     }
 
     // TODO(grp): Implement embedded binary validation builtin.
-    fprintf(stderr, "error: embedded binary validation not supported\n");
+    fprintf(processContext->standardError(), "error: embedded binary validation not supported\n");
     return 1;
 }
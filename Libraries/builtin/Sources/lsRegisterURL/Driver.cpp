@@ -45,30 +45,30 @@ run(process::Context const *processContext, libutil::Filesystem *filesystem)
     Options options;
     std::pair<bool, std::string> result = libutil::Options::Parse<Options>(&options, processContext->commandLineArguments());
     if (!result.first) {
-        fprintf(stderr, "error: %s\n", result.second.c_str());
+        fprintf(processContext->standardError(), "error: %s\n", result.second.c_str());
         return 1;
     }
 
     if (!options.input()) {
-        fprintf(stderr, "error: no input specified\n");
+        fprintf(processContext->standardError(), "error: no input specified\n");
         return 1;
     }
 
 #if defined(__APPLE__) && TARGET_OS_MAC && !TARGET_OS_IPHONE
     CFURLRef URL = CFURLCreateFromFileSystemRepresentation(kCFAllocatorDefault, reinterpret_cast<const UInt8 *>(options.input()->c_str()), options.input()->size(), false);
     if (URL == NULL) {
-        fprintf(stderr, "error: failed to create URL\n");
+        fprintf(processContext->standardError(), "error: failed to create URL\n");
         return 1;
     }
 
     OSStatus status = LSRegisterURL(URL, true);
     CFRelease(URL);
     if (status != noErr) {
-        fprintf(stderr, "error: LSRegisterURL failed %ld\n", (long)status);
+        fprintf(processContext->standardError(), "error: LSRegisterURL failed %ld\n", (long)status);
         return 1;
     }
 #else
-    fprintf(stderr, "warning: not supported on this platform\n");
+    fprintf(processContext->standardError(), "warning: not supported on this platform\n");
 #endif
 
     return 0;
@@ -0,0 +1,168 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <builtin/Client.h>
+#include <builtin/Driver.h>
+#include <builtin/Server.h>
+#include <libutil/MemoryFilesystem.h>
+#include <process/Context.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#if !_WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using builtin::Client;
+using builtin::Server;
+using libutil::Filesystem;
+using libutil::MemoryFilesystem;
+
+class ExitDriver : public builtin::Driver {
+public:
+    virtual std::string name()
+    { return "builtin-exit"; }
+
+public:
+    /* Exits with the first argument, once the context is as requested. */
+    virtual int run(process::Context const *processContext, Filesystem *filesystem)
+    {
+        if (processContext->executablePath() != "/usr/bin/builtin-exit" ||
+            processContext->currentDirectory() != "/working" ||
+            processContext->environmentVariable("VARIABLE") != ext::optional<std::string>("value") ||
+            processContext->commandLineArguments().empty()) {
+            return 100;
+        }
+
+        fprintf(processContext->standardOutput(), "output %s\n", processContext->commandLineArguments().front().c_str());
+        fprintf(processContext->standardError(), "error %s\n", processContext->commandLineArguments().front().c_str());
+        return std::atoi(processContext->commandLineArguments().front().c_str());
+    }
+};
+
+#if !_WIN32
+static Client::Request
+ExitRequest(std::string const &name, int exitCode)
+{
+    return Client::Request(
+        name,
+        "/usr/bin/" + name,
+        "/working",
+        { std::to_string(exitCode) },
+        { { "VARIABLE", "value" } });
+}
+
+TEST(Server, Run)
+{
+    char const *tmpdir = getenv("TMPDIR");
+    std::string socketPath = std::string(tmpdir != nullptr ? tmpdir : "/tmp") + "/builtin-server-test-" + std::to_string(::getpid()) + ".sock";
+
+    MemoryFilesystem filesystem = MemoryFilesystem({ });
+    Server server(builtin::Registry::Create({ std::make_shared<ExitDriver>() }), &filesystem, 4);
+    EXPECT_EQ(ext::nullopt, Client::Run(socketPath, ExitRequest("builtin-exit", 0)));
+
+    ASSERT_TRUE(server.start(socketPath));
+    EXPECT_EQ(socketPath, server.socketPath());
+
+    /* Exit codes and output come back from the tool. */
+    ext::optional<Client::Response> response = Client::Run(socketPath, ExitRequest("builtin-exit", 0));
+    ASSERT_NE(ext::nullopt, response);
+    EXPECT_EQ(ext::optional<int>(0), response->exitCode());
+    EXPECT_EQ("output 0\n", response->output());
+    EXPECT_EQ("error 0\n", response->error());
+
+    response = Client::Run(socketPath, ExitRequest("builtin-exit", 3));
+    ASSERT_NE(ext::nullopt, response);
+    EXPECT_EQ(ext::optional<int>(3), response->exitCode());
+    EXPECT_EQ("output 3\n", response->output());
+
+    /* Tools the server doesn't have aren't run. */
+    response = Client::Run(socketPath, ExitRequest("builtin-missing", 0));
+    ASSERT_NE(ext::nullopt, response);
+    EXPECT_EQ(ext::nullopt, response->exitCode());
+
+    /* Once stopped, clients should run tools themselves. */
+    server.stop();
+    EXPECT_EQ(ext::nullopt, Client::Run(socketPath, ExitRequest("builtin-exit", 0)));
+}
+
+TEST(Server, LostResponse)
+{
+    char const *tmpdir = getenv("TMPDIR");
+    std::string socketPath = std::string(tmpdir != nullptr ? tmpdir : "/tmp") + "/builtin-server-test-lost-" + std::to_string(::getpid()) + ".sock";
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    (void)::unlink(socketPath.c_str());
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_LE(0, listener);
+    ASSERT_EQ(0, ::bind(listener, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)));
+    ASSERT_EQ(0, ::listen(listener, 1));
+
+    /* A server that takes the request, then goes away without answering. */
+    std::thread server = std::thread([listener] {
+        int connection = ::accept(listener, nullptr, nullptr);
+        std::vector<uint8_t> contents;
+        (void)Client::ReadMessage(connection, &contents);
+        ::close(connection);
+    });
+
+    /* The tool may have run, so it's a failure rather than a reason to run it again. */
+    ext::optional<Client::Response> response = Client::Run(socketPath, ExitRequest("builtin-exit", 0));
+    server.join();
+    ASSERT_NE(ext::nullopt, response);
+    EXPECT_EQ(ext::optional<int>(1), response->exitCode());
+    EXPECT_FALSE(response->error().empty());
+
+    ::close(listener);
+    (void)::unlink(socketPath.c_str());
+}
+#endif
+
+TEST(Server, Request)
+{
+    Client::Request request = Client::Request("name", "/path/name", "/working", { "a", "", "b" }, { { "A", "1" }, { "B", "" } });
+    std::vector<uint8_t> contents = request.serialize();
+
+    ext::optional<Client::Request> result = Client::Request::Deserialize(contents);
+    ASSERT_NE(ext::nullopt, result);
+    EXPECT_EQ("name", result->name());
+    EXPECT_EQ("/path/name", result->executablePath());
+    EXPECT_EQ("/working", result->workingDirectory());
+    EXPECT_EQ(request.arguments(), result->arguments());
+    EXPECT_EQ(request.environment(), result->environment());
+
+    /* Truncated requests are rejected. */
+    contents.pop_back();
+    EXPECT_EQ(ext::nullopt, Client::Request::Deserialize(contents));
+}
+
+TEST(Server, Response)
+{
+    std::vector<uint8_t> contents = Client::Response(2, "output", "error").serialize();
+    ext::optional<Client::Response> result = Client::Response::Deserialize(contents);
+    ASSERT_NE(ext::nullopt, result);
+    EXPECT_EQ(ext::optional<int>(2), result->exitCode());
+    EXPECT_EQ("output", result->output());
+    EXPECT_EQ("error", result->error());
+
+    result = Client::Response::Deserialize(Client::Response(ext::nullopt, "", "").serialize());
+    ASSERT_NE(ext::nullopt, result);
+    EXPECT_EQ(ext::nullopt, result->exitCode());
+
+    contents.pop_back();
+    EXPECT_EQ(ext::nullopt, Client::Response::Deserialize(contents));
+}
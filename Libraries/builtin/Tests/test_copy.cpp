@@ -9,14 +9,24 @@
 #include <gtest/gtest.h>
 #include <builtin/copy/Options.h>
 #include <builtin/copy/Driver.h>
+#include <graphics/Format/PNG.h>
+#include <graphics/Image.h>
+#include <libutil/DefaultFilesystem.h>
 #include <libutil/Filesystem.h>
 #include <libutil/MemoryFilesystem.h>
 #include <process/Context.h>
 #include <process/MemoryContext.h>
 #include <plist/Format/Encoding.h>
 
+#include <cstdlib>
+
+#if !_WIN32
+#include <unistd.h>
+#endif
+
 using builtin::copy::Driver;
 using builtin::copy::Options;
+using libutil::DefaultFilesystem;
 using libutil::Filesystem;
 using libutil::MemoryFilesystem;
 
@@ -98,3 +108,83 @@ TEST(copy, IgnoreMissingOutput)
     EXPECT_EQ(0, driver.run(&succeed, &filesystem));
 }
 
+
+TEST(copy, CompressPNGs)
+{
+    graphics::PixelFormat format = graphics::PixelFormat(graphics::PixelFormat::Color::Grayscale, graphics::PixelFormat::Order::Forward, graphics::PixelFormat::Alpha::None);
+    auto image = graphics::Image(16, 16, format, std::vector<uint8_t>(16 * 16, 0x80));
+    std::vector<uint8_t> png = *graphics::Format::PNG::Write(image, graphics::Format::PNG::Filter::None, 0).first;
+
+    std::vector<uint8_t> contents;
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("input", {
+            MemoryFilesystem::Entry::File("image.png", png),
+            MemoryFilesystem::Entry::File("other", Contents("other")),
+        }),
+        MemoryFilesystem::Entry::Directory("output", { }),
+        MemoryFilesystem::Entry::Directory("tmp", { }),
+    });
+
+    Driver driver;
+    auto process = process::MemoryContext(filesystem.path(driver.name()), filesystem.path(""), { "-compress-pngs", "input", "output", }, { { "TMPDIR", filesystem.path("tmp") }, { "USER", "user" } });
+    EXPECT_EQ(0, driver.run(&process, &filesystem));
+
+    /* The optimized images are cached for the user in the environment. */
+    EXPECT_EQ(Filesystem::Type::Directory, filesystem.type(filesystem.path("tmp/xcbuild-png-cache-user")));
+
+    contents.clear();
+    EXPECT_TRUE(filesystem.read(&contents, filesystem.path("output/input/image.png")));
+    EXPECT_LT(contents.size(), png.size());
+    EXPECT_EQ(graphics::Format::PNG::Read(png).first->data(), graphics::Format::PNG::Read(contents).first->data());
+
+    contents.clear();
+    EXPECT_TRUE(filesystem.read(&contents, filesystem.path("output/input/other")));
+    EXPECT_EQ(contents, Contents("other"));
+}
+
+#if !_WIN32
+TEST(copy, StampFile)
+{
+    /* Stamps need real modification times, so use a real directory. */
+    DefaultFilesystem filesystem;
+    char const *tmpdir = getenv("TMPDIR");
+    std::string root = std::string(tmpdir != nullptr ? tmpdir : "/tmp") + "/builtin-copy-XXXXXX";
+    ASSERT_NE(nullptr, ::mkdtemp(&root[0]));
+
+    ASSERT_TRUE(filesystem.write(Contents("one"), root + "/in1"));
+    ASSERT_TRUE(filesystem.write(Contents("two"), root + "/in2"));
+
+    Driver driver;
+    auto process = process::MemoryContext(driver.name(), root, { "-stamp-file", "stamps/copy.stamps", "in1", "in2", "output", }, std::unordered_map<std::string, std::string>());
+    EXPECT_EQ(0, driver.run(&process, &filesystem));
+    EXPECT_TRUE(filesystem.exists(root + "/stamps/copy.stamps"));
+
+    ext::optional<uint64_t> copied1 = filesystem.modificationTime(root + "/output/in1");
+    ext::optional<uint64_t> copied2 = filesystem.modificationTime(root + "/output/in2");
+    ASSERT_NE(ext::nullopt, copied1);
+
+    /* Nothing changed, so nothing is copied again. */
+    EXPECT_EQ(0, driver.run(&process, &filesystem));
+    EXPECT_EQ(copied1, filesystem.modificationTime(root + "/output/in1"));
+    EXPECT_EQ(copied2, filesystem.modificationTime(root + "/output/in2"));
+
+    /* Only changed inputs are copied again. */
+    ASSERT_TRUE(filesystem.write(Contents("changed"), root + "/in2"));
+    EXPECT_EQ(0, driver.run(&process, &filesystem));
+    EXPECT_EQ(copied1, filesystem.modificationTime(root + "/output/in1"));
+
+    std::vector<uint8_t> contents;
+    EXPECT_TRUE(filesystem.read(&contents, root + "/output/in2"));
+    EXPECT_EQ(Contents("changed"), contents);
+
+    /* As are changed outputs. */
+    ASSERT_TRUE(filesystem.write(Contents("modified"), root + "/output/in1"));
+    EXPECT_EQ(0, driver.run(&process, &filesystem));
+
+    contents.clear();
+    EXPECT_TRUE(filesystem.read(&contents, root + "/output/in1"));
+    EXPECT_EQ(Contents("one"), contents);
+
+    EXPECT_TRUE(filesystem.removeDirectory(root, true));
+}
+#endif
@@ -0,0 +1,82 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <builtin/Client.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if !_WIN32
+#include <unistd.h>
+#endif
+
+#if !_WIN32
+extern char **environ;
+#endif
+
+/*
+ * Runs a builtin tool in the builtin server, if one is running. Otherwise,
+ * or if the server doesn't have the tool, runs the tool's own executable.
+ * Once the server has the request, the tool is never run again here.
+ *
+ * Usage: builtin-client <tool executable> [arguments...]
+ */
+int
+main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <tool> [arguments...]\n", argv[0]);
+        return 1;
+    }
+
+#if !_WIN32
+    std::string executablePath = argv[1];
+
+    if (char const *socketPath = getenv(builtin::Client::ServerEnvironmentVariable.c_str())) {
+        std::string name = executablePath.substr(executablePath.rfind('/') + 1);
+
+        std::vector<std::string> arguments;
+        for (int i = 2; i < argc; i++) {
+            arguments.push_back(argv[i]);
+        }
+
+        std::unordered_map<std::string, std::string> environment;
+        for (char **variable = environ; *variable != nullptr; variable++) {
+            std::string entry = *variable;
+            std::string::size_type equals = entry.find('=');
+            if (equals != std::string::npos) {
+                environment.insert({ entry.substr(0, equals), entry.substr(equals + 1) });
+            }
+        }
+
+        std::vector<char> workingDirectory = std::vector<char>(4096);
+        if (::getcwd(workingDirectory.data(), workingDirectory.size()) != nullptr) {
+            builtin::Client::Request request = builtin::Client::Request(name, executablePath, workingDirectory.data(), arguments, environment);
+            if (ext::optional<builtin::Client::Response> response = builtin::Client::Run(socketPath, request)) {
+                fwrite(response->output().data(), 1, response->output().size(), stdout);
+                fwrite(response->error().data(), 1, response->error().size(), stderr);
+
+                /* Only run the tool directly if the server doesn't have it. */
+                if (response->exitCode()) {
+                    return *response->exitCode();
+                }
+            }
+        }
+    }
+
+    ::execv(executablePath.c_str(), &argv[1]);
+    fprintf(stderr, "error: unable to run %s\n", executablePath.c_str());
+    return 1;
+#else
+    fprintf(stderr, "error: builtin server not supported\n");
+    return 1;
+#endif
+}
@@ -35,12 +35,45 @@ public:
     static std::pair<ext::optional<Image>, std::string>
     Read(std::vector<uint8_t> const &contents);
 
+public:
+    /*
+     * How rows are filtered before compression.
+     */
+    enum class Filter {
+        None,
+        Sub,
+        Up,
+        Average,
+        Paeth,
+        /*
+         * Choose the filter for each row that is likely to compress best.
+         */
+        Adaptive,
+    };
+
 public:
     /*
      * Write a PNG image.
      */
     static std::pair<ext::optional<std::vector<uint8_t>>, std::string>
     Write(Image const &image);
+
+    /*
+     * Write a PNG image with a row filter and a zlib compression level,
+     * from 0 to 9 or -1 for the default.
+     */
+    static std::pair<ext::optional<std::vector<uint8_t>>, std::string>
+    Write(Image const &image, Filter filter, int compressionLevel);
+
+public:
+    /*
+     * Losslessly reduce the size of a PNG image. Ancillary chunks are
+     * removed, and 8-bit images are re-encoded with fewer channels when
+     * possible and with whichever filter compresses best. Returns the
+     * contents unchanged if they cannot be made smaller.
+     */
+    static std::pair<ext::optional<std::vector<uint8_t>>, std::string>
+    Optimize(std::vector<uint8_t> const &contents);
 };
 
 }
@@ -0,0 +1,60 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __graphics_Format_PNGOptimizer_h
+#define __graphics_Format_PNGOptimizer_h
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <ext/optional>
+
+namespace libutil { class Filesystem; }
+namespace libutil { class ThreadPool; }
+
+namespace graphics {
+namespace Format {
+
+/*
+ * Optimizes PNG files as they are copied, across a thread pool. Results
+ * are cached in a directory keyed by the digest of the original contents,
+ * so unchanged images are not optimized again by later builds.
+ */
+class PNGOptimizer {
+private:
+    libutil::Filesystem       *_filesystem;
+    ext::optional<std::string> _cachePath;
+
+public:
+    /*
+     * Create an optimizer. Without a cache path, nothing is cached. The
+     * cache directory is created only the current user can access; if
+     * that fails, for example if another user owns it, nothing is cached.
+     */
+    PNGOptimizer(libutil::Filesystem *filesystem, ext::optional<std::string> const &cachePath);
+
+public:
+    /*
+     * Optimize the contents of a PNG file, using the cache if possible.
+     */
+    std::pair<ext::optional<std::vector<uint8_t>>, std::string>
+    optimize(std::vector<uint8_t> const &contents) const;
+
+    /*
+     * Copy PNG files from the first path to the second, optimizing each.
+     * The paths may be the same to optimize in place. Returns the paths
+     * that failed and why, in the order given.
+     */
+    std::vector<std::pair<std::string, std::string>>
+    copy(libutil::ThreadPool *threadPool, std::vector<std::pair<std::string, std::string>> const &files) const;
+};
+
+}
+}
+
+#endif // !__graphics_Format_PNGOptimizer_h
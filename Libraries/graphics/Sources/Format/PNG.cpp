@@ -8,6 +8,7 @@
 
 #include <graphics/Format/PNG.h>
 
+#include <cstdlib>
 #include <iterator>
 #include <memory>
 #include <ext/optional>
@@ -527,8 +528,93 @@ Read(std::vector<uint8_t> const &contents)
 
 #include <zlib.h>
 
+static uint8_t
+PaethPredictor(uint8_t a, uint8_t b, uint8_t c)
+{
+    int p = static_cast<int>(a) + static_cast<int>(b) - static_cast<int>(c);
+    int pa = std::abs(p - static_cast<int>(a));
+    int pb = std::abs(p - static_cast<int>(b));
+    int pc = std::abs(p - static_cast<int>(c));
+    if (pa <= pb && pa <= pc) {
+        return a;
+    } else if (pb <= pc) {
+        return b;
+    } else {
+        return c;
+    }
+}
+
+/*
+ * Filter a row into the output, which is preceded by the filter type.
+ * The previous row is null for the first row.
+ */
+static void
+FilterRow(PNG::Filter filter, uint8_t const *row, uint8_t const *previous, size_t size, size_t bytesPerPixel, uint8_t *output)
+{
+    for (size_t i = 0; i < size; i++) {
+        uint8_t a = (i >= bytesPerPixel ? row[i - bytesPerPixel] : 0);
+        uint8_t b = (previous != nullptr ? previous[i] : 0);
+        uint8_t c = (previous != nullptr && i >= bytesPerPixel ? previous[i - bytesPerPixel] : 0);
+
+        switch (filter) {
+            case PNG::Filter::None:
+                output[i + 1] = row[i];
+                break;
+            case PNG::Filter::Sub:
+                output[i + 1] = row[i] - a;
+                break;
+            case PNG::Filter::Up:
+                output[i + 1] = row[i] - b;
+                break;
+            case PNG::Filter::Average:
+                output[i + 1] = row[i] - static_cast<uint8_t>((static_cast<int>(a) + static_cast<int>(b)) / 2);
+                break;
+            case PNG::Filter::Paeth:
+                output[i + 1] = row[i] - PaethPredictor(a, b, c);
+                break;
+            case PNG::Filter::Adaptive:
+                abort();
+        }
+    }
+
+    output[0] = static_cast<uint8_t>(filter);
+}
+
+/*
+ * Filter a row with each filter, keeping the one with the smallest sum
+ * of absolute differences. This is the heuristic suggested by the PNG
+ * specification.
+ */
+static void
+FilterRowAdaptive(uint8_t const *row, uint8_t const *previous, size_t size, size_t bytesPerPixel, uint8_t *output)
+{
+    static PNG::Filter const filters[] = { PNG::Filter::None, PNG::Filter::Sub, PNG::Filter::Up, PNG::Filter::Average, PNG::Filter::Paeth };
+
+    std::vector<uint8_t> candidate = std::vector<uint8_t>(size + 1);
+    uint64_t best = UINT64_MAX;
+    for (PNG::Filter filter : filters) {
+        FilterRow(filter, row, previous, size, bytesPerPixel, candidate.data());
+
+        uint64_t sum = 0;
+        for (size_t i = 1; i < size + 1; i++) {
+            sum += std::abs(static_cast<int>(static_cast<int8_t>(candidate[i])));
+        }
+
+        if (sum < best) {
+            best = sum;
+            memcpy(output, candidate.data(), size + 1);
+        }
+    }
+}
+
 std::pair<ext::optional<std::vector<uint8_t>>, std::string> PNG::
 Write(Image const &image)
+{
+    return Write(image, Filter::None, Z_DEFAULT_COMPRESSION);
+}
+
+std::pair<ext::optional<std::vector<uint8_t>>, std::string> PNG::
+Write(Image const &image, Filter filter, int compressionLevel)
 {
     std::vector<uint8_t> png;
 
@@ -623,12 +709,14 @@ Write(Image const &image)
     strm.zfree = Z_NULL;
     strm.opaque = Z_NULL;
 
-    int ret = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, 8, 15, 8, Z_DEFAULT_STRATEGY);
+    /* Filtered data compresses best without string matching preferred. */
+    int strategy = (filter == Filter::None ? Z_DEFAULT_STRATEGY : Z_FILTERED);
+    int ret = deflateInit2(&strm, compressionLevel, 8, 15, 8, strategy);
     if (ret != Z_OK) {
         return std::make_pair(ext::nullopt, "deflate init failed");
     }
 
-    /* Add filter bytes between rows in the image. */
+    /* Filter each row, each preceded by its filter type. */
     uint32_t filter_stride = image.width() * format.bytesPerPixel();
     size_t filter_size = (data.size() / filter_stride);
     std::vector<uint8_t> buffer = std::vector<uint8_t>(data.size() + filter_size);
@@ -636,8 +724,14 @@ Write(Image const &image)
         size_t offset = (i * filter_stride);
         size_t filter_offset = i;
 
-        *(buffer.data() + offset + filter_offset) = 0; // filter format
-        memcpy(buffer.data() + offset + filter_offset + 1, data.data() + offset, filter_stride);
+        uint8_t const *row = data.data() + offset;
+        uint8_t const *previous = (i > 0 ? row - filter_stride : nullptr);
+        uint8_t *output = buffer.data() + offset + filter_offset;
+        if (filter == Filter::Adaptive) {
+            FilterRowAdaptive(row, previous, filter_stride, format.bytesPerPixel(), output);
+        } else {
+            FilterRow(filter, row, previous, filter_stride, format.bytesPerPixel(), output);
+        }
     }
 
     strm.avail_in = buffer.size();
@@ -700,3 +794,151 @@ Write(Image const &image)
     return std::make_pair(png, std::string());
 }
 
+
+/*
+ * A chunk within a PNG file: its offset and size, including the length,
+ * type, and checksum fields around its data.
+ */
+typedef std::pair<size_t, size_t> Chunk;
+
+static bool
+ReadChunks(std::vector<uint8_t> const &contents, std::vector<Chunk> *chunks)
+{
+    size_t offset = 8;
+    while (contents.size() - offset >= 12) {
+        uint32_t length_big;
+        memcpy(&length_big, contents.data() + offset, sizeof(length_big));
+        size_t length = ntohl(length_big);
+        if (contents.size() - offset - 12 < length) {
+            return false;
+        }
+
+        chunks->push_back({ offset, length + 12 });
+        offset += length + 12;
+
+        if (memcmp(contents.data() + chunks->back().first + 4, "IEND", 4) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Remove channels that carry no information: an alpha channel that is
+ * always opaque, and color channels that are always equal.
+ */
+static Image
+ReduceChannels(Image const &image)
+{
+    PixelFormat const &format = image.format();
+    std::vector<uint8_t> const &data = image.data();
+    size_t bytesPerPixel = format.bytesPerPixel();
+    bool alpha = (format.alpha() == PixelFormat::Alpha::Last);
+    bool rgb = (format.color() == PixelFormat::Color::RGB);
+
+    bool opaque = alpha;
+    bool gray = rgb;
+    for (size_t i = 0; i < data.size() && (opaque || gray); i += bytesPerPixel) {
+        if (opaque && data[i + bytesPerPixel - 1] != 0xff) {
+            opaque = false;
+        }
+        if (gray && (data[i] != data[i + 1] || data[i] != data[i + 2])) {
+            gray = false;
+        }
+    }
+
+    if (!opaque && !gray) {
+        return image;
+    }
+
+    bool keepAlpha = (alpha && !opaque);
+    size_t colors = (rgb && !gray ? 3 : 1);
+    std::vector<uint8_t> reduced;
+    reduced.reserve(data.size() / bytesPerPixel * (colors + (keepAlpha ? 1 : 0)));
+    for (size_t i = 0; i < data.size(); i += bytesPerPixel) {
+        reduced.insert(reduced.end(), data.begin() + i, data.begin() + i + colors);
+        if (keepAlpha) {
+            reduced.push_back(data[i + bytesPerPixel - 1]);
+        }
+    }
+
+    PixelFormat reducedFormat = PixelFormat(
+        (colors == 3 ? PixelFormat::Color::RGB : PixelFormat::Color::Grayscale),
+        PixelFormat::Order::Forward,
+        (keepAlpha ? PixelFormat::Alpha::Last : PixelFormat::Alpha::None));
+    return Image(image.width(), image.height(), reducedFormat, reduced);
+}
+
+std::pair<ext::optional<std::vector<uint8_t>>, std::string> PNG::
+Optimize(std::vector<uint8_t> const &contents)
+{
+    uint8_t const header[] = { 0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a };
+    if (contents.size() < sizeof(header) || memcmp(contents.data(), header, sizeof(header)) != 0) {
+        return std::make_pair(ext::nullopt, "contents is not a PNG");
+    }
+
+    std::vector<Chunk> chunks;
+    if (!ReadChunks(contents, &chunks) || chunks.front().second != 25 || memcmp(contents.data() + chunks.front().first + 4, "IHDR", 4) != 0) {
+        return std::make_pair(ext::nullopt, "invalid PNG chunks");
+    }
+
+    /*
+     * Keep only critical chunks, and the transparency chunk which affects
+     * how pixels are interpreted. Ancillary chunks have a lowercase type.
+     */
+    std::vector<uint8_t> stripped = std::vector<uint8_t>(std::begin(header), std::end(header));
+    bool transparency = false;
+    for (Chunk const &chunk : chunks) {
+        uint8_t const *type = contents.data() + chunk.first + 4;
+        if (memcmp(type, "CgBI", 4) == 0) {
+            /* Already optimized for iOS; only Apple's decoder can read it. */
+            return std::make_pair(contents, std::string());
+        }
+
+        bool critical = ((type[0] & 0x20) == 0);
+        bool trns = (memcmp(type, "tRNS", 4) == 0);
+        if (critical || trns) {
+            stripped.insert(stripped.end(), contents.begin() + chunk.first, contents.begin() + chunk.first + chunk.second);
+        }
+        transparency = transparency || trns;
+    }
+
+    std::vector<uint8_t> best = (stripped.size() < contents.size() ? stripped : contents);
+
+    /*
+     * Re-encoding goes through a decoded image, which only represents
+     * 8-bit images without a palette or a transparent color exactly.
+     */
+    uint8_t bit_depth = contents[chunks.front().first + 16];
+    uint8_t color_type = contents[chunks.front().first + 17];
+    if (bit_depth != 8 || color_type == 3 || transparency) {
+        return std::make_pair(best, std::string());
+    }
+
+    auto read = Read(contents);
+    if (!read.first) {
+        return std::make_pair(ext::nullopt, read.second);
+    }
+
+    PixelFormat const &format = read.first->format();
+    if (format.order() != PixelFormat::Order::Forward || (format.alpha() != PixelFormat::Alpha::None && format.alpha() != PixelFormat::Alpha::Last)) {
+        return std::make_pair(best, std::string());
+    }
+
+    Image image = ReduceChannels(*read.first);
+
+    static Filter const filters[] = { Filter::None, Filter::Sub, Filter::Up, Filter::Paeth, Filter::Adaptive };
+    for (Filter filter : filters) {
+        auto written = Write(image, filter, Z_BEST_COMPRESSION);
+        if (!written.first) {
+            return written;
+        }
+
+        if (written.first->size() < best.size()) {
+            best = std::move(*written.first);
+        }
+    }
+
+    return std::make_pair(best, std::string());
+}
@@ -0,0 +1,125 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <graphics/Format/PNGOptimizer.h>
+#include <graphics/Format/PNG.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/ThreadPool.h>
+#include <libutil/md5.h>
+
+using graphics::Format::PNGOptimizer;
+using graphics::Format::PNG;
+using libutil::Filesystem;
+using libutil::FSUtil;
+using libutil::ThreadPool;
+
+/*
+ * Identifies the optimization; change when the output would change.
+ */
+static char const CacheVersion[] = "1";
+
+PNGOptimizer::
+PNGOptimizer(Filesystem *filesystem, ext::optional<std::string> const &cachePath) :
+    _filesystem(filesystem),
+    _cachePath (cachePath)
+{
+    /*
+     * Cached files are used as-is, so only use a cache nobody else could
+     * have written to. Caching is best effort; without it, files are still
+     * optimized, just not saved.
+     */
+    if (_cachePath) {
+        if (!_filesystem->createDirectory(FSUtil::GetDirectoryName(*_cachePath), true) || !_filesystem->createPrivateDirectory(*_cachePath)) {
+            _cachePath = ext::nullopt;
+        }
+    }
+}
+
+static std::string
+ContentsDigest(std::vector<uint8_t> const &contents)
+{
+    md5_state_t state;
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<md5_byte_t const *>(CacheVersion), sizeof(CacheVersion));
+    md5_append(&state, reinterpret_cast<md5_byte_t const *>(contents.data()), contents.size());
+
+    uint8_t digest[16];
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
+
+    static char const hex[] = "0123456789abcdef";
+    std::string result;
+    for (uint8_t byte : digest) {
+        result += hex[byte >> 4];
+        result += hex[byte & 0xf];
+    }
+    return result;
+}
+
+std::pair<ext::optional<std::vector<uint8_t>>, std::string> PNGOptimizer::
+optimize(std::vector<uint8_t> const &contents) const
+{
+    std::string cacheFile;
+    if (_cachePath) {
+        cacheFile = *_cachePath + "/" + ContentsDigest(contents) + ".png";
+
+        std::vector<uint8_t> cached;
+        if (_filesystem->read(&cached, cacheFile)) {
+            return std::make_pair(cached, std::string());
+        }
+    }
+
+    auto optimized = PNG::Optimize(contents);
+    if (optimized.first && _cachePath) {
+        /* Replaced atomically, so other builds never read a partial file. */
+        (void)_filesystem->writeIfChanged(*optimized.first, cacheFile);
+    }
+
+    return optimized;
+}
+
+std::vector<std::pair<std::string, std::string>> PNGOptimizer::
+copy(ThreadPool *threadPool, std::vector<std::pair<std::string, std::string>> const &files) const
+{
+    /* Empty if the file was copied, otherwise why it failed. */
+    std::vector<std::string> errors = std::vector<std::string>(files.size());
+
+    threadPool->apply(files.size(), [this, &files, &errors](size_t index) {
+        std::pair<std::string, std::string> const &file = files[index];
+
+        std::vector<uint8_t> contents;
+        if (!_filesystem->read(&contents, file.first)) {
+            errors[index] = "unable to read file";
+            return;
+        }
+
+        auto optimized = optimize(contents);
+        if (!optimized.first) {
+            errors[index] = optimized.second;
+            return;
+        }
+
+        /* Leave files optimized in place untouched if nothing changed. */
+        if (file.first == file.second && *optimized.first == contents) {
+            return;
+        }
+
+        if (!_filesystem->write(*optimized.first, file.second)) {
+            errors[index] = "unable to write file";
+            return;
+        }
+    });
+
+    std::vector<std::pair<std::string, std::string>> failures;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!errors[i].empty()) {
+            failures.push_back({ files[i].first, errors[i] });
+        }
+    }
+    return failures;
+}
@@ -11,6 +11,8 @@
 #include <graphics/Image.h>
 #include <graphics/PixelFormat.h>
 
+#include <zlib.h>
+
 using graphics::Format::PNG;
 using graphics::Image;
 using graphics::PixelFormat;
@@ -155,3 +157,73 @@ TEST(PNG, Write)
         EXPECT_EQ(*result.first, png);
     }
 }
+
+static Image
+Gradient(size_t width, size_t height, PixelFormat::Color color, PixelFormat::Alpha alpha)
+{
+    PixelFormat format = PixelFormat(color, PixelFormat::Order::Forward, alpha);
+    std::vector<uint8_t> pixels;
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            for (size_t c = 0; c < format.bytesPerPixel(); c++) {
+                pixels.push_back(static_cast<uint8_t>(x * 3 + y * 5 + c * 40));
+            }
+        }
+    }
+    return Image(width, height, format, pixels);
+}
+
+TEST(PNG, WriteFilters)
+{
+    Image image = Gradient(17, 9, PixelFormat::Color::RGB, PixelFormat::Alpha::Last);
+
+    PNG::Filter const filters[] = { PNG::Filter::None, PNG::Filter::Sub, PNG::Filter::Up, PNG::Filter::Average, PNG::Filter::Paeth, PNG::Filter::Adaptive };
+    for (PNG::Filter filter : filters) {
+        auto written = PNG::Write(image, filter, 9);
+        ASSERT_NE(written.first, ext::nullopt);
+
+        /* Filtering must not change the pixels. */
+        auto read = PNG::Read(*written.first);
+        ASSERT_NE(read.first, ext::nullopt);
+        EXPECT_EQ(PixelFormat::Convert(read.first->data(), read.first->format(), image.format()), image.data());
+    }
+}
+
+TEST(PNG, Optimize)
+{
+    /* An opaque image with an alpha channel, stored uncompressed. */
+    Image image = Gradient(32, 32, PixelFormat::Color::RGB, PixelFormat::Alpha::None);
+    PixelFormat opaqueFormat = PixelFormat(PixelFormat::Color::RGB, PixelFormat::Order::Forward, PixelFormat::Alpha::Last);
+    std::vector<uint8_t> opaque;
+    for (size_t i = 0; i < image.data().size(); i += 3) {
+        opaque.insert(opaque.end(), image.data().begin() + i, image.data().begin() + i + 3);
+        opaque.push_back(0xff);
+    }
+    auto written = PNG::Write(Image(32, 32, opaqueFormat, opaque), PNG::Filter::None, 0);
+    ASSERT_NE(written.first, ext::nullopt);
+    std::vector<uint8_t> png = *written.first;
+
+    /* Add a text chunk after the header. */
+    std::vector<uint8_t> text = { 0x0, 0x0, 0x0, 0x2, 't', 'E', 'X', 't', 'a', 0x0 };
+    uint32_t crc = crc32(crc32(0, NULL, 0), text.data() + 4, text.size() - 4);
+    text.insert(text.end(), { static_cast<uint8_t>(crc >> 24), static_cast<uint8_t>(crc >> 16), static_cast<uint8_t>(crc >> 8), static_cast<uint8_t>(crc) });
+    png.insert(png.begin() + 33, text.begin(), text.end());
+
+    auto optimized = PNG::Optimize(png);
+    ASSERT_NE(optimized.first, ext::nullopt);
+    EXPECT_LT(optimized.first->size(), png.size());
+    EXPECT_EQ(std::string::npos, std::string(optimized.first->begin(), optimized.first->end()).find("tEXt"));
+
+    /* The pixels are unchanged, but the unused alpha channel is gone. */
+    auto read = PNG::Read(*optimized.first);
+    ASSERT_NE(read.first, ext::nullopt);
+    EXPECT_EQ(PixelFormat::Alpha::None, read.first->format().alpha());
+    EXPECT_EQ(PixelFormat::Convert(read.first->data(), read.first->format(), image.format()), image.data());
+
+    /* Already optimal images are unchanged. */
+    auto again = PNG::Optimize(*optimized.first);
+    ASSERT_NE(again.first, ext::nullopt);
+    EXPECT_EQ(*optimized.first, *again.first);
+
+    EXPECT_EQ(ext::nullopt, PNG::Optimize({ 0x1, 0x2, 0x3 }).first);
+}
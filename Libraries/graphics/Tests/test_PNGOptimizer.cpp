@@ -0,0 +1,84 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <graphics/Format/PNG.h>
+#include <graphics/Format/PNGOptimizer.h>
+#include <graphics/Image.h>
+#include <graphics/PixelFormat.h>
+#include <libutil/MemoryFilesystem.h>
+#include <libutil/ThreadPool.h>
+
+using graphics::Format::PNG;
+using graphics::Format::PNGOptimizer;
+using graphics::Image;
+using graphics::PixelFormat;
+using libutil::Filesystem;
+using libutil::MemoryFilesystem;
+using libutil::ThreadPool;
+
+static std::vector<uint8_t>
+Uncompressed()
+{
+    PixelFormat format = PixelFormat(PixelFormat::Color::Grayscale, PixelFormat::Order::Forward, PixelFormat::Alpha::None);
+    auto image = Image(16, 16, format, std::vector<uint8_t>(16 * 16, 0x80));
+    return *PNG::Write(image, PNG::Filter::None, 0).first;
+}
+
+TEST(PNGOptimizer, Copy)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("in.png", Uncompressed()),
+        MemoryFilesystem::Entry::File("bad.png", { 0x1 }),
+    });
+
+    /* A pool with one thread works on the calling thread, as the memory filesystem is not thread safe. */
+    ThreadPool threadPool(1);
+    PNGOptimizer optimizer = PNGOptimizer(&filesystem, filesystem.path("cache"));
+    auto failures = optimizer.copy(&threadPool, {
+        { filesystem.path("in.png"), filesystem.path("out.png") },
+        { filesystem.path("bad.png"), filesystem.path("bad-out.png") },
+        { filesystem.path("missing.png"), filesystem.path("missing-out.png") },
+    });
+    ASSERT_EQ(2, failures.size());
+    EXPECT_EQ(filesystem.path("bad.png"), failures[0].first);
+    EXPECT_EQ(filesystem.path("missing.png"), failures[1].first);
+
+    std::vector<uint8_t> out;
+    ASSERT_TRUE(filesystem.read(&out, filesystem.path("out.png")));
+    EXPECT_LT(out.size(), Uncompressed().size());
+    EXPECT_FALSE(filesystem.exists(filesystem.path("bad-out.png")));
+
+    /* The result is cached by the original contents. */
+    std::vector<uint8_t> const marker = { 0x0 };
+    size_t cached = 0;
+    filesystem.readDirectory(filesystem.path("cache"), false, [&](std::string const &name) {
+        cached++;
+        ASSERT_TRUE(filesystem.write(marker, filesystem.path("cache") + "/" + name));
+    });
+    EXPECT_EQ(1, cached);
+
+    /* Cached files are written atomically, so are used as they are. */
+    auto optimized = optimizer.optimize(Uncompressed());
+    ASSERT_NE(ext::nullopt, optimized.first);
+    EXPECT_EQ(marker, *optimized.first);
+}
+
+TEST(PNGOptimizer, UnusableCache)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::File("cache", { 0x1 }),
+    });
+
+    /* Without a cache directory, files are still optimized. */
+    PNGOptimizer optimizer = PNGOptimizer(&filesystem, filesystem.path("cache"));
+    auto optimized = optimizer.optimize(Uncompressed());
+    ASSERT_NE(ext::nullopt, optimized.first);
+    EXPECT_LT(optimized.first->size(), Uncompressed().size());
+    EXPECT_EQ(Filesystem::Type::File, filesystem.type(filesystem.path("cache")));
+}
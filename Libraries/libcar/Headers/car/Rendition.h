@@ -84,6 +84,25 @@ public:
         { return _format; }
     };
 
+public:
+    /*
+     * How to trade encoding time against encoded size.
+     */
+    enum class Optimization {
+        /*
+         * Balance encoding time and size.
+         */
+        Default,
+        /*
+         * Encode as quickly as possible, such as for debug builds.
+         */
+        Time,
+        /*
+         * Encode as small as possible, such as for release builds.
+         */
+        Space,
+    };
+
 public:
     enum class ResizeMode {
         FixedSize,
@@ -235,7 +254,7 @@ public:
     /*
      * Serialize the rendition for writing to a file.
      */
-    std::vector<uint8_t> write() const;
+    std::vector<uint8_t> write(Optimization optimization = Optimization::Default) const;
 
 public:
     /*
@@ -43,7 +43,9 @@ private:
     ext::optional<struct car_key_format *> _keyfmt;
     std::unordered_map<std::string, Facet> _facets;
     std::unordered_multimap<uint16_t, Rendition> _renditions;
+    std::vector<std::pair<AttributeList, std::vector<uint8_t>>> _encodedRenditions;
     std::vector<KeyValuePair> _rawRenditions;
+    Rendition::Optimization _optimization;
 
 private:
     Writer(unique_ptr_bom bom);
@@ -66,6 +68,12 @@ public:
      */
     void addRendition(Rendition const &rendition);
 
+    /*
+     * Add a rendition for a facet that is already serialized, such as by
+     * `Rendition::write()`. The key is created from the attributes.
+     */
+    void addRendition(AttributeList const &attributes, std::vector<uint8_t> const &value);
+
     /*
      * Add a rendition for a facet, optimized for fast editing of CAR files
      */
@@ -77,6 +85,14 @@ public:
     ext::optional<struct car_key_format *> &keyfmt()
     { return _keyfmt; }
 
+    /*
+     * How renditions added lazily are encoded when written.
+     */
+    Rendition::Optimization optimization() const
+    { return _optimization; }
+    Rendition::Optimization &optimization()
+    { return _optimization; }
+
 public:
     /*
      * Create a new archive inside a BOM.
@@ -141,7 +141,7 @@ dump() const
 }
 
 static ext::optional<Rendition::Data> Decode(struct car_rendition_value *value);
-static ext::optional<std::vector<uint8_t>> Encode(Rendition const *rendition, ext::optional<Rendition::Data> data);
+static ext::optional<std::vector<uint8_t>> Encode(Rendition const *rendition, ext::optional<Rendition::Data> data, Rendition::Optimization optimization);
 
 
 static Rendition::ResizeMode
@@ -436,7 +436,7 @@ Decode(struct car_rendition_value *value)
 }
 
 static ext::optional<std::vector<uint8_t>>
-Encode(Rendition const *rendition, ext::optional<Rendition::Data> data)
+Encode(Rendition const *rendition, ext::optional<Rendition::Data> data, Rendition::Optimization optimization)
 {
     if (!data || data->data().size() == 0) {
         return ext::nullopt;
@@ -464,29 +464,46 @@ Encode(Rendition const *rendition, ext::optional<Rendition::Data> data)
         zlibStream.avail_in = static_cast<uInt>(uncompressed_length);
 
         int deflateLevel = Z_DEFAULT_COMPRESSION;
+        switch (optimization) {
+            case Rendition::Optimization::Default:
+                break;
+            case Rendition::Optimization::Time:
+                deflateLevel = Z_BEST_SPEED;
+                break;
+            case Rendition::Optimization::Space:
+                deflateLevel = Z_BEST_COMPRESSION;
+                break;
+        }
+
         int windowSize = 16 + MAX_WBITS;
         int err = deflateInit2(&zlibStream, deflateLevel, Z_DEFLATED, windowSize, 8, Z_DEFAULT_STRATEGY);
         if (err != Z_OK) {
             return ext::nullopt;
         }
 
+        /* Compress directly into the output; the bound is enough to finish in one pass. */
+        compressed_vector.resize(deflateBound(&zlibStream, zlibStream.avail_in));
+        zlibStream.next_out = static_cast<Bytef *>(compressed_vector.data());
+        zlibStream.avail_out = static_cast<uInt>(compressed_vector.size());
+
         while (true) {
-            uint8_t tmp[4096];
-            zlibStream.next_out = (Bytef*)&tmp;
-            zlibStream.avail_out = (uInt)sizeof(tmp);
             err = deflate(&zlibStream, Z_FINISH);
-            size_t block_size = sizeof(tmp) - zlibStream.avail_out;
-            compressed_vector.resize(compressed_vector.size() + block_size);
-            memcpy(&compressed_vector[compressed_vector.size() - block_size], &tmp[0], block_size);
             if (err == Z_STREAM_END) {  /* Done */
                 break;
             }
-            if (err != Z_OK) {  /* Z_OK -> Made progress, else err */
+            if (err != Z_OK && err != Z_BUF_ERROR) {  /* Z_OK -> Made progress, else err */
                 deflateEnd(&zlibStream);
                 fprintf(stderr, "Zlib error %d", err);
                 return ext::nullopt;
             }
+
+            /* Out of space, grow and continue. */
+            size_t used = compressed_vector.size() - zlibStream.avail_out;
+            compressed_vector.resize(compressed_vector.size() * 2);
+            zlibStream.next_out = static_cast<Bytef *>(compressed_vector.data() + used);
+            zlibStream.avail_out = static_cast<uInt>(compressed_vector.size() - used);
         }
+        compressed_vector.resize(zlibStream.total_out);
         deflateEnd(&zlibStream);
 
         /* The gzip header includes an operating system field. For consistent results, clear it. */
@@ -523,7 +540,7 @@ Create(
 }
 
 std::vector<uint8_t> Rendition::
-write() const
+write(Optimization optimization) const
 {
     // Create header
     struct car_rendition_value header;
@@ -625,7 +642,7 @@ write() const
     info_bytes_per_row.bytes_per_row = _width * bytes_per_pixel;
 
     // Write bitmap data
-    ext::optional<std::vector<uint8_t>> data = Encode(this, renditionData);
+    ext::optional<std::vector<uint8_t>> data = Encode(this, renditionData, optimization);
     if (!data) {
         printf("Error: no bitmap data for %s\n", this->fileName().c_str());
         data = ext::optional<std::vector<uint8_t>>(std::vector<uint8_t>());
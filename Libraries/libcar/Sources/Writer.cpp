@@ -23,7 +23,8 @@ using car::Rendition;
 
 Writer::
 Writer(unique_ptr_bom bom) :
-    _bom(std::move(bom))
+    _bom         (std::move(bom)),
+    _optimization(Rendition::Optimization::Default)
 {
 }
 
@@ -48,6 +49,12 @@ addRendition(Rendition const &rendition)
     }
 }
 
+void Writer::
+addRendition(AttributeList const &attributes, std::vector<uint8_t> const &value)
+{
+    _encodedRenditions.push_back({ attributes, value });
+}
+
 void Writer::
 addRendition(void *key, size_t key_len, void *value, size_t value_len)
 {
@@ -58,7 +65,8 @@ addRendition(void *key, size_t key_len, void *value, size_t value_len)
 static std::vector<enum car_attribute_identifier>
 DetermineKeyFormat(
     std::unordered_map<std::string, Facet> const &facets,
-    std::unordered_multimap<uint16_t, Rendition> const &renditions)
+    std::unordered_multimap<uint16_t, Rendition> const &renditions,
+    std::vector<std::pair<car::AttributeList, std::vector<uint8_t>>> const &encodedRenditions)
 {
     std::unordered_set<enum car_attribute_identifier> format;
     auto insert = [&format](enum car_attribute_identifier identifier, uint16_t value) {
@@ -73,6 +81,10 @@ DetermineKeyFormat(
         item.second.attributes().iterate(insert);
     }
 
+    for (auto const &item : encodedRenditions) {
+        item.first.iterate(insert);
+    }
+
     /* Sort attributes to preserve ordering. */
     auto ordered = std::set<enum car_attribute_identifier>(format.begin(), format.end());
     return std::vector<enum car_attribute_identifier>(ordered.begin(), ordered.end());
@@ -87,7 +99,7 @@ write() const
      * Each tree entry (facet or rendition) requires 2: one key index, one value index.
      */
     uint32_t facet_count = _facets.size();
-    uint32_t rendition_count = _renditions.size() + _rawRenditions.size();
+    uint32_t rendition_count = _renditions.size() + _encodedRenditions.size() + _rawRenditions.size();
     uint32_t bom_index_count = 8 + facet_count * 2 + rendition_count * 2;
     bom_index_reserve(_bom.get(), bom_index_count);
 
@@ -124,7 +136,7 @@ write() const
     struct car_key_format *keyfmt;
     size_t keyfmt_size;
     if (_keyfmt == ext::nullopt) {
-      std::vector<enum car_attribute_identifier> format = DetermineKeyFormat(_facets, _renditions);
+      std::vector<enum car_attribute_identifier> format = DetermineKeyFormat(_facets, _renditions, _encodedRenditions);
       keyfmt_size = sizeof(struct car_key_format) + (format.size() * sizeof(uint32_t));
       keyfmt = (struct car_key_format *)malloc(keyfmt_size);
       strncpy(keyfmt->magic, "tmfk", 4);
@@ -163,7 +175,7 @@ write() const
     if (renditions_tree_context != NULL) {
         for (auto const &item : _renditions) {
             auto attributes_value = item.second.attributes().write(keyfmt->num_identifiers, keyfmt->identifier_list);
-            auto rendition_value = item.second.write();
+            auto rendition_value = item.second.write(_optimization);
             bom_tree_add(
                 renditions_tree_context,
                 reinterpret_cast<void const *>(attributes_value.data()),
@@ -171,6 +183,15 @@ write() const
                 reinterpret_cast<void const *>(rendition_value.data()),
                 rendition_value.size());
         }
+        for (auto const &item : _encodedRenditions) {
+            auto attributes_value = item.first.write(keyfmt->num_identifiers, keyfmt->identifier_list);
+            bom_tree_add(
+                renditions_tree_context,
+                reinterpret_cast<void const *>(attributes_value.data()),
+                attributes_value.size(),
+                reinterpret_cast<void const *>(item.second.data()),
+                item.second.size());
+        }
         for (auto const &item : _rawRenditions) {
             bom_tree_add(
                 renditions_tree_context,
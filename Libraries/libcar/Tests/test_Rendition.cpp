@@ -243,3 +243,35 @@ TEST(Rendition, SerializeSlices)
     }
 }
 
+
+TEST(Rendition, SerializeOptimization)
+{
+    size_t width = 64;
+    size_t height = 64;
+
+    /* A gradient, so the encoding levels differ. */
+    auto format = car::Rendition::Data::Format::PremultipliedBGRA8;
+    auto bitmap = std::vector<uint8_t>(width * height * 4);
+    for (size_t i = 0; i < bitmap.size(); i++) {
+        bitmap[i] = static_cast<uint8_t>((i % 4 == 3) ? 0xff : (i * 7) / (i % 5 + 1));
+    }
+
+    auto data = car::Rendition::Data(bitmap, format);
+    car::Rendition rendition = car::Rendition::Create(EmptyAttributeList(), data);
+    rendition.width() = width;
+    rendition.height() = height;
+    rendition.scale() = 1.0;
+    rendition.fileName() = "test.png";
+
+    std::vector<uint8_t> time = rendition.write(Rendition::Optimization::Time);
+    std::vector<uint8_t> space = rendition.write(Rendition::Optimization::Space);
+    EXPECT_EQ(rendition.write(), rendition.write(Rendition::Optimization::Default));
+    EXPECT_LE(space.size(), time.size());
+
+    /* Every optimization decodes to the same pixels. */
+    for (std::vector<uint8_t> *value : { &time, &space }) {
+        car::Rendition deserialized_rendition = car::Rendition::Load(EmptyAttributeList(), reinterpret_cast<struct car_rendition_value *>(value->data()));
+        ASSERT_NE(ext::nullopt, deserialized_rendition.data());
+        EXPECT_EQ(bitmap, deserialized_rendition.data()->data());
+    }
+}
@@ -253,3 +253,55 @@ TEST(Writer, TestWriter100Optimal)
     EXPECT_EQ(rendition_count, create_rendition_count);
 }
 
+
+TEST(Writer, TestWriterEncoded)
+{
+    auto writer_bom = car::Writer::unique_ptr_bom(bom_alloc_empty(bom_context_memory(NULL, 0)), bom_free);
+    EXPECT_NE(writer_bom, nullptr);
+
+    auto writer = car::Writer::Create(std::move(writer_bom));
+    EXPECT_NE(writer, ext::nullopt);
+
+    car::AttributeList attributes = car::AttributeList({
+        { car_attribute_identifier_idiom, car_attribute_identifier_idiom_value_universal },
+        { car_attribute_identifier_scale, 2 },
+        { car_attribute_identifier_identifier, 1 },
+    });
+
+    car::Facet facet = car::Facet::Create("testpattern", attributes);
+    writer->addFacet(facet);
+
+    /* Serialize the rendition ahead of time, as if it were reused. */
+    auto data = car::Rendition::Data(test_pixels, car::Rendition::Data::Format::PremultipliedBGRA8);
+    car::Rendition rendition = car::Rendition::Create(attributes, data);
+    rendition.width() = 8;
+    rendition.height() = 8;
+    rendition.scale() = 2;
+    rendition.fileName() = "testpattern.png";
+    rendition.layout() = car_rendition_value_layout_one_part_scale;
+    writer->addRendition(attributes, rendition.write());
+
+    writer->write();
+
+    /* Read back. */
+    struct bom_context_memory const *writer_memory = bom_memory(writer->bom());
+    struct bom_context_memory reader_memory = bom_context_memory(writer_memory->data, writer_memory->size);
+    auto reader_bom = std::unique_ptr<struct bom_context, decltype(&bom_free)>(bom_alloc_load(reader_memory), bom_free);
+    EXPECT_NE(reader_bom, nullptr);
+
+    ext::optional<car::Reader> reader = car::Reader::Load(std::move(reader_bom));
+    EXPECT_NE(reader, ext::nullopt);
+
+    int rendition_count = 0;
+    reader->facetIterate([&reader, &rendition_count](car::Facet const &facet) {
+        EXPECT_EQ(facet.name(), "testpattern");
+
+        for (auto const &rendition : reader->lookupRenditions(facet)) {
+            rendition_count++;
+            EXPECT_EQ(rendition.data()->data(), test_pixels);
+            EXPECT_EQ(rendition.fileName(), "testpattern.png");
+        }
+    });
+
+    EXPECT_EQ(rendition_count, 1);
+}
@@ -0,0 +1,142 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <bom/bom.h>
+#include <car/AttributeList.h>
+#include <car/Rendition.h>
+#include <car/Writer.h>
+#include <graphics/Image.h>
+#include <graphics/PixelFormat.h>
+#include <graphics/Format/PNG.h>
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/*
+ * Compares the time to encode renditions and the size of the resulting
+ * archive for each optimization. Encodes the PNG images given, or a set
+ * of generated images if none are.
+ */
+
+static ext::optional<car::Rendition::Data>
+ReadImage(std::string const &path, size_t *width, size_t *height)
+{
+    std::ifstream file = std::ifstream(path, std::ios::binary);
+    if (file.fail()) {
+        return ext::nullopt;
+    }
+    std::vector<uint8_t> contents = std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    auto png = graphics::Format::PNG::Read(contents);
+    if (!png.first) {
+        return ext::nullopt;
+    }
+
+    graphics::Image const &image = *png.first;
+    *width = image.width();
+    *height = image.height();
+
+    std::vector<uint8_t> pixels = graphics::PixelFormat::Convert(
+        image.data(),
+        image.format(),
+        graphics::PixelFormat(
+            graphics::PixelFormat::Color::RGB,
+            graphics::PixelFormat::Order::Reversed,
+            graphics::PixelFormat::Alpha::PremultipliedFirst));
+    return car::Rendition::Data(pixels, car::Rendition::Data::Format::PremultipliedBGRA8);
+}
+
+static car::Rendition::Data
+GenerateImage(size_t index, size_t width, size_t height)
+{
+    /* Gradients with some noise, roughly as compressible as icons. */
+    std::vector<uint8_t> pixels = std::vector<uint8_t>(width * height * 4);
+    uint32_t seed = static_cast<uint32_t>(index + 1);
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            seed = seed * 1103515245 + 12345;
+            uint8_t noise = static_cast<uint8_t>((seed >> 16) & 0x7);
+
+            uint8_t *pixel = &pixels[(y * width + x) * 4];
+            pixel[0] = static_cast<uint8_t>(x * 255 / width + noise);
+            pixel[1] = static_cast<uint8_t>(y * 255 / height + index);
+            pixel[2] = static_cast<uint8_t>((x + y) * 127 / (width + height) + noise);
+            pixel[3] = 0xff;
+        }
+    }
+    return car::Rendition::Data(pixels, car::Rendition::Data::Format::PremultipliedBGRA8);
+}
+
+int
+main(int argc, char **argv)
+{
+    std::vector<car::Rendition> renditions;
+    for (int i = 1; i < argc; i++) {
+        size_t width = 0;
+        size_t height = 0;
+        ext::optional<car::Rendition::Data> data = ReadImage(argv[i], &width, &height);
+        if (!data) {
+            fprintf(stderr, "error: unable to read PNG %s\n", argv[i]);
+            return 1;
+        }
+
+        car::Rendition rendition = car::Rendition::Create(car::AttributeList({ }), data);
+        rendition.width() = width;
+        rendition.height() = height;
+        rendition.fileName() = argv[i];
+        renditions.push_back(rendition);
+    }
+
+    if (renditions.empty()) {
+        for (size_t i = 0; i < 64; i++) {
+            car::Rendition rendition = car::Rendition::Create(car::AttributeList({ }), GenerateImage(i, 256, 256));
+            rendition.width() = 256;
+            rendition.height() = 256;
+            rendition.fileName() = "image" + std::to_string(i) + ".png";
+            renditions.push_back(rendition);
+        }
+    }
+
+    std::vector<std::pair<std::string, car::Rendition::Optimization>> optimizations = {
+        { "default", car::Rendition::Optimization::Default },
+        { "time", car::Rendition::Optimization::Time },
+        { "space", car::Rendition::Optimization::Space },
+    };
+
+    printf("%-10s %12s %16s %14s\n", "mode", "encode (ms)", "renditions (B)", "archive (B)");
+    for (auto const &optimization : optimizations) {
+        auto writer = car::Writer::Create(car::Writer::unique_ptr_bom(bom_alloc_empty(bom_context_memory(NULL, 0)), bom_free));
+        if (!writer) {
+            fprintf(stderr, "error: unable to create archive\n");
+            return 1;
+        }
+
+        size_t encodedSize = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < renditions.size(); i++) {
+            car::AttributeList attributes = car::AttributeList({
+                { car_attribute_identifier_idiom, car_attribute_identifier_idiom_value_universal },
+                { car_attribute_identifier_identifier, static_cast<uint16_t>(i + 1) },
+            });
+            std::vector<uint8_t> encoded = renditions[i].write(optimization.second);
+            encodedSize += encoded.size();
+            writer->addRendition(attributes, encoded);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        writer->write();
+
+        double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+        printf("%-10s %12.1f %16zu %14zu\n", optimization.first.c_str(), milliseconds, encodedSize, bom_memory(writer->bom())->size);
+    }
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __libutil_CachingFilesystem_h
+#define __libutil_CachingFilesystem_h
+
+#include <libutil/Filesystem.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace libutil {
+
+/*
+ * Wraps another filesystem, remembering the results of queries about
+ * entries, directory listings, and file lookups. Changes made through
+ * this filesystem invalidate the affected results; changes made any other
+ * way are not seen until `invalidate()` is called. Safe to use from
+ * multiple threads; the wrapped filesystem must also be.
+ */
+class CachingFilesystem : public Filesystem {
+private:
+    class Entry {
+    public:
+        ext::optional<bool>                    exists;
+        ext::optional<ext::optional<Type>>     type;
+        ext::optional<bool>                    readable;
+        ext::optional<bool>                    writable;
+        ext::optional<bool>                    executable;
+    };
+
+private:
+    Filesystem                                                  *_filesystem;
+
+private:
+    mutable std::mutex                                           _mutex;
+    mutable uint64_t                                             _generation;
+    mutable std::unordered_map<std::string, Entry>               _entries;
+    mutable std::map<std::pair<std::string, bool>, std::vector<std::string>> _directories;
+    mutable std::unordered_map<std::string, ext::optional<std::string>> _lookups;
+    mutable std::unordered_map<std::string, std::string>         _resolvedPaths;
+
+private:
+    mutable std::atomic<size_t>                                  _hits;
+    mutable std::atomic<size_t>                                  _misses;
+
+public:
+    explicit CachingFilesystem(Filesystem *filesystem);
+    virtual ~CachingFilesystem();
+
+public:
+    /*
+     * The filesystem being cached.
+     */
+    Filesystem *filesystem() const
+    { return _filesystem; }
+
+public:
+    /*
+     * Number of queries answered from the cache.
+     */
+    size_t hits() const
+    { return _hits; }
+
+    /*
+     * Number of queries passed through to the wrapped filesystem.
+     */
+    size_t misses() const
+    { return _misses; }
+
+public:
+    /*
+     * Forget all cached results, such as after external changes.
+     */
+    void invalidate();
+
+public:
+    virtual bool exists(std::string const &path) const;
+    virtual ext::optional<Type> type(std::string const &path) const;
+    virtual ext::optional<uint64_t> modificationTime(std::string const &path) const;
+
+public:
+    virtual bool isReadable(std::string const &path) const;
+    virtual bool isWritable(std::string const &path) const;
+    virtual bool isExecutable(std::string const &path) const;
+
+public:
+    virtual ext::optional<Permissions> readFilePermissions(std::string const &path) const;
+    virtual bool writeFilePermissions(std::string const &path, Permissions::Operation operation, Permissions permissions);
+    virtual bool createFile(std::string const &path);
+    virtual bool read(std::vector<uint8_t> *contents, std::string const &path, size_t offset = 0, ext::optional<size_t> length = ext::nullopt) const;
+    virtual bool write(std::vector<uint8_t> const &contents, std::string const &path);
+    virtual bool writeIfChanged(std::vector<uint8_t> const &contents, std::string const &path, bool *written = nullptr);
+    virtual bool copyFile(std::string const &from, std::string const &to);
+    virtual bool removeFile(std::string const &path);
+
+public:
+    virtual ext::optional<Permissions> readSymbolicLinkPermissions(std::string const &path) const;
+    virtual bool writeSymbolicLinkPermissions(std::string const &path, Permissions::Operation operation, Permissions permissions);
+    virtual ext::optional<std::string> readSymbolicLinkCanonical(std::string const &path, bool *directory = nullptr) const;
+    virtual ext::optional<std::string> readSymbolicLink(std::string const &path, bool *directory = nullptr) const;
+    virtual bool writeSymbolicLink(std::string const &target, std::string const &path, bool directory);
+    virtual bool copySymbolicLink(std::string const &from, std::string const &to);
+    virtual bool removeSymbolicLink(std::string const &path);
+
+public:
+    virtual ext::optional<Permissions> readDirectoryPermissions(std::string const &path) const;
+    virtual bool writeDirectoryPermissions(std::string const &path, Permissions::Operation operation, Permissions permissions, bool recursive);
+    virtual bool createDirectory(std::string const &path, bool recursive);
+    virtual bool createPrivateDirectory(std::string const &path);
+    virtual bool readDirectory(std::string const &path, bool recursive, std::function<void(std::string const &)> const &cb) const;
+    virtual bool copyDirectory(std::string const &from, std::string const &to, bool recursive);
+    virtual bool removeDirectory(std::string const &path, bool recursive);
+
+public:
+    virtual std::string resolvePath(std::string const &path) const;
+
+public:
+    virtual ext::optional<std::string> findFile(std::string const &name, std::vector<std::string> const &paths) const;
+    virtual ext::optional<std::string> findExecutable(std::string const &name, std::vector<std::string> const &paths) const;
+
+private:
+    template<typename T, typename F>
+    T entryValue(std::string const &path, ext::optional<T> Entry::*field, F const &compute) const;
+
+private:
+    ext::optional<std::string> lookup(bool executable, std::string const &name, std::vector<std::string> const &paths) const;
+
+private:
+    void invalidate(std::string const &path);
+};
+
+}
+
+#endif  // !__libutil_CachingFilesystem_h
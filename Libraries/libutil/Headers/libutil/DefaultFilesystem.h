@@ -17,6 +17,7 @@ class DefaultFilesystem : public Filesystem {
 public:
     virtual bool exists(std::string const &path) const;
     virtual ext::optional<Type> type(std::string const &path) const;
+    virtual ext::optional<uint64_t> modificationTime(std::string const &path) const;
 
 public:
     virtual bool isReadable(std::string const &path) const;
@@ -29,6 +30,7 @@ public:
     virtual bool createFile(std::string const &path);
     virtual bool read(std::vector<uint8_t> *contents, std::string const &path, size_t offset = 0, ext::optional<size_t> length = ext::nullopt) const;
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path);
+    virtual bool writeIfChanged(std::vector<uint8_t> const &contents, std::string const &path, bool *written = nullptr);
     virtual bool copyFile(std::string const &from, std::string const &to);
     virtual bool removeFile(std::string const &path);
 
@@ -45,7 +47,9 @@ public:
     virtual ext::optional<Permissions> readDirectoryPermissions(std::string const &path) const;
     virtual bool writeDirectoryPermissions(std::string const &path, Permissions::Operation operation, Permissions permissions, bool recursive);
     virtual bool createDirectory(std::string const &path, bool recursive);
+    virtual bool createPrivateDirectory(std::string const &path);
     virtual bool readDirectory(std::string const &path, bool recursive, std::function<void(std::string const &)> const &cb) const;
+    virtual bool readDirectoryEntries(std::string const &path, bool metadata, std::vector<DirectoryEntry> *entries) const;
     virtual bool copyDirectory(std::string const &from, std::string const &to, bool recursive);
     virtual bool removeDirectory(std::string const &path, bool recursive);
 
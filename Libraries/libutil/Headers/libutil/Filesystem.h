@@ -12,12 +12,15 @@
 #include <libutil/Permissions.h>
 
 #include <functional>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <ext/optional>
 
 namespace libutil {
 
+class ThreadPool;
+
 class Filesystem {
 public:
     /*
@@ -38,6 +41,27 @@ public:
         Directory,
     };
 
+    /*
+     * An entry found while reading a directory.
+     */
+    struct DirectoryEntry {
+        /*
+         * The path of the entry, relative to the directory read.
+         */
+        std::string path;
+        /*
+         * The type of the entry, without following symbolic links. Not
+         * set for unsupported types, such as devices.
+         */
+        ext::optional<Type> type;
+        /*
+         * The modification stamp, and for files the size, if metadata
+         * was requested.
+         */
+        ext::optional<uint64_t> modificationTime;
+        ext::optional<uint64_t> size;
+    };
+
 public:
     /*
      * Test if a filesystem entry exists.
@@ -49,6 +73,13 @@ public:
      */
     virtual ext::optional<Type> type(std::string const &path) const = 0;
 
+    /*
+     * Get an opaque modification stamp for a filesystem entry. The stamp
+     * changes when the entry is modified; for a directory, that includes
+     * adding or removing entries inside it.
+     */
+    virtual ext::optional<uint64_t> modificationTime(std::string const &path) const = 0;
+
 public:
     /*
      * Test if a file is readable.
@@ -92,6 +123,13 @@ public:
      */
     virtual bool write(std::vector<uint8_t> const &contents, std::string const &path) = 0;
 
+    /*
+     * Write to a file, unless it already has the same contents. Unchanged
+     * files are left untouched, keeping their modification time, so work
+     * depending on them isn't redone. Optionally reports if it was written.
+     */
+    virtual bool writeIfChanged(std::vector<uint8_t> const &contents, std::string const &path, bool *written = nullptr);
+
     /*
      * Copy a file to a new path.
      */
@@ -155,11 +193,40 @@ public:
      */
     virtual bool createDirectory(std::string const &path, bool recursive) = 0;
 
+    /*
+     * Create a directory only the current user can access, or check that
+     * an existing one is. Fails if it is owned by another user or others
+     * can write to it, so its contents can be trusted. Filesystems without
+     * users only create it.
+     */
+    virtual bool createPrivateDirectory(std::string const &path);
+
     /*
      * Enumerate contents of a directory.
      */
     virtual bool readDirectory(std::string const &path, bool recursive, std::function<void(std::string const &)> const &cb) const = 0;
 
+    /*
+     * Read the entries of a single directory, with their types and, if
+     * requested, their metadata. Entry paths are the names in the directory.
+     */
+    virtual bool readDirectoryEntries(std::string const &path, bool metadata, std::vector<DirectoryEntry> *entries) const;
+
+    /*
+     * Walk the contents of a directory. Each directory's entries are
+     * reported together, then each of its subdirectories is walked in
+     * turn, the same order as a recursive `readDirectory()`. Returning
+     * false for a directory skips its contents. Symbolic links are not
+     * followed. With a thread pool, the subdirectories of a directory are
+     * read in parallel, but the callback is always called on this thread.
+     */
+    bool walkDirectory(
+        std::string const &path,
+        bool recursive,
+        bool metadata,
+        std::function<bool(DirectoryEntry const &)> const &cb,
+        ThreadPool *threadPool = nullptr) const;
+
     /*
      * Copy a directory to a new path, optionally recursively.
      */
@@ -180,12 +247,12 @@ public:
     /*
      * Finds a file in the given directories.
      */
-    ext::optional<std::string> findFile(std::string const &name, std::vector<std::string> const &paths) const;
+    virtual ext::optional<std::string> findFile(std::string const &name, std::vector<std::string> const &paths) const;
 
     /*
      * Finds an executable in the given directories.
      */
-    ext::optional<std::string> findExecutable(std::string const &name, std::vector<std::string> const &paths) const;
+    virtual ext::optional<std::string> findExecutable(std::string const &name, std::vector<std::string> const &paths) const;
 
 public:
     /*
@@ -0,0 +1,121 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __libutil_LookupCache_h
+#define __libutil_LookupCache_h
+
+#include <libutil/Filesystem.h>
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <ext/optional>
+
+namespace libutil {
+
+/*
+ * Remembers the results of lookups, such as finding an executable in a
+ * list of search paths, across processes. Each result records the
+ * modification stamps of the paths it was derived from, and is discarded
+ * once any of those stamps change.
+ */
+class LookupCache {
+public:
+    /*
+     * Modification stamps of paths, captured before a lookup.
+     */
+    using Stamps = std::vector<std::pair<std::string, ext::optional<uint64_t>>>;
+
+private:
+    class Entry {
+    public:
+        std::vector<std::string> values;
+        Stamps                   stamps;
+    };
+
+private:
+    std::unordered_map<std::string, Entry> _entries;
+    size_t                                 _limit;
+    bool                                   _modified;
+
+public:
+    /*
+     * Create an empty cache. Once it holds `limit` entries, inserting
+     * a new entry first forgets all others. Zero means no limit.
+     */
+    explicit LookupCache(size_t limit = 1024);
+    ~LookupCache();
+
+public:
+    /*
+     * If the cache changed since it was loaded.
+     */
+    bool modified() const
+    { return _modified; }
+
+    /*
+     * Forget all cached results.
+     */
+    void clear();
+
+public:
+    /*
+     * Find the values stored for a key. Returns nothing if there are none
+     * or if any path they depend on has changed since they were stored.
+     */
+    ext::optional<std::vector<std::string>> lookup(Filesystem const *filesystem, std::string const &key) const;
+
+    /*
+     * Store the values for a key, valid while the stamped paths are
+     * unchanged. Stamp the paths before performing the lookup so changes
+     * made during the lookup are not missed.
+     */
+    void insert(std::string const &key, std::vector<std::string> const &values, Stamps const &stamps);
+
+public:
+    /*
+     * Finds a file in the given directories, using and updating the cache.
+     */
+    ext::optional<std::string> findFile(Filesystem const *filesystem, std::string const &name, std::vector<std::string> const &paths);
+
+    /*
+     * Finds an executable in the given directories, using and updating the cache.
+     */
+    ext::optional<std::string> findExecutable(Filesystem const *filesystem, std::string const &name, std::vector<std::string> const &paths);
+
+public:
+    /*
+     * Load cached results from a file. A missing or unreadable file
+     * leaves the cache empty.
+     */
+    bool load(Filesystem const *filesystem, std::string const &path);
+
+    /*
+     * Write the cached results to a file.
+     */
+    bool save(Filesystem *filesystem, std::string const &path);
+
+public:
+    /*
+     * Capture the current modification stamps of paths.
+     */
+    static Stamps Stamp(Filesystem const *filesystem, std::vector<std::string> const &paths);
+
+    /*
+     * Combine the components of a lookup into a key.
+     */
+    static std::string Key(std::vector<std::string> const &components);
+
+private:
+    ext::optional<std::string> find(Filesystem const *filesystem, bool executable, std::string const &name, std::vector<std::string> const &paths);
+};
+
+}
+
+#endif  // !__libutil_LookupCache_h
@@ -55,7 +55,8 @@ public:
     };
 
 private:
-    Entry _root;
+    Entry    _root;
+    uint64_t _generation;
 
 public:
     MemoryFilesystem(std::vector<Entry> const &entries);
@@ -72,6 +73,7 @@ public:
 public:
     virtual bool exists(std::string const &path) const;
     virtual ext::optional<Type> type(std::string const &path) const;
+    virtual ext::optional<uint64_t> modificationTime(std::string const &path) const;
 
 public:
     virtual bool isReadable(std::string const &path) const;
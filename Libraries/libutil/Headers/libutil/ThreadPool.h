@@ -0,0 +1,96 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __libutil_ThreadPool_h
+#define __libutil_ThreadPool_h
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libutil {
+
+/*
+ * A fixed set of worker threads that run dispatched tasks. Tasks are
+ * started in the order they were dispatched, but may finish in any order.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread>          _threads;
+    std::deque<std::function<void()>> _tasks;
+    size_t                            _pending;
+    bool                              _stopping;
+
+private:
+    std::mutex                        _mutex;
+    std::condition_variable           _taskAvailable;
+    std::condition_variable           _tasksFinished;
+
+public:
+    /*
+     * Create a thread pool. If the number of threads is zero, one thread
+     * per available processor is used.
+     */
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool &operator=(ThreadPool const &) = delete;
+
+public:
+    /*
+     * The number of threads running tasks. A pool with a single thread
+     * runs tasks synchronously, on the dispatching thread.
+     */
+    size_t threads() const
+    { return _threads.empty() ? 1 : _threads.size(); }
+
+public:
+    /*
+     * Queue a task to run on a worker thread.
+     */
+    void dispatch(std::function<void()> const &task);
+
+    /*
+     * Block until all dispatched tasks have finished.
+     */
+    void wait();
+
+public:
+    /*
+     * Invoke a block for each index in [0, count), spread across the pool,
+     * and wait for all invocations to finish. Results should be written
+     * to per-index storage so they can be consumed in a stable order.
+     * Can be called from several threads at once, but not from a task
+     * running on this pool.
+     */
+    void apply(size_t count, std::function<void(size_t)> const &block);
+
+public:
+    /*
+     * The number of processors available to run threads.
+     */
+    static size_t DefaultThreads();
+
+    /*
+     * A pool shared by the whole process, with one thread per processor.
+     * Use it for work that may run in several places at once, so that
+     * each doesn't start its own thread per processor.
+     */
+    static ThreadPool &Shared();
+
+private:
+    void work();
+};
+
+}
+
+#endif  // !__libutil_ThreadPool_h
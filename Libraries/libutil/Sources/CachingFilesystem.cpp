@@ -0,0 +1,426 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <libutil/CachingFilesystem.h>
+#include <libutil/FSUtil.h>
+
+using libutil::CachingFilesystem;
+using libutil::Filesystem;
+using libutil::FSUtil;
+using libutil::Permissions;
+
+CachingFilesystem::
+CachingFilesystem(Filesystem *filesystem) :
+    _filesystem(filesystem),
+    _generation(0),
+    _hits      (0),
+    _misses    (0)
+{
+}
+
+CachingFilesystem::
+~CachingFilesystem()
+{
+}
+
+static bool
+PathContains(std::string const &parent, std::string const &path)
+{
+    /* True if the path is the parent or inside of it. */
+    return (path.compare(0, parent.size(), parent) == 0 && (path.size() == parent.size() || path[parent.size()] == '/'));
+}
+
+static std::string
+LookupKey(bool executable, std::string const &name, std::vector<std::string> const &paths)
+{
+    std::string key = (executable ? "x" : "f") + name;
+    for (std::string const &path : paths) {
+        key += '\0';
+        key += path;
+    }
+    return key;
+}
+
+void CachingFilesystem::
+invalidate()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _generation++;
+    _entries.clear();
+    _directories.clear();
+    _lookups.clear();
+    _resolvedPaths.clear();
+}
+
+void CachingFilesystem::
+invalidate(std::string const &path)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _generation++;
+
+    /* The entry itself and anything inside of it, if a directory. */
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (PathContains(path, it->first)) {
+            it = _entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    /* Its parents, which creating directories or copying may have created. */
+    for (std::string current = path, parent = FSUtil::GetDirectoryName(current); !parent.empty() && parent != current; current = parent, parent = FSUtil::GetDirectoryName(current)) {
+        _entries.erase(parent);
+    }
+
+    /* Listings that could include the entry, or that are inside of it. */
+    for (auto it = _directories.begin(); it != _directories.end();) {
+        if (PathContains(it->first.first, path) || PathContains(path, it->first.first)) {
+            it = _directories.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    /* Lookups and resolved paths can depend on any entry; start over. */
+    _lookups.clear();
+    _resolvedPaths.clear();
+}
+
+template<typename T, typename F>
+T CachingFilesystem::
+entryValue(std::string const &path, ext::optional<T> Entry::*field, F const &compute) const
+{
+    uint64_t generation;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _entries.find(path);
+        if (it != _entries.end() && it->second.*field) {
+            _hits++;
+            return *(it->second.*field);
+        }
+        generation = _generation;
+    }
+
+    /* Query outside of the lock so other threads are not blocked on it. */
+    _misses++;
+    T value = compute();
+
+    /* If invalidated while querying, the value could already be out of date. */
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (generation == _generation) {
+        _entries[path].*field = value;
+    }
+    return value;
+}
+
+bool CachingFilesystem::
+exists(std::string const &path) const
+{
+    return entryValue<bool>(path, &Entry::exists, [&] {
+        return _filesystem->exists(path);
+    });
+}
+
+ext::optional<Filesystem::Type> CachingFilesystem::
+type(std::string const &path) const
+{
+    return entryValue<ext::optional<Type>>(path, &Entry::type, [&] {
+        return _filesystem->type(path);
+    });
+}
+
+ext::optional<uint64_t> CachingFilesystem::
+modificationTime(std::string const &path) const
+{
+    /* Not cached: callers use this to notice changes the cache would hide. */
+    return _filesystem->modificationTime(path);
+}
+
+bool CachingFilesystem::
+isReadable(std::string const &path) const
+{
+    return entryValue<bool>(path, &Entry::readable, [&] {
+        return _filesystem->isReadable(path);
+    });
+}
+
+bool CachingFilesystem::
+isWritable(std::string const &path) const
+{
+    return entryValue<bool>(path, &Entry::writable, [&] {
+        return _filesystem->isWritable(path);
+    });
+}
+
+bool CachingFilesystem::
+isExecutable(std::string const &path) const
+{
+    return entryValue<bool>(path, &Entry::executable, [&] {
+        return _filesystem->isExecutable(path);
+    });
+}
+
+ext::optional<Permissions> CachingFilesystem::
+readFilePermissions(std::string const &path) const
+{
+    return _filesystem->readFilePermissions(path);
+}
+
+bool CachingFilesystem::
+writeFilePermissions(std::string const &path, Permissions::Operation operation, Permissions permissions)
+{
+    bool result = _filesystem->writeFilePermissions(path, operation, permissions);
+    invalidate(path);
+    return result;
+}
+
+bool CachingFilesystem::
+createFile(std::string const &path)
+{
+    bool result = _filesystem->createFile(path);
+    invalidate(path);
+    return result;
+}
+
+bool CachingFilesystem::
+read(std::vector<uint8_t> *contents, std::string const &path, size_t offset, ext::optional<size_t> length) const
+{
+    return _filesystem->read(contents, path, offset, length);
+}
+
+bool CachingFilesystem::
+write(std::vector<uint8_t> const &contents, std::string const &path)
+{
+    bool result = _filesystem->write(contents, path);
+    invalidate(path);
+    return result;
+}
+
+bool CachingFilesystem::
+writeIfChanged(std::vector<uint8_t> const &contents, std::string const &path, bool *written)
+{
+    bool result = _filesystem->writeIfChanged(contents, path, written);
+    invalidate(path);
+    return result;
+}
+
+bool CachingFilesystem::
+copyFile(std::string const &from, std::string const &to)
+{
+    bool result = _filesystem->copyFile(from, to);
+    invalidate(to);
+    return result;
+}
+
+bool CachingFilesystem::
+removeFile(std::string const &path)
+{
+    bool result = _filesystem->removeFile(path);
+    invalidate(path);
+    return result;
+}
+
+ext::optional<Permissions> CachingFilesystem::
+readSymbolicLinkPermissions(std::string const &path) const
+{
+    return _filesystem->readSymbolicLinkPermissions(path);
+}
+
+bool CachingFilesystem::
+writeSymbolicLinkPermissions(std::string const &path, Permissions::Operation operation, Permissions permissions)
+{
+    bool result = _filesystem->writeSymbolicLinkPermissions(path, operation, permissions);
+    invalidate(path);
+    return result;
+}
+
+ext::optional<std::string> CachingFilesystem::
+readSymbolicLinkCanonical(std::string const &path, bool *directory) const
+{
+    return _filesystem->readSymbolicLinkCanonical(path, directory);
+}
+
+ext::optional<std::string> CachingFilesystem::
+readSymbolicLink(std::string const &path, bool *directory) const
+{
+    return _filesystem->readSymbolicLink(path, directory);
+}
+
+bool CachingFilesystem::
+writeSymbolicLink(std::string const &target, std::string const &path, bool directory)
+{
+    bool result = _filesystem->writeSymbolicLink(target, path, directory);
+    invalidate(path);
+    return result;
+}
+
+bool CachingFilesystem::
+copySymbolicLink(std::string const &from, std::string const &to)
+{
+    bool result = _filesystem->copySymbolicLink(from, to);
+    invalidate(to);
+    return result;
+}
+
+bool CachingFilesystem::
+removeSymbolicLink(std::string const &path)
+{
+    bool result = _filesystem->removeSymbolicLink(path);
+    invalidate(path);
+    return result;
+}
+
+ext::optional<Permissions> CachingFilesystem::
+readDirectoryPermissions(std::string const &path) const
+{
+    return _filesystem->readDirectoryPermissions(path);
+}
+
+bool CachingFilesystem::
+writeDirectoryPermissions(std::string const &path, Permissions::Operation operation, Permissions permissions, bool recursive)
+{
+    bool result = _filesystem->writeDirectoryPermissions(path, operation, permissions, recursive);
+    invalidate(path);
+    return result;
+}
+
+bool CachingFilesystem::
+createDirectory(std::string const &path, bool recursive)
+{
+    bool result = _filesystem->createDirectory(path, recursive);
+    invalidate(path);
+    return result;
+}
+
+bool CachingFilesystem::
+createPrivateDirectory(std::string const &path)
+{
+    bool result = _filesystem->createPrivateDirectory(path);
+    invalidate(path);
+    return result;
+}
+
+bool CachingFilesystem::
+readDirectory(std::string const &path, bool recursive, std::function<void(std::string const &)> const &cb) const
+{
+    std::vector<std::string> entries;
+    bool cached = false;
+    uint64_t generation;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _directories.find({ path, recursive });
+        if (it != _directories.end()) {
+            entries = it->second;
+            cached = true;
+        }
+        generation = _generation;
+    }
+
+    if (cached) {
+        _hits++;
+    } else {
+        _misses++;
+
+        if (!_filesystem->readDirectory(path, recursive, [&entries](std::string const &name) {
+            entries.push_back(name);
+        })) {
+            return false;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (generation == _generation) {
+            _directories[{ path, recursive }] = entries;
+        }
+    }
+
+    /* Call back outside of the lock, in case the callback uses this filesystem. */
+    for (std::string const &entry : entries) {
+        cb(entry);
+    }
+
+    return true;
+}
+
+bool CachingFilesystem::
+copyDirectory(std::string const &from, std::string const &to, bool recursive)
+{
+    bool result = _filesystem->copyDirectory(from, to, recursive);
+    invalidate(to);
+    return result;
+}
+
+bool CachingFilesystem::
+removeDirectory(std::string const &path, bool recursive)
+{
+    bool result = _filesystem->removeDirectory(path, recursive);
+    invalidate(path);
+    return result;
+}
+
+std::string CachingFilesystem::
+resolvePath(std::string const &path) const
+{
+    uint64_t generation;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _resolvedPaths.find(path);
+        if (it != _resolvedPaths.end()) {
+            _hits++;
+            return it->second;
+        }
+        generation = _generation;
+    }
+
+    _misses++;
+    std::string resolved = _filesystem->resolvePath(path);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (generation == _generation) {
+        _resolvedPaths.insert({ path, resolved });
+    }
+    return resolved;
+}
+
+ext::optional<std::string> CachingFilesystem::
+lookup(bool executable, std::string const &name, std::vector<std::string> const &paths) const
+{
+    std::string key = LookupKey(executable, name, paths);
+
+    uint64_t generation;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _lookups.find(key);
+        if (it != _lookups.end()) {
+            _hits++;
+            return it->second;
+        }
+        generation = _generation;
+    }
+
+    _misses++;
+    ext::optional<std::string> result = (executable ? Filesystem::findExecutable(name, paths) : Filesystem::findFile(name, paths));
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (generation == _generation) {
+        _lookups.insert({ key, result });
+    }
+    return result;
+}
+
+ext::optional<std::string> CachingFilesystem::
+findFile(std::string const &name, std::vector<std::string> const &paths) const
+{
+    return lookup(false, name, paths);
+}
+
+ext::optional<std::string> CachingFilesystem::
+findExecutable(std::string const &name, std::vector<std::string> const &paths) const
+{
+    return lookup(true, name, paths);
+}
@@ -10,6 +10,7 @@
 #include <libutil/FSUtil.h>
 #include <libutil/Relative.h>
 
+#include <atomic>
 #include <stack>
 #include <climits>
 #include <cstdlib>
@@ -23,6 +24,7 @@
 #include <unistd.h>
 #include <libgen.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #if defined(__APPLE__)
 #include <copyfile.h>
@@ -118,6 +120,33 @@ exists(std::string const &path) const
 #endif
 }
 
+#if !_WIN32
+static uint64_t
+StatModificationTime(struct stat const &st)
+{
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    return static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+static ext::optional<Filesystem::Type>
+StatType(struct stat const &st)
+{
+    if (S_ISREG(st.st_mode)) {
+        return Filesystem::Type::File;
+    } else if (S_ISLNK(st.st_mode)) {
+        return Filesystem::Type::SymbolicLink;
+    } else if (S_ISDIR(st.st_mode)) {
+        return Filesystem::Type::Directory;
+    } else {
+        /* Unsupported file type, e.g. character or block device. */
+        return ext::nullopt;
+    }
+}
+#endif
+
 ext::optional<Filesystem::Type> DefaultFilesystem::
 type(std::string const &path) const
 {
@@ -169,16 +198,29 @@ type(std::string const &path) const
         return ext::nullopt;
     }
 
-    if (S_ISREG(st.st_mode)) {
-        return Type::File;
-    } else if (S_ISLNK(st.st_mode)) {
-        return Type::SymbolicLink;
-    } else if (S_ISDIR(st.st_mode)) {
-        return Type::Directory;
-    } else {
-        /* Unsupported file type, e.g. character or block device. */
+    return StatType(st);
+#endif
+}
+
+ext::optional<uint64_t> DefaultFilesystem::
+modificationTime(std::string const &path) const
+{
+#if _WIN32
+    WideString wide = StringToWideString(path);
+
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(wide.c_str(), GetFileExInfoStandard, &data)) {
+        return ext::nullopt;
+    }
+
+    return (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
         return ext::nullopt;
     }
+
+    return StatModificationTime(st);
 #endif
 }
 
@@ -402,15 +444,14 @@ writeDirectoryPermissions(std::string const &path, Permissions::Operation operat
     if (recursive) {
         bool success = true;
 
-        success &= this->readDirectory(path, recursive, [this, &path, &operation, &permissions, &success](std::string const &name) {
-            std::string full = path + "/" + name;
+        success &= this->walkDirectory(path, recursive, false, [this, &path, &operation, &permissions, &success](DirectoryEntry const &entry) {
+            std::string full = path + "/" + entry.path;
 
-            ext::optional<Type> type = this->type(full);
-            if (!type) {
+            if (!entry.type) {
                 return false;
             }
 
-            switch (*type) {
+            switch (*entry.type) {
                 case Type::File:
                     if (!this->writeFilePermissions(full, operation, permissions)) {
                         success = false;
@@ -602,6 +643,76 @@ write(std::vector<uint8_t> const &contents, std::string const &path)
 #endif
 }
 
+bool DefaultFilesystem::
+writeIfChanged(std::vector<uint8_t> const &contents, std::string const &path, bool *written)
+{
+#if _WIN32
+    return Filesystem::writeIfChanged(contents, path, written);
+#else
+    struct stat st;
+    bool exists = (::lstat(path.c_str(), &st) == 0);
+
+    /* Writing through a symbolic link shouldn't replace the link itself. */
+    if (exists && !S_ISREG(st.st_mode)) {
+        return Filesystem::writeIfChanged(contents, path, written);
+    }
+
+    /* Only read the existing contents if they could possibly match. */
+    if (exists && static_cast<uint64_t>(st.st_size) == contents.size()) {
+        std::vector<uint8_t> existing;
+        if (this->read(&existing, path) && (contents.empty() || ::memcmp(existing.data(), contents.data(), contents.size()) == 0)) {
+            if (written != nullptr) {
+                *written = false;
+            }
+            return true;
+        }
+    }
+
+    /*
+     * Write next to the file then rename it into place, so the file is
+     * replaced atomically: readers see either the old or new contents.
+     */
+    static std::atomic<unsigned long> counter(0);
+    std::string temporary = path + ".tmp." + std::to_string(::getpid()) + "." + std::to_string(counter++);
+
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (fd < 0) {
+        return false;
+    }
+
+    /* Keep the permissions of the file being replaced. */
+    if (exists) {
+        (void)::fchmod(fd, st.st_mode & 07777);
+    }
+
+    uint8_t const *data = contents.data();
+    size_t size = contents.size();
+    while (size > 0) {
+        ssize_t result = ::write(fd, data, size);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        } else if (result <= 0) {
+            ::close(fd);
+            ::unlink(temporary.c_str());
+            return false;
+        }
+
+        data += result;
+        size -= result;
+    }
+
+    if (::close(fd) != 0 || ::rename(temporary.c_str(), path.c_str()) != 0) {
+        ::unlink(temporary.c_str());
+        return false;
+    }
+
+    if (written != nullptr) {
+        *written = true;
+    }
+    return true;
+#endif
+}
+
 bool DefaultFilesystem::
 copyFile(std::string const &from, std::string const &to)
 {
@@ -951,107 +1062,124 @@ createDirectory(std::string const &path, bool recursive)
 }
 
 bool DefaultFilesystem::
-readDirectory(std::string const &path, bool recursive, std::function<void(std::string const &)> const &cb) const
+createPrivateDirectory(std::string const &path)
 {
-    std::function<bool(std::string const &, ext::optional<std::string> const &)> process =
-        [this, &recursive, &cb, &process](std::string const &absolute, ext::optional<std::string> const &relative) -> bool {
 #if _WIN32
-        WideString wide = StringToWideString(absolute);
-        wide += static_cast<wchar_t>('\\');
-        wide += static_cast<wchar_t>('*');
-
-        WIN32_FIND_DATAW data;
-        HANDLE handle = FindFirstFileW(wide.c_str(), &data);
-        if (handle == INVALID_HANDLE_VALUE) {
-            return false;
-        }
+    return Filesystem::createPrivateDirectory(path);
 #else
-        DIR *dp = ::opendir(absolute.c_str());
-        if (dp == nullptr) {
-            return false;
-        }
+    if (::mkdir(path.c_str(), S_IRWXU) != 0 && errno != EEXIST) {
+        return false;
+    }
+
+    /* Not following symbolic links, which another user could have created. */
+    struct stat st;
+    if (::lstat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return false;
+    }
+
+    return (st.st_uid == ::geteuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0);
 #endif
+}
+
+bool DefaultFilesystem::
+readDirectory(std::string const &path, bool recursive, std::function<void(std::string const &)> const &cb) const
+{
+    return this->walkDirectory(path, recursive, false, [&cb](DirectoryEntry const &entry) {
+        cb(entry.path);
+        return true;
+    });
+}
 
-        /* Report children. */
+bool DefaultFilesystem::
+readDirectoryEntries(std::string const &path, bool metadata, std::vector<DirectoryEntry> *entries) const
+{
 #if _WIN32
-        do {
-            std::string name_ = WideStringToString(WideString(data.cFileName));
-            char const *name = name_.c_str();
-#else
-        while (struct dirent *entry = ::readdir(dp)) {
-            char const *name = entry->d_name;
-#endif
-            if (::strcmp(name, ".") == 0 || ::strcmp(name, "..") == 0) {
-                continue;
-            }
+    WideString wide = StringToWideString(path);
+    wide += static_cast<wchar_t>('\\');
+    wide += static_cast<wchar_t>('*');
 
-            std::string path = (relative ? *relative + "/" + name : name);
+    WIN32_FIND_DATAW data;
+    HANDLE handle = FindFirstFileW(wide.c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
 
-            cb(path);
+    do {
+        std::string name = WideStringToString(WideString(data.cFileName));
+        if (name == "." || name == "..") {
+            continue;
         }
-#if _WIN32
-        while (FindNextFileW(handle, &data));
-        if (GetLastError() != ERROR_NO_MORE_FILES) {
-            return false;
+
+        DirectoryEntry entry;
+        entry.path = name;
+
+        /* Matches type(): reparse points are only assumed to be symbolic links here. */
+        if ((data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0) {
+            entry.type = (data.dwReserved0 == IO_REPARSE_TAG_SYMLINK ? ext::optional<Type>(Type::SymbolicLink) : ext::nullopt);
+        } else if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+            entry.type = Type::Directory;
+        } else {
+            entry.type = Type::File;
         }
-#endif
 
-        /* Process subdirectories. */
-        if (recursive) {
-#if _WIN32
-            FindClose(handle);
-            handle = FindFirstFileW(wide.c_str(), &data);
-            if (handle == INVALID_HANDLE_VALUE) {
-                return false;
-            }
-#else
-            ::rewinddir(dp);
-#endif
+        if (metadata) {
+            entry.modificationTime = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+            entry.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        }
 
-#if _WIN32
-            do {
-                std::string name_ = WideStringToString(WideString(data.cFileName));
-                char const *name = name_.c_str();
+        entries->push_back(std::move(entry));
+    } while (FindNextFileW(handle, &data));
+
+    bool success = (GetLastError() == ERROR_NO_MORE_FILES);
+    FindClose(handle);
+    return success;
 #else
-            while (struct dirent *entry = ::readdir(dp)) {
-                char const *name = entry->d_name;
-#endif
-                if (::strcmp(name, ".") == 0 || ::strcmp(name, "..") == 0) {
-                    continue;
-                }
+    DIR *dp = ::opendir(path.c_str());
+    if (dp == nullptr) {
+        return false;
+    }
 
-                std::string full = absolute + "/" + name;
+    while (struct dirent *dirent = ::readdir(dp)) {
+        char const *name = dirent->d_name;
+        if (::strcmp(name, ".") == 0 || ::strcmp(name, "..") == 0) {
+            continue;
+        }
 
-                if (this->type(full) == Type::Directory) {
-                    std::string path = (relative ? *relative + "/" + name : name);
-                    if (!process(full, path)) {
-#if _WIN32
-                        FindClose(handle);
-#else
-                        ::closedir(dp);
+        DirectoryEntry entry;
+        entry.path = name;
+
+        /*
+         * Most filesystems report the type while reading the directory.
+         * Otherwise, or for metadata, stat relative to the open directory.
+         */
+        bool known = false;
+#if defined(DT_UNKNOWN)
+        switch (dirent->d_type) {
+            case DT_REG: entry.type = Type::File; known = true; break;
+            case DT_LNK: entry.type = Type::SymbolicLink; known = true; break;
+            case DT_DIR: entry.type = Type::Directory; known = true; break;
+            case DT_UNKNOWN: break;
+            default: known = true; break;
+        }
 #endif
-                        return false;
-                    }
-                }
-            }
 
-#if _WIN32
-            while (FindNextFileW(handle, &data));
-            if (GetLastError() != ERROR_NO_MORE_FILES) {
-                return false;
+        if (!known || metadata) {
+            struct stat st;
+            if (::fstatat(::dirfd(dp), name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                entry.type = StatType(st);
+                if (metadata) {
+                    entry.modificationTime = StatModificationTime(st);
+                    entry.size = static_cast<uint64_t>(st.st_size);
+                }
             }
-#endif
         }
 
-#if _WIN32
-        FindClose(handle);
-#else
-        ::closedir(dp);
-#endif
-        return true;
-    };
+        entries->push_back(std::move(entry));
+    }
 
-    return process(path, ext::nullopt);
+    ::closedir(dp);
+    return true;
+#endif
 }
 
 bool DefaultFilesystem::
@@ -1087,37 +1215,33 @@ removeDirectory(std::string const &path, bool recursive)
     if (recursive) {
         bool success = true;
 
-        success &= this->readDirectory(path, recursive, [this, &path, &success](std::string const &name) {
-            std::string full = path + "/" + name;
+        /* Collect the contents first, then remove children before their parents. */
+        std::vector<DirectoryEntry> entries;
+        success &= this->walkDirectory(path, recursive, false, [&entries](DirectoryEntry const &entry) {
+            entries.push_back(entry);
+            return true;
+        });
 
-            ext::optional<Type> type = this->type(full);
-            if (!type) {
-                return false;
+        for (auto it = entries.rbegin(); it != entries.rend() && success; ++it) {
+            std::string full = path + "/" + it->path;
+
+            if (!it->type) {
+                success = false;
+                break;
             }
 
-            switch (*type) {
+            switch (*it->type) {
                 case Type::File:
-                    if (!this->removeFile(full)) {
-                        success = false;
-                        return false;
-                    }
+                    success = this->removeFile(full);
                     break;
                 case Type::SymbolicLink:
-                    if (!this->removeSymbolicLink(full)) {
-                        success = false;
-                        return false;
-                    }
+                    success = this->removeSymbolicLink(full);
                     break;
                 case Type::Directory:
-                    if (!this->removeDirectory(full, false)) {
-                        success = false;
-                        return false;
-                    }
+                    success = this->removeDirectory(full, false);
                     break;
             }
-
-            return true;
-        });
+        }
 
         if (!success) {
             return false;
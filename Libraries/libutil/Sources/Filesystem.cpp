@@ -8,12 +8,14 @@
 
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/ThreadPool.h>
 
 #include <unordered_set>
 #include <sstream>
 
 using libutil::Filesystem;
 using libutil::FSUtil;
+using libutil::ThreadPool;
 
 bool Filesystem::
 copyFile(std::string const &from, std::string const &to)
@@ -31,6 +33,29 @@ copyFile(std::string const &from, std::string const &to)
     return true;
 }
 
+bool Filesystem::
+writeIfChanged(std::vector<uint8_t> const &contents, std::string const &path, bool *written)
+{
+    if (this->type(path) == Type::File) {
+        std::vector<uint8_t> existing;
+        if (this->read(&existing, path) && existing == contents) {
+            if (written != nullptr) {
+                *written = false;
+            }
+            return true;
+        }
+    }
+
+    if (!this->write(contents, path)) {
+        return false;
+    }
+
+    if (written != nullptr) {
+        *written = true;
+    }
+    return true;
+}
+
 bool Filesystem::
 copySymbolicLink(std::string const &from, std::string const &to)
 {
@@ -57,6 +82,13 @@ copySymbolicLink(std::string const &from, std::string const &to)
     return true;
 }
 
+bool Filesystem::
+createPrivateDirectory(std::string const &path)
+{
+    /* Without ownership to check, only make sure it exists. Another process may create it first. */
+    return (this->type(path) == Type::Directory || this->createDirectory(path, false) || this->type(path) == Type::Directory);
+}
+
 bool Filesystem::
 copyDirectory(std::string const &from, std::string const &to, bool recursive)
 {
@@ -81,16 +113,15 @@ copyDirectory(std::string const &from, std::string const &to, bool recursive)
     if (recursive) {
         bool success = true;
 
-        success &= this->readDirectory(from, recursive, [this, &from, &to, &success](std::string const &path) {
-            std::string fromPath = from + "/" + path;
-            std::string toPath = to + "/" + path;
+        success &= this->walkDirectory(from, recursive, false, [this, &from, &to, &success](DirectoryEntry const &entry) {
+            std::string fromPath = from + "/" + entry.path;
+            std::string toPath = to + "/" + entry.path;
 
-            ext::optional<Type> type = this->type(fromPath);
-            if (!type) {
+            if (!entry.type) {
                 return false;
             }
 
-            switch (*type) {
+            switch (*entry.type) {
                 case Type::File:
                     if (!this->copyFile(fromPath, toPath)) {
                         success = false;
@@ -122,6 +153,99 @@ copyDirectory(std::string const &from, std::string const &to, bool recursive)
     return true;
 }
 
+bool Filesystem::
+readDirectoryEntries(std::string const &path, bool metadata, std::vector<DirectoryEntry> *entries) const
+{
+    return this->readDirectory(path, false, [this, &path, &metadata, &entries](std::string const &name) {
+        std::string full = path + "/" + name;
+
+        DirectoryEntry entry;
+        entry.path = name;
+        entry.type = this->type(full);
+        if (metadata) {
+            entry.modificationTime = this->modificationTime(full);
+
+            /* Without a way to ask for the size, read the file to find it. */
+            std::vector<uint8_t> contents;
+            if (entry.type == Type::File && this->read(&contents, full)) {
+                entry.size = contents.size();
+            }
+        }
+        entries->push_back(entry);
+    });
+}
+
+/*
+ * Report the entries of a directory already read, then walk each of its
+ * subdirectories in turn. The subdirectories are read together, so that
+ * with a thread pool they are read in parallel.
+ */
+static bool
+WalkEntries(
+    Filesystem const *filesystem,
+    std::string const &path,
+    ext::optional<std::string> const &directory,
+    std::vector<Filesystem::DirectoryEntry> *entries,
+    bool recursive,
+    bool metadata,
+    std::function<bool(Filesystem::DirectoryEntry const &)> const &cb,
+    ThreadPool *threadPool)
+{
+    std::vector<std::string> subdirectories;
+    for (Filesystem::DirectoryEntry &entry : *entries) {
+        if (directory) {
+            entry.path = *directory + "/" + entry.path;
+        }
+
+        if (cb(entry) && recursive && entry.type == Filesystem::Type::Directory) {
+            subdirectories.push_back(entry.path);
+        }
+    }
+
+    if (subdirectories.empty()) {
+        return true;
+    }
+
+    std::vector<std::vector<Filesystem::DirectoryEntry>> contents = std::vector<std::vector<Filesystem::DirectoryEntry>>(subdirectories.size());
+    std::vector<uint8_t> read = std::vector<uint8_t>(subdirectories.size(), false);
+
+    auto block = [filesystem, &path, &metadata, &subdirectories, &contents, &read](size_t index) {
+        read[index] = filesystem->readDirectoryEntries(path + "/" + subdirectories[index], metadata, &contents[index]);
+    };
+
+    if (threadPool != nullptr && subdirectories.size() > 1) {
+        threadPool->apply(subdirectories.size(), block);
+    } else {
+        for (size_t i = 0; i < subdirectories.size(); ++i) {
+            block(i);
+        }
+    }
+
+    for (size_t i = 0; i < subdirectories.size(); ++i) {
+        if (!read[i] || !WalkEntries(filesystem, path, subdirectories[i], &contents[i], recursive, metadata, cb, threadPool)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Filesystem::
+walkDirectory(
+    std::string const &path,
+    bool recursive,
+    bool metadata,
+    std::function<bool(DirectoryEntry const &)> const &cb,
+    ThreadPool *threadPool) const
+{
+    std::vector<DirectoryEntry> entries;
+    if (!this->readDirectoryEntries(path, metadata, &entries)) {
+        return false;
+    }
+
+    return WalkEntries(this, path, ext::nullopt, &entries, recursive, metadata, cb, threadPool);
+}
+
 ext::optional<std::string> Filesystem::
 findFile(std::string const &name, std::vector<std::string> const &paths) const
 {
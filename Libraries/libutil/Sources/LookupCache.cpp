@@ -0,0 +1,272 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <libutil/LookupCache.h>
+
+using libutil::LookupCache;
+using libutil::Filesystem;
+
+/*
+ * Identifies the file format; change when the layout changes.
+ */
+static char const CacheMagic[] = "xcbuild-lookup-cache-1";
+
+LookupCache::
+LookupCache(size_t limit) :
+    _limit   (limit),
+    _modified(false)
+{
+}
+
+LookupCache::
+~LookupCache()
+{
+}
+
+void LookupCache::
+clear()
+{
+    if (!_entries.empty()) {
+        _entries.clear();
+        _modified = true;
+    }
+}
+
+ext::optional<std::vector<std::string>> LookupCache::
+lookup(Filesystem const *filesystem, std::string const &key) const
+{
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        return ext::nullopt;
+    }
+
+    for (auto const &stamp : it->second.stamps) {
+        if (filesystem->modificationTime(stamp.first) != stamp.second) {
+            return ext::nullopt;
+        }
+    }
+
+    return it->second.values;
+}
+
+void LookupCache::
+insert(std::string const &key, std::vector<std::string> const &values, Stamps const &stamps)
+{
+    /* Lookups with many distinct keys would otherwise grow the cache forever. */
+    if (_limit != 0 && _entries.size() >= _limit && _entries.find(key) == _entries.end()) {
+        _entries.clear();
+    }
+
+    Entry entry;
+    entry.values = values;
+    entry.stamps = stamps;
+    _entries[key] = std::move(entry);
+    _modified = true;
+}
+
+ext::optional<std::string> LookupCache::
+find(Filesystem const *filesystem, bool executable, std::string const &name, std::vector<std::string> const &paths)
+{
+    std::vector<std::string> components = { executable ? "x" : "f", name };
+    components.insert(components.end(), paths.begin(), paths.end());
+    std::string key = Key(components);
+
+    if (auto values = lookup(filesystem, key)) {
+        if (values->size() == 1) {
+            return values->front();
+        }
+    }
+
+    /*
+     * Only found results are stored. A search path gaining the entry
+     * changes its stamp, but an existing file becoming executable does not.
+     */
+    Stamps stamps = Stamp(filesystem, paths);
+    ext::optional<std::string> result = (executable ? filesystem->findExecutable(name, paths) : filesystem->findFile(name, paths));
+    if (result) {
+        insert(key, { *result }, stamps);
+    }
+
+    return result;
+}
+
+ext::optional<std::string> LookupCache::
+findFile(Filesystem const *filesystem, std::string const &name, std::vector<std::string> const &paths)
+{
+    return find(filesystem, false, name, paths);
+}
+
+ext::optional<std::string> LookupCache::
+findExecutable(Filesystem const *filesystem, std::string const &name, std::vector<std::string> const &paths)
+{
+    return find(filesystem, true, name, paths);
+}
+
+LookupCache::Stamps LookupCache::
+Stamp(Filesystem const *filesystem, std::vector<std::string> const &paths)
+{
+    Stamps stamps;
+    stamps.reserve(paths.size());
+    for (std::string const &path : paths) {
+        stamps.push_back({ path, filesystem->modificationTime(path) });
+    }
+    return stamps;
+}
+
+std::string LookupCache::
+Key(std::vector<std::string> const &components)
+{
+    std::string key;
+    for (std::string const &component : components) {
+        key += component;
+        key += '\0';
+    }
+    return key;
+}
+
+/*
+ * The file is a sequence of little-endian integers and length-prefixed
+ * strings, starting with the magic string and the number of entries.
+ */
+
+static void
+WriteInteger(std::vector<uint8_t> *contents, uint64_t value)
+{
+    for (size_t n = 0; n < sizeof(value); n++) {
+        contents->push_back(static_cast<uint8_t>(value >> (n * 8)));
+    }
+}
+
+static void
+WriteString(std::vector<uint8_t> *contents, std::string const &value)
+{
+    WriteInteger(contents, value.size());
+    contents->insert(contents->end(), value.begin(), value.end());
+}
+
+static bool
+ReadInteger(std::vector<uint8_t> const &contents, size_t *offset, uint64_t *value)
+{
+    if (contents.size() - *offset < sizeof(*value)) {
+        return false;
+    }
+
+    *value = 0;
+    for (size_t n = 0; n < sizeof(*value); n++) {
+        *value |= static_cast<uint64_t>(contents[*offset + n]) << (n * 8);
+    }
+
+    *offset += sizeof(*value);
+    return true;
+}
+
+static bool
+ReadString(std::vector<uint8_t> const &contents, size_t *offset, std::string *value)
+{
+    uint64_t size;
+    if (!ReadInteger(contents, offset, &size) || contents.size() - *offset < size) {
+        return false;
+    }
+
+    value->assign(reinterpret_cast<char const *>(contents.data() + *offset), size);
+    *offset += size;
+    return true;
+}
+
+bool LookupCache::
+load(Filesystem const *filesystem, std::string const &path)
+{
+    _entries.clear();
+    _modified = false;
+
+    std::vector<uint8_t> contents;
+    if (!filesystem->read(&contents, path)) {
+        return false;
+    }
+
+    size_t offset = 0;
+    std::string magic;
+    uint64_t count;
+    if (!ReadString(contents, &offset, &magic) || magic != CacheMagic || !ReadInteger(contents, &offset, &count)) {
+        return false;
+    }
+
+    std::unordered_map<std::string, Entry> entries;
+    for (uint64_t n = 0; n < count; n++) {
+        std::string key;
+        Entry entry;
+
+        uint64_t values;
+        if (!ReadString(contents, &offset, &key) || !ReadInteger(contents, &offset, &values)) {
+            return false;
+        }
+        for (uint64_t v = 0; v < values; v++) {
+            std::string value;
+            if (!ReadString(contents, &offset, &value)) {
+                return false;
+            }
+            entry.values.push_back(value);
+        }
+
+        uint64_t stamps;
+        if (!ReadInteger(contents, &offset, &stamps)) {
+            return false;
+        }
+        for (uint64_t s = 0; s < stamps; s++) {
+            std::string stampPath;
+            uint64_t present;
+            uint64_t time;
+            if (!ReadString(contents, &offset, &stampPath) || !ReadInteger(contents, &offset, &present) || !ReadInteger(contents, &offset, &time)) {
+                return false;
+            }
+            entry.stamps.push_back({ stampPath, present ? ext::optional<uint64_t>(time) : ext::nullopt });
+        }
+
+        entries[key] = std::move(entry);
+    }
+
+    /* Trailing data means the file was corrupted, such as by concurrent writers. */
+    if (offset != contents.size()) {
+        return false;
+    }
+
+    _entries = std::move(entries);
+    return true;
+}
+
+bool LookupCache::
+save(Filesystem *filesystem, std::string const &path)
+{
+    std::vector<uint8_t> contents;
+    WriteString(&contents, CacheMagic);
+    WriteInteger(&contents, _entries.size());
+
+    for (auto const &entry : _entries) {
+        WriteString(&contents, entry.first);
+
+        WriteInteger(&contents, entry.second.values.size());
+        for (std::string const &value : entry.second.values) {
+            WriteString(&contents, value);
+        }
+
+        WriteInteger(&contents, entry.second.stamps.size());
+        for (auto const &stamp : entry.second.stamps) {
+            WriteString(&contents, stamp.first);
+            WriteInteger(&contents, stamp.second ? 1 : 0);
+            WriteInteger(&contents, stamp.second.value_or(0));
+        }
+    }
+
+    /* Replaced atomically, as concurrent processes share the file. */
+    if (!filesystem->writeIfChanged(contents, path)) {
+        return false;
+    }
+
+    _modified = false;
+    return true;
+}
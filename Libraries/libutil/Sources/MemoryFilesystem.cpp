@@ -72,10 +72,11 @@ Directory(std::string const &name, std::vector<Entry> const &children)
 MemoryFilesystem::
 MemoryFilesystem(std::vector<MemoryFilesystem::Entry> const &entries) :
 #if _WIN32
-    _root(MemoryFilesystem::Entry::Directory("C:", entries))
+    _root(MemoryFilesystem::Entry::Directory("C:", entries)),
 #else
-    _root(MemoryFilesystem::Entry::Directory("", entries))
+    _root(MemoryFilesystem::Entry::Directory("", entries)),
 #endif
+    _generation(0)
 {
 }
 
@@ -195,6 +196,17 @@ type(std::string const &path) const
     return type;
 }
 
+ext::optional<uint64_t> MemoryFilesystem::
+modificationTime(std::string const &path) const
+{
+    if (!this->exists(path)) {
+        return ext::nullopt;
+    }
+
+    /* No per-entry times are kept; any change counts as a change to every entry. */
+    return _generation;
+}
+
 bool MemoryFilesystem::
 isReadable(std::string const &path) const
 {
@@ -269,6 +281,8 @@ writeDirectoryPermissions(std::string const &path, Permissions::Operation operat
 bool MemoryFilesystem::
 createFile(std::string const &path)
 {
+    _generation++;
+
     return WalkPath<MemoryFilesystem::Entry>(this, path, false, [](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
         if (entry != nullptr) {
             if (entry->type() == Type::File) {
@@ -311,6 +325,8 @@ read(std::vector<uint8_t> *contents, std::string const &path, size_t offset, ext
 bool MemoryFilesystem::
 write(std::vector<uint8_t> const &contents, std::string const &path)
 {
+    _generation++;
+
     return WalkPath<MemoryFilesystem::Entry>(this, path, false, [&](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
         if (entry != nullptr) {
             if (entry->type() == Type::File) {
@@ -340,6 +356,8 @@ copyFile(std::string const &from, std::string const &to)
 bool MemoryFilesystem::
 removeFile(std::string const &path)
 {
+    _generation++;
+
     return WalkPath<MemoryFilesystem::Entry>(this, path, false, [](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
         if (entry != nullptr) {
             if (entry->type() == Type::File) {
@@ -393,6 +411,8 @@ removeSymbolicLink(std::string const &path)
 bool MemoryFilesystem::
 createDirectory(std::string const &path, bool recursive)
 {
+    _generation++;
+
     return WalkPath<MemoryFilesystem::Entry>(this, path, recursive, [](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
         if (entry != nullptr) {
             if (entry->type() == Type::Directory) {
@@ -451,6 +471,8 @@ readDirectory(std::string const &path, bool recursive, std::function<void(std::s
 bool MemoryFilesystem::
 removeDirectory(std::string const &path, bool recursive)
 {
+    _generation++;
+
     return WalkPath<MemoryFilesystem::Entry>(this, path, false, [&recursive](MemoryFilesystem::Entry *parent, std::string const &name, MemoryFilesystem::Entry *entry) -> MemoryFilesystem::Entry * {
         if (entry != nullptr && entry->type() == Type::Directory) {
             /* Only remove empty directories unless recursive. */
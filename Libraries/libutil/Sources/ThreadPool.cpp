@@ -0,0 +1,151 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <libutil/ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+
+using libutil::ThreadPool;
+
+ThreadPool::
+ThreadPool(size_t threads) :
+    _pending (0),
+    _stopping(false)
+{
+    if (threads == 0) {
+        threads = DefaultThreads();
+    }
+
+    /* A single thread is run inline; no need for a worker. */
+    if (threads > 1) {
+        for (size_t i = 0; i < threads; ++i) {
+            _threads.push_back(std::thread(&ThreadPool::work, this));
+        }
+    }
+}
+
+ThreadPool::
+~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _taskAvailable.notify_all();
+
+    for (std::thread &thread : _threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::
+dispatch(std::function<void()> const &task)
+{
+    if (_threads.empty()) {
+        task();
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _tasks.push_back(task);
+        _pending++;
+    }
+    _taskAvailable.notify_one();
+}
+
+void ThreadPool::
+wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _tasksFinished.wait(lock, [this] { return _pending == 0; });
+}
+
+void ThreadPool::
+apply(size_t count, std::function<void(size_t)> const &block)
+{
+    if (_threads.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            block(i);
+        }
+        return;
+    }
+
+    /*
+     * Each worker claims the next unclaimed index, so uneven work per
+     * index is balanced without needing a task per index.
+     */
+    std::atomic<size_t> next(0);
+    size_t workers = std::min(count, _threads.size());
+
+    /*
+     * Only wait for this call's workers, not all tasks in the pool, so
+     * callers sharing the pool don't wait on each other's work.
+     */
+    size_t running = workers;
+    for (size_t i = 0; i < workers; ++i) {
+        dispatch([this, &next, &running, count, &block] {
+            for (size_t index = next++; index < count; index = next++) {
+                block(index);
+            }
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (--running == 0) {
+                _tasksFinished.notify_all();
+            }
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _tasksFinished.wait(lock, [&running] { return running == 0; });
+}
+
+ThreadPool &ThreadPool::
+Shared()
+{
+    static ThreadPool shared;
+    return shared;
+}
+
+size_t ThreadPool::
+DefaultThreads()
+{
+    unsigned int threads = std::thread::hardware_concurrency();
+    return (threads > 0 ? threads : 1);
+}
+
+void ThreadPool::
+work()
+{
+    for (;;) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _taskAvailable.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+            if (_tasks.empty()) {
+                /* Stopping and no work left. */
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+
+        task();
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _pending--;
+            if (_pending == 0) {
+                _tasksFinished.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,168 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/CachingFilesystem.h>
+#include <libutil/MemoryFilesystem.h>
+
+using libutil::CachingFilesystem;
+using libutil::MemoryFilesystem;
+using libutil::Filesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+static MemoryFilesystem
+BasicFilesystem()
+{
+    return MemoryFilesystem({
+        MemoryFilesystem::Entry::File("file1", Contents("one")),
+        MemoryFilesystem::Entry::Directory("dir1", {
+            MemoryFilesystem::Entry::File("file2", Contents("two")),
+        }),
+    });
+}
+
+TEST(CachingFilesystem, Queries)
+{
+    auto memory = BasicFilesystem();
+    CachingFilesystem filesystem(&memory);
+
+    EXPECT_TRUE(filesystem.exists(memory.path("file1")));
+    EXPECT_EQ(0, filesystem.hits());
+    EXPECT_EQ(1, filesystem.misses());
+
+    EXPECT_TRUE(filesystem.exists(memory.path("file1")));
+    EXPECT_EQ(1, filesystem.hits());
+    EXPECT_EQ(1, filesystem.misses());
+
+    EXPECT_EQ(Filesystem::Type::Directory, filesystem.type(memory.path("dir1")));
+    EXPECT_EQ(Filesystem::Type::Directory, filesystem.type(memory.path("dir1")));
+    EXPECT_FALSE(filesystem.exists(memory.path("missing")));
+    EXPECT_FALSE(filesystem.exists(memory.path("missing")));
+    EXPECT_EQ(3, filesystem.hits());
+    EXPECT_EQ(3, filesystem.misses());
+}
+
+TEST(CachingFilesystem, ReadDirectory)
+{
+    auto memory = BasicFilesystem();
+    CachingFilesystem filesystem(&memory);
+
+    std::vector<std::string> first;
+    EXPECT_TRUE(filesystem.readDirectory(memory.path("dir1"), false, [&](std::string const &name) {
+        first.push_back(name);
+    }));
+
+    std::vector<std::string> second;
+    EXPECT_TRUE(filesystem.readDirectory(memory.path("dir1"), false, [&](std::string const &name) {
+        second.push_back(name);
+    }));
+
+    EXPECT_EQ(std::vector<std::string>({ "file2" }), first);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(1, filesystem.hits());
+
+    EXPECT_FALSE(filesystem.readDirectory(memory.path("missing"), false, [](std::string const &name) { }));
+}
+
+TEST(CachingFilesystem, Invalidation)
+{
+    auto memory = BasicFilesystem();
+    CachingFilesystem filesystem(&memory);
+
+    std::string path = memory.path("dir1/file3");
+    EXPECT_FALSE(filesystem.exists(path));
+    EXPECT_EQ(ext::nullopt, filesystem.findFile("file3", { memory.path("dir1") }));
+
+    size_t count = 0;
+    filesystem.readDirectory(memory.path("dir1"), false, [&](std::string const &name) { count++; });
+    EXPECT_EQ(1, count);
+
+    /* Writing through the cache invalidates the entry, its directory, and lookups. */
+    EXPECT_TRUE(filesystem.write(Contents("three"), path));
+    EXPECT_TRUE(filesystem.exists(path));
+    EXPECT_EQ(path, filesystem.findFile("file3", { memory.path("dir1") }));
+
+    count = 0;
+    filesystem.readDirectory(memory.path("dir1"), false, [&](std::string const &name) { count++; });
+    EXPECT_EQ(2, count);
+
+    /* Removing a directory invalidates entries inside of it. */
+    EXPECT_TRUE(filesystem.removeDirectory(memory.path("dir1"), true));
+    EXPECT_FALSE(filesystem.exists(path));
+
+    /* External changes are only seen after invalidating. */
+    EXPECT_FALSE(filesystem.exists(memory.path("file4")));
+    EXPECT_TRUE(memory.write(Contents("four"), memory.path("file4")));
+    EXPECT_FALSE(filesystem.exists(memory.path("file4")));
+    filesystem.invalidate();
+    EXPECT_TRUE(filesystem.exists(memory.path("file4")));
+}
+
+TEST(CachingFilesystem, InvalidateCreatedParents)
+{
+    auto memory = BasicFilesystem();
+    CachingFilesystem filesystem(&memory);
+
+    EXPECT_EQ(ext::nullopt, filesystem.type(memory.path("new")));
+    EXPECT_FALSE(filesystem.exists(memory.path("new/sub")));
+
+    /* Parents created along the way are no longer missing. */
+    EXPECT_TRUE(filesystem.createDirectory(memory.path("new/sub/dir"), true));
+    EXPECT_EQ(Filesystem::Type::Directory, filesystem.type(memory.path("new")));
+    EXPECT_TRUE(filesystem.exists(memory.path("new/sub")));
+    EXPECT_TRUE(filesystem.exists(memory.path("new/sub/dir")));
+}
+
+/*
+ * Changes the filesystem while a query is in progress, as another thread
+ * could between the query and the result being cached.
+ */
+class ChangingFilesystem : public MemoryFilesystem {
+public:
+    std::function<void()> change;
+
+public:
+    ChangingFilesystem(MemoryFilesystem const &filesystem) :
+        MemoryFilesystem(filesystem)
+    {
+    }
+
+public:
+    virtual ext::optional<Type> type(std::string const &path) const
+    {
+        ext::optional<Type> result = MemoryFilesystem::type(path);
+        if (change) {
+            std::function<void()> current = change;
+            const_cast<ChangingFilesystem *>(this)->change = nullptr;
+            current();
+        }
+        return result;
+    }
+};
+
+TEST(CachingFilesystem, InvalidateDuringQuery)
+{
+    ChangingFilesystem memory = ChangingFilesystem(BasicFilesystem());
+    CachingFilesystem filesystem(&memory);
+
+    std::string path = memory.path("file3");
+    memory.change = [&] {
+        EXPECT_TRUE(filesystem.write(Contents("three"), path));
+    };
+
+    /* The query started before the write, so can't see it... */
+    EXPECT_EQ(ext::nullopt, filesystem.type(path));
+
+    /* ...but its result must not be cached over the invalidation. */
+    EXPECT_EQ(Filesystem::Type::File, filesystem.type(path));
+}
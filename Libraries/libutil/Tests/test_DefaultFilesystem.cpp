@@ -0,0 +1,169 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/DefaultFilesystem.h>
+#include <libutil/ThreadPool.h>
+
+#include <algorithm>
+#include <map>
+#include <cstdlib>
+
+#if !_WIN32
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+using libutil::DefaultFilesystem;
+using libutil::Filesystem;
+using libutil::Permissions;
+using libutil::ThreadPool;
+
+#if !_WIN32
+static std::string
+TemporaryDirectory()
+{
+    char const *tmpdir = getenv("TMPDIR");
+    std::string path = std::string(tmpdir != nullptr ? tmpdir : "/tmp") + "/libutil-XXXXXX";
+    if (::mkdtemp(&path[0]) == nullptr) {
+        return std::string();
+    }
+    return path;
+}
+
+TEST(DefaultFilesystem, WalkDirectory)
+{
+    DefaultFilesystem filesystem;
+    std::string root = TemporaryDirectory();
+    ASSERT_FALSE(root.empty());
+
+    ASSERT_TRUE(filesystem.createDirectory(root + "/a/b/c", true));
+    ASSERT_TRUE(filesystem.createDirectory(root + "/d", false));
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>(3), root + "/file"));
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>(5), root + "/a/b/file"));
+    ASSERT_TRUE(filesystem.writeSymbolicLink("a", root + "/link", true));
+
+    /* Types come from the directory; symbolic links are not followed. */
+    std::map<std::string, Filesystem::DirectoryEntry> entries;
+    ThreadPool threadPool(4);
+    EXPECT_TRUE(filesystem.walkDirectory(root, true, true, [&entries](Filesystem::DirectoryEntry const &entry) {
+        entries[entry.path] = entry;
+        return true;
+    }, &threadPool));
+
+    EXPECT_EQ(7, entries.size());
+    EXPECT_EQ(Filesystem::Type::Directory, entries["a"].type);
+    EXPECT_EQ(Filesystem::Type::Directory, entries["a/b/c"].type);
+    EXPECT_EQ(Filesystem::Type::Directory, entries["d"].type);
+    EXPECT_EQ(Filesystem::Type::SymbolicLink, entries["link"].type);
+    EXPECT_EQ(Filesystem::Type::File, entries["a/b/file"].type);
+    EXPECT_EQ(ext::optional<uint64_t>(5), entries["a/b/file"].size);
+    EXPECT_EQ(filesystem.modificationTime(root + "/file"), entries["file"].modificationTime);
+
+    /* Without metadata, nothing is stat'd. */
+    std::vector<std::string> paths;
+    EXPECT_TRUE(filesystem.walkDirectory(root + "/a", true, false, [&paths](Filesystem::DirectoryEntry const &entry) {
+        EXPECT_EQ(ext::nullopt, entry.size);
+        paths.push_back(entry.path);
+        return true;
+    }));
+    ASSERT_EQ(3, paths.size());
+    EXPECT_EQ("b", paths[0]);
+    std::sort(paths.begin(), paths.end());
+    EXPECT_EQ(paths, std::vector<std::string>({ "b", "b/c", "b/file" }));
+
+    /* Recursive listings walk each subdirectory completely before the next. */
+    ASSERT_TRUE(filesystem.createDirectory(root + "/d/e", false));
+    paths.clear();
+    EXPECT_TRUE(filesystem.readDirectory(root, true, [&paths](std::string const &path) {
+        paths.push_back(path);
+    }));
+    ASSERT_EQ(8, paths.size());
+    std::vector<std::string> top = std::vector<std::string>(paths.begin(), paths.begin() + 4);
+    bool aFirst = (std::find(top.begin(), top.end(), "a") < std::find(top.begin(), top.end(), "d"));
+    std::vector<std::string> nested = std::vector<std::string>(paths.begin() + 4, paths.end());
+    if (!aFirst) {
+        std::rotate(nested.begin(), nested.begin() + 1, nested.end());
+    }
+    EXPECT_EQ("a/b", nested[0]);
+    std::sort(nested.begin() + 1, nested.begin() + 3);
+    EXPECT_EQ(nested, std::vector<std::string>({ "a/b", "a/b/c", "a/b/file", "d/e" }));
+
+    /* Nested directories are removed children first. */
+    EXPECT_TRUE(filesystem.removeDirectory(root, true));
+    EXPECT_FALSE(filesystem.exists(root));
+}
+
+TEST(DefaultFilesystem, WriteIfChanged)
+{
+    DefaultFilesystem filesystem;
+    std::string root = TemporaryDirectory();
+    ASSERT_FALSE(root.empty());
+
+    std::string path = root + "/file";
+    std::vector<uint8_t> contents = { 'a', 'b', 'c' };
+    bool written;
+    ASSERT_TRUE(filesystem.writeIfChanged(contents, path, &written));
+    EXPECT_TRUE(written);
+    ASSERT_TRUE(filesystem.writeFilePermissions(path, Permissions::Operation::Add, Permissions({ Permissions::Permission::Execute }, { }, { })));
+
+    /* Unchanged contents leave the file alone. */
+    ext::optional<uint64_t> modificationTime = filesystem.modificationTime(path);
+    EXPECT_TRUE(filesystem.writeIfChanged(contents, path, &written));
+    EXPECT_FALSE(written);
+    EXPECT_EQ(modificationTime, filesystem.modificationTime(path));
+
+    /* Changed contents replace the file, keeping its permissions. */
+    contents = { 'a', 'b', 'd' };
+    EXPECT_TRUE(filesystem.writeIfChanged(contents, path, &written));
+    EXPECT_TRUE(written);
+    std::vector<uint8_t> read;
+    EXPECT_TRUE(filesystem.read(&read, path));
+    EXPECT_EQ(contents, read);
+    EXPECT_TRUE(filesystem.isExecutable(path));
+
+    /* Nothing is left behind from replacing the file. */
+    std::vector<std::string> paths;
+    EXPECT_TRUE(filesystem.readDirectory(root, false, [&paths](std::string const &name) {
+        paths.push_back(name);
+    }));
+    EXPECT_EQ(std::vector<std::string>({ "file" }), paths);
+
+    EXPECT_TRUE(filesystem.removeDirectory(root, true));
+}
+
+TEST(DefaultFilesystem, PrivateDirectory)
+{
+    DefaultFilesystem filesystem;
+    std::string root = TemporaryDirectory();
+    ASSERT_FALSE(root.empty());
+
+    /* Created for only this user, and accepted again once it exists. */
+    std::string path = root + "/private";
+    ASSERT_TRUE(filesystem.createPrivateDirectory(path));
+    struct stat st;
+    ASSERT_EQ(0, ::stat(path.c_str(), &st));
+    EXPECT_EQ(0, st.st_mode & (S_IRWXG | S_IRWXO));
+    EXPECT_TRUE(filesystem.createPrivateDirectory(path));
+
+    /* Others could have changed what is in it. */
+    ASSERT_EQ(0, ::chmod(path.c_str(), S_IRWXU | S_IWOTH));
+    EXPECT_FALSE(filesystem.createPrivateDirectory(path));
+
+    /* Or what it points to. */
+    std::string link = root + "/link";
+    ASSERT_EQ(0, ::symlink(root.c_str(), link.c_str()));
+    EXPECT_FALSE(filesystem.createPrivateDirectory(link));
+
+    /* Not a directory at all. */
+    ASSERT_TRUE(filesystem.write({ }, root + "/file"));
+    EXPECT_FALSE(filesystem.createPrivateDirectory(root + "/file"));
+
+    EXPECT_TRUE(filesystem.removeDirectory(root, true));
+}
+#endif
@@ -0,0 +1,87 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/LookupCache.h>
+#include <libutil/MemoryFilesystem.h>
+
+using libutil::LookupCache;
+using libutil::MemoryFilesystem;
+
+static MemoryFilesystem
+BasicFilesystem()
+{
+    return MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("dir1", { }),
+        MemoryFilesystem::Entry::Directory("dir2", {
+            MemoryFilesystem::Entry::File("tool", { }),
+        }),
+    });
+}
+
+TEST(LookupCache, FindExecutable)
+{
+    auto filesystem = BasicFilesystem();
+    std::vector<std::string> paths = { filesystem.path("dir1"), filesystem.path("dir2") };
+
+    LookupCache cache;
+    EXPECT_EQ(filesystem.path("dir2/tool"), cache.findExecutable(&filesystem, "tool", paths));
+    EXPECT_TRUE(cache.modified());
+    EXPECT_EQ(ext::nullopt, cache.findExecutable(&filesystem, "missing", paths));
+
+    /* Changes the cache cannot see return the cached result. */
+    filesystem.root().child("dir2")->children().clear();
+    EXPECT_EQ(filesystem.path("dir2/tool"), cache.findExecutable(&filesystem, "tool", paths));
+
+    /* Changes to the search paths are seen. */
+    ASSERT_TRUE(filesystem.createFile(filesystem.path("dir1/tool")));
+    EXPECT_EQ(filesystem.path("dir1/tool"), cache.findExecutable(&filesystem, "tool", paths));
+}
+
+TEST(LookupCache, Stamps)
+{
+    auto filesystem = BasicFilesystem();
+
+    LookupCache cache;
+    std::string key = LookupCache::Key({ "key", "component" });
+    cache.insert(key, { "value" }, LookupCache::Stamp(&filesystem, { filesystem.path("dir1"), filesystem.path("missing") }));
+    EXPECT_EQ(std::vector<std::string>({ "value" }), cache.lookup(&filesystem, key));
+    EXPECT_EQ(ext::nullopt, cache.lookup(&filesystem, LookupCache::Key({ "key" })));
+
+    /* Creating a path that was missing invalidates. */
+    ASSERT_TRUE(filesystem.createDirectory(filesystem.path("missing"), false));
+    EXPECT_EQ(ext::nullopt, cache.lookup(&filesystem, key));
+}
+
+TEST(LookupCache, SaveLoad)
+{
+    auto filesystem = BasicFilesystem();
+    std::vector<std::string> paths = { filesystem.path("dir1"), filesystem.path("dir2") };
+
+    LookupCache cache;
+    cache.insert("unstamped", { "one", "two" }, { });
+    cache.insert("stamped", { "three" }, LookupCache::Stamp(&filesystem, paths));
+    ASSERT_TRUE(cache.save(&filesystem, filesystem.path("cache")));
+    EXPECT_FALSE(cache.modified());
+
+    LookupCache loaded;
+    EXPECT_TRUE(loaded.load(&filesystem, filesystem.path("cache")));
+    EXPECT_FALSE(loaded.modified());
+    EXPECT_EQ(std::vector<std::string>({ "one", "two" }), loaded.lookup(&filesystem, "unstamped"));
+
+    /* The memory filesystem's stamps change with any write, including the save. */
+    EXPECT_EQ(ext::nullopt, loaded.lookup(&filesystem, "stamped"));
+
+    /* Corrupted files are ignored. */
+    std::vector<uint8_t> contents;
+    ASSERT_TRUE(filesystem.read(&contents, filesystem.path("cache")));
+    contents.push_back(0);
+    ASSERT_TRUE(filesystem.write(contents, filesystem.path("cache")));
+    EXPECT_FALSE(loaded.load(&filesystem, filesystem.path("cache")));
+    EXPECT_EQ(ext::nullopt, loaded.lookup(&filesystem, "unstamped"));
+}
@@ -8,9 +8,11 @@
 
 #include <gtest/gtest.h>
 #include <libutil/MemoryFilesystem.h>
+#include <libutil/ThreadPool.h>
 
 using libutil::MemoryFilesystem;
 using libutil::Filesystem;
+using libutil::ThreadPool;
 
 static std::vector<uint8_t>
 Contents(std::string const &string)
@@ -195,6 +197,33 @@ TEST(MemoryFilesystem, Write)
     EXPECT_FALSE(filesystem.exists(filesystem.path("invalid/new")));
 }
 
+TEST(MemoryFilesystem, WriteIfChanged)
+{
+    auto filesystem = BasicFilesystem();
+    std::vector<uint8_t> contents;
+    bool written;
+
+    /* Same contents are not written. */
+    ext::optional<uint64_t> modificationTime = filesystem.modificationTime(filesystem.path("file1"));
+    EXPECT_TRUE(filesystem.writeIfChanged(Contents("one"), filesystem.path("file1"), &written));
+    EXPECT_FALSE(written);
+    EXPECT_EQ(modificationTime, filesystem.modificationTime(filesystem.path("file1")));
+
+    /* Different contents, even of the same size, are. */
+    EXPECT_TRUE(filesystem.writeIfChanged(Contents("two"), filesystem.path("file1"), &written));
+    EXPECT_TRUE(written);
+    EXPECT_TRUE(filesystem.read(&contents, filesystem.path("file1")));
+    EXPECT_EQ(contents, Contents("two"));
+
+    /* New files are written. */
+    EXPECT_TRUE(filesystem.writeIfChanged(Contents("new"), filesystem.path("new"), &written));
+    EXPECT_TRUE(written);
+    EXPECT_TRUE(filesystem.exists(filesystem.path("new")));
+
+    /* Can't write to a directory. */
+    EXPECT_FALSE(filesystem.writeIfChanged(Contents("new"), filesystem.path("dir1")));
+}
+
 TEST(MemoryFilesystem, CopyFile)
 {
     std::vector<uint8_t> contents;
@@ -341,6 +370,73 @@ TEST(MemoryFilesystem, ReadDirectory)
     EXPECT_EQ(files, std::vector<std::string>());
 }
 
+TEST(MemoryFilesystem, WalkDirectory)
+{
+    auto filesystem = BasicFilesystem();
+
+    std::vector<std::pair<std::string, ext::optional<Filesystem::Type>>> entries;
+    auto accumulate = [&entries](Filesystem::DirectoryEntry const &entry) {
+        entries.push_back({ entry.path, entry.type });
+        return true;
+    };
+
+    /* Parents are reported before children, with their types. */
+    EXPECT_TRUE(filesystem.walkDirectory(filesystem.path(""), true, false, accumulate));
+    EXPECT_EQ(entries, (std::vector<std::pair<std::string, ext::optional<Filesystem::Type>>>({
+        { "file1", Filesystem::Type::File },
+        { "dir1", Filesystem::Type::Directory },
+        { "dir2", Filesystem::Type::Directory },
+        { "dir1/file2", Filesystem::Type::File },
+        { "dir2/file2", Filesystem::Type::File },
+        { "dir2/dir3", Filesystem::Type::Directory },
+    })));
+
+    /* Reading in parallel reports in the same order. */
+    auto expected = entries;
+    entries.clear();
+    ThreadPool threadPool(4);
+    EXPECT_TRUE(filesystem.walkDirectory(filesystem.path(""), true, false, accumulate, &threadPool));
+    EXPECT_EQ(expected, entries);
+
+    /* Directories can be skipped. */
+    std::vector<std::string> paths;
+    EXPECT_TRUE(filesystem.walkDirectory(filesystem.path(""), true, false, [&paths](Filesystem::DirectoryEntry const &entry) {
+        paths.push_back(entry.path);
+        return entry.path != "dir2";
+    }));
+    EXPECT_EQ(paths, std::vector<std::string>({ "file1", "dir1", "dir2", "dir1/file2" }));
+
+    /* Can't walk nonexistent directory. */
+    EXPECT_FALSE(filesystem.walkDirectory(filesystem.path("invalid"), true, false, accumulate));
+}
+
+TEST(MemoryFilesystem, WalkDirectoryOrder)
+{
+    auto filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("a", {
+            MemoryFilesystem::Entry::Directory("b", {
+                MemoryFilesystem::Entry::Directory("c", { }),
+            }),
+        }),
+        MemoryFilesystem::Entry::Directory("d", {
+            MemoryFilesystem::Entry::File("e", std::vector<uint8_t>(3)),
+        }),
+    });
+
+    /* Each subdirectory is walked completely before the next, as search paths rely on. */
+    std::vector<std::string> const expected = { "a", "d", "a/b", "a/b/c", "d/e" };
+    for (ThreadPool *threadPool : { static_cast<ThreadPool *>(nullptr), new ThreadPool(4) }) {
+        std::vector<std::string> paths;
+        EXPECT_TRUE(filesystem.walkDirectory(filesystem.path(""), true, true, [&paths](Filesystem::DirectoryEntry const &entry) {
+            paths.push_back(entry.path);
+            EXPECT_EQ(entry.type == Filesystem::Type::File ? ext::optional<uint64_t>(3) : ext::nullopt, entry.size);
+            return true;
+        }, threadPool));
+        EXPECT_EQ(expected, paths);
+        delete threadPool;
+    }
+}
+
 TEST(MemoryFilesystem, CopyDirectory)
 {
     auto filesystem = BasicFilesystem();
@@ -0,0 +1,81 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <libutil/ThreadPool.h>
+
+#include <atomic>
+
+using libutil::ThreadPool;
+
+TEST(ThreadPool, DispatchWait)
+{
+    ThreadPool pool(4);
+    EXPECT_EQ(4, pool.threads());
+
+    std::atomic<int> count(0);
+    for (int i = 0; i < 100; ++i) {
+        pool.dispatch([&count] { count++; });
+    }
+    pool.wait();
+    EXPECT_EQ(100, count);
+}
+
+TEST(ThreadPool, Apply)
+{
+    ThreadPool pool(4);
+
+    std::vector<size_t> results(1000, 0);
+    pool.apply(results.size(), [&results](size_t index) {
+        results[index] = index * 2;
+    });
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(i * 2, results[i]);
+    }
+}
+
+TEST(ThreadPool, ApplyConcurrently)
+{
+    ThreadPool pool(4);
+
+    /* Callers sharing a pool each get back only once their own work is done. */
+    std::vector<std::vector<size_t>> results(4, std::vector<size_t>(1000, 0));
+    std::vector<std::thread> callers;
+    for (size_t caller = 0; caller < results.size(); ++caller) {
+        callers.push_back(std::thread([&pool, &results, caller] {
+            std::vector<size_t> *result = &results[caller];
+            pool.apply(result->size(), [result, caller](size_t index) {
+                (*result)[index] = index + caller;
+            });
+
+            for (size_t i = 0; i < result->size(); ++i) {
+                EXPECT_EQ(i + caller, (*result)[i]);
+            }
+        }));
+    }
+
+    for (std::thread &caller : callers) {
+        caller.join();
+    }
+}
+
+TEST(ThreadPool, SingleThreadInline)
+{
+    ThreadPool pool(1);
+    EXPECT_EQ(1, pool.threads());
+
+    /* Single threaded pools run in order on the calling thread. */
+    std::thread::id caller = std::this_thread::get_id();
+    std::vector<size_t> order;
+    pool.apply(5, [&](size_t index) {
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        order.push_back(index);
+    });
+    EXPECT_EQ(std::vector<size_t>({ 0, 1, 2, 3, 4 }), order);
+}
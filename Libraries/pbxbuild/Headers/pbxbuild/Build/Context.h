@@ -13,6 +13,8 @@
 #include <pbxbuild/WorkspaceContext.h>
 #include <pbxbuild/Build/Environment.h>
 #include <pbxbuild/Target/Environment.h>
+#include <pbxbuild/Tool/HeadermapCache.h>
+#include <pbxbuild/Tool/SearchPathsCache.h>
 
 #include <ext/optional>
 
@@ -36,6 +38,8 @@ private:
 
 private:
     std::shared_ptr<std::unordered_map<pbxproj::PBX::Target::shared_ptr, Target::Environment>> _targetEnvironments;
+    std::shared_ptr<Tool::SearchPathsCache> _searchPathsCache;
+    std::shared_ptr<Tool::HeadermapCache>   _headermapCache;
 
 public:
     Context(
@@ -111,6 +115,19 @@ public:
     ext::optional<Target::Environment>
     targetEnvironment(Build::Environment const &buildEnvironment, pbxproj::PBX::Target::shared_ptr const &target) const;
 
+public:
+    /*
+     * Recursive search path expansions shared by all targets in the build.
+     */
+    Tool::SearchPathsCache *searchPathsCache() const
+    { return _searchPathsCache.get(); }
+
+    /*
+     * Project headers shared by all targets in the build.
+     */
+    Tool::HeadermapCache *headermapCache() const
+    { return _headermapCache.get(); }
+
 public:
     /*
      * Finds a target by identifier within a project.
@@ -19,6 +19,16 @@
 namespace pbxbuild {
 
 class HeaderMap {
+public:
+    /*
+     * A header: the key is found at the prefix followed by the suffix.
+     */
+    struct Entry {
+        std::string key;
+        std::string prefix;
+        std::string suffix;
+    };
+
 private:
     HMapHeader              _header;
     std::vector<HMapBucket> _buckets;
@@ -40,6 +50,23 @@ public:
 public:
     bool add(std::string const &key, std::string const &prefix, std::string const &suffix);
 
+    /*
+     * Add many entries, sizing the buckets once for all of them. Keys that
+     * already exist are skipped. Returns the number of entries added.
+     */
+    size_t add(std::vector<Entry> const &entries);
+
+    /*
+     * Size the buckets to hold a total number of entries without growing.
+     */
+    void reserve(size_t count);
+
+public:
+    /*
+     * The prefix and suffix for a key, if present. Keys are case-insensitive.
+     */
+    bool find(std::string const &key, std::string *prefix, std::string *suffix) const;
+
 public:
     void dump();
 
@@ -16,6 +16,10 @@
 #include <pbxbuild/Tool/Context.h>
 #include <pbxbuild/Tool/ToolResolver.h>
 
+namespace libutil { class CachingFilesystem; }
+namespace libutil { class Filesystem; }
+namespace libutil { class ThreadPool; }
+
 namespace pbxbuild {
 
 namespace Tool {
@@ -26,6 +30,7 @@ namespace Tool {
     class InfoPlistResolver;
     class InterfaceBuilderResolver;
     class MakeDirectoryResolver;
+    class ScriptEnvironment;
     class ScriptResolver;
     class SwiftResolver;
     class SymlinkResolver;
@@ -55,6 +60,13 @@ private:
     std::unique_ptr<Tool::TouchResolver>                _touchResolver;
     std::unordered_map<std::string, Tool::ToolResolver> _toolResolvers;
 
+private:
+    std::unique_ptr<Tool::ScriptEnvironment>            _scriptEnvironment;
+
+private:
+    std::unique_ptr<libutil::CachingFilesystem>         _filesystem;
+    std::unique_ptr<libutil::ThreadPool>                _threadPool;
+
 public:
     explicit Context(Tool::Context const &toolContext);
     ~Context();
@@ -82,6 +94,25 @@ public:
     Tool::TouchResolver const            *touchResolver(Phase::Environment const &phaseEnvironment);
     Tool::ToolResolver const             *toolResolver(Phase::Environment const &phaseEnvironment, std::string const &identifier);
 
+public:
+    /*
+     * Build settings for scripts run with the target's environment, shared
+     * by each of those scripts.
+     */
+    Tool::ScriptEnvironment const        *scriptEnvironment(Phase::Environment const &phaseEnvironment);
+
+public:
+    /*
+     * Filesystem for resolving build files. Queries are cached while the
+     * phases are resolved, since nothing is built until afterwards.
+     */
+    libutil::Filesystem const            *filesystem();
+
+    /*
+     * Workers for resolving independent build files concurrently.
+     */
+    libutil::ThreadPool                  *threadPool();
+
 public:
     /*
      * Groups the files according to the tools used to build them.
@@ -9,6 +9,7 @@
 #ifndef __pbxbuild_Tool_ClangResolver_h
 #define __pbxbuild_Tool_ClangResolver_h
 
+#include <pbxbuild/Tool/Invocation.h>
 #include <pbxspec/Manager.h>
 #include <pbxspec/PBX/Compiler.h>
 
@@ -23,6 +24,7 @@ namespace Tool {
 
 class Context;
 class Input;
+class OptionsCache;
 class PrecompiledHeaderInfo;
 class SearchPaths;
 
@@ -35,6 +37,60 @@ public:
     ~ClangResolver();
 
 public:
+    /*
+     * A source file's compilation, resolved but not yet added to a context.
+     */
+    class PreparedSource {
+    private:
+        Tool::Invocation                                _invocation;
+        std::shared_ptr<Tool::PrecompiledHeaderInfo>    _precompiledHeaderInfo;
+        bool                                            _isCPlusPlus;
+        std::vector<std::string>                        _linkerArgs;
+
+    public:
+        PreparedSource(
+            Tool::Invocation const &invocation,
+            std::shared_ptr<Tool::PrecompiledHeaderInfo> const &precompiledHeaderInfo,
+            bool isCPlusPlus,
+            std::vector<std::string> const &linkerArgs);
+        ~PreparedSource();
+
+    public:
+        Tool::Invocation const &invocation() const
+        { return _invocation; }
+        std::shared_ptr<Tool::PrecompiledHeaderInfo> const &precompiledHeaderInfo() const
+        { return _precompiledHeaderInfo; }
+        bool isCPlusPlus() const
+        { return _isCPlusPlus; }
+        std::vector<std::string> const &linkerArgs() const
+        { return _linkerArgs; }
+    };
+
+public:
+    /*
+     * Resolve the compilation of a source file. Only reads from the tool
+     * context, so may be called concurrently for independent files. If an
+     * options cache is passed, it must be shared only by sources resolved
+     * with the same environment.
+     */
+    PreparedSource prepareSource(
+        Tool::Context const &toolContext,
+        pbxsetting::Environment const &environment,
+        Tool::Input const &input,
+        std::string const &outputDirectory,
+        Tool::OptionsCache *optionsCache = nullptr) const;
+
+    /*
+     * Add a prepared source compilation to the tool context.
+     */
+    void mergeSource(
+        Tool::Context *toolContext,
+        pbxsetting::Environment const &environment,
+        PreparedSource const &preparedSource) const;
+
+    /*
+     * Resolve and add the compilation of a source file.
+     */
     void resolveSource(
         Tool::Context *toolContext,
         pbxsetting::Environment const &environment,
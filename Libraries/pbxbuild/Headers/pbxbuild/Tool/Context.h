@@ -16,6 +16,7 @@
 #include <pbxbuild/Tool/ModuleMapInfo.h>
 #include <pbxbuild/Tool/PrecompiledHeaderInfo.h>
 #include <pbxbuild/Tool/SearchPaths.h>
+#include <pbxbuild/Tool/SearchPathsCache.h>
 #include <xcsdk/SDK/Target.h>
 #include <xcsdk/SDK/Toolchain.h>
 
@@ -37,6 +38,7 @@ private:
 
 private:
     SearchPaths                      _searchPaths;
+    SearchPathsCache                *_searchPathsCache;
 
 private:
     HeadermapInfo                    _headermapInfo;
@@ -60,7 +62,8 @@ public:
         xcsdk::SDK::Target::shared_ptr const &sdk,
         std::vector<xcsdk::SDK::Toolchain::shared_ptr> const &toolchains,
         std::string const &workingDirectory,
-        SearchPaths const &searchPaths);
+        SearchPaths const &searchPaths,
+        SearchPathsCache *searchPathsCache = nullptr);
     ~Context();
 
 public:
@@ -74,6 +77,8 @@ public:
 public:
     SearchPaths const &searchPaths() const
     { return _searchPaths; }
+    SearchPathsCache *searchPathsCache() const
+    { return _searchPathsCache; }
 
 public:
     HeadermapInfo const &headermapInfo() const
@@ -15,6 +15,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <ext/optional>
 
 namespace pbxsetting { class Environment; }
 
@@ -39,6 +40,28 @@ public:
         std::string const &outputDirectory,
         std::string const &logMessageTitle) const;
 
+    /*
+     * Copy inputs in invocations of up to `batchSize` inputs each, rather
+     * than one invocation per input. Each batch records stamps for the
+     * files it copied, so only files that changed are copied again.
+     */
+    void resolveBatched(
+        Tool::Context *toolContext,
+        pbxsetting::Environment const &environment,
+        std::vector<Tool::Input> const &inputs,
+        std::string const &outputDirectory,
+        std::string const &logMessageTitle,
+        size_t batchSize) const;
+
+private:
+    void resolve(
+        Tool::Context *toolContext,
+        pbxsetting::Environment const &environment,
+        std::vector<Tool::Input> const &input,
+        std::string const &outputDirectory,
+        std::string const &logMessageTitle,
+        ext::optional<std::string> const &stampFile) const;
+
 public:
     static std::string ToolIdentifier()
     { return "com.apple.compilers.pbxcp"; }
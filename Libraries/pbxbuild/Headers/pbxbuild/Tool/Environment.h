@@ -48,6 +48,14 @@ public:
     std::vector<std::string> inputs(std::string const &workingDirectory) const;
     std::vector<std::string> outputs(std::string const &workingDirectory) const;
 
+public:
+    /*
+     * The settings added by `Create()` whose values depend on the specific
+     * inputs and outputs, rather than on the tool and base environment.
+     */
+    static std::unordered_set<std::string> const &
+    InputOutputSettings();
+
 public:
     static Tool::Environment
     Create(
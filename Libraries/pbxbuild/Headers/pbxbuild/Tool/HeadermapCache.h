@@ -0,0 +1,96 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __pbxbuild_Tool_HeadermapCache_h
+#define __pbxbuild_Tool_HeadermapCache_h
+
+#include <pbxspec/Manager.h>
+#include <pbxproj/PBX/Project.h>
+#include <pbxsetting/Value.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libutil { class Filesystem; }
+namespace pbxsetting { class Environment; }
+
+namespace pbxbuild {
+namespace Tool {
+
+/*
+ * The headers of each project in a build, shared by all of its targets.
+ * Each target only needs to add its own headers on top of these, rather
+ * than finding the headers of every other target in the project again.
+ * Safe to use from multiple threads.
+ */
+class HeadermapCache {
+public:
+    /*
+     * A header in the project, from a file reference or a headers phase.
+     */
+    struct Header {
+        std::string fileName;
+        std::string directory;
+        std::string frameworkName;
+        bool        isPublic;
+        bool        isPrivate;
+        bool        isNonFramework;
+    };
+
+    /*
+     * The headers in a project, and the header maps that are the same
+     * for every target in it.
+     */
+    struct ProjectHeaders {
+        std::vector<Header>              projectHeaders;
+        std::vector<std::vector<Header>> targetHeaders;
+
+        std::vector<uint8_t>             projectHeadersData;
+        std::vector<uint8_t>             allTargetHeadersData;
+        std::vector<uint8_t>             allNonFrameworkTargetHeadersData;
+    };
+
+private:
+    class Project;
+
+private:
+    std::mutex                                                                       _mutex;
+    std::unordered_map<pbxproj::PBX::Project::shared_ptr, std::shared_ptr<Project>>  _projects;
+    std::unordered_map<std::string, std::shared_ptr<std::vector<std::string> const>> _directoryHeaders;
+
+public:
+    HeadermapCache();
+    ~HeadermapCache();
+
+public:
+    /*
+     * The headers in a project. Header paths are resolved in the given
+     * environment; the headers are only found again if a setting used
+     * to resolve them has a different value.
+     */
+    std::shared_ptr<ProjectHeaders const>
+    projectHeaders(
+        libutil::Filesystem const *filesystem,
+        pbxspec::Manager::shared_ptr const &specManager,
+        pbxsetting::Environment const &environment,
+        pbxproj::PBX::Project::shared_ptr const &project);
+
+    /*
+     * The names of the header files directly inside a directory.
+     */
+    std::shared_ptr<std::vector<std::string> const>
+    directoryHeaders(libutil::Filesystem const *filesystem, std::string const &path);
+};
+
+}
+}
+
+#endif // !__pbxbuild_Tool_HeadermapCache_h
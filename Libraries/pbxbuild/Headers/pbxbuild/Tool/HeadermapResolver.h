@@ -18,6 +18,7 @@
 #include <string>
 #include <vector>
 
+namespace libutil { class Filesystem; }
 namespace pbxsetting { class Environment; }
 
 namespace pbxbuild {
@@ -25,6 +26,7 @@ namespace Tool {
 
 class SearchPaths;
 class Context;
+class HeadermapCache;
 
 class HeadermapResolver {
 private:
@@ -37,9 +39,11 @@ public:
 
 public:
     void resolve(
+        libutil::Filesystem const *filesystem,
         Tool::Context *toolContext,
         pbxsetting::Environment const &environment,
-        pbxproj::PBX::Target::shared_ptr const &target) const;
+        pbxproj::PBX::Target::shared_ptr const &target,
+        Tool::HeadermapCache *headermapCache) const;
 
 public:
     pbxspec::PBX::Tool::shared_ptr const &tool() const
@@ -11,6 +11,7 @@
 
 #include <dependency/DependencyInfoFormat.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -36,6 +37,34 @@ public:
         { return _path; }
     };
 
+public:
+    /*
+     * Lets an invocation be skipped when nothing it depends on has changed
+     * since it last succeeded: the contents of its inputs, and a digest of
+     * everything else, such as the script it runs and its environment.
+     */
+    class ContentHash {
+    private:
+        std::string _database;
+        std::string _digest;
+
+    public:
+        ContentHash(std::string const &database, std::string const &digest);
+
+    public:
+        /*
+         * Where the hashes of previous successful runs are recorded.
+         */
+        std::string const &database() const
+        { return _database; }
+
+        /*
+         * Digest of what the invocation depends on, other than its inputs.
+         */
+        std::string const &digest() const
+        { return _digest; }
+    };
+
 public:
     /*
      * Represents the executable used to run the tool for the invocation.
@@ -90,6 +119,9 @@ private:
     std::unordered_map<std::string, std::string> _environment;
     std::string                                  _workingDirectory;
 
+private:
+    std::shared_ptr<std::unordered_map<std::string, std::string> const> _sharedEnvironment;
+
 private:
     std::vector<std::string>                     _inputs;
     std::vector<std::string>                     _outputs;
@@ -102,6 +134,9 @@ private:
 private:
     std::vector<DependencyInfo>                  _dependencyInfo;
 
+private:
+    ext::optional<ContentHash>                   _contentHash;
+
 private:
     std::string                                  _logMessage;
     bool                                         _showEnvironmentInLog;
@@ -139,6 +174,23 @@ public:
     std::string &workingDirectory()
     { return _workingDirectory; }
 
+public:
+    /*
+     * Environment variables shared with other invocations, such as the
+     * build settings passed to scripts. The invocation's own environment
+     * takes precedence over these.
+     */
+    std::shared_ptr<std::unordered_map<std::string, std::string> const> const &sharedEnvironment() const
+    { return _sharedEnvironment; }
+    std::shared_ptr<std::unordered_map<std::string, std::string> const> &sharedEnvironment()
+    { return _sharedEnvironment; }
+
+    /*
+     * The invocation's own environment combined with the shared environment.
+     */
+    std::unordered_map<std::string, std::string>
+    fullEnvironment() const;
+
 public:
     std::vector<std::string> const &inputs() const
     { return _inputs; }
@@ -180,6 +232,14 @@ public:
     std::vector<DependencyInfo> &dependencyInfo()
     { return _dependencyInfo; }
 
+public:
+    ext::optional<ContentHash> const &contentHash() const
+    { return _contentHash; }
+
+public:
+    ext::optional<ContentHash> &contentHash()
+    { return _contentHash; }
+
 public:
     std::string const &logMessage() const
     { return _logMessage; }
@@ -12,6 +12,8 @@
 #include <pbxspec/PBX/FileType.h>
 #include <pbxspec/PBX/PropertyOption.h>
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -22,6 +24,7 @@ namespace pbxbuild {
 namespace Tool {
 
 class Environment;
+class SearchPathsCache;
 
 class OptionsResult {
 private:
@@ -47,12 +50,41 @@ public:
         std::string const &workingDirectory,
         std::vector<pbxspec::PBX::PropertyOption::shared_ptr> const &options,
         pbxspec::PBX::FileType::shared_ptr const &fileType,
-        std::unordered_set<std::string> const &deletedSettings = std::unordered_set<std::string>());
+        std::unordered_set<std::string> const &deletedSettings = std::unordered_set<std::string>(),
+        Tool::SearchPathsCache *searchPathsCache = nullptr);
 
     static OptionsResult Create(
         Tool::Environment const &toolEnvironment,
         std::string const &workingDirectory,
-        pbxspec::PBX::FileType::shared_ptr const &fileType);
+        pbxspec::PBX::FileType::shared_ptr const &fileType,
+        Tool::SearchPathsCache *searchPathsCache = nullptr);
+};
+
+/*
+ * Creates options results for many inputs to the same tools. Options which
+ * don't reference the input or output are evaluated only once per tool and
+ * file type; the rest are evaluated for each input. The results are the
+ * same as `OptionsResult::Create()`. Must only be used for tool environments
+ * created from the same base environment. Safe to use from multiple threads.
+ */
+class OptionsCache {
+private:
+    class Template;
+
+private:
+    std::mutex                                                 _mutex;
+    std::unordered_map<std::string, std::shared_ptr<Template>> _templates;
+
+public:
+    OptionsCache();
+    ~OptionsCache();
+
+public:
+    OptionsResult create(
+        Tool::Environment const &toolEnvironment,
+        std::string const &workingDirectory,
+        pbxspec::PBX::FileType::shared_ptr const &fileType,
+        Tool::SearchPathsCache *searchPathsCache = nullptr);
 };
 
 }
@@ -0,0 +1,68 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __pbxbuild_Tool_ScriptEnvironment_h
+#define __pbxbuild_Tool_ScriptEnvironment_h
+
+#include <pbxsetting/Level.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace pbxsetting { class Environment; }
+
+namespace pbxbuild {
+namespace Tool {
+
+/*
+ * The build settings passed to scripts in their environment. All of the
+ * settings are resolved once and shared by every script invocation using
+ * the same environment; each invocation only needs the settings that its
+ * own levels could change.
+ */
+class ScriptEnvironment {
+private:
+    std::shared_ptr<std::unordered_map<std::string, std::string> const> _values;
+    std::unordered_map<std::string, std::unordered_set<std::string>>    _reverseDependencies;
+    std::string                                                         _valuesDigest;
+
+public:
+    explicit ScriptEnvironment(pbxsetting::Environment const &environment);
+    ~ScriptEnvironment();
+
+public:
+    /*
+     * The value of every setting in the environment.
+     */
+    std::shared_ptr<std::unordered_map<std::string, std::string> const> const &values() const
+    { return _values; }
+
+public:
+    /*
+     * The values that could differ from the shared values when the levels
+     * are added to the front of the environment. The environment passed
+     * must be the shared environment with those levels added.
+     */
+    std::unordered_map<std::string, std::string>
+    overlay(pbxsetting::Environment const &environment, std::vector<pbxsetting::Level> const &levels) const;
+
+    /*
+     * Digest of the environment of an invocation using an overlay, along
+     * with other contents the invocation depends on, such as its script.
+     */
+    std::string
+    digest(std::unordered_map<std::string, std::string> const &overlay, std::string const &contents) const;
+};
+
+}
+}
+
+#endif // !__pbxbuild_Tool_ScriptEnvironment_h
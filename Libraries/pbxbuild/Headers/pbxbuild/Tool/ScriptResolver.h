@@ -17,6 +17,7 @@ namespace pbxbuild {
 namespace Tool {
 
 class Context;
+class ScriptEnvironment;
 
 class ScriptResolver {
 private:
@@ -33,10 +34,12 @@ public:
     void resolve(
         Tool::Context *toolContext,
         pbxsetting::Environment const &environment,
+        Tool::ScriptEnvironment const &scriptEnvironment,
         pbxproj::PBX::ShellScriptBuildPhase::shared_ptr const &buildPhase) const;
     void resolve(
         Tool::Context *toolContext,
         pbxsetting::Environment const &environment,
+        Tool::ScriptEnvironment const &scriptEnvironment,
         Tool::Input const &file) const;
 
 public:
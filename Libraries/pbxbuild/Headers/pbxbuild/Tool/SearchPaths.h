@@ -17,6 +17,8 @@ namespace pbxsetting { class Environment; }
 namespace pbxbuild {
 namespace Tool {
 
+class SearchPathsCache;
+
 class SearchPaths {
 private:
     std::vector<std::string> _headerSearchPaths;
@@ -42,12 +44,16 @@ public:
     { return _librarySearchPaths; }
 
 public:
+    /*
+     * Resolve the search paths for an environment. Recursive search paths
+     * are expanded through the cache, if one is provided.
+     */
     static Tool::SearchPaths
-    Create(pbxsetting::Environment const &environment, std::string const &workingDirectory);
+    Create(pbxsetting::Environment const &environment, std::string const &workingDirectory, Tool::SearchPathsCache *searchPathsCache = nullptr);
 
 public:
     static std::vector<std::string>
-    ExpandRecursive(std::vector<std::string> const &paths, pbxsetting::Environment const &environment, std::string const &workingDirectory);
+    ExpandRecursive(std::vector<std::string> const &paths, pbxsetting::Environment const &environment, std::string const &workingDirectory, Tool::SearchPathsCache *searchPathsCache = nullptr);
 };
 
 }
@@ -0,0 +1,66 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __pbxbuild_Tool_SearchPathsCache_h
+#define __pbxbuild_Tool_SearchPathsCache_h
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libutil { class Filesystem; }
+
+namespace pbxbuild {
+namespace Tool {
+
+/*
+ * Subdirectories found expanding recursive search paths, shared by all
+ * targets in a build. Each root is only walked once for each set of
+ * included and excluded subdirectory patterns. Safe to use from multiple
+ * threads.
+ */
+class SearchPathsCache {
+private:
+    std::mutex                                                                _mutex;
+    std::unordered_map<std::string, std::shared_ptr<std::vector<std::string>>> _subdirectories;
+
+public:
+    SearchPathsCache();
+    ~SearchPathsCache();
+
+public:
+    /*
+     * The subdirectories under a root, relative to it, parents first.
+     * Subdirectories matching an excluded pattern are skipped along with
+     * their contents, unless they also match an included pattern.
+     */
+    std::shared_ptr<std::vector<std::string> const>
+    subdirectories(
+        libutil::Filesystem const *filesystem,
+        std::string const &root,
+        std::vector<std::string> const &excluded,
+        std::vector<std::string> const &included);
+
+public:
+    /*
+     * Find the subdirectories under a root without caching.
+     */
+    static std::vector<std::string>
+    FindSubdirectories(
+        libutil::Filesystem const *filesystem,
+        std::string const &root,
+        std::vector<std::string> const &excluded,
+        std::vector<std::string> const &included);
+};
+
+}
+}
+
+#endif // !__pbxbuild_Tool_SearchPathsCache_h
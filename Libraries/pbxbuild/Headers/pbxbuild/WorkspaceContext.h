@@ -118,16 +118,17 @@ public:
 
 public:
     /*
-     * Creates a workspace context from a real workspace.
+     * Creates a workspace context from a real workspace. Projects are
+     * loaded through the project cache, if provided.
      */
     static WorkspaceContext
-    Workspace(libutil::Filesystem const *filesystem, std::string const &userName, pbxsetting::Environment const &baseEnvironment, xcworkspace::XC::Workspace::shared_ptr const &workspace);
+    Workspace(libutil::Filesystem const *filesystem, std::string const &userName, pbxsetting::Environment const &baseEnvironment, xcworkspace::XC::Workspace::shared_ptr const &workspace, pbxproj::ProjectCache *projectCache = nullptr);
 
     /*
      * Creates a workspace context for a legacy project-only build.
      */
     static WorkspaceContext
-    Project(libutil::Filesystem const *filesystem, std::string const &userName, pbxsetting::Environment const &baseEnvironment, pbxproj::PBX::Project::shared_ptr const &project);
+    Project(libutil::Filesystem const *filesystem, std::string const &userName, pbxsetting::Environment const &baseEnvironment, pbxproj::PBX::Project::shared_ptr const &project, pbxproj::ProjectCache *projectCache = nullptr);
 };
 
 }
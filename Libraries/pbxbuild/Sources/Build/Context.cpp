@@ -29,7 +29,9 @@ Context(
     _configuration       (configuration),
     _defaultConfiguration(defaultConfiguration),
     _overrideLevels      (overrideLevels),
-    _targetEnvironments  (std::make_shared<std::unordered_map<pbxproj::PBX::Target::shared_ptr, Target::Environment>>())
+    _targetEnvironments  (std::make_shared<std::unordered_map<pbxproj::PBX::Target::shared_ptr, Target::Environment>>()),
+    _searchPathsCache    (std::make_shared<pbxbuild::Tool::SearchPathsCache>()),
+    _headermapCache      (std::make_shared<pbxbuild::Tool::HeadermapCache>())
 {
 }
 
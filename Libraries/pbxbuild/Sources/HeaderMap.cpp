@@ -10,7 +10,6 @@
 
 #include <algorithm>
 #include <iterator>
-#include <map>
 #include <cstring>
 
 using pbxbuild::HeaderMap;
@@ -193,6 +192,61 @@ add(std::string const &key, std::string const &prefix, std::string const &suffix
     return true;
 }
 
+size_t HeaderMap::
+add(std::vector<Entry> const &entries)
+{
+    reserve(_header.NumEntries + entries.size());
+
+    size_t added = 0;
+    for (Entry const &entry : entries) {
+        if (add(entry.key, entry.prefix, entry.suffix)) {
+            added++;
+        }
+    }
+    return added;
+}
+
+void HeaderMap::
+reserve(size_t count)
+{
+    //
+    // Keep the same load factor as grow(), and a power of two.
+    //
+    uint32_t numBuckets = _header.NumBuckets;
+    while (count + 1 >= (numBuckets * 3) / 4) {
+        numBuckets <<= 1;
+    }
+
+    if (numBuckets != _header.NumBuckets) {
+        rehash(numBuckets);
+    }
+}
+
+bool HeaderMap::
+find(std::string const &key, std::string *prefix, std::string *suffix) const
+{
+    if (_header.NumBuckets == 0) {
+        return false;
+    }
+
+    std::string canonical = CanonicalizeKey(key);
+    unsigned hash = HashHMapKey(key) % _header.NumBuckets;
+    for (size_t n = 0; n < _header.NumBuckets; n++) {
+        HMapBucket const &bucket = _buckets[(hash + n) % _header.NumBuckets];
+        if (bucket.Key == HMAP_EmptyBucketKey) {
+            return false;
+        }
+
+        if (CanonicalizeKey(&_strings[bucket.Key]) == canonical) {
+            *prefix = &_strings[bucket.Prefix];
+            *suffix = &_strings[bucket.Suffix];
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void HeaderMap::
 grow()
 {
@@ -215,22 +269,20 @@ rehash(uint32_t newNumBuckets)
     buckets.resize(newNumBuckets);
     _buckets.swap(buckets);
 
-    std::multimap <uint32_t, HMapBucket *> rehashed;
+    //
+    // Set the new size first, since set() probes within it.
+    //
+    uint32_t oldNumBuckets = _header.NumBuckets;
+    _header.NumBuckets = newNumBuckets;
 
-    for (size_t n = 0; n < _header.NumBuckets; n++) {
+    for (size_t n = 0; n < oldNumBuckets; n++) {
         if (buckets[n].Key == HMAP_EmptyBucketKey)
             continue;
 
         unsigned hash = HashHMapKey(&_strings[buckets[n].Key]) % newNumBuckets;
-        rehashed.insert(std::make_pair(hash, &buckets[n]));
+        set(hash, buckets[n].Key, buckets[n].Prefix, buckets[n].Suffix, true);
     }
 
-    for (auto BI : rehashed) {
-        set(BI.first, BI.second->Key, BI.second->Prefix, BI.second->Suffix, true);
-    }
-
-    _header.NumBuckets = newNumBuckets;
-
     _modified = false;
 }
 
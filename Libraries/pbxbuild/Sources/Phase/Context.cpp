@@ -16,6 +16,8 @@
 #include <pbxbuild/Tool/InfoPlistResolver.h>
 #include <pbxbuild/Tool/InterfaceBuilderResolver.h>
 #include <pbxbuild/Tool/MakeDirectoryResolver.h>
+#include <pbxbuild/Tool/OptionsResult.h>
+#include <pbxbuild/Tool/ScriptEnvironment.h>
 #include <pbxbuild/Tool/ScriptResolver.h>
 #include <pbxbuild/Tool/SwiftResolver.h>
 #include <pbxbuild/Tool/SymlinkResolver.h>
@@ -23,13 +25,18 @@
 #include <pbxbuild/Tool/ToolResolver.h>
 #include <pbxbuild/Target/Environment.h>
 #include <pbxbuild/Target/BuildRules.h>
+#include <pbxsetting/Type.h>
+#include <libutil/CachingFilesystem.h>
+#include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/ThreadPool.h>
 
 #include <cassert>
 
 namespace Phase = pbxbuild::Phase;
 namespace Tool = pbxbuild::Tool;
 namespace Target = pbxbuild::Target;
+using libutil::Filesystem;
 using libutil::FSUtil;
 
 Phase::Context::
@@ -162,6 +169,16 @@ scriptResolver(Phase::Environment const &phaseEnvironment)
     return _scriptResolver.get();
 }
 
+Tool::ScriptEnvironment const *Phase::Context::
+scriptEnvironment(Phase::Environment const &phaseEnvironment)
+{
+    if (_scriptEnvironment == nullptr) {
+        _scriptEnvironment = std::unique_ptr<Tool::ScriptEnvironment>(new Tool::ScriptEnvironment(phaseEnvironment.targetEnvironment().environment()));
+    }
+
+    return _scriptEnvironment.get();
+}
+
 Tool::SwiftResolver const *Phase::Context::
 swiftResolver(Phase::Environment const &phaseEnvironment)
 {
@@ -201,6 +218,26 @@ touchResolver(Phase::Environment const &phaseEnvironment)
     return _touchResolver.get();
 }
 
+Filesystem const *Phase::Context::
+filesystem()
+{
+    if (_filesystem == nullptr) {
+        _filesystem = std::unique_ptr<libutil::CachingFilesystem>(new libutil::CachingFilesystem(Filesystem::GetDefaultUNSAFE()));
+    }
+
+    return _filesystem.get();
+}
+
+libutil::ThreadPool *Phase::Context::
+threadPool()
+{
+    if (_threadPool == nullptr) {
+        _threadPool = std::unique_ptr<libutil::ThreadPool>(new libutil::ThreadPool());
+    }
+
+    return _threadPool.get();
+}
+
 Tool::ToolResolver const *Phase::Context::
 toolResolver(Phase::Environment const &phaseEnvironment, std::string const &identifier)
 {
@@ -331,6 +368,50 @@ Group(std::vector<Tool::Input> const &files)
     return result;
 }
 
+/*
+ * Determine the tool to use for a group of build files, based on the
+ * build rule of the first file. Empty if there is no applicable tool.
+ */
+static std::string
+BuildRuleToolIdentifier(Tool::Input const &first, std::string const &fallbackToolIdentifier)
+{
+    std::string toolIdentifier = fallbackToolIdentifier;
+
+    Target::BuildRules::BuildRule::shared_ptr const &buildRule = first.buildRule();
+    if (buildRule != nullptr) {
+        if (pbxspec::PBX::Tool::shared_ptr const &tool = buildRule->tool()) {
+            /*
+             * Some tools additionally limit their file types beyond what their build rule allows.
+             * For example, the default compiler limits itself to just source files, despite its
+             * default build rule specifying that it accepts all C-family inputs, including headers.
+             */
+            // TODO(grp): Is this the right way to make .h files not get compiled as resources?
+            if (tool->fileTypes() || tool->inputFileTypes()) {
+                if (first.fileType() != nullptr) {
+                    std::vector<std::string> toolFileTypes;
+                    if (tool->fileTypes()) {
+                        toolFileTypes.insert(toolFileTypes.end(), tool->fileTypes()->begin(), tool->fileTypes()->end());
+                    }
+                    if (tool->inputFileTypes()) {
+                        toolFileTypes.insert(toolFileTypes.end(), tool->inputFileTypes()->begin(), tool->inputFileTypes()->end());
+                    }
+
+                    std::string inputFileType = first.fileType()->identifier();
+                    bool toolAcceptsInputFileType = (toolFileTypes.empty() || std::find(toolFileTypes.begin(), toolFileTypes.end(), inputFileType) != toolFileTypes.end());
+
+                    if (toolAcceptsInputFileType) {
+                        toolIdentifier = tool->identifier();
+                    }
+                }
+            } else {
+                toolIdentifier = tool->identifier();
+            }
+        }
+    }
+
+    return toolIdentifier;
+}
+
 bool Phase::Context::
 resolveBuildFiles(
     Phase::Environment const &phaseEnvironment,
@@ -340,7 +421,59 @@ resolveBuildFiles(
     std::string const &outputDirectory,
     std::string const &fallbackToolIdentifier)
 {
-    for (std::vector<Tool::Input> const &files : groups) {
+    /*
+     * Compiling sources is most of the work here, and each source is
+     * independent. Prepare those compilations across the thread pool first,
+     * then merge them into the tool context in order with the other files.
+     */
+    std::vector<ext::optional<Tool::ClangResolver::PreparedSource>> preparedSources(groups.size());
+
+    std::vector<size_t> sourceGroups;
+    for (size_t i = 0; i < groups.size(); ++i) {
+        Tool::Input const &first = groups[i].front();
+        Target::BuildRules::BuildRule::shared_ptr const &buildRule = first.buildRule();
+        if (buildRule != nullptr && buildRule->script().empty() && BuildRuleToolIdentifier(first, fallbackToolIdentifier) == Tool::ClangResolver::ToolIdentifier()) {
+            sourceGroups.push_back(i);
+        }
+    }
+
+    if (sourceGroups.size() > 1) {
+        if (Tool::ClangResolver const *clangResolver = this->clangResolver(phaseEnvironment)) {
+            /* Most options are the same for every source; only evaluate those once. */
+            Tool::OptionsCache optionsCache;
+
+            threadPool()->apply(sourceGroups.size(), [&](size_t index) {
+                size_t group = sourceGroups[index];
+                Tool::Input const &first = groups[group].front();
+
+                std::string fileOutputDirectory = outputDirectory;
+                if (first.localization()) {
+                    fileOutputDirectory += "/" + *first.localization() + ".lproj";
+                }
+
+                preparedSources[group] = clangResolver->prepareSource(_toolContext, environment, first, fileOutputDirectory, &optionsCache);
+            });
+        }
+    }
+
+    /* Scripts for build rules share the build settings for this environment. */
+    std::unique_ptr<Tool::ScriptEnvironment> scriptEnvironment;
+
+    /*
+     * Copies can be batched. Batches are files of the same type copied to the
+     * same directory, so the options for every file in a batch are the same.
+     */
+    int64_t copyBatchSize = pbxsetting::Type::ParseInteger(environment.resolve("PBXCP_BATCH_SIZE"));
+    struct CopyBatch {
+        std::string              outputDirectory;
+        std::string              logMessageTitle;
+        std::vector<Tool::Input> inputs;
+    };
+    std::vector<CopyBatch> copyBatches;
+    std::unordered_map<std::string, size_t> copyBatchIndexes;
+
+    for (size_t i = 0; i < groups.size(); ++i) {
+        std::vector<Tool::Input> const &files = groups[i];
         assert(!files.empty());
         Tool::Input const &first = files.front();
 
@@ -359,43 +492,15 @@ resolveBuildFiles(
         if (buildRule != nullptr && !buildRule->script().empty()) {
             if (Tool::ScriptResolver const *scriptResolver = this->scriptResolver(phaseEnvironment)) {
                 assert(files.size() == 1); // TODO(grp): Is this a valid assertion?
-                scriptResolver->resolve(&_toolContext, environment, first);
+                if (scriptEnvironment == nullptr) {
+                    scriptEnvironment = std::unique_ptr<Tool::ScriptEnvironment>(new Tool::ScriptEnvironment(environment));
+                }
+                scriptResolver->resolve(&_toolContext, environment, *scriptEnvironment, first);
             } else {
                 return false;
             }
         } else {
-            std::string toolIdentifier = fallbackToolIdentifier;
-
-            if (buildRule != nullptr) {
-                if (pbxspec::PBX::Tool::shared_ptr const &tool = buildRule->tool()) {
-                    /*
-                     * Some tools additionally limit their file types beyond what their build rule allows.
-                     * For example, the default compiler limits itself to just source files, despite its
-                     * default build rule specifying that it accepts all C-family inputs, including headers.
-                     */
-                    // TODO(grp): Is this the right way to make .h files not get compiled as resources?
-                    if (tool->fileTypes() || tool->inputFileTypes()) {
-                        if (first.fileType() != nullptr) {
-                            std::vector<std::string> toolFileTypes;
-                            if (tool->fileTypes()) {
-                                toolFileTypes.insert(toolFileTypes.end(), tool->fileTypes()->begin(), tool->fileTypes()->end());
-                            }
-                            if (tool->inputFileTypes()) {
-                                toolFileTypes.insert(toolFileTypes.end(), tool->inputFileTypes()->begin(), tool->inputFileTypes()->end());
-                            }
-
-                            std::string inputFileType = first.fileType()->identifier();
-                            bool toolAcceptsInputFileType = (toolFileTypes.empty() || std::find(toolFileTypes.begin(), toolFileTypes.end(), inputFileType) != toolFileTypes.end());
-
-                            if (toolAcceptsInputFileType) {
-                                toolIdentifier = tool->identifier();
-                            }
-                        }
-                    } else {
-                        toolIdentifier = tool->identifier();
-                    }
-                }
-            }
+            std::string toolIdentifier = BuildRuleToolIdentifier(first, fallbackToolIdentifier);
 
             if (toolIdentifier.empty()) {
                 fprintf(stderr, "warning: no tool available for build rule\n");
@@ -411,7 +516,11 @@ resolveBuildFiles(
             } else if (toolIdentifier == Tool::ClangResolver::ToolIdentifier()) {
                 if (Tool::ClangResolver const *clangResolver = this->clangResolver(phaseEnvironment)) {
                     assert(files.size() == 1); // TODO(grp): Is this a valid assertion?
-                    clangResolver->resolveSource(&_toolContext, environment, first, fileOutputDirectory);
+                    if (preparedSources[i]) {
+                        clangResolver->mergeSource(&_toolContext, environment, *preparedSources[i]);
+                    } else {
+                        clangResolver->resolveSource(&_toolContext, environment, first, fileOutputDirectory);
+                    }
                 } else {
                     return false;
                 }
@@ -427,7 +536,21 @@ resolveBuildFiles(
                 }
 
                 if (Tool::CopyResolver const *copyResolver = this->copyResolver(phaseEnvironment)) {
-                    copyResolver->resolve(&_toolContext, environment, files, fileOutputDirectory, logMessageTitle);
+                    if (copyBatchSize > 1) {
+                        std::string fileTypeIdentifier = (first.fileType() != nullptr ? first.fileType()->identifier() : std::string());
+                        std::string key = fileOutputDirectory + '\0' + fileTypeIdentifier + '\0' + logMessageTitle;
+
+                        auto it = copyBatchIndexes.find(key);
+                        if (it == copyBatchIndexes.end()) {
+                            it = copyBatchIndexes.insert({ key, copyBatches.size() }).first;
+                            copyBatches.push_back({ fileOutputDirectory, logMessageTitle, { } });
+                        }
+
+                        std::vector<Tool::Input> *batchInputs = &copyBatches[it->second].inputs;
+                        batchInputs->insert(batchInputs->end(), files.begin(), files.end());
+                    } else {
+                        copyResolver->resolve(&_toolContext, environment, files, fileOutputDirectory, logMessageTitle);
+                    }
                 } else {
                     return false;
                 }
@@ -459,6 +582,16 @@ resolveBuildFiles(
         }
     }
 
+    if (!copyBatches.empty()) {
+        if (Tool::CopyResolver const *copyResolver = this->copyResolver(phaseEnvironment)) {
+            for (CopyBatch const &copyBatch : copyBatches) {
+                copyResolver->resolveBatched(&_toolContext, environment, copyBatch.inputs, copyBatch.outputDirectory, copyBatch.logMessageTitle, static_cast<size_t>(copyBatchSize));
+            }
+        } else {
+            return false;
+        }
+    }
+
     return true;
 }
 
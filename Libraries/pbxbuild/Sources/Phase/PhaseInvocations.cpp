@@ -48,12 +48,14 @@ Create(Phase::Environment const &phaseEnvironment, pbxproj::PBX::Target::shared_
     /* Create the tool context for building. */
     Tool::SearchPaths searchPaths = Tool::SearchPaths::Create(
         targetEnvironment.environment(),
-        targetEnvironment.workingDirectory());
+        targetEnvironment.workingDirectory(),
+        phaseEnvironment.buildContext().searchPathsCache());
     Tool::Context toolContext = Tool::Context(
         targetEnvironment.sdk(),
         targetEnvironment.toolchains(),
         targetEnvironment.workingDirectory(),
-        searchPaths);
+        searchPaths,
+        phaseEnvironment.buildContext().searchPathsCache());
 
     Phase::Context phaseContext(toolContext);
 
@@ -35,6 +35,6 @@ resolve(Phase::Environment const &phaseEnvironment, Phase::Context *phaseContext
 
     pbxsetting::Environment const &environment = phaseEnvironment.targetEnvironment().environment();
 
-    scriptResolver->resolve(&phaseContext->toolContext(), environment, _buildPhase);
+    scriptResolver->resolve(&phaseContext->toolContext(), environment, *phaseContext->scriptEnvironment(phaseEnvironment), _buildPhase);
     return true;
 }
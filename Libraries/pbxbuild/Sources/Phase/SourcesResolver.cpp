@@ -119,7 +119,7 @@ resolve(Phase::Environment const &phaseEnvironment, Phase::Context *phaseContext
     }
 
     /* Populate the tool context with what's needed for compilation. */
-    headermapResolver->resolve(&phaseContext->toolContext(), targetEnvironment.environment(), phaseEnvironment.target());
+    headermapResolver->resolve(phaseContext->filesystem(), &phaseContext->toolContext(), targetEnvironment.environment(), phaseEnvironment.target(), phaseEnvironment.buildContext().headermapCache());
 
     /*
      * Module maps need to be generated.
@@ -129,7 +129,7 @@ resolve(Phase::Environment const &phaseEnvironment, Phase::Context *phaseContext
         fprintf(stderr, "error: unable to resolve module map\n");
     }
 
-    std::vector<Tool::Input> files = Phase::File::ResolveBuildFiles(Filesystem::GetDefaultUNSAFE(), phaseEnvironment, targetEnvironment.environment(), _buildPhase->files());
+    std::vector<Tool::Input> files = Phase::File::ResolveBuildFiles(phaseContext->filesystem(), phaseEnvironment, targetEnvironment.environment(), _buildPhase->files());
 
     /*
      * Split files based on whether their tool is architecture-neutral.
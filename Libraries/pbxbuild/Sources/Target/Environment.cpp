@@ -292,6 +292,12 @@ ExecutablePathsLevel(std::vector<std::string> const &executablePaths)
 ext::optional<Target::Environment> Target::Environment::
 Create(Build::Environment const &buildEnvironment, Build::Context const &buildContext, pbxproj::PBX::Target::shared_ptr const &target)
 {
+    /* Build phases are parsed on first use; a target with an invalid phase can't be built. */
+    if (!target->loadBuildPhases()) {
+        fprintf(stderr, "error: unable to load build phases for target %s\n", target->name().c_str());
+        return ext::nullopt;
+    }
+
     /* Use the source root, which could have been modified by project options, rather than the raw project path. */
     std::string workingDirectory = target->project()->sourceRoot();
 
@@ -65,7 +65,7 @@ resolve(
      * Resolve the tool options.
      */
     Tool::Environment toolEnvironment = Tool::Environment::Create(_tool, assetCatalogEnvironment, toolContext->workingDirectory(), std::vector<Tool::Input>());
-    Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext->workingDirectory(), nullptr);
+    Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext->workingDirectory(), nullptr, toolContext->searchPathsCache());
     Tool::Tokens::ToolExpansions tokens = Tool::Tokens::ExpandTool(toolEnvironment, options);
 
     pbxsetting::Environment const &environment = toolEnvironment.environment();
@@ -88,7 +88,11 @@ resolve(
     arguments.insert(arguments.end(), deploymentTargetArguments.begin(), deploymentTargetArguments.end());
 
     // TODO(grp): This is a hack to work around missing `Condition` support in options.
-    arguments.erase(std::remove(arguments.begin(), arguments.end(), "--optimization"), arguments.end());
+    // Only an empty optimization is dropped; `time` and `space` are passed through.
+    auto optimization = std::find(arguments.begin(), arguments.end(), "--optimization");
+    if (optimization != arguments.end() && (optimization + 1 == arguments.end() || (optimization + 1)->empty())) {
+        arguments.erase(optimization);
+    }
     arguments.erase(std::remove(arguments.begin(), arguments.end(), ""), arguments.end());
 
     // TODO(grp): This should be handled generically for all tools.
@@ -157,7 +157,7 @@ resolvePrecompiledHeader(
     pbxspec::PBX::Tool::shared_ptr tool = std::static_pointer_cast <pbxspec::PBX::Tool> (_compiler);
     Tool::Environment toolEnvironment = Tool::Environment::Create(tool, environment, toolContext->workingDirectory(), { input }, { output });
     pbxsetting::Environment const &env = toolEnvironment.environment();
-    Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext->workingDirectory(), input.fileType());
+    Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext->workingDirectory(), input.fileType(), toolContext->searchPathsCache());
     Tool::Tokens::ToolExpansions tokens = Tool::Tokens::ExpandTool(toolEnvironment, options);
 
     std::vector<std::string> arguments = precompiledHeaderInfo.arguments();
@@ -194,14 +194,33 @@ resolvePrecompiledHeader(
     toolContext->auxiliaryFiles().push_back(serializedFile);
 }
 
-void Tool::ClangResolver::
-resolveSource(
-    Tool::Context *toolContext,
+Tool::ClangResolver::PreparedSource::
+PreparedSource(
+    Tool::Invocation const &invocation,
+    std::shared_ptr<Tool::PrecompiledHeaderInfo> const &precompiledHeaderInfo,
+    bool isCPlusPlus,
+    std::vector<std::string> const &linkerArgs) :
+    _invocation           (invocation),
+    _precompiledHeaderInfo(precompiledHeaderInfo),
+    _isCPlusPlus          (isCPlusPlus),
+    _linkerArgs           (linkerArgs)
+{
+}
+
+Tool::ClangResolver::PreparedSource::
+~PreparedSource()
+{
+}
+
+Tool::ClangResolver::PreparedSource Tool::ClangResolver::
+prepareSource(
+    Tool::Context const &toolContext,
     pbxsetting::Environment const &environment,
     Tool::Input const &input,
-    std::string const &outputDirectory) const
+    std::string const &outputDirectory,
+    Tool::OptionsCache *optionsCache) const
 {
-    Tool::HeadermapInfo const &headermapInfo = toolContext->headermapInfo();
+    Tool::HeadermapInfo const &headermapInfo = toolContext.headermapInfo();
 
     std::string resolvedOutputDirectory;
     if (_compiler->outputDir()) {
@@ -222,10 +241,12 @@ resolveSource(
     std::vector<std::string> inputArguments = input.compilerFlags().value_or(std::vector<std::string>());
 
     pbxspec::PBX::Tool::shared_ptr tool = std::static_pointer_cast <pbxspec::PBX::Tool> (_compiler);
-    Tool::Environment toolEnvironment = Tool::Environment::Create(tool, environment, toolContext->workingDirectory(), { input }, { output });
+    Tool::Environment toolEnvironment = Tool::Environment::Create(tool, environment, toolContext.workingDirectory(), { input }, { output });
     pbxsetting::Environment const &env = toolEnvironment.environment();
 
-    Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext->workingDirectory(), input.fileType());
+    Tool::OptionsResult options = (optionsCache != nullptr ?
+        optionsCache->create(toolEnvironment, toolContext.workingDirectory(), input.fileType(), toolContext.searchPathsCache()) :
+        Tool::OptionsResult::Create(toolEnvironment, toolContext.workingDirectory(), input.fileType(), toolContext.searchPathsCache()));
     Tool::Tokens::ToolExpansions tokens = Tool::Tokens::ExpandTool(toolEnvironment, options);
 
     std::vector<std::string> inputDependencies;
@@ -237,8 +258,8 @@ resolveSource(
     size_t dialectOffset = arguments.size();
 
     arguments.insert(arguments.end(), tokens.arguments().begin(), tokens.arguments().end());
-    Tool::CompilerCommon::AppendIncludePathFlags(&arguments, env, toolContext->searchPaths(), headermapInfo);
-    AppendFrameworkPathFlags(&arguments, env, toolContext->searchPaths());
+    Tool::CompilerCommon::AppendIncludePathFlags(&arguments, env, toolContext.searchPaths(), headermapInfo);
+    AppendFrameworkPathFlags(&arguments, env, toolContext.searchPaths());
     AppendCustomFlags(&arguments, env, dialect);
 
     bool precompilePrefixHeader = pbxsetting::Type::ParseBoolean(env.resolve("GCC_PRECOMPILE_PREFIX_HEADER"));
@@ -246,7 +267,7 @@ resolveSource(
     std::shared_ptr<Tool::PrecompiledHeaderInfo> precompiledHeaderInfo = nullptr;
 
     if (!prefixHeader.empty()) {
-        std::string prefixHeaderFile = FSUtil::ResolveRelativePath(prefixHeader, toolContext->workingDirectory());
+        std::string prefixHeaderFile = FSUtil::ResolveRelativePath(prefixHeader, toolContext.workingDirectory());
 
         if (precompilePrefixHeader) {
             std::vector<std::string> precompiledHeaderArguments;
@@ -270,7 +291,7 @@ resolveSource(
     AppendDependencyInfoFlags(&arguments, _compiler, env);
     AppendInputOutputFlags(&arguments, _compiler, input.path(), output);
 
-    std::string logMessage = CompileLogMessage(_compiler, "CompileC", input.path(), dialect, output, env, toolContext->workingDirectory());
+    std::string logMessage = CompileLogMessage(_compiler, "CompileC", input.path(), dialect, output, env, toolContext.workingDirectory());
 
     std::vector<Tool::Invocation::DependencyInfo> dependencyInfo;
     if (_compiler->dependencyInfoFile()) {
@@ -283,16 +304,28 @@ resolveSource(
     invocation.executable() = Tool::Invocation::Executable::Determine(tokens.executable());
     invocation.arguments() = arguments;
     invocation.environment() = options.environment();
-    invocation.workingDirectory() = toolContext->workingDirectory();
-    invocation.inputs() = toolEnvironment.inputs(toolContext->workingDirectory());
-    invocation.outputs() = toolEnvironment.outputs(toolContext->workingDirectory());
+    invocation.workingDirectory() = toolContext.workingDirectory();
+    invocation.inputs() = toolEnvironment.inputs(toolContext.workingDirectory());
+    invocation.outputs() = toolEnvironment.outputs(toolContext.workingDirectory());
     invocation.inputDependencies() = inputDependencies;
     invocation.dependencyInfo() = dependencyInfo;
     invocation.logMessage() = logMessage;
-    invocation.priority() = toolContext->currentPhaseInvocationPriority();
+    invocation.priority() = toolContext.currentPhaseInvocationPriority();
     // Wait for swift artifacts to be available before running this invocation
     invocation.waitForSwiftArtifacts() = true;
 
+    return PreparedSource(invocation, precompiledHeaderInfo, DialectIsCPlusPlus(dialect), options.linkerArgs());
+}
+
+void Tool::ClangResolver::
+mergeSource(
+    Tool::Context *toolContext,
+    pbxsetting::Environment const &environment,
+    PreparedSource const &preparedSource) const
+{
+    Tool::Invocation const &invocation = preparedSource.invocation();
+    std::shared_ptr<Tool::PrecompiledHeaderInfo> const &precompiledHeaderInfo = preparedSource.precompiledHeaderInfo();
+
     /* Add the compilation invocation to the context. */
     toolContext->invocations().push_back(invocation);
     auto variantArchitectureKey = std::make_pair(environment.resolve("variant"), environment.resolve("arch"));
@@ -317,7 +350,7 @@ resolveSource(
         }
     }
 
-    if (DialectIsCPlusPlus(dialect) && _compiler->execCPlusPlusLinkerPath()) {
+    if (preparedSource.isCPlusPlus() && _compiler->execCPlusPlusLinkerPath()) {
         /* If a single C++ file is seen, use the C++ linker driver. */
         compilationInfo->linkerDriver() = *_compiler->execCPlusPlusLinkerPath();
     } else if (compilationInfo->linkerDriver().empty() && _compiler->execPath()) {
@@ -325,7 +358,7 @@ resolveSource(
         compilationInfo->linkerDriver() = _compiler->execPath()->raw();
     }
 
-    for (std::string const &linkerArg : options.linkerArgs()) {
+    for (std::string const &linkerArg : preparedSource.linkerArgs()) {
         std::vector<std::string> *linkerArguments = &compilationInfo->linkerArguments();
 
         /* Avoid duplicating arguments for multiple compiler invocations. */
@@ -335,6 +368,16 @@ resolveSource(
     }
 }
 
+void Tool::ClangResolver::
+resolveSource(
+    Tool::Context *toolContext,
+    pbxsetting::Environment const &environment,
+    Tool::Input const &input,
+    std::string const &outputDirectory) const
+{
+    mergeSource(toolContext, environment, prepareSource(*toolContext, environment, input, outputDirectory));
+}
+
 std::unique_ptr<Tool::ClangResolver> Tool::ClangResolver::
 Create(pbxspec::Manager::shared_ptr const &specManager, std::vector<std::string> const &specDomains, std::string const &compilerIdentifier)
 {
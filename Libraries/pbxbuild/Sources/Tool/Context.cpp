@@ -15,11 +15,13 @@ Context(
     xcsdk::SDK::Target::shared_ptr const &sdk,
     std::vector<xcsdk::SDK::Toolchain::shared_ptr> const &toolchains,
     std::string const &workingDirectory,
-    Tool::SearchPaths const &searchPaths) :
+    Tool::SearchPaths const &searchPaths,
+    Tool::SearchPathsCache *searchPathsCache) :
     _sdk                            (sdk),
     _toolchains                     (toolchains),
     _workingDirectory               (workingDirectory),
     _searchPaths                    (searchPaths),
+    _searchPathsCache               (searchPathsCache),
     _currentPhaseInvocationPriority (0)
 {
 }
@@ -13,9 +13,12 @@
 #include <pbxbuild/Tool/Context.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/md5.h>
 
 #include <algorithm>
+#include <iomanip>
 #include <iterator>
+#include <sstream>
 
 namespace Tool = pbxbuild::Tool;
 using libutil::Filesystem;
@@ -34,6 +37,77 @@ resolve(
     std::vector<Tool::Input> const &inputs,
     std::string const &outputDirectory,
     std::string const &logMessageTitle) const
+{
+    resolve(toolContext, baseEnvironment, inputs, outputDirectory, logMessageTitle, ext::nullopt);
+}
+
+/*
+ * Name a batch by what it copies, so the name doesn't change when other
+ * copies are added to or removed from the target.
+ */
+static std::string
+BatchName(std::vector<Tool::Input> const &inputs, std::string const &outputDirectory)
+{
+    std::vector<std::string> paths;
+    for (Tool::Input const &input : inputs) {
+        paths.push_back(input.path());
+    }
+    std::sort(paths.begin(), paths.end());
+
+    md5_state_t state;
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<md5_byte_t const *>(outputDirectory.c_str()), outputDirectory.size() + 1);
+    for (std::string const &path : paths) {
+        md5_append(&state, reinterpret_cast<md5_byte_t const *>(path.c_str()), path.size() + 1);
+    }
+
+    uint8_t digest[16];
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&digest));
+
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (uint8_t c : digest) {
+        ss << std::setw(2) << static_cast<int>(c);
+    }
+    return ss.str();
+}
+
+void Tool::CopyResolver::
+resolveBatched(
+    Tool::Context *toolContext,
+    pbxsetting::Environment const &environment,
+    std::vector<Tool::Input> const &inputs,
+    std::string const &outputDirectory,
+    std::string const &logMessageTitle,
+    size_t batchSize) const
+{
+    if (batchSize == 0) {
+        batchSize = 1;
+    }
+
+    for (size_t offset = 0; offset < inputs.size(); offset += batchSize) {
+        auto begin = inputs.begin() + offset;
+        auto end = inputs.begin() + std::min(offset + batchSize, inputs.size());
+        std::vector<Tool::Input> batch = std::vector<Tool::Input>(begin, end);
+
+        if (batch.size() == 1) {
+            /* The build system already skips a single unchanged file. */
+            resolve(toolContext, environment, batch, outputDirectory, logMessageTitle, ext::nullopt);
+        } else {
+            std::string stampFile = environment.resolve("TARGET_TEMP_DIR") + "/CopyStamps/Copy-" + BatchName(batch, outputDirectory) + ".stamps";
+            resolve(toolContext, environment, batch, outputDirectory, logMessageTitle, stampFile);
+        }
+    }
+}
+
+void Tool::CopyResolver::
+resolve(
+    Tool::Context *toolContext,
+    pbxsetting::Environment const &baseEnvironment,
+    std::vector<Tool::Input> const &inputs,
+    std::string const &outputDirectory,
+    std::string const &logMessageTitle,
+    ext::optional<std::string> const &stampFile) const
 {
     /*
      * Add the copy-specific build settings.
@@ -60,6 +134,10 @@ resolve(
      * Build the arguments: each input file, then the output directory.
      */
     std::vector<std::string> args;
+    if (stampFile) {
+        args.push_back("-stamp-file");
+        args.push_back(*stampFile);
+    }
     for (Tool::Input const &input : inputs) {
         args.push_back(input.path());
     }
@@ -69,7 +147,7 @@ resolve(
      * Resolve the tool options. Inputs can either be full build files or just paths.
      */
     Tool::Environment toolEnvironment = Tool::Environment::Create(_tool, environment, toolContext->workingDirectory(), inputs, outputPaths);
-    Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext->workingDirectory(), nullptr);
+    Tool::OptionsResult options = Tool::OptionsResult::Create(toolEnvironment, toolContext->workingDirectory(), nullptr, toolContext->searchPathsCache());
     Tool::Tokens::ToolExpansions tokens = Tool::Tokens::ExpandTool(toolEnvironment, options, std::string(), args);
 
     // TODO(grp): This should be generic for all tools.
@@ -92,6 +170,10 @@ resolve(
     invocation.workingDirectory() = toolContext->workingDirectory();
     invocation.inputs() = toolEnvironment.inputs(toolContext->workingDirectory());
     invocation.outputs() = toolEnvironment.outputs(toolContext->workingDirectory());
+    if (stampFile) {
+        /* An output so the build system tracks and cleans it. */
+        invocation.outputs().push_back(*stampFile);
+    }
     invocation.dependencyInfo() = dependencyInfo;
     invocation.logMessage() = tokens.logMessage();
     invocation.priority() = toolContext->currentPhaseInvocationPriority();
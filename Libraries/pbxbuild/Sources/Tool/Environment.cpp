@@ -80,6 +80,34 @@ OutputLevel(std::string const &output)
     });
 }
 
+std::unordered_set<std::string> const &Tool::Environment::
+InputOutputSettings()
+{
+    static std::unordered_set<std::string> const *settings = new std::unordered_set<std::string>({
+        /* From InputLevel(). */
+        "Input",
+        "InputPath",
+        "InputFile",
+        "InputFileName",
+        "InputFileBase",
+        "InputFileSuffix",
+        "InputFileRelativePath",
+        "InputFileBaseUniquefier",
+        "InputFileTextEncoding",
+        /* From OutputLevel(). */
+        "Output",
+        "OutputPath",
+        "OutputFile",
+        "OutputDir",
+        "OutputFileName",
+        "OutputFileBase",
+        /* Vary with the localization of the input. */
+        "ProductResourcesDir",
+        "TempResourcesDir",
+    });
+    return *settings;
+}
+
 Tool::Environment Tool::Environment::
 Create(
     pbxspec::PBX::Tool::shared_ptr const &tool,
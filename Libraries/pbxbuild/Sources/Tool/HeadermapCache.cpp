@@ -0,0 +1,234 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <pbxbuild/Tool/HeadermapCache.h>
+#include <pbxbuild/FileTypeResolver.h>
+#include <pbxbuild/HeaderMap.h>
+#include <pbxsetting/Environment.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+
+#include <algorithm>
+
+namespace Tool = pbxbuild::Tool;
+using pbxbuild::HeaderMap;
+using pbxbuild::FileTypeResolver;
+using libutil::Filesystem;
+using libutil::FSUtil;
+
+/*
+ * The settings that header paths in a project are resolved against, and
+ * the headers found for each distinct set of values of those settings.
+ */
+class Tool::HeadermapCache::Project {
+public:
+    std::vector<pbxsetting::Value>                                         settings;
+    std::unordered_map<std::string, std::shared_ptr<ProjectHeaders const>> headers;
+};
+
+Tool::HeadermapCache::
+HeadermapCache()
+{
+}
+
+Tool::HeadermapCache::
+~HeadermapCache()
+{
+}
+
+static void
+AddSettings(std::vector<pbxsetting::Value> *settings, pbxsetting::Value const &value)
+{
+    /* Source trees are the only settings in a file reference's path. */
+    for (pbxsetting::Value::Entry const &entry : value.entries()) {
+        if (entry.type() == pbxsetting::Value::Entry::Type::Value) {
+            pbxsetting::Value setting = pbxsetting::Value({ entry });
+            if (std::find(settings->begin(), settings->end(), setting) == settings->end()) {
+                settings->push_back(setting);
+            }
+        }
+    }
+}
+
+static bool
+IsHeader(Filesystem const *filesystem, pbxspec::Manager::shared_ptr const &specManager, pbxproj::PBX::FileReference::shared_ptr const &fileReference, std::string const &filePath)
+{
+    pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(filesystem, specManager, { pbxspec::Manager::AnyDomain() }, fileReference, filePath);
+    return (fileType != nullptr && (fileType->identifier() == "sourcecode.c.h" || fileType->identifier() == "sourcecode.cpp.h"));
+}
+
+static std::shared_ptr<Tool::HeadermapCache::ProjectHeaders const>
+CreateProjectHeaders(
+    Filesystem const *filesystem,
+    pbxspec::Manager::shared_ptr const &specManager,
+    pbxsetting::Environment const &environment,
+    pbxproj::PBX::Project::shared_ptr const &project)
+{
+    auto projectHeaders = std::make_shared<Tool::HeadermapCache::ProjectHeaders>();
+
+    for (pbxproj::PBX::FileReference::shared_ptr const &fileReference : project->fileReferences()) {
+        std::string filePath = environment.expand(fileReference->resolve());
+        if (!IsHeader(filesystem, specManager, fileReference, filePath)) {
+            continue;
+        }
+
+        Tool::HeadermapCache::Header header;
+        header.fileName       = FSUtil::GetBaseName(filePath);
+        header.directory      = FSUtil::GetDirectoryName(filePath) + "/";
+        header.isPublic       = false;
+        header.isPrivate      = false;
+        header.isNonFramework = false;
+        projectHeaders->projectHeaders.push_back(header);
+    }
+
+    for (pbxproj::PBX::Target::shared_ptr const &projectTarget : project->targets()) {
+        // TODO(grp): This is a little messy. Maybe check the product type specification, or the product reference's file type?
+        bool isNonFramework = (projectTarget->type() == pbxproj::PBX::Target::Type::Native && std::static_pointer_cast<pbxproj::PBX::NativeTarget>(projectTarget)->productType().find("framework") == std::string::npos);
+
+        std::vector<Tool::HeadermapCache::Header> targetHeaders;
+        for (pbxproj::PBX::BuildPhase::shared_ptr const &buildPhase : projectTarget->buildPhases()) {
+            if (buildPhase->type() != pbxproj::PBX::BuildPhase::Type::Headers) {
+                continue;
+            }
+
+            for (pbxproj::PBX::BuildFile::shared_ptr const &buildFile : buildPhase->files()) {
+                if (buildFile->fileRef() == nullptr || buildFile->fileRef()->type() != pbxproj::PBX::GroupItem::Type::FileReference) {
+                    continue;
+                }
+
+                pbxproj::PBX::FileReference::shared_ptr const &fileReference = std::static_pointer_cast <pbxproj::PBX::FileReference> (buildFile->fileRef());
+                std::string filePath = environment.expand(fileReference->resolve());
+                if (!IsHeader(filesystem, specManager, fileReference, filePath)) {
+                    continue;
+                }
+
+                std::vector<std::string> const &attributes = buildFile->attributes();
+
+                Tool::HeadermapCache::Header header;
+                header.fileName       = FSUtil::GetBaseName(filePath);
+                header.directory      = FSUtil::GetDirectoryName(filePath) + "/";
+                header.frameworkName  = projectTarget->productName() + "/" + header.fileName;
+                header.isPublic       = std::find(attributes.begin(), attributes.end(), "Public") != attributes.end();
+                header.isPrivate      = std::find(attributes.begin(), attributes.end(), "Private") != attributes.end();
+                header.isNonFramework = isNonFramework;
+                targetHeaders.push_back(header);
+            }
+        }
+
+        projectHeaders->targetHeaders.push_back(targetHeaders);
+    }
+
+    /* These header maps don't depend on the target being built. */
+    std::vector<HeaderMap::Entry> projectEntries;
+    for (Tool::HeadermapCache::Header const &header : projectHeaders->projectHeaders) {
+        projectEntries.push_back({ header.fileName, header.directory, header.fileName });
+    }
+
+    std::vector<HeaderMap::Entry> allTargetEntries;
+    std::vector<HeaderMap::Entry> allNonFrameworkTargetEntries;
+    for (std::vector<Tool::HeadermapCache::Header> const &targetHeaders : projectHeaders->targetHeaders) {
+        for (Tool::HeadermapCache::Header const &header : targetHeaders) {
+            if (header.isPublic || header.isPrivate) {
+                allTargetEntries.push_back({ header.frameworkName, header.directory, header.fileName });
+                if (header.isNonFramework) {
+                    allNonFrameworkTargetEntries.push_back({ header.frameworkName, header.directory, header.fileName });
+                }
+            }
+        }
+    }
+
+    HeaderMap projectHeadersMap;
+    projectHeadersMap.add(projectEntries);
+    projectHeaders->projectHeadersData = projectHeadersMap.write();
+
+    HeaderMap allTargetHeadersMap;
+    allTargetHeadersMap.add(allTargetEntries);
+    projectHeaders->allTargetHeadersData = allTargetHeadersMap.write();
+
+    HeaderMap allNonFrameworkTargetHeadersMap;
+    allNonFrameworkTargetHeadersMap.add(allNonFrameworkTargetEntries);
+    projectHeaders->allNonFrameworkTargetHeadersData = allNonFrameworkTargetHeadersMap.write();
+
+    return projectHeaders;
+}
+
+std::shared_ptr<Tool::HeadermapCache::ProjectHeaders const> Tool::HeadermapCache::
+projectHeaders(
+    Filesystem const *filesystem,
+    pbxspec::Manager::shared_ptr const &specManager,
+    pbxsetting::Environment const &environment,
+    pbxproj::PBX::Project::shared_ptr const &project)
+{
+    std::shared_ptr<Project> cached;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        std::shared_ptr<Project> &entry = _projects[project];
+        if (entry == nullptr) {
+            entry = std::make_shared<Project>();
+
+            for (pbxproj::PBX::FileReference::shared_ptr const &fileReference : project->fileReferences()) {
+                AddSettings(&entry->settings, fileReference->resolve());
+            }
+            for (pbxproj::PBX::Target::shared_ptr const &projectTarget : project->targets()) {
+                for (pbxproj::PBX::BuildPhase::shared_ptr const &buildPhase : projectTarget->buildPhases()) {
+                    for (pbxproj::PBX::BuildFile::shared_ptr const &buildFile : buildPhase->files()) {
+                        if (buildFile->fileRef() != nullptr) {
+                            AddSettings(&entry->settings, buildFile->fileRef()->resolve());
+                        }
+                    }
+                }
+            }
+        }
+        cached = entry;
+    }
+
+    /* Headers resolve to the same paths if the settings they use are the same. */
+    std::string key;
+    for (pbxsetting::Value const &setting : cached->settings) {
+        key += environment.expand(setting);
+        key += '\0';
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = cached->headers.find(key);
+        if (it != cached->headers.end()) {
+            return it->second;
+        }
+    }
+
+    /* Find headers outside of the lock; if another thread did too, keep the first. */
+    std::shared_ptr<ProjectHeaders const> projectHeaders = CreateProjectHeaders(filesystem, specManager, environment, project);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    return cached->headers.insert({ key, projectHeaders }).first->second;
+}
+
+std::shared_ptr<std::vector<std::string> const> Tool::HeadermapCache::
+directoryHeaders(Filesystem const *filesystem, std::string const &path)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _directoryHeaders.find(path);
+        if (it != _directoryHeaders.end()) {
+            return it->second;
+        }
+    }
+
+    auto headers = std::make_shared<std::vector<std::string>>();
+    filesystem->readDirectory(path, false, [&](std::string const &fileName) {
+        // TODO(grp): Use FileTypeResolver when reliable.
+        std::string extension = FSUtil::GetFileExtension(fileName);
+        if (extension == "h" || extension == "hpp") {
+            headers->push_back(fileName);
+        }
+    });
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _directoryHeaders.insert({ path, headers }).first->second;
+}
@@ -8,17 +8,17 @@
 
 #include <pbxbuild/Tool/HeadermapResolver.h>
 #include <pbxbuild/Tool/HeadermapInfo.h>
+#include <pbxbuild/Tool/HeadermapCache.h>
 #include <pbxbuild/Tool/SearchPaths.h>
 #include <pbxbuild/Tool/Context.h>
-#include <pbxbuild/FileTypeResolver.h>
 #include <pbxbuild/HeaderMap.h>
+#include <pbxsetting/Environment.h>
 #include <pbxsetting/Type.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
 
 namespace Tool = pbxbuild::Tool;
 using pbxbuild::HeaderMap;
-using pbxbuild::FileTypeResolver;
 using libutil::Filesystem;
 using libutil::FSUtil;
 
@@ -72,9 +72,11 @@ HeadermapSearchPaths(pbxspec::Manager::shared_ptr const &specManager, pbxsetting
 
 void Tool::HeadermapResolver::
 resolve(
+    Filesystem const *filesystem,
     Tool::Context *toolContext,
     pbxsetting::Environment const &environment,
-    pbxproj::PBX::Target::shared_ptr const &target
+    pbxproj::PBX::Target::shared_ptr const &target,
+    Tool::HeadermapCache *headermapCache
 ) const
 {
     /* Add the compiler default environment, which contains the headermap setting defaults. */
@@ -89,12 +91,6 @@ resolve(
         // TODO(grp): Support VFS-based header maps.
     }
 
-    HeaderMap targetName;
-    HeaderMap ownTargetHeaders;
-    HeaderMap projectHeaders;
-    HeaderMap allTargetHeaders;
-    HeaderMap allNonFrameworkTargetHeaders;
-
     bool includeFlatEntriesForTargetBeingBuilt     = pbxsetting::Type::ParseBoolean(compilerEnvironment.resolve("HEADERMAP_INCLUDES_FLAT_ENTRIES_FOR_TARGET_BEING_BUILT"));
     bool includeFrameworkEntriesForAllProductTypes = pbxsetting::Type::ParseBoolean(compilerEnvironment.resolve("HEADERMAP_INCLUDES_FRAMEWORK_ENTRIES_FOR_ALL_PRODUCT_TYPES"));
     bool includeProjectHeaders                     = pbxsetting::Type::ParseBoolean(compilerEnvironment.resolve("HEADERMAP_INCLUDES_PROJECT_HEADERS"));
@@ -104,91 +100,54 @@ resolve(
 
     pbxproj::PBX::Project::shared_ptr project = target->project();
 
-    std::vector<std::string> headermapSearchPaths = HeadermapSearchPaths(_specManager, compilerEnvironment, target, toolContext->searchPaths(), toolContext->workingDirectory());
-    for (std::string const &path : headermapSearchPaths) {
-        Filesystem::GetDefaultUNSAFE()->readDirectory(path, false, [&](std::string const &fileName) -> bool {
-            // TODO(grp): Use FileTypeResolver when reliable.
-            std::string extension = FSUtil::GetFileExtension(fileName);
-            if (extension != "h" && extension != "hpp") {
-                return true;
-            }
+    /* The headers of other targets are shared; only this target's headers need to be added. */
+    std::shared_ptr<Tool::HeadermapCache::ProjectHeaders const> projectHeaders = headermapCache->projectHeaders(filesystem, _specManager, compilerEnvironment, project);
 
-            targetName.add(fileName, path + "/", fileName);
-            return true;
-        });
-    }
+    std::vector<HeaderMap::Entry> targetNameEntries;
+    std::vector<HeaderMap::Entry> ownTargetHeadersEntries;
 
-    for (pbxproj::PBX::FileReference::shared_ptr const &fileReference : project->fileReferences()) {
-        std::string filePath = compilerEnvironment.expand(fileReference->resolve());
-        pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(Filesystem::GetDefaultUNSAFE(), _specManager, { pbxspec::Manager::AnyDomain() }, fileReference, filePath);
-        if (fileType == nullptr || (fileType->identifier() != "sourcecode.c.h" && fileType->identifier() != "sourcecode.cpp.h")) {
-            continue;
+    std::vector<std::string> headermapSearchPaths = HeadermapSearchPaths(_specManager, compilerEnvironment, target, toolContext->searchPaths(), toolContext->workingDirectory());
+    for (std::string const &path : headermapSearchPaths) {
+        for (std::string const &fileName : *headermapCache->directoryHeaders(filesystem, path)) {
+            targetNameEntries.push_back({ fileName, path + "/", fileName });
         }
+    }
 
-        std::string fileName = FSUtil::GetBaseName(filePath);
-        std::string fileDirectory = FSUtil::GetDirectoryName(filePath) + "/";
-
-        projectHeaders.add(fileName, fileDirectory, fileName);
-        if (includeProjectHeaders) {
-            targetName.add(fileName, fileDirectory, fileName);
+    if (includeProjectHeaders) {
+        for (Tool::HeadermapCache::Header const &header : projectHeaders->projectHeaders) {
+            targetNameEntries.push_back({ header.fileName, header.directory, header.fileName });
         }
     }
 
-    for (pbxproj::PBX::Target::shared_ptr const &projectTarget : project->targets()) {
-       for (pbxproj::PBX::BuildPhase::shared_ptr const &buildPhase : projectTarget->buildPhases()) {
-            if (buildPhase->type() != pbxproj::PBX::BuildPhase::Type::Headers) {
-                continue;
-            }
+    for (size_t n = 0; n < project->targets().size(); n++) {
+        bool isTarget = (project->targets()[n] == target);
 
-            for (pbxproj::PBX::BuildFile::shared_ptr const &buildFile : buildPhase->files()) {
-                if (buildFile->fileRef() == nullptr || buildFile->fileRef()->type() != pbxproj::PBX::GroupItem::Type::FileReference) {
-                    continue;
-                }
-
-                pbxproj::PBX::FileReference::shared_ptr const &fileReference = std::static_pointer_cast <pbxproj::PBX::FileReference> (buildFile->fileRef());
-                std::string filePath = compilerEnvironment.expand(fileReference->resolve());
-                pbxspec::PBX::FileType::shared_ptr fileType = FileTypeResolver::Resolve(Filesystem::GetDefaultUNSAFE(), _specManager, { pbxspec::Manager::AnyDomain() }, fileReference, filePath);
-                if (fileType == nullptr || (fileType->identifier() != "sourcecode.c.h" && fileType->identifier() != "sourcecode.cpp.h")) {
-                    continue;
-                }
-
-                std::string fileName = FSUtil::GetBaseName(filePath);
-                std::string fileDirectory = FSUtil::GetDirectoryName(filePath) + "/";
-                std::string frameworkName = projectTarget->productName() + "/" + fileName;
+        for (Tool::HeadermapCache::Header const &header : projectHeaders->targetHeaders[n]) {
+            if (isTarget) {
+                ownTargetHeadersEntries.push_back({ header.fileName, header.directory, header.fileName });
 
-                std::vector<std::string> const &attributes = buildFile->attributes();
-                bool isPublic  = std::find(attributes.begin(), attributes.end(), "Public") != attributes.end();
-                bool isPrivate = std::find(attributes.begin(), attributes.end(), "Private") != attributes.end();
-
-                if (projectTarget == target) {
-                    ownTargetHeaders.add(fileName, fileDirectory, fileName);
-
-                    if (!isPublic && !isPrivate) {
-                        ownTargetHeaders.add(frameworkName, fileDirectory, fileName);
-                        if (includeFlatEntriesForTargetBeingBuilt) {
-                            targetName.add(frameworkName, fileDirectory, fileName);
-                        }
+                if (!header.isPublic && !header.isPrivate) {
+                    ownTargetHeadersEntries.push_back({ header.frameworkName, header.directory, header.fileName });
+                    if (includeFlatEntriesForTargetBeingBuilt) {
+                        targetNameEntries.push_back({ header.frameworkName, header.directory, header.fileName });
                     }
                 }
+            }
 
-                if (isPublic || isPrivate) {
-                    allTargetHeaders.add(frameworkName, fileDirectory, fileName);
-                    if (includeFrameworkEntriesForAllProductTypes) {
-                        targetName.add(frameworkName, fileDirectory, fileName);
-                    }
-
-                    // TODO(grp): This is a little messy. Maybe check the product type specification, or the product reference's file type?
-                    if (projectTarget->type() == pbxproj::PBX::Target::Type::Native && std::static_pointer_cast<pbxproj::PBX::NativeTarget>(projectTarget)->productType().find("framework") == std::string::npos) {
-                        allNonFrameworkTargetHeaders.add(frameworkName, fileDirectory, fileName);
-                        if (!includeFrameworkEntriesForAllProductTypes) {
-                            targetName.add(frameworkName, fileDirectory, fileName);
-                        }
-                    }
+            if (header.isPublic || header.isPrivate) {
+                if (includeFrameworkEntriesForAllProductTypes || header.isNonFramework) {
+                    targetNameEntries.push_back({ header.frameworkName, header.directory, header.fileName });
                 }
             }
         }
     }
 
+    HeaderMap targetName;
+    targetName.add(targetNameEntries);
+
+    HeaderMap ownTargetHeaders;
+    ownTargetHeaders.add(ownTargetHeadersEntries);
+
     std::string headermapFile                                = compilerEnvironment.resolve("CPP_HEADERMAP_FILE");
     std::string headermapFileForOwnTargetHeaders             = compilerEnvironment.resolve("CPP_HEADERMAP_FILE_FOR_OWN_TARGET_HEADERS");
     std::string headermapFileForAllTargetHeaders             = compilerEnvironment.resolve("CPP_HEADERMAP_FILE_FOR_ALL_TARGET_HEADERS");
@@ -199,10 +158,10 @@ resolve(
     std::vector<Tool::AuxiliaryFile> auxiliaryFiles = {
         Tool::AuxiliaryFile::Data(headermapFile, targetName.write()),
         Tool::AuxiliaryFile::Data(headermapFileForOwnTargetHeaders, ownTargetHeaders.write()),
-        Tool::AuxiliaryFile::Data(headermapFileForAllTargetHeaders, allTargetHeaders.write()),
-        Tool::AuxiliaryFile::Data(headermapFileForAllNonFrameworkTargetHeaders, allNonFrameworkTargetHeaders.write()),
+        Tool::AuxiliaryFile::Data(headermapFileForAllTargetHeaders, projectHeaders->allTargetHeadersData),
+        Tool::AuxiliaryFile::Data(headermapFileForAllNonFrameworkTargetHeaders, projectHeaders->allNonFrameworkTargetHeadersData),
         Tool::AuxiliaryFile::Data(headermapFileForGeneratedFiles, generatedFiles.write()),
-        Tool::AuxiliaryFile::Data(headermapFileForProjectFiles, projectHeaders.write()),
+        Tool::AuxiliaryFile::Data(headermapFileForProjectFiles, projectHeaders->projectHeadersData),
     };
 
     toolContext->auxiliaryFiles().insert(toolContext->auxiliaryFiles().end(), auxiliaryFiles.begin(), auxiliaryFiles.end());
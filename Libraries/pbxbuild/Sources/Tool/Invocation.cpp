@@ -13,6 +13,7 @@
 
 namespace Tool = pbxbuild::Tool;
 using DependencyInfo = Tool::Invocation::DependencyInfo;
+using ContentHash = Tool::Invocation::ContentHash;
 using Executable = Tool::Invocation::Executable;
 using libutil::Filesystem;
 using libutil::FSUtil;
@@ -24,6 +25,13 @@ DependencyInfo(dependency::DependencyInfoFormat format, std::string const &path)
 {
 }
 
+ContentHash::
+ContentHash(std::string const &database, std::string const &digest) :
+    _database(database),
+    _digest  (digest)
+{
+}
+
 Executable::
 Executable(
     ext::optional<std::string> const &external,
@@ -75,3 +83,14 @@ Tool::Invocation::
 {
 }
 
+std::unordered_map<std::string, std::string> Tool::Invocation::
+fullEnvironment() const
+{
+    std::unordered_map<std::string, std::string> environment = _environment;
+    if (_sharedEnvironment != nullptr) {
+        /* Doesn't replace existing values. */
+        environment.insert(_sharedEnvironment->begin(), _sharedEnvironment->end());
+    }
+    return environment;
+}
+
@@ -79,13 +79,13 @@ AddOptionArgumentValue(std::vector<std::string> *arguments, pbxsetting::Environm
 }
 
 static void
-AddOptionArgumentValues(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, std::vector<pbxsetting::Value> const &args, pbxspec::PBX::PropertyOption::shared_ptr const &option)
+AddOptionArgumentValues(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, Tool::SearchPathsCache *searchPathsCache, std::vector<pbxsetting::Value> const &args, pbxspec::PBX::PropertyOption::shared_ptr const &option)
 {
     if ((option->type() == "StringList" || option->type() == "stringlist") ||
         (option->type() == "PathList" || option->type() == "pathlist")) {
         std::vector<std::string> values = pbxsetting::Type::ParseList(environment.resolve(option->name()));
         if (option->flattenRecursiveSearchPathsInValue()) {
-            values = Tool::SearchPaths::ExpandRecursive(values, environment, workingDirectory);
+            values = Tool::SearchPaths::ExpandRecursive(values, environment, workingDirectory, searchPathsCache);
         }
 
         for (std::string const &value : values) {
@@ -110,7 +110,7 @@ ArgumentValuesFromArray(plist::Array const *args)
 }
 
 static void
-AddOptionValuesArguments(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, plist::Array const *values, std::string const &value, pbxspec::PBX::PropertyOption::shared_ptr const &option)
+AddOptionValuesArguments(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, Tool::SearchPathsCache *searchPathsCache, plist::Array const *values, std::string const &value, pbxspec::PBX::PropertyOption::shared_ptr const &option)
 {
     if (values == nullptr) {
         return;
@@ -127,10 +127,10 @@ AddOptionValuesArguments(std::vector<std::string> *arguments, pbxsetting::Enviro
                 if (entryValue->value() == value) {
                     if (auto entryFlag = entry->value <plist::String> ("CommandLineFlag")) {
                         std::vector<pbxsetting::Value> argsValues = { pbxsetting::Value::Parse(entryFlag->value()) };
-                        AddOptionArgumentValues(arguments, environment, workingDirectory, argsValues, option);
+                        AddOptionArgumentValues(arguments, environment, workingDirectory, searchPathsCache, argsValues, option);
                     } else if (auto entryArgs = entry->value <plist::Array> ("CommandLineArgs")) {
                         std::vector<pbxsetting::Value> argsValues = ArgumentValuesFromArray(entryArgs);
-                        AddOptionArgumentValues(arguments, environment, workingDirectory, argsValues, option);
+                        AddOptionArgumentValues(arguments, environment, workingDirectory, searchPathsCache, argsValues, option);
                     }
                 }
             }
@@ -139,7 +139,7 @@ AddOptionValuesArguments(std::vector<std::string> *arguments, pbxsetting::Enviro
 }
 
 static void
-AddOptionArgsArguments(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, plist::Object const *argsValue, std::string const &value, pbxspec::PBX::PropertyOption::shared_ptr const &option)
+AddOptionArgsArguments(std::vector<std::string> *arguments, pbxsetting::Environment const &environment, std::string const &workingDirectory, Tool::SearchPathsCache *searchPathsCache, plist::Object const *argsValue, std::string const &value, pbxspec::PBX::PropertyOption::shared_ptr const &option)
 {
     /*
      * `CommandLineArgs` and `AdditionalLinkerArgs` are either arrays of arguments or dictionaries
@@ -148,28 +148,107 @@ AddOptionArgsArguments(std::vector<std::string> *arguments, pbxsetting::Environm
 
     if (auto args = plist::CastTo <plist::Array> (argsValue)) {
         std::vector<pbxsetting::Value> argsValues = ArgumentValuesFromArray(args);
-        AddOptionArgumentValues(arguments, environment, workingDirectory, argsValues, option);
+        AddOptionArgumentValues(arguments, environment, workingDirectory, searchPathsCache, argsValues, option);
     } else if (auto argsValues = plist::CastTo <plist::Dictionary> (argsValue)) {
         if (auto args = argsValues->value <plist::Array> (value)) {
             std::vector<pbxsetting::Value> argsValues = ArgumentValuesFromArray(args);
-            AddOptionArgumentValues(arguments, environment, workingDirectory, argsValues, option);
+            AddOptionArgumentValues(arguments, environment, workingDirectory, searchPathsCache, argsValues, option);
         } else if (auto args = argsValues->value <plist::Array> ("<<otherwise>>")) {
             std::vector<pbxsetting::Value> argsValues = ArgumentValuesFromArray(args);
-            AddOptionArgumentValues(arguments, environment, workingDirectory, argsValues, option);
+            AddOptionArgumentValues(arguments, environment, workingDirectory, searchPathsCache, argsValues, option);
         }
     }
 }
 
+static bool
+AddOptionArguments(
+    std::vector<std::string> *arguments,
+    std::vector<std::pair<std::string, std::string>> *environmentVariables,
+    std::vector<std::string> *linkerArgs,
+    pbxsetting::Environment const &environment,
+    std::string const &workingDirectory,
+    Tool::SearchPathsCache *searchPathsCache,
+    std::string const &architecture,
+    pbxspec::PBX::PropertyOption::shared_ptr const &option,
+    pbxspec::PBX::FileType::shared_ptr const &fileType)
+{
+    if (option->condition() && !EvaluateCondition(*option->condition(), environment)) {
+        return false;
+    }
+    if (option->commandLineCondition() && !EvaluateCondition(*option->commandLineCondition(), environment)) {
+        return false;
+    }
+
+    if (option->architectures() && std::find(option->architectures()->begin(), option->architectures()->end(), architecture) == option->architectures()->end()) {
+        return false;
+    }
+
+    if (option->fileTypes() && fileType != nullptr && std::find(option->fileTypes()->begin(), option->fileTypes()->end(), fileType->identifier()) == option->fileTypes()->end()) {
+        return false;
+    }
+
+    // TODO(grp): Use PropertyOption::conditionFlavors().
+    std::string value = environment.resolve(option->name());
+
+    if (option->type() == "Boolean" || option->type() == "bool") {
+        bool booleanValue = pbxsetting::Type::ParseBoolean(value);
+        ext::optional<pbxsetting::Value> const &flag = (booleanValue ? option->commandLineFlag() : option->commandLineFlagIfFalse());
+
+        if (flag) {
+            /* Boolean flags don't get the flag value after, since that would be just YES or NO. */
+            arguments->push_back(environment.expand(*flag));
+        }
+    } else {
+        if (!value.empty()) {
+            if (option->commandLineFlag()) {
+                pbxsetting::Value const &flag = *option->commandLineFlag();
+
+                /* Pass both the command line flag and the option value itself. */
+                std::vector<pbxsetting::Value> values = { flag, pbxsetting::Value::Variable("value") };
+                AddOptionArgumentValues(arguments, environment, workingDirectory, searchPathsCache, values, option);
+            }
+        }
+    }
+
+    AddOptionValuesArguments(arguments, environment, workingDirectory, searchPathsCache, plist::CastTo<plist::Array>(option->values()), value, option);
+    AddOptionValuesArguments(arguments, environment, workingDirectory, searchPathsCache, plist::CastTo<plist::Array>(option->allowedValues()), value, option);
+
+    if (!value.empty()) {
+        /* Pass the prefix then the option value in the same argument. */
+        if (option->commandLinePrefixFlag()) {
+            pbxsetting::Value const &prefix = *option->commandLinePrefixFlag();
+            pbxsetting::Value prefixValue = prefix + pbxsetting::Value::Variable("value");
+            AddOptionArgumentValues(arguments, environment, workingDirectory, searchPathsCache, { prefixValue }, option);
+        }
+    }
+
+    AddOptionArgsArguments(arguments, environment, workingDirectory, searchPathsCache, option->commandLineArgs(), value, option);
+    AddOptionArgsArguments(linkerArgs, environment, workingDirectory, searchPathsCache, option->additionalLinkerArgs(), value, option);
+
+    if (option->setValueInEnvironmentVariable()) {
+        std::string const &variable = environment.expand(*option->setValueInEnvironmentVariable());
+        environmentVariables->push_back({ variable, value });
+    }
+
+    // TODO(grp): Use PropertyOption::conditionFlavors().
+    // TODO(grp): Use PropertyOption::isCommand{Input,Output}().
+    // TODO(grp): Use PropertyOption::isInputDependency(), PropertyOption::outputDependencies().
+    // TODO(grp): Use PropertyOption::outputsAreSourceFiles().
+
+    return true;
+}
+
 Tool::OptionsResult Tool::OptionsResult::
 Create(
     pbxsetting::Environment const &environment,
     std::string const &workingDirectory,
     std::vector<pbxspec::PBX::PropertyOption::shared_ptr> const &options,
     pbxspec::PBX::FileType::shared_ptr const &fileType,
-    std::unordered_set<std::string> const &deletedSettings)
+    std::unordered_set<std::string> const &deletedSettings,
+    Tool::SearchPathsCache *searchPathsCache)
 {
     std::vector<std::string> arguments;
-    std::unordered_map<std::string, std::string> environmentVariables;
+    std::vector<std::pair<std::string, std::string>> environmentVariables;
     std::vector<std::string> linkerArgs;
 
     std::string architecture = environment.resolve("arch");
@@ -179,97 +258,236 @@ Create(
             continue;
         }
 
-        if (option->condition() && !EvaluateCondition(*option->condition(), environment)) {
-            continue;
-        }
-        if (option->commandLineCondition() && !EvaluateCondition(*option->commandLineCondition(), environment)) {
-            continue;
-        }
+        AddOptionArguments(&arguments, &environmentVariables, &linkerArgs, environment, workingDirectory, searchPathsCache, architecture, option, fileType);
+    }
 
-        if (option->architectures() && std::find(option->architectures()->begin(), option->architectures()->end(), architecture) == option->architectures()->end()) {
-            continue;
-        }
+    /* Earlier options take precedence for the same environment variable. */
+    std::unordered_map<std::string, std::string> environmentVariablesMap;
+    environmentVariablesMap.insert(environmentVariables.begin(), environmentVariables.end());
 
-        if (option->fileTypes() && fileType != nullptr && std::find(option->fileTypes()->begin(), option->fileTypes()->end(), fileType->identifier()) == option->fileTypes()->end()) {
-            continue;
+    return Tool::OptionsResult(arguments, environmentVariablesMap, linkerArgs);
+}
+
+static Tool::OptionsResult
+AddToolEnvironment(Tool::Environment const &toolEnvironment, Tool::OptionsResult const &optionsResult)
+{
+    /* Add tool-level environment variables. */
+    std::unordered_map<std::string, std::string> environmentVariables = optionsResult.environment();
+    if (toolEnvironment.tool()->environmentVariables()) {
+        for (auto const &variable : *toolEnvironment.tool()->environmentVariables()) {
+            environmentVariables.insert({ variable.first, toolEnvironment.environment().expand(variable.second) });
         }
+    }
 
-        // TODO(grp): Use PropertyOption::conditionFlavors().
-        std::string value = environment.resolve(option->name());
+    /* Copy important environment variables for all tools. */
+    environmentVariables["PATH"] = toolEnvironment.environment().resolve("PATH");
+    environmentVariables["DEVELOPER_DIR"] = toolEnvironment.environment().resolve("DEVELOPER_DIR");
 
-        if (option->type() == "Boolean" || option->type() == "bool") {
-            bool booleanValue = pbxsetting::Type::ParseBoolean(value);
-            ext::optional<pbxsetting::Value> const &flag = (booleanValue ? option->commandLineFlag() : option->commandLineFlagIfFalse());
+    return Tool::OptionsResult(optionsResult.arguments(), environmentVariables, optionsResult.linkerArgs());
+}
 
-            if (flag) {
-                /* Boolean flags don't get the flag value after, since that would be just YES or NO. */
-                arguments.push_back(environment.expand(*flag));
-            }
-        } else {
-            if (!value.empty()) {
-                if (option->commandLineFlag()) {
-                    pbxsetting::Value const &flag = *option->commandLineFlag();
+Tool::OptionsResult Tool::OptionsResult::
+Create(
+    Tool::Environment const &toolEnvironment,
+    std::string const &workingDirectory,
+    pbxspec::PBX::FileType::shared_ptr const &fileType,
+    Tool::SearchPathsCache *searchPathsCache)
+{
+    Tool::OptionsResult optionsResult = Create(
+        toolEnvironment.environment(),
+        workingDirectory,
+        toolEnvironment.tool()->options().value_or(pbxspec::PBX::PropertyOption::vector()),
+        fileType,
+        toolEnvironment.tool()->deletedProperties().value_or(std::unordered_set<std::string>()),
+        searchPathsCache);
 
-                    /* Pass both the command line flag and the option value itself. */
-                    std::vector<pbxsetting::Value> values = { flag, pbxsetting::Value::Variable("value") };
-                    AddOptionArgumentValues(&arguments, environment, workingDirectory, values, option);
-                }
-            }
+    return AddToolEnvironment(toolEnvironment, optionsResult);
+}
+
+/*
+ * The arguments added by a single option, or, if the option's arguments
+ * depend on the input or output, the option to evaluate for each input.
+ */
+class Tool::OptionsCache::Template {
+public:
+    class Entry {
+    public:
+        pbxspec::PBX::PropertyOption::shared_ptr         option;
+
+    public:
+        std::vector<std::string>                         arguments;
+        std::vector<std::pair<std::string, std::string>> environmentVariables;
+        std::vector<std::string>                         linkerArgs;
+    };
+
+public:
+    std::vector<Entry> entries;
+};
+
+static void
+AddArgsValues(std::vector<pbxsetting::Value> *values, plist::Array const *args)
+{
+    if (args != nullptr) {
+        std::vector<pbxsetting::Value> argsValues = ArgumentValuesFromArray(args);
+        values->insert(values->end(), argsValues.begin(), argsValues.end());
+    }
+}
+
+static void
+AddArgsObjectValues(std::vector<pbxsetting::Value> *values, plist::Object const *argsValue)
+{
+    if (auto args = plist::CastTo <plist::Array> (argsValue)) {
+        AddArgsValues(values, args);
+    } else if (auto argsValues = plist::CastTo <plist::Dictionary> (argsValue)) {
+        for (size_t n = 0; n < argsValues->count(); n++) {
+            AddArgsValues(values, argsValues->value <plist::Array> (n));
         }
+    }
+}
 
-        AddOptionValuesArguments(&arguments, environment, workingDirectory, plist::CastTo<plist::Array>(option->values()), value, option);
-        AddOptionValuesArguments(&arguments, environment, workingDirectory, plist::CastTo<plist::Array>(option->allowedValues()), value, option);
+static void
+AddValuesArrayValues(std::vector<pbxsetting::Value> *values, plist::Array const *entries)
+{
+    if (entries == nullptr) {
+        return;
+    }
 
-        if (!value.empty()) {
-            /* Pass the prefix then the option value in the same argument. */
-            if (option->commandLinePrefixFlag()) {
-                pbxsetting::Value const &prefix = *option->commandLinePrefixFlag();
-                pbxsetting::Value prefixValue = prefix + pbxsetting::Value::Variable("value");
-                AddOptionArgumentValues(&arguments, environment, workingDirectory, { prefixValue }, option);
+    for (size_t n = 0; n < entries->count(); n++) {
+        if (auto entry = entries->value <plist::Dictionary> (n)) {
+            if (auto entryFlag = entry->value <plist::String> ("CommandLineFlag")) {
+                values->push_back(pbxsetting::Value::Parse(entryFlag->value()));
             }
+            AddArgsValues(values, entry->value <plist::Array> ("CommandLineArgs"));
         }
+    }
+}
 
-        AddOptionArgsArguments(&arguments, environment, workingDirectory, option->commandLineArgs(), value, option);
-        AddOptionArgsArguments(&linkerArgs, environment, workingDirectory, option->additionalLinkerArgs(), value, option);
+/*
+ * All of the expressions that are expanded when evaluating an option.
+ */
+static std::vector<pbxsetting::Value>
+OptionValues(pbxspec::PBX::PropertyOption::shared_ptr const &option)
+{
+    std::vector<pbxsetting::Value> values;
+    values.push_back(pbxsetting::Value::Variable("arch"));
+    values.push_back(pbxsetting::Value::Variable(option->name()));
 
-        if (option->setValueInEnvironmentVariable()) {
-            std::string const &variable = environment.expand(*option->setValueInEnvironmentVariable());
-            environmentVariables.insert({ variable, value });
-        }
+    if (option->condition()) {
+        values.push_back(pbxsetting::Value::Parse(*option->condition()));
+    }
+    if (option->commandLineCondition()) {
+        values.push_back(pbxsetting::Value::Parse(*option->commandLineCondition()));
+    }
 
-        // TODO(grp): Use PropertyOption::conditionFlavors().
-        // TODO(grp): Use PropertyOption::isCommand{Input,Output}().
-        // TODO(grp): Use PropertyOption::isInputDependency(), PropertyOption::outputDependencies().
-        // TODO(grp): Use PropertyOption::outputsAreSourceFiles().
+    if (option->commandLineFlag()) {
+        values.push_back(*option->commandLineFlag());
+    }
+    if (option->commandLineFlagIfFalse()) {
+        values.push_back(*option->commandLineFlagIfFalse());
+    }
+    if (option->commandLinePrefixFlag()) {
+        values.push_back(*option->commandLinePrefixFlag());
     }
+    if (option->setValueInEnvironmentVariable()) {
+        values.push_back(*option->setValueInEnvironmentVariable());
+    }
+
+    AddValuesArrayValues(&values, plist::CastTo<plist::Array>(option->values()));
+    AddValuesArrayValues(&values, plist::CastTo<plist::Array>(option->allowedValues()));
+    AddArgsObjectValues(&values, option->commandLineArgs());
+    AddArgsObjectValues(&values, option->additionalLinkerArgs());
 
-    return Tool::OptionsResult(arguments, environmentVariables, linkerArgs);
+    return values;
 }
 
-Tool::OptionsResult Tool::OptionsResult::
-Create(
+Tool::OptionsCache::
+OptionsCache()
+{
+}
+
+Tool::OptionsCache::
+~OptionsCache()
+{
+}
+
+Tool::OptionsResult Tool::OptionsCache::
+create(
     Tool::Environment const &toolEnvironment,
     std::string const &workingDirectory,
-    pbxspec::PBX::FileType::shared_ptr const &fileType)
+    pbxspec::PBX::FileType::shared_ptr const &fileType,
+    Tool::SearchPathsCache *searchPathsCache)
 {
-    Tool::OptionsResult optionsResult = Create(
-        toolEnvironment.environment(),
-        workingDirectory,
-        toolEnvironment.tool()->options().value_or(pbxspec::PBX::PropertyOption::vector()),
-        fileType,
-        toolEnvironment.tool()->deletedProperties().value_or(std::unordered_set<std::string>()));
+    pbxspec::PBX::Tool::shared_ptr const &tool = toolEnvironment.tool();
+    pbxsetting::Environment const &environment = toolEnvironment.environment();
+    pbxspec::PBX::PropertyOption::vector options = tool->options().value_or(pbxspec::PBX::PropertyOption::vector());
+    std::unordered_set<std::string> deletedSettings = tool->deletedProperties().value_or(std::unordered_set<std::string>());
+    std::string architecture = environment.resolve("arch");
 
-    /* Add tool-level environment variables. */
-    std::unordered_map<std::string, std::string> environmentVariables = optionsResult.environment();
-    if (toolEnvironment.tool()->environmentVariables()) {
-        for (auto const &variable : *toolEnvironment.tool()->environmentVariables()) {
-            environmentVariables.insert({ variable.first, toolEnvironment.environment().expand(variable.second) });
+    std::string key = tool->identifier() + "\n" + (fileType != nullptr ? fileType->identifier() : std::string());
+
+    std::shared_ptr<Template> optionsTemplate;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _templates.find(key);
+        if (it != _templates.end()) {
+            optionsTemplate = it->second;
         }
     }
 
-    /* Copy important environment variables for all tools. */
-    environmentVariables["PATH"] = toolEnvironment.environment().resolve("PATH");
-    environmentVariables["DEVELOPER_DIR"] = toolEnvironment.environment().resolve("DEVELOPER_DIR");
+    if (optionsTemplate == nullptr) {
+        /*
+         * Evaluate each option once, keeping the arguments from options that
+         * are independent of the input and output. This is done outside of the
+         * lock; if another thread creates the same template, either is valid.
+         */
+        optionsTemplate = std::make_shared<Template>();
+
+        for (pbxspec::PBX::PropertyOption::shared_ptr const &option : options) {
+            if (deletedSettings.find(option->name()) != deletedSettings.end()) {
+                continue;
+            }
 
-    return Tool::OptionsResult(optionsResult.arguments(), environmentVariables, optionsResult.linkerArgs());
+            Template::Entry entry;
+
+            bool dependent = false;
+            for (pbxsetting::Value const &value : OptionValues(option)) {
+                if (environment.dependsOn(value, Tool::Environment::InputOutputSettings())) {
+                    dependent = true;
+                    break;
+                }
+            }
+
+            if (dependent) {
+                entry.option = option;
+            } else if (!AddOptionArguments(&entry.arguments, &entry.environmentVariables, &entry.linkerArgs, environment, workingDirectory, searchPathsCache, architecture, option, fileType)) {
+                /* Option never applies. */
+                continue;
+            }
+
+            optionsTemplate->entries.push_back(entry);
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _templates.insert({ key, optionsTemplate });
+    }
+
+    std::vector<std::string> arguments;
+    std::vector<std::pair<std::string, std::string>> environmentVariables;
+    std::vector<std::string> linkerArgs;
+
+    for (Template::Entry const &entry : optionsTemplate->entries) {
+        if (entry.option != nullptr) {
+            AddOptionArguments(&arguments, &environmentVariables, &linkerArgs, environment, workingDirectory, searchPathsCache, architecture, entry.option, fileType);
+        } else {
+            arguments.insert(arguments.end(), entry.arguments.begin(), entry.arguments.end());
+            environmentVariables.insert(environmentVariables.end(), entry.environmentVariables.begin(), entry.environmentVariables.end());
+            linkerArgs.insert(linkerArgs.end(), entry.linkerArgs.begin(), entry.linkerArgs.end());
+        }
+    }
+
+    /* Earlier options take precedence for the same environment variable. */
+    std::unordered_map<std::string, std::string> environmentVariablesMap;
+    environmentVariablesMap.insert(environmentVariables.begin(), environmentVariables.end());
+
+    return AddToolEnvironment(toolEnvironment, Tool::OptionsResult(arguments, environmentVariablesMap, linkerArgs));
 }
@@ -0,0 +1,112 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <pbxbuild/Tool/ScriptEnvironment.h>
+#include <pbxsetting/Environment.h>
+#include <libutil/md5.h>
+
+#include <algorithm>
+
+namespace Tool = pbxbuild::Tool;
+
+static void
+AppendValues(md5_state_t *state, std::unordered_map<std::string, std::string> const &values)
+{
+    /* Hash in a stable order, and separate each part so none can run together. */
+    using Value = std::unordered_map<std::string, std::string>::value_type;
+    std::vector<Value const *> sorted;
+    sorted.reserve(values.size());
+    for (auto const &value : values) {
+        sorted.push_back(&value);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](Value const *a, Value const *b) {
+        return a->first < b->first;
+    });
+
+    for (Value const *value : sorted) {
+        md5_append(state, reinterpret_cast<md5_byte_t const *>(value->first.c_str()), value->first.size() + 1);
+        md5_append(state, reinterpret_cast<md5_byte_t const *>(value->second.c_str()), value->second.size() + 1);
+    }
+}
+
+static std::string
+Finish(md5_state_t *state)
+{
+    uint8_t digest[16];
+    md5_finish(state, reinterpret_cast<md5_byte_t *>(&digest));
+
+    static char const hex[] = "0123456789abcdef";
+    std::string result;
+    for (uint8_t byte : digest) {
+        result += hex[byte >> 4];
+        result += hex[byte & 0xf];
+    }
+    return result;
+}
+
+Tool::ScriptEnvironment::
+ScriptEnvironment(pbxsetting::Environment const &environment) :
+    _values             (std::make_shared<std::unordered_map<std::string, std::string>>(environment.computeValues(pbxsetting::Condition::Empty()))),
+    _reverseDependencies(environment.reverseDependencies())
+{
+    md5_state_t state;
+    md5_init(&state);
+    AppendValues(&state, *_values);
+    _valuesDigest = Finish(&state);
+}
+
+Tool::ScriptEnvironment::
+~ScriptEnvironment()
+{
+}
+
+std::unordered_map<std::string, std::string> Tool::ScriptEnvironment::
+overlay(pbxsetting::Environment const &environment, std::vector<pbxsetting::Level> const &levels) const
+{
+    /* Find the settings in the levels, then any settings that use those. */
+    std::unordered_set<std::string> settings;
+    std::vector<std::string> queue;
+    for (pbxsetting::Level const &level : levels) {
+        for (pbxsetting::Setting const &setting : level.settings()) {
+            if (settings.insert(setting.name()).second) {
+                queue.push_back(setting.name());
+            }
+        }
+    }
+
+    while (!queue.empty()) {
+        std::string setting = queue.back();
+        queue.pop_back();
+
+        auto it = _reverseDependencies.find(setting);
+        if (it != _reverseDependencies.end()) {
+            for (std::string const &dependent : it->second) {
+                if (settings.insert(dependent).second) {
+                    queue.push_back(dependent);
+                }
+            }
+        }
+    }
+
+    std::unordered_map<std::string, std::string> values;
+    for (std::string const &setting : settings) {
+        values[setting] = environment.resolve(setting);
+    }
+    return values;
+}
+
+std::string Tool::ScriptEnvironment::
+digest(std::unordered_map<std::string, std::string> const &overlay, std::string const &contents) const
+{
+    md5_state_t state;
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<md5_byte_t const *>(_valuesDigest.c_str()), _valuesDigest.size() + 1);
+    AppendValues(&state, overlay);
+    md5_append(&state, reinterpret_cast<md5_byte_t const *>(contents.data()), contents.size());
+    return Finish(&state);
+}
@@ -8,6 +8,7 @@
 
 #include <pbxbuild/Tool/ScriptResolver.h>
 #include <pbxbuild/Tool/Context.h>
+#include <pbxbuild/Tool/ScriptEnvironment.h>
 #include <pbxsetting/Environment.h>
 #include <pbxsetting/Level.h>
 #include <pbxsetting/Setting.h>
@@ -83,6 +84,7 @@ void Tool::ScriptResolver::
 resolve(
     Tool::Context *toolContext,
     pbxsetting::Environment const &environment,
+    Tool::ScriptEnvironment const &scriptEnvironment,
     pbxproj::PBX::ShellScriptBuildPhase::shared_ptr const &buildPhase) const
 {
     pbxsetting::Level level = pbxsetting::Level({
@@ -112,20 +114,33 @@ resolve(
     std::string contents = (!buildPhase->shellPath().empty() ? "#!" + buildPhase->shellPath() + "\n" : "") + buildPhase->shellScript();
     auto scriptFile = Tool::AuxiliaryFile::Data(scriptFilePath, std::vector<uint8_t>(contents.begin(), contents.end()), true);
 
-    pbxsetting::Environment scriptEnvironment = pbxsetting::Environment(environment);
-    scriptEnvironment.insertFront(ScriptInputOutputLevel(inputFiles, outputFiles, true), false);
-    std::unordered_map<std::string, std::string> environmentVariables = scriptEnvironment.computeValues(pbxsetting::Condition::Empty());
+    /* Only the input and output settings differ from the shared environment. */
+    pbxsetting::Level inputOutputLevel = ScriptInputOutputLevel(inputFiles, outputFiles, true);
+    pbxsetting::Environment inputOutputEnvironment = pbxsetting::Environment(environment);
+    inputOutputEnvironment.insertFront(inputOutputLevel, false);
+    std::unordered_map<std::string, std::string> environmentVariables = scriptEnvironment.overlay(inputOutputEnvironment, { inputOutputLevel });
 
     Tool::Invocation invocation;
     invocation.executable() = Tool::Invocation::Executable::External("/bin/sh");
     invocation.arguments() = { "-c", Escape::Shell(scriptFilePath) };
     invocation.environment() = environmentVariables;
+    invocation.sharedEnvironment() = scriptEnvironment.values();
     invocation.workingDirectory() = toolContext->workingDirectory();
     invocation.phonyInputs() = inputFiles; /* User-specified, may not exist. */
     invocation.outputs() = outputFiles;
     invocation.logMessage() = phaseEnvironment.expand(logMessage);
     invocation.showEnvironmentInLog() = buildPhase->showEnvVarsInLog();
     invocation.priority() = toolContext->currentPhaseInvocationPriority();
+
+    /*
+     * Opt-in, as scripts can depend on files they don't declare as inputs.
+     * Recorded per target, so targets don't contend for the same database.
+     */
+    if (pbxsetting::Type::ParseBoolean(environment.resolve("SKIP_UNCHANGED_SCRIPT_PHASES"))) {
+        std::string database = environment.resolve("TARGET_TEMP_DIR") + "/ScriptHashes.db";
+        invocation.contentHash() = Tool::Invocation::ContentHash(database, scriptEnvironment.digest(environmentVariables, contents));
+    }
+
     toolContext->invocations().push_back(invocation);
 
     toolContext->auxiliaryFiles().push_back(scriptFile);
@@ -135,6 +150,7 @@ void Tool::ScriptResolver::
 resolve(
     Tool::Context *toolContext,
     pbxsetting::Environment const &environment,
+    Tool::ScriptEnvironment const &scriptEnvironment,
     Tool::Input const &input) const
 {
     Target::BuildRules::BuildRule::shared_ptr const &buildRule = input.buildRule();
@@ -177,13 +193,15 @@ resolve(
     /*
      * Compute the final environment by adding the standard script levels.
      */
-    ruleEnvironment.insertFront(ScriptInputOutputLevel({ inputAbsolutePath }, outputFiles, false), false);
-    std::unordered_map<std::string, std::string> environmentVariables = ruleEnvironment.computeValues(pbxsetting::Condition::Empty());
+    pbxsetting::Level inputOutputLevel = ScriptInputOutputLevel({ inputAbsolutePath }, outputFiles, false);
+    ruleEnvironment.insertFront(inputOutputLevel, false);
+    std::unordered_map<std::string, std::string> environmentVariables = scriptEnvironment.overlay(ruleEnvironment, { level, inputOutputLevel });
 
     Tool::Invocation invocation;
     invocation.executable() = Tool::Invocation::Executable::External("/bin/sh");
     invocation.arguments() = { "-c", buildRule->script() };
     invocation.environment() = environmentVariables;
+    invocation.sharedEnvironment() = scriptEnvironment.values();
     invocation.workingDirectory() = toolContext->workingDirectory();
     invocation.inputs() = { inputAbsolutePath };
     invocation.outputs() = outputFiles;
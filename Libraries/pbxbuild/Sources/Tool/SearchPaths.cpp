@@ -8,6 +8,7 @@
 
 #include <pbxbuild/Tool/SearchPaths.h>
 #include <pbxbuild/Tool/Context.h>
+#include <pbxbuild/Tool/SearchPathsCache.h>
 #include <pbxsetting/Environment.h>
 #include <pbxsetting/Type.h>
 #include <libutil/Filesystem.h>
@@ -31,7 +32,7 @@ SearchPaths(
 }
 
 static void
-AppendPaths(std::vector<std::string> *args, pbxsetting::Environment const &environment, std::string const &workingDirectory, std::vector<std::string> const &paths)
+AppendPaths(std::vector<std::string> *args, pbxsetting::Environment const &environment, std::string const &workingDirectory, Tool::SearchPathsCache *searchPathsCache, std::vector<std::string> const &paths)
 {
     Filesystem const *filesystem = Filesystem::GetDefaultUNSAFE();
 
@@ -55,18 +56,17 @@ AppendPaths(std::vector<std::string> *args, pbxsetting::Environment const &envir
             args->push_back(root);
 
             std::string absoluteRoot = FSUtil::ResolveRelativePath(root, workingDirectory);
-            filesystem->readDirectory(absoluteRoot, true, [&](std::string const &relative) -> bool {
-                // TODO(grp): Use build settings for included and excluded recursive paths.
-                // Included: INCLUDED_RECURSIVE_SEARCH_PATH_SUBDIRECTORIES
-                // Excluded: EXCLUDED_RECURSIVE_SEARCH_PATH_SUBDIRECTORIES
-                // Follow: RECURSIVE_SEARCH_PATHS_FOLLOW_SYMLINKS
-
-                std::string absolute = absoluteRoot + "/" + relative;
-                if (filesystem->type(absolute) == Filesystem::Type::Directory) {
-                    args->push_back(root + "/" + relative);
-                }
-                return true;
-            });
+            std::vector<std::string> excluded = pbxsetting::Type::ParseList(environment.resolve("EXCLUDED_RECURSIVE_SEARCH_PATH_SUBDIRECTORIES"));
+            std::vector<std::string> included = pbxsetting::Type::ParseList(environment.resolve("INCLUDED_RECURSIVE_SEARCH_PATH_SUBDIRECTORIES"));
+
+            /* Many targets share the same recursive roots; only walk each once. */
+            std::shared_ptr<std::vector<std::string> const> subdirectories = (searchPathsCache != nullptr ?
+                searchPathsCache->subdirectories(filesystem, absoluteRoot, excluded, included) :
+                std::make_shared<std::vector<std::string>>(Tool::SearchPathsCache::FindSubdirectories(filesystem, absoluteRoot, excluded, included)));
+
+            for (std::string const &subdirectory : *subdirectories) {
+                args->push_back(root + "/" + subdirectory);
+            }
         } else {
             args->push_back(path);
         }
@@ -74,29 +74,29 @@ AppendPaths(std::vector<std::string> *args, pbxsetting::Environment const &envir
 }
 
 std::vector<std::string> Tool::SearchPaths::
-ExpandRecursive(std::vector<std::string> const &paths, pbxsetting::Environment const &environment, std::string const &workingDirectory)
+ExpandRecursive(std::vector<std::string> const &paths, pbxsetting::Environment const &environment, std::string const &workingDirectory, Tool::SearchPathsCache *searchPathsCache)
 {
     std::vector<std::string> result;
-    AppendPaths(&result, environment, workingDirectory, paths);
+    AppendPaths(&result, environment, workingDirectory, searchPathsCache, paths);
     return result;
 }
 
 Tool::SearchPaths Tool::SearchPaths::
-Create(pbxsetting::Environment const &environment, std::string const &workingDirectory)
+Create(pbxsetting::Environment const &environment, std::string const &workingDirectory, Tool::SearchPathsCache *searchPathsCache)
 {
     std::vector<std::string> headerSearchPaths;
-    AppendPaths(&headerSearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("PRODUCT_TYPE_HEADER_SEARCH_PATHS")));
-    AppendPaths(&headerSearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("HEADER_SEARCH_PATHS")));
+    AppendPaths(&headerSearchPaths, environment, workingDirectory, searchPathsCache, pbxsetting::Type::ParseList(environment.resolve("PRODUCT_TYPE_HEADER_SEARCH_PATHS")));
+    AppendPaths(&headerSearchPaths, environment, workingDirectory, searchPathsCache, pbxsetting::Type::ParseList(environment.resolve("HEADER_SEARCH_PATHS")));
 
     std::vector<std::string> userHeaderSearchPaths;
-    AppendPaths(&userHeaderSearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("USER_HEADER_SEARCH_PATHS")));
+    AppendPaths(&userHeaderSearchPaths, environment, workingDirectory, searchPathsCache, pbxsetting::Type::ParseList(environment.resolve("USER_HEADER_SEARCH_PATHS")));
 
     std::vector<std::string> frameworkSearchPaths;
-    AppendPaths(&frameworkSearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("FRAMEWORK_SEARCH_PATHS")));
-    AppendPaths(&frameworkSearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("PRODUCT_TYPE_FRAMEWORK_SEARCH_PATHS")));
+    AppendPaths(&frameworkSearchPaths, environment, workingDirectory, searchPathsCache, pbxsetting::Type::ParseList(environment.resolve("FRAMEWORK_SEARCH_PATHS")));
+    AppendPaths(&frameworkSearchPaths, environment, workingDirectory, searchPathsCache, pbxsetting::Type::ParseList(environment.resolve("PRODUCT_TYPE_FRAMEWORK_SEARCH_PATHS")));
 
     std::vector<std::string> librarySearchPaths;
-    AppendPaths(&librarySearchPaths, environment, workingDirectory, pbxsetting::Type::ParseList(environment.resolve("LIBRARY_SEARCH_PATHS")));
+    AppendPaths(&librarySearchPaths, environment, workingDirectory, searchPathsCache, pbxsetting::Type::ParseList(environment.resolve("LIBRARY_SEARCH_PATHS")));
 
     return Tool::SearchPaths(headerSearchPaths, userHeaderSearchPaths, frameworkSearchPaths, librarySearchPaths);
 }
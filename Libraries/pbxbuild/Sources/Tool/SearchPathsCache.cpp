@@ -0,0 +1,98 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <pbxbuild/Tool/SearchPathsCache.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/Wildcard.h>
+
+namespace Tool = pbxbuild::Tool;
+using libutil::Filesystem;
+using libutil::FSUtil;
+using libutil::Wildcard;
+
+Tool::SearchPathsCache::
+SearchPathsCache()
+{
+}
+
+Tool::SearchPathsCache::
+~SearchPathsCache()
+{
+}
+
+static bool
+MatchesAny(std::vector<std::string> const &patterns, std::string const &name)
+{
+    for (std::string const &pattern : patterns) {
+        if (Wildcard::Match(pattern, name)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<std::string> Tool::SearchPathsCache::
+FindSubdirectories(
+    Filesystem const *filesystem,
+    std::string const &root,
+    std::vector<std::string> const &excluded,
+    std::vector<std::string> const &included)
+{
+    std::vector<std::string> subdirectories;
+
+    // TODO(grp): Follow symbolic links if RECURSIVE_SEARCH_PATHS_FOLLOW_SYMLINKS.
+    filesystem->walkDirectory(root, true, false, [&](Filesystem::DirectoryEntry const &entry) -> bool {
+        if (entry.type != Filesystem::Type::Directory) {
+            return false;
+        }
+
+        std::string name = FSUtil::GetBaseName(entry.path);
+        if (MatchesAny(excluded, name) && !MatchesAny(included, name)) {
+            /* Don't walk excluded directories. */
+            return false;
+        }
+
+        subdirectories.push_back(entry.path);
+        return true;
+    });
+
+    return subdirectories;
+}
+
+std::shared_ptr<std::vector<std::string> const> Tool::SearchPathsCache::
+subdirectories(
+    Filesystem const *filesystem,
+    std::string const &root,
+    std::vector<std::string> const &excluded,
+    std::vector<std::string> const &included)
+{
+    std::string key = root;
+    for (std::vector<std::string> const *patterns : { &excluded, &included }) {
+        key += '\0';
+        for (std::string const &pattern : *patterns) {
+            key += pattern;
+            key += '\n';
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _subdirectories.find(key);
+        if (it != _subdirectories.end()) {
+            return it->second;
+        }
+    }
+
+    /* Walk outside of the lock; if another thread walked too, keep the first. */
+    auto subdirectories = std::make_shared<std::vector<std::string>>(FindSubdirectories(filesystem, root, excluded, included));
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _subdirectories.insert({ key, subdirectories }).first->second;
+}
@@ -135,7 +135,7 @@ IterateWorkspaceFiles(xcworkspace::XC::Workspace::shared_ptr const &workspace, s
 }
 
 static void
-LoadWorkspaceProjects(Filesystem const *filesystem, std::vector<pbxproj::PBX::Project::shared_ptr> *projects, xcworkspace::XC::Workspace::shared_ptr const &workspace)
+LoadWorkspaceProjects(Filesystem const *filesystem, pbxproj::ProjectCache *projectCache, std::vector<pbxproj::PBX::Project::shared_ptr> *projects, xcworkspace::XC::Workspace::shared_ptr const &workspace)
 {
     /*
      * Load all the projects in the workspace.
@@ -143,7 +143,7 @@ LoadWorkspaceProjects(Filesystem const *filesystem, std::vector<pbxproj::PBX::Pr
     IterateWorkspaceFiles(workspace, [&](xcworkspace::XC::FileRef::shared_ptr const &ref) {
         std::string path = ref->resolve(workspace);
 
-        pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(filesystem, path);
+        pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(filesystem, path, projectCache);
         if (project != nullptr) {
             projects->push_back(project);
         }
@@ -179,6 +179,7 @@ LoadConfigurationFiles(
 static void
 LoadNestedProjects(
     Filesystem const *filesystem,
+    pbxproj::ProjectCache *projectCache,
     std::vector<pbxproj::PBX::Project::shared_ptr> *projects,
     std::unordered_map<pbxproj::XC::BuildConfiguration::shared_ptr, pbxsetting::XC::Config> *configs,
     pbxsetting::Environment const &baseEnvironment,
@@ -216,7 +217,7 @@ LoadNestedProjects(
             /*
              * Load the project.
              */
-            pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(filesystem, projectPath);
+            pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(filesystem, projectPath, projectCache);
             if (project != nullptr) {
                 nestedProjects.push_back(project);
             }
@@ -232,7 +233,7 @@ LoadNestedProjects(
         /*
          * Load nested projects of the nested projects.
          */
-        LoadNestedProjects(filesystem, projects, configs, baseEnvironment, nestedProjects);
+        LoadNestedProjects(filesystem, projectCache, projects, configs, baseEnvironment, nestedProjects);
     }
 }
 
@@ -265,7 +266,7 @@ CreateProjectMap(std::vector<pbxproj::PBX::Project::shared_ptr> const &projects)
 }
 
 WorkspaceContext WorkspaceContext::
-Workspace(Filesystem const *filesystem, std::string const &userName, pbxsetting::Environment const &baseEnvironment, xcworkspace::XC::Workspace::shared_ptr const &workspace)
+Workspace(Filesystem const *filesystem, std::string const &userName, pbxsetting::Environment const &baseEnvironment, xcworkspace::XC::Workspace::shared_ptr const &workspace, pbxproj::ProjectCache *projectCache)
 {
     std::vector<pbxproj::PBX::Project::shared_ptr> projects;
     std::vector<xcscheme::SchemeGroup::shared_ptr> schemeGroups;
@@ -282,12 +283,12 @@ Workspace(Filesystem const *filesystem, std::string const &userName, pbxsetting:
     /*
      * Load projects within the workspace.
      */
-    LoadWorkspaceProjects(filesystem, &projects, workspace);
+    LoadWorkspaceProjects(filesystem, projectCache, &projects, workspace);
 
     /*
      * Recursively load nested projects within those projects.
      */
-    LoadNestedProjects(filesystem, &projects, &configs, baseEnvironment, projects);
+    LoadNestedProjects(filesystem, projectCache, &projects, &configs, baseEnvironment, projects);
 
     /*
      * Load schemes for all projects, including nested projects.
@@ -303,7 +304,7 @@ Workspace(Filesystem const *filesystem, std::string const &userName, pbxsetting:
 }
 
 WorkspaceContext WorkspaceContext::
-Project(Filesystem const *filesystem, std::string const &userName, pbxsetting::Environment const &baseEnvironment, pbxproj::PBX::Project::shared_ptr const &project)
+Project(Filesystem const *filesystem, std::string const &userName, pbxsetting::Environment const &baseEnvironment, pbxproj::PBX::Project::shared_ptr const &project, pbxproj::ProjectCache *projectCache)
 {
     std::vector<pbxproj::PBX::Project::shared_ptr> projects;
     std::vector<xcscheme::SchemeGroup::shared_ptr> schemeGroups;
@@ -317,7 +318,7 @@ Project(Filesystem const *filesystem, std::string const &userName, pbxsetting::E
     /*
      * Recursively load nested projects within the project.
      */
-    LoadNestedProjects(filesystem, &projects, &configs, baseEnvironment, projects);
+    LoadNestedProjects(filesystem, projectCache, &projects, &configs, baseEnvironment, projects);
 
     /*
      * Load schemes for all projects, including the root and nested projects.
@@ -0,0 +1,65 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/Tool/CopyResolver.h>
+#include <pbxbuild/Tool/Context.h>
+#include <pbxbuild/Tool/Input.h>
+#include <pbxbuild/Tool/SearchPaths.h>
+#include <pbxspec/Manager.h>
+#include <pbxsetting/Environment.h>
+#include <pbxsetting/Level.h>
+#include <pbxsetting/Setting.h>
+#include <libutil/DefaultFilesystem.h>
+
+#include <algorithm>
+
+namespace Tool = pbxbuild::Tool;
+
+/*
+ * Resolve a copy of one file with the copy tool from the specifications.
+ */
+static std::vector<std::string>
+CopyArguments(std::vector<pbxsetting::Setting> const &settings)
+{
+    libutil::DefaultFilesystem filesystem;
+    auto manager = pbxspec::Manager::Create();
+    manager->registerDomains(&filesystem, { { "default", SPECIFICATIONS_PATH "/Tool/com.apple.compilers.pbxcp.xcspec" } });
+
+    std::unique_ptr<Tool::CopyResolver> resolver = Tool::CopyResolver::Create(manager, { "default" });
+    if (resolver == nullptr) {
+        return std::vector<std::string>();
+    }
+
+    pbxsetting::Environment environment;
+    environment.insertBack(pbxsetting::Level(settings), false);
+
+    Tool::SearchPaths searchPaths = Tool::SearchPaths({ }, { }, { }, { });
+    Tool::Context toolContext = Tool::Context(nullptr, { }, "/", searchPaths);
+    resolver->resolve(&toolContext, environment, { Tool::Input("/input/image.png", nullptr) }, "/output", "Copy");
+    if (toolContext.invocations().size() != 1) {
+        return std::vector<std::string>();
+    }
+
+    return toolContext.invocations().front().arguments();
+}
+
+TEST(CopyResolver, CompressPNGFiles)
+{
+    std::vector<std::string> compressed = CopyArguments({
+        pbxsetting::Setting::Create("COMPRESS_PNG_FILES", "YES"),
+    });
+    ASSERT_FALSE(compressed.empty());
+    EXPECT_NE(compressed.end(), std::find(compressed.begin(), compressed.end(), "-compress-pngs"));
+
+    std::vector<std::string> uncompressed = CopyArguments({
+        pbxsetting::Setting::Create("COMPRESS_PNG_FILES", "NO"),
+    });
+    ASSERT_FALSE(uncompressed.empty());
+    EXPECT_EQ(uncompressed.end(), std::find(uncompressed.begin(), uncompressed.end(), "-compress-pngs"));
+}
@@ -0,0 +1,59 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/HeaderMap.h>
+
+using pbxbuild::HeaderMap;
+
+TEST(HeaderMap, Add)
+{
+    HeaderMap hmap;
+    for (size_t n = 0; n < 100; n++) {
+        std::string name = "Header" + std::to_string(n) + ".h";
+        EXPECT_TRUE(hmap.add(name, "/include/", name));
+    }
+
+    /* Keys are case-insensitive, and the first one added is kept. */
+    EXPECT_FALSE(hmap.add("header1.h", "/other/", "header1.h"));
+
+    std::string prefix;
+    std::string suffix;
+    for (size_t n = 0; n < 100; n++) {
+        std::string name = "Header" + std::to_string(n) + ".h";
+        ASSERT_TRUE(hmap.find(name, &prefix, &suffix));
+        EXPECT_EQ("/include/", prefix);
+        EXPECT_EQ(name, suffix);
+    }
+    EXPECT_FALSE(hmap.find("Missing.h", &prefix, &suffix));
+}
+
+TEST(HeaderMap, AddEntries)
+{
+    std::vector<HeaderMap::Entry> entries;
+    for (size_t n = 0; n < 1000; n++) {
+        std::string name = "Module/Header" + std::to_string(n) + ".h";
+        entries.push_back({ name, "/include/", name });
+    }
+    entries.push_back({ "module/header0.h", "/other/", "header0.h" });
+
+    HeaderMap hmap;
+    EXPECT_EQ(1000, hmap.add(entries));
+
+    /* Written header maps read back the same. */
+    HeaderMap read;
+    ASSERT_TRUE(read.read(hmap.write()));
+
+    std::string prefix;
+    std::string suffix;
+    ASSERT_TRUE(read.find("MODULE/HEADER0.H", &prefix, &suffix));
+    EXPECT_EQ("/include/", prefix);
+    EXPECT_EQ("Module/Header0.h", suffix);
+    ASSERT_TRUE(read.find("Module/Header999.h", &prefix, &suffix));
+    EXPECT_EQ("Module/Header999.h", suffix);
+}
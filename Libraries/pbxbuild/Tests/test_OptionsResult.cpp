@@ -8,12 +8,16 @@
 
 #include <gtest/gtest.h>
 #include <pbxbuild/Tool/OptionsResult.h>
+#include <pbxbuild/Tool/Environment.h>
+#include <pbxbuild/Tool/Input.h>
+#include <pbxspec/Manager.h>
 #include <pbxsetting/Environment.h>
 #include <pbxsetting/Level.h>
 #include <pbxsetting/Setting.h>
 #include <plist/Dictionary.h>
 #include <plist/Format/ASCII.h>
 #include <plist/Format/Encoding.h>
+#include <libutil/MemoryFilesystem.h>
 
 namespace Tool = pbxbuild::Tool;
 
@@ -651,3 +655,94 @@ Unsupported:
 
 */
 
+
+/*
+ * Test that cached options give the same results as evaluating them each
+ * time, both for the first input and for later inputs reusing the cache.
+ */
+TEST(OptionsCache, SameAsCreate)
+{
+    std::string spec = R"spec({
+        Type = Tool;
+        Identifier = "com.test.tool";
+        Options = (
+            {
+                Name = INDEPENDENT;
+                Type = String;
+                CommandLineFlag = "-independent";
+            },
+            {
+                Name = DIRECT;
+                Type = String;
+                CommandLineArgs = ( "-direct", "$(value)-$(InputFileBase)" );
+            },
+            {
+                Name = INDIRECT;
+                Type = String;
+                CommandLineFlag = "-indirect";
+            },
+            {
+                Name = CONDITIONAL;
+                Type = Boolean;
+                CommandLineFlag = "-conditional";
+                Condition = "$(InputFileSuffix) == .c";
+            },
+            {
+                Name = VARIABLE;
+                Type = String;
+                SetValueInEnvironmentVariable = "VARIABLE";
+            },
+            {
+                Name = LINKED;
+                Type = Boolean;
+                AdditionalLinkerArgs = { YES = ( "-linked", "$(OutputFileBase)" ); };
+            },
+        );
+    })spec";
+
+    auto filesystem = libutil::MemoryFilesystem({
+        libutil::MemoryFilesystem::Entry::Directory("specs", {
+            libutil::MemoryFilesystem::Entry::File("Test.xcspec", std::vector<uint8_t>(spec.begin(), spec.end())),
+        }),
+    });
+
+    auto manager = pbxspec::Manager::Create();
+    manager->registerDomains(&filesystem, { { "test", filesystem.path("specs") } });
+    auto tool = manager->tool("com.test.tool", { "test" });
+    ASSERT_NE(nullptr, tool);
+
+    auto environment = Environment({
+        pbxsetting::Setting::Create("INDEPENDENT", "value"),
+        pbxsetting::Setting::Create("DIRECT", "direct"),
+        pbxsetting::Setting::Parse("INDIRECT", "$(INDIRECT_NAME)"),
+        pbxsetting::Setting::Parse("INDIRECT_NAME", "$(InputFileName)"),
+        pbxsetting::Setting::Create("CONDITIONAL", "YES"),
+        pbxsetting::Setting::Parse("VARIABLE", "$(InputFileBase).variable"),
+        pbxsetting::Setting::Create("LINKED", "YES"),
+    });
+
+    /* Relative input paths need an absolute working directory. */
+    std::string workingDirectory = "/";
+
+    Tool::OptionsCache cache;
+    for (std::string const &input : std::vector<std::string>({ "/one.c", "/two.m" })) {
+        /* Inputs after the first reuse the cached options for the tool. */
+        auto toolEnvironment = Tool::Environment::Create(tool, environment, workingDirectory, { Tool::Input(input, FileType) }, { input + ".o" });
+        auto created = Tool::OptionsResult::Create(toolEnvironment, workingDirectory, FileType);
+        auto cached = cache.create(toolEnvironment, workingDirectory, FileType);
+
+        EXPECT_EQ(created.arguments(), cached.arguments());
+        EXPECT_EQ(created.environment(), cached.environment());
+        EXPECT_EQ(created.linkerArgs(), cached.linkerArgs());
+    }
+
+    auto toolEnvironment = Tool::Environment::Create(tool, environment, workingDirectory, { Tool::Input("/two.m", FileType) }, { "/two.m.o" });
+    auto cached = cache.create(toolEnvironment, workingDirectory, FileType);
+    EXPECT_EQ(cached.arguments(), std::vector<std::string>({
+        "-independent", "value",
+        "-direct", "direct-two",
+        "-indirect", "two.m",
+    }));
+    EXPECT_EQ("two.variable", cached.environment().at("VARIABLE"));
+    EXPECT_EQ(cached.linkerArgs(), std::vector<std::string>({ "-linked", "two.m" }));
+}
@@ -0,0 +1,73 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/Tool/ScriptEnvironment.h>
+#include <pbxsetting/Environment.h>
+
+namespace Tool = pbxbuild::Tool;
+using pbxsetting::Environment;
+using pbxsetting::Level;
+using pbxsetting::Setting;
+
+TEST(ScriptEnvironment, Overlay)
+{
+    Environment environment;
+    environment.insertBack(Level({
+        Setting::Parse("INPUT_NAME", "$(INPUT_FILE_PATH:file)"),
+        Setting::Parse("GENERATED", "$(DERIVED_FILE_DIR)/$(INPUT_NAME)"),
+        Setting::Parse("DERIVED_FILE_DIR", "/derived"),
+        Setting::Parse("UNRELATED", "value"),
+    }), false);
+
+    Tool::ScriptEnvironment scriptEnvironment = Tool::ScriptEnvironment(environment);
+    EXPECT_EQ("/derived/", scriptEnvironment.values()->at("GENERATED"));
+
+    Level level = Level({
+        Setting::Create("INPUT_FILE_PATH", "/source/file.txt"),
+    });
+    Environment inputEnvironment = Environment(environment);
+    inputEnvironment.insertFront(level, false);
+
+    /* Only the added settings and the settings using them are in the overlay. */
+    std::unordered_map<std::string, std::string> overlay = scriptEnvironment.overlay(inputEnvironment, { level });
+    EXPECT_EQ(3, overlay.size());
+    EXPECT_EQ("/source/file.txt", overlay["INPUT_FILE_PATH"]);
+    EXPECT_EQ("file.txt", overlay["INPUT_NAME"]);
+    EXPECT_EQ("/derived/file.txt", overlay["GENERATED"]);
+
+    /* Combined with the shared values, the same as resolving everything. */
+    std::unordered_map<std::string, std::string> combined = overlay;
+    combined.insert(scriptEnvironment.values()->begin(), scriptEnvironment.values()->end());
+    EXPECT_EQ(inputEnvironment.computeValues(pbxsetting::Condition::Empty()), combined);
+}
+
+TEST(ScriptEnvironment, Digest)
+{
+    Environment environment;
+    environment.insertBack(Level({
+        Setting::Create("A", "1"),
+        Setting::Create("B", "2"),
+    }), false);
+
+    Environment changed;
+    changed.insertBack(Level({
+        Setting::Create("A", "1"),
+        Setting::Create("B", "3"),
+    }), false);
+
+    Tool::ScriptEnvironment scriptEnvironment = Tool::ScriptEnvironment(environment);
+    std::string digest = scriptEnvironment.digest({ { "C", "4" } }, "script");
+
+    /* Stable for the same inputs, but not for any change to them. */
+    EXPECT_EQ(digest, Tool::ScriptEnvironment(environment).digest({ { "C", "4" } }, "script"));
+    EXPECT_NE(digest, Tool::ScriptEnvironment(changed).digest({ { "C", "4" } }, "script"));
+    EXPECT_NE(digest, scriptEnvironment.digest({ { "C", "5" } }, "script"));
+    EXPECT_NE(digest, scriptEnvironment.digest({ { "C4", "" } }, "script"));
+    EXPECT_NE(digest, scriptEnvironment.digest({ { "C", "4" } }, "other"));
+}
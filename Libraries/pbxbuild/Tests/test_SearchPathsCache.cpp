@@ -0,0 +1,73 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxbuild/Tool/SearchPathsCache.h>
+#include <libutil/MemoryFilesystem.h>
+
+namespace Tool = pbxbuild::Tool;
+using libutil::MemoryFilesystem;
+
+static MemoryFilesystem
+Filesystem()
+{
+    return MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("root", {
+            MemoryFilesystem::Entry::File("header.h", { }),
+            MemoryFilesystem::Entry::Directory("include", {
+                MemoryFilesystem::Entry::Directory("nested", {
+                    MemoryFilesystem::Entry::Directory("deep", { }),
+                }),
+            }),
+            MemoryFilesystem::Entry::Directory("Base.lproj", {
+                MemoryFilesystem::Entry::Directory("hidden", { }),
+            }),
+            MemoryFilesystem::Entry::Directory("Kept.framework", {
+                MemoryFilesystem::Entry::Directory("Headers", { }),
+            }),
+            MemoryFilesystem::Entry::Directory(".git", { }),
+        }),
+    });
+}
+
+TEST(SearchPathsCache, FindSubdirectories)
+{
+    MemoryFilesystem filesystem = Filesystem();
+    std::string root = filesystem.path("root");
+
+    /*
+     * Without patterns, all directories are found. The order decides which
+     * headers shadow others: a directory's subdirectories come first, then
+     * each of them is searched completely before the next.
+     */
+    EXPECT_EQ(std::vector<std::string>({ "include", "Base.lproj", "Kept.framework", ".git", "include/nested", "include/nested/deep", "Base.lproj/hidden", "Kept.framework/Headers" }),
+        Tool::SearchPathsCache::FindSubdirectories(&filesystem, root, { }, { }));
+
+    /* Excluded directories are skipped along with their contents, unless included. */
+    EXPECT_EQ(std::vector<std::string>({ "include", "Kept.framework", "include/nested", "include/nested/deep", "Kept.framework/Headers" }),
+        Tool::SearchPathsCache::FindSubdirectories(&filesystem, root, { "*.lproj", "*.framework", ".git" }, { "Kept.*" }));
+}
+
+TEST(SearchPathsCache, Subdirectories)
+{
+    MemoryFilesystem filesystem = Filesystem();
+    std::string root = filesystem.path("root");
+
+    Tool::SearchPathsCache cache;
+    auto first = cache.subdirectories(&filesystem, root, { "*.lproj" }, { });
+    EXPECT_EQ(6, first->size());
+
+    /* Later changes are not seen for the same root and patterns. */
+    ASSERT_TRUE(filesystem.createDirectory(root + "/added", false));
+    EXPECT_EQ(first, cache.subdirectories(&filesystem, root, { "*.lproj" }, { }));
+
+    /* Different patterns are cached separately. */
+    auto second = cache.subdirectories(&filesystem, root, { }, { });
+    EXPECT_NE(first, second);
+    EXPECT_EQ(9, second->size());
+}
@@ -35,6 +35,7 @@ public:
 
 protected:
     bool parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::string> *seen, bool check) override;
+    void archive(Archive &archive) override;
 };
 
 } }
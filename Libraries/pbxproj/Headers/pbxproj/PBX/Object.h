@@ -18,6 +18,7 @@
 
 namespace plist { class Dictionary; }
 namespace pbxproj { class Context; }
+namespace pbxproj { class Archive; }
 
 namespace pbxproj { namespace PBX {
 
@@ -55,6 +56,16 @@ private:
 protected:
     virtual bool parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::string> *seen, bool check);
 
+private:
+    friend class pbxproj::Archive;
+
+protected:
+    /*
+     * Write or read the fields set by parse(), for project snapshots.
+     * Subclasses archive their superclass's fields first.
+     */
+    virtual void archive(Archive &archive);
+
 public:
     template <typename T>
     inline bool isa() const
@@ -14,7 +14,13 @@
 #include <pbxproj/PBX/Target.h>
 #include <pbxproj/XC/ConfigurationList.h>
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+
 namespace libutil { class Filesystem; }
+namespace plist { class Object; }
+namespace pbxproj { class ProjectCache; }
 
 namespace pbxproj { namespace PBX {
 
@@ -62,13 +68,30 @@ private:
     std::string                        _projectRoot;
     std::vector<ProjectReference>      _projectReferences;
     Target::vector                     _targets;
-    FileReference::vector              _fileReferences;
+
+private:
+    mutable std::atomic<bool>          _fileReferencesParsed;
+    mutable FileReference::vector      _fileReferences;
+
+private:
+    std::unique_ptr<plist::Object>     _contents;
+    std::shared_ptr<Context>           _context;
+    mutable std::mutex                 _contextMutex;
 
 public:
     Project();
+    ~Project();
 
 public:
-    static shared_ptr Open(libutil::Filesystem const *filesystem, std::string const &path);
+    /*
+     * Open the project at a path. If a cache is provided, the project file
+     * is loaded from a snapshot when unchanged, and a snapshot is stored
+     * when it has to be parsed.
+     */
+    static shared_ptr Open(libutil::Filesystem const *filesystem, std::string const &path, ProjectCache *cache = nullptr);
+
+private:
+    void setPaths(std::string const &dataFile);
 
 public:
     inline XC::ConfigurationList::shared_ptr const &buildConfigurationList() const
@@ -131,8 +154,11 @@ protected:
     { _blueprints[object->blueprintIdentifier()] = object; }
 
 public:
-    inline FileReference::vector const &fileReferences() const
-    { return _fileReferences; }
+    /*
+     * All file references in the project, including those only used by
+     * build files. This parses the build phases of every target.
+     */
+    FileReference::vector const &fileReferences() const;
 
 public:
     inline Object::shared_ptr resolveBuildableReference(std::string const &blueprintIdentifier) const
@@ -150,8 +176,18 @@ public:
 public:
     pbxsetting::Level settings(void) const;
 
+protected:
+    friend class Target;
+    /*
+     * Parse objects that were deferred when the project was opened, using
+     * the retained project file. Parses are serialized, so objects shared
+     * between targets are only parsed once.
+     */
+    void parseDeferred(std::function<void(Context &)> const &parse) const;
+
 protected:
     bool parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::string> *seen, bool check) override;
+    void archive(Archive &archive) override;
 
 public:
     static inline char const *Isa()
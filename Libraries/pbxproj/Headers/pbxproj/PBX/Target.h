@@ -14,6 +14,8 @@
 #include <pbxproj/PBX/BuildPhase.h>
 #include <pbxproj/PBX/TargetDependency.h>
 
+#include <atomic>
+
 namespace pbxproj { namespace PBX {
 
 class Project;
@@ -40,9 +42,14 @@ private:
     std::string                       _name;
     std::string                       _productName;
     XC::ConfigurationList::shared_ptr _buildConfigurationList;
-    PBX::BuildPhase::vector           _buildPhases;
     PBX::TargetDependency::vector     _dependencies;
 
+private:
+    std::vector<std::string>          _buildPhaseIDs;
+    mutable std::atomic<bool>         _buildPhasesParsed;
+    mutable bool                      _buildPhasesValid;
+    mutable PBX::BuildPhase::vector   _buildPhases;
+
 protected:
     Target(std::string const &isa, Type type);
 
@@ -67,8 +74,19 @@ public:
     { return _buildConfigurationList; }
 
 public:
-    inline BuildPhase::vector const &buildPhases() const
-    { return _buildPhases; }
+    /*
+     * Build phases, and the build files in them, are parsed on first use
+     * from the project file retained by the project, so only the targets
+     * a build reaches pay for them. If any phase is invalid, there are
+     * no build phases; use loadBuildPhases() to tell that apart.
+     */
+    BuildPhase::vector const &buildPhases() const;
+
+    /*
+     * Parse the build phases if they haven't been parsed yet. Returns
+     * false if any of them is invalid.
+     */
+    bool loadBuildPhases() const;
 
 public:
     inline TargetDependency::vector const &dependencies() const
@@ -79,6 +97,10 @@ public:
 
 protected:
     bool parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::string> *seen, bool check) override;
+    void archive(Archive &archive) override;
+
+private:
+    bool parseBuildPhases(Context &context) const;
 };
 
 } }
@@ -0,0 +1,72 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __pbxproj_ProjectCache_h
+#define __pbxproj_ProjectCache_h
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libutil { class Filesystem; }
+namespace pbxproj { namespace PBX { class Project; } }
+
+namespace pbxproj {
+
+/*
+ * Stores snapshots of parsed project files, so unchanged projects don't
+ * need to be parsed again. Snapshots hold the objects of the project,
+ * including the build phases of every target, rather than its property
+ * list, so loading one skips both parsing and building the objects.
+ */
+class ProjectCache {
+private:
+    libutil::Filesystem *_filesystem;
+    std::string          _directory;
+
+public:
+    /*
+     * Create a cache storing snapshots in a directory. The directory is
+     * created when the first snapshot is stored.
+     */
+    ProjectCache(libutil::Filesystem *filesystem, std::string const &directory);
+
+public:
+    /*
+     * The directory snapshots are stored in.
+     */
+    std::string const &directory() const
+    { return _directory; }
+
+public:
+    /*
+     * Path to the snapshot for a project file.
+     */
+    std::string snapshotPath(std::string const &path) const;
+
+public:
+    /*
+     * Load the project parsed from a project file. Fails unless a snapshot
+     * was stored for the file with the same size, modification time and
+     * contents, from the same version of the snapshot format. The paths of
+     * the loaded project are not set.
+     */
+    std::shared_ptr<PBX::Project>
+    load(std::string const &path, std::vector<uint8_t> const &contents) const;
+
+    /*
+     * Store a snapshot of the project parsed from a project file. Fails if
+     * any of the project's build phases are invalid.
+     */
+    bool
+    store(std::string const &path, std::vector<uint8_t> const &contents, std::shared_ptr<PBX::Project> const &project);
+};
+
+}
+
+#endif // !__pbxproj_ProjectCache_h
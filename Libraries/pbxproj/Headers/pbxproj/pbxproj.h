@@ -28,4 +28,6 @@
 #include <pbxproj/XC/ConfigurationList.h>
 #include <pbxproj/XC/VersionGroup.h>
 
+#include <pbxproj/ProjectCache.h>
+
 #endif  // !__pbxproj_pbxproj_h
@@ -0,0 +1,215 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef __pbxproj_Archive_h
+#define __pbxproj_Archive_h
+
+#include <pbxproj/PBX/Object.h>
+#include <pbxsetting/Level.h>
+#include <pbxsetting/Value.h>
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace pbxproj {
+
+namespace PBX {
+
+class Project;
+class GroupItem;
+class BuildPhase;
+class Target;
+
+}
+
+/*
+ * Whether an object read from an archive can be referred to as a T.
+ * Classes that are only used through their subclasses are matched by
+ * the specializations below.
+ */
+template <typename T>
+struct ArchiveIsa {
+    static inline bool Match(PBX::Object const *object)
+    { return object->isa <T> (); }
+};
+
+template <>
+struct ArchiveIsa <PBX::Object> {
+    static inline bool Match(PBX::Object const *object)
+    { return true; }
+};
+
+template <>
+struct ArchiveIsa <PBX::GroupItem> {
+    static bool Match(PBX::Object const *object);
+};
+
+template <>
+struct ArchiveIsa <PBX::BuildPhase> {
+    static bool Match(PBX::Object const *object);
+};
+
+template <>
+struct ArchiveIsa <PBX::Target> {
+    static bool Match(PBX::Object const *object);
+};
+
+/*
+ * Writes or reads the object graph of a project. Each object archives
+ * its own fields in `PBX::Object::archive()`, making the same calls to
+ * write and to read, so the two can't disagree.
+ *
+ * An archive starts with a table of strings, then a table with the
+ * class and identifier of each object, then the fields of each object.
+ * Reading creates every object from the table before reading any
+ * fields, so references between objects, which are written as indexes
+ * into the table, resolve as they are read. Strings are written once
+ * and referred to by index.
+ */
+class Archive {
+private:
+    struct StringReference {
+        char const *data;
+        uint32_t    size;
+    };
+
+private:
+    bool                                               _reading;
+    bool                                               _valid;
+    std::shared_ptr<PBX::Project>                      _project;
+    std::vector<PBX::Object::shared_ptr>               _objects;
+
+private:
+    std::vector<uint8_t>                               _fields;
+    std::unordered_map<PBX::Object const *, uint32_t>  _objectIndexes;
+    std::unordered_map<std::string, uint32_t>          _stringIndexes;
+    std::vector<std::string const *>                   _strings;
+
+private:
+    uint8_t const                                     *_current;
+    uint8_t const                                     *_end;
+    std::vector<StringReference>                       _stringReferences;
+
+private:
+    explicit Archive(bool reading);
+
+public:
+    /*
+     * If this archive is reading objects, rather than writing them.
+     */
+    inline bool reading() const
+    { return _reading; }
+
+    /*
+     * The project being written or read.
+     */
+    inline std::shared_ptr<PBX::Project> const &project() const
+    { return _project; }
+
+    /*
+     * Mark the archive as failed. Nothing is written, and nothing read
+     * from it is used.
+     */
+    inline void invalidate()
+    { _valid = false; }
+
+public:
+    void value(bool *value);
+    void value(uint32_t *value);
+    void value(std::string *value);
+    void value(std::vector<std::string> *value);
+    void value(pbxsetting::Value *value);
+    void value(std::vector<pbxsetting::Value> *value);
+    void value(pbxsetting::Level *value);
+
+    template <typename T>
+    inline typename std::enable_if<std::is_enum<T>::value>::type
+    value(T *value)
+    {
+        uint32_t raw = static_cast<uint32_t>(*value);
+        this->value(&raw);
+        *value = static_cast<T>(raw);
+    }
+
+public:
+    /*
+     * The number of items in a list. Reading fails if there aren't
+     * enough bytes left for that many items.
+     */
+    void size(size_t *size);
+
+public:
+    template <typename T>
+    inline void object(std::shared_ptr<T> *object)
+    {
+        if (_reading) {
+            PBX::Object::shared_ptr const &read = readObject();
+            if (read != nullptr && !ArchiveIsa <T> ::Match(read.get())) {
+                _valid = false;
+                object->reset();
+            } else {
+                *object = std::static_pointer_cast <T> (read);
+            }
+        } else {
+            writeObject(*object);
+        }
+    }
+
+    template <typename T>
+    inline void objects(std::vector<std::shared_ptr<T>> *objects)
+    {
+        size_t size = objects->size();
+        this->size(&size);
+
+        if (_reading) {
+            objects->clear();
+            for (size_t n = 0; n < size && _valid; n++) {
+                std::shared_ptr<T> object;
+                this->object(&object);
+                objects->push_back(object);
+            }
+        } else {
+            for (std::shared_ptr<T> &object : *objects) {
+                this->object(&object);
+            }
+        }
+    }
+
+private:
+    uint8_t read8();
+    uint32_t read32();
+    void write8(uint8_t value);
+    void write32(uint32_t value);
+
+private:
+    PBX::Object::shared_ptr const &readObject();
+    void writeObject(PBX::Object::shared_ptr const &object);
+    uint32_t writeString(std::string const &string);
+
+public:
+    /*
+     * Write the object graph of a project, parsing anything that was
+     * deferred when the project was opened. Fails if any of it is invalid.
+     */
+    static bool
+    Write(std::shared_ptr<PBX::Project> const &project, std::vector<uint8_t> *contents);
+
+    /*
+     * Read the object graph of a project. Fails if the contents are not
+     * an archive written by Write().
+     */
+    static std::shared_ptr<PBX::Project>
+    Read(std::vector<uint8_t> const &contents);
+};
+
+}
+
+#endif  // !__pbxproj_Archive_h
@@ -67,9 +67,10 @@ public:
     plist::Dictionary const *objects;
 
     //
-    // The main project
+    // The main project. Not owned, as the project keeps its context to
+    // parse objects on first use.
     //
-    std::shared_ptr<PBX::Project> project;
+    std::weak_ptr<PBX::Project> project;
 
     //
     // Cached values
@@ -102,12 +103,11 @@ public:
 public:
     Context()
     {
-        project = nullptr;
     }
 
     inline void clear()
     {
-        project = nullptr;
+        project.reset();
         projects.clear();
         fileReferences.clear();
         referenceProxies.clear();
@@ -0,0 +1,543 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <pbxproj/Archive.h>
+#include <pbxproj/PBX/AggregateTarget.h>
+#include <pbxproj/PBX/BuildFile.h>
+#include <pbxproj/PBX/BuildPhases.h>
+#include <pbxproj/PBX/BuildRule.h>
+#include <pbxproj/PBX/ContainerItemProxy.h>
+#include <pbxproj/PBX/FileReference.h>
+#include <pbxproj/PBX/Group.h>
+#include <pbxproj/PBX/LegacyTarget.h>
+#include <pbxproj/PBX/NativeTarget.h>
+#include <pbxproj/PBX/Project.h>
+#include <pbxproj/PBX/ReferenceProxy.h>
+#include <pbxproj/PBX/TargetDependency.h>
+#include <pbxproj/PBX/VariantGroup.h>
+#include <pbxproj/XC/BuildConfiguration.h>
+#include <pbxproj/XC/ConfigurationList.h>
+#include <pbxproj/XC/VersionGroup.h>
+
+#include <algorithm>
+
+using pbxproj::Archive;
+using pbxproj::ArchiveIsa;
+namespace PBX = pbxproj::PBX;
+namespace XC = pbxproj::XC;
+
+bool ArchiveIsa <PBX::GroupItem> ::
+Match(PBX::Object const *object)
+{
+    return (object->isa <PBX::Group> () ||
+            object->isa <PBX::VariantGroup> () ||
+            object->isa <XC::VersionGroup> () ||
+            object->isa <PBX::FileReference> () ||
+            object->isa <PBX::ReferenceProxy> ());
+}
+
+bool ArchiveIsa <PBX::BuildPhase> ::
+Match(PBX::Object const *object)
+{
+    return (object->isa <PBX::HeadersBuildPhase> () ||
+            object->isa <PBX::SourcesBuildPhase> () ||
+            object->isa <PBX::ResourcesBuildPhase> () ||
+            object->isa <PBX::FrameworksBuildPhase> () ||
+            object->isa <PBX::CopyFilesBuildPhase> () ||
+            object->isa <PBX::ShellScriptBuildPhase> () ||
+            object->isa <PBX::AppleScriptBuildPhase> () ||
+            object->isa <PBX::RezBuildPhase> ());
+}
+
+bool ArchiveIsa <PBX::Target> ::
+Match(PBX::Object const *object)
+{
+    return (object->isa <PBX::NativeTarget> () ||
+            object->isa <PBX::LegacyTarget> () ||
+            object->isa <PBX::AggregateTarget> ());
+}
+
+Archive::
+Archive(bool reading) :
+    _reading(reading),
+    _valid  (true),
+    _current(nullptr),
+    _end    (nullptr)
+{
+}
+
+uint8_t Archive::
+read8()
+{
+    if (_end - _current < 1) {
+        _valid = false;
+        return 0;
+    }
+
+    return *_current++;
+}
+
+uint32_t Archive::
+read32()
+{
+    if (_end - _current < 4) {
+        _valid = false;
+        return 0;
+    }
+
+    uint32_t value = 0;
+    for (size_t n = 0; n < 4; n++) {
+        value |= static_cast<uint32_t>(_current[n]) << (n * 8);
+    }
+    _current += 4;
+    return value;
+}
+
+void Archive::
+write8(uint8_t value)
+{
+    _fields.push_back(value);
+}
+
+void Archive::
+write32(uint32_t value)
+{
+    for (size_t n = 0; n < 4; n++) {
+        _fields.push_back(static_cast<uint8_t>(value >> (n * 8)));
+    }
+}
+
+void Archive::
+value(bool *value)
+{
+    if (_reading) {
+        *value = (read8() != 0);
+    } else {
+        write8(*value ? 1 : 0);
+    }
+}
+
+void Archive::
+value(uint32_t *value)
+{
+    if (_reading) {
+        *value = read32();
+    } else {
+        write32(*value);
+    }
+}
+
+uint32_t Archive::
+writeString(std::string const &string)
+{
+    auto I = _stringIndexes.insert({ string, static_cast<uint32_t>(_strings.size()) });
+    if (I.second) {
+        /* Keys aren't moved when the map grows. */
+        _strings.push_back(&I.first->first);
+    }
+    return I.first->second;
+}
+
+void Archive::
+value(std::string *value)
+{
+    if (_reading) {
+        uint32_t index = read32();
+        if (index >= _stringReferences.size()) {
+            _valid = false;
+            return;
+        }
+
+        StringReference const &reference = _stringReferences[index];
+        value->assign(reference.data, reference.size);
+    } else {
+        write32(writeString(*value));
+    }
+}
+
+void Archive::
+value(std::vector<std::string> *value)
+{
+    size_t size = value->size();
+    this->size(&size);
+
+    if (_reading) {
+        value->resize(size);
+    }
+
+    for (std::string &string : *value) {
+        this->value(&string);
+    }
+}
+
+void Archive::
+value(pbxsetting::Value *value)
+{
+    enum EntryType : uint8_t {
+        EntryTypeString,
+        EntryTypeValue,
+    };
+
+    if (_reading) {
+        size_t size = 0;
+        this->size(&size);
+
+        std::vector<pbxsetting::Value::Entry> entries;
+        for (size_t n = 0; n < size && _valid; n++) {
+            uint8_t type = read8();
+            if (type == EntryTypeString) {
+                std::string string;
+                this->value(&string);
+                entries.push_back(pbxsetting::Value::Entry(string));
+            } else if (type == EntryTypeValue) {
+                pbxsetting::Value nested = pbxsetting::Value::Empty();
+                this->value(&nested);
+                entries.push_back(pbxsetting::Value::Entry(std::make_shared<pbxsetting::Value>(nested)));
+            } else {
+                _valid = false;
+            }
+        }
+
+        *value = pbxsetting::Value(entries);
+    } else {
+        /* Written as the parsed entries: the raw string can't represent every value. */
+        size_t size = value->entries().size();
+        this->size(&size);
+
+        for (pbxsetting::Value::Entry const &entry : value->entries()) {
+            switch (entry.type()) {
+                case pbxsetting::Value::Entry::Type::String: {
+                    write8(EntryTypeString);
+                    write32(writeString(*entry.string()));
+                    break;
+                }
+                case pbxsetting::Value::Entry::Type::Value: {
+                    write8(EntryTypeValue);
+                    pbxsetting::Value nested = *entry.value();
+                    this->value(&nested);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void Archive::
+value(std::vector<pbxsetting::Value> *value)
+{
+    size_t size = value->size();
+    this->size(&size);
+
+    if (_reading) {
+        value->clear();
+        for (size_t n = 0; n < size && _valid; n++) {
+            pbxsetting::Value entry = pbxsetting::Value::Empty();
+            this->value(&entry);
+            value->push_back(entry);
+        }
+    } else {
+        for (pbxsetting::Value &entry : *value) {
+            this->value(&entry);
+        }
+    }
+}
+
+void Archive::
+value(pbxsetting::Level *value)
+{
+    if (_reading) {
+        size_t size = 0;
+        this->size(&size);
+
+        std::vector<pbxsetting::Setting> settings;
+        for (size_t n = 0; n < size && _valid; n++) {
+            std::string name;
+            this->value(&name);
+
+            size_t conditions = 0;
+            this->size(&conditions);
+
+            std::unordered_map<std::string, std::string> condition;
+            for (size_t c = 0; c < conditions && _valid; c++) {
+                std::string key;
+                std::string match;
+                this->value(&key);
+                this->value(&match);
+                condition.insert({ key, match });
+            }
+
+            pbxsetting::Value setting = pbxsetting::Value::Empty();
+            this->value(&setting);
+
+            settings.push_back(pbxsetting::Setting(name, pbxsetting::Condition(condition), setting));
+        }
+
+        *value = pbxsetting::Level(settings);
+    } else {
+        size_t size = value->settings().size();
+        this->size(&size);
+
+        for (pbxsetting::Setting const &setting : value->settings()) {
+            write32(writeString(setting.name()));
+
+            /* Sorted, so the same settings are always written the same way. */
+            std::vector<std::pair<std::string, std::string>> conditions = std::vector<std::pair<std::string, std::string>>(
+                setting.condition().values().begin(), setting.condition().values().end());
+            std::sort(conditions.begin(), conditions.end());
+
+            size_t size = conditions.size();
+            this->size(&size);
+
+            for (auto const &condition : conditions) {
+                write32(writeString(condition.first));
+                write32(writeString(condition.second));
+            }
+
+            pbxsetting::Value entry = setting.value();
+            this->value(&entry);
+        }
+    }
+}
+
+void Archive::
+size(size_t *size)
+{
+    if (_reading) {
+        *size = read32();
+
+        /* Every item takes at least a byte. */
+        if (*size > static_cast<size_t>(_end - _current)) {
+            _valid = false;
+            *size = 0;
+        }
+    } else {
+        write32(static_cast<uint32_t>(*size));
+    }
+}
+
+PBX::Object::shared_ptr const &Archive::
+readObject()
+{
+    static PBX::Object::shared_ptr const none = nullptr;
+
+    /* Zero is no object; other objects are offset by one. */
+    uint32_t index = read32();
+    if (index == 0) {
+        return none;
+    } else if (index > _objects.size()) {
+        _valid = false;
+        return none;
+    }
+
+    return _objects[index - 1];
+}
+
+void Archive::
+writeObject(PBX::Object::shared_ptr const &object)
+{
+    if (object == nullptr) {
+        write32(0);
+        return;
+    }
+
+    /* New objects are added to the table, and their fields written later. */
+    auto I = _objectIndexes.insert({ object.get(), static_cast<uint32_t>(_objects.size()) });
+    if (I.second) {
+        _objects.push_back(object);
+    }
+
+    write32(I.first->second + 1);
+}
+
+template <typename T>
+static PBX::Object::shared_ptr
+CreateObject()
+{
+    return std::make_shared <T> ();
+}
+
+typedef PBX::Object::shared_ptr (*ObjectFactory)();
+
+static ObjectFactory
+FindObjectFactory(std::string const &isa)
+{
+    /* Roughly the most common classes first. */
+    if (isa == PBX::BuildFile::Isa()) {
+        return &CreateObject <PBX::BuildFile>;
+    } else if (isa == PBX::FileReference::Isa()) {
+        return &CreateObject <PBX::FileReference>;
+    } else if (isa == PBX::Group::Isa()) {
+        return &CreateObject <PBX::Group>;
+    } else if (isa == PBX::VariantGroup::Isa()) {
+        return &CreateObject <PBX::VariantGroup>;
+    } else if (isa == XC::VersionGroup::Isa()) {
+        return &CreateObject <XC::VersionGroup>;
+    } else if (isa == PBX::ReferenceProxy::Isa()) {
+        return &CreateObject <PBX::ReferenceProxy>;
+    } else if (isa == PBX::ContainerItemProxy::Isa()) {
+        return &CreateObject <PBX::ContainerItemProxy>;
+    } else if (isa == PBX::TargetDependency::Isa()) {
+        return &CreateObject <PBX::TargetDependency>;
+    } else if (isa == PBX::BuildRule::Isa()) {
+        return &CreateObject <PBX::BuildRule>;
+    } else if (isa == XC::BuildConfiguration::Isa()) {
+        return &CreateObject <XC::BuildConfiguration>;
+    } else if (isa == XC::ConfigurationList::Isa()) {
+        return &CreateObject <XC::ConfigurationList>;
+    } else if (isa == PBX::HeadersBuildPhase::Isa()) {
+        return &CreateObject <PBX::HeadersBuildPhase>;
+    } else if (isa == PBX::SourcesBuildPhase::Isa()) {
+        return &CreateObject <PBX::SourcesBuildPhase>;
+    } else if (isa == PBX::ResourcesBuildPhase::Isa()) {
+        return &CreateObject <PBX::ResourcesBuildPhase>;
+    } else if (isa == PBX::FrameworksBuildPhase::Isa()) {
+        return &CreateObject <PBX::FrameworksBuildPhase>;
+    } else if (isa == PBX::CopyFilesBuildPhase::Isa()) {
+        return &CreateObject <PBX::CopyFilesBuildPhase>;
+    } else if (isa == PBX::ShellScriptBuildPhase::Isa()) {
+        return &CreateObject <PBX::ShellScriptBuildPhase>;
+    } else if (isa == PBX::AppleScriptBuildPhase::Isa()) {
+        return &CreateObject <PBX::AppleScriptBuildPhase>;
+    } else if (isa == PBX::RezBuildPhase::Isa()) {
+        return &CreateObject <PBX::RezBuildPhase>;
+    } else if (isa == PBX::NativeTarget::Isa()) {
+        return &CreateObject <PBX::NativeTarget>;
+    } else if (isa == PBX::LegacyTarget::Isa()) {
+        return &CreateObject <PBX::LegacyTarget>;
+    } else if (isa == PBX::AggregateTarget::Isa()) {
+        return &CreateObject <PBX::AggregateTarget>;
+    } else if (isa == PBX::Project::Isa()) {
+        return &CreateObject <PBX::Project>;
+    } else {
+        return nullptr;
+    }
+}
+
+bool Archive::
+Write(std::shared_ptr<PBX::Project> const &project, std::vector<uint8_t> *contents)
+{
+    Archive archive = Archive(false);
+    archive._project = project;
+
+    /*
+     * Write the fields of each object. Objects they refer to are added
+     * to the table as they are found, so this reaches the whole graph.
+     */
+    archive._objectIndexes.insert({ project.get(), 0 });
+    archive._objects.push_back(project);
+    for (size_t n = 0; n < archive._objects.size(); n++) {
+        archive._objects[n]->archive(archive);
+        if (!archive._valid) {
+            return false;
+        }
+    }
+
+    /*
+     * The object table refers to strings too, so build it before the
+     * string table it's written after.
+     */
+    std::vector<uint8_t> fields = std::move(archive._fields);
+    archive._fields.clear();
+
+    archive.write32(static_cast<uint32_t>(archive._objects.size()));
+    for (PBX::Object::shared_ptr const &object : archive._objects) {
+        archive.write32(archive.writeString(object->isa()));
+        archive.write32(archive.writeString(object->blueprintIdentifier()));
+    }
+    std::vector<uint8_t> objects = std::move(archive._fields);
+    archive._fields.clear();
+
+    archive.write32(static_cast<uint32_t>(archive._strings.size()));
+    for (std::string const *string : archive._strings) {
+        archive.write32(static_cast<uint32_t>(string->size()));
+        archive._fields.insert(archive._fields.end(), string->begin(), string->end());
+    }
+
+    *contents = std::move(archive._fields);
+    contents->insert(contents->end(), objects.begin(), objects.end());
+    contents->insert(contents->end(), fields.begin(), fields.end());
+    return true;
+}
+
+std::shared_ptr<PBX::Project> Archive::
+Read(std::vector<uint8_t> const &contents)
+{
+    Archive archive = Archive(true);
+    archive._current = contents.data();
+    archive._end = contents.data() + contents.size();
+
+    /*
+     * Strings are used in place; they're copied into objects as read.
+     */
+    size_t strings = 0;
+    archive.size(&strings);
+    archive._stringReferences.reserve(strings);
+    for (size_t n = 0; n < strings && archive._valid; n++) {
+        uint32_t size = archive.read32();
+        if (size > static_cast<size_t>(archive._end - archive._current)) {
+            return nullptr;
+        }
+
+        archive._stringReferences.push_back({ reinterpret_cast<char const *>(archive._current), size });
+        archive._current += size;
+    }
+
+    /*
+     * Create every object, so references resolve as fields are read.
+     */
+    size_t objects = 0;
+    archive.size(&objects);
+    archive._objects.reserve(objects);
+
+    std::unordered_map<uint32_t, ObjectFactory> factories;
+    std::string isa;
+    std::string blueprintIdentifier;
+    for (size_t n = 0; n < objects && archive._valid; n++) {
+        uint32_t isaIndex = archive.read32();
+        if (isaIndex >= archive._stringReferences.size()) {
+            return nullptr;
+        }
+
+        auto I = factories.find(isaIndex);
+        if (I == factories.end()) {
+            StringReference const &reference = archive._stringReferences[isaIndex];
+            isa.assign(reference.data, reference.size);
+            I = factories.insert({ isaIndex, FindObjectFactory(isa) }).first;
+        }
+        if (I->second == nullptr) {
+            return nullptr;
+        }
+
+        archive.value(&blueprintIdentifier);
+
+        PBX::Object::shared_ptr object = I->second();
+        object->setBlueprintIdentifier(blueprintIdentifier);
+        archive._objects.push_back(object);
+    }
+
+    if (!archive._valid || archive._objects.empty() || !archive._objects.front()->isa <PBX::Project> ()) {
+        return nullptr;
+    }
+    archive._project = std::static_pointer_cast <PBX::Project> (archive._objects.front());
+
+    /*
+     * Read the fields of each object, in the order they were written.
+     */
+    for (PBX::Object::shared_ptr const &object : archive._objects) {
+        object->archive(archive);
+        if (!archive._valid) {
+            return nullptr;
+        }
+    }
+
+    if (archive._current != archive._end) {
+        return nullptr;
+    }
+
+    return archive._project;
+}
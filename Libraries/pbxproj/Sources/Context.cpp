@@ -15,13 +15,15 @@ namespace PBX = pbxproj::PBX;
 void Context::
 cacheObject(PBX::Object::shared_ptr const &O, std::string const &id)
 {
-    if (project == nullptr && O->isa <PBX::Project> ()) {
-        project = std::static_pointer_cast <PBX::Project> (O);
+    std::shared_ptr<PBX::Project> owner = project.lock();
+    if (owner == nullptr && O->isa <PBX::Project> ()) {
+        owner = std::static_pointer_cast <PBX::Project> (O);
+        project = owner;
     }
 
     O->setBlueprintIdentifier(id);
 
-    if (project != nullptr && project != O) {
-        project->cacheObject(O);
+    if (owner != nullptr && owner != O) {
+        owner->cacheObject(O);
     }
 }
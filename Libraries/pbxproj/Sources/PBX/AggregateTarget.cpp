@@ -8,10 +8,12 @@
 
 #include <pbxproj/PBX/AggregateTarget.h>
 #include <pbxproj/PBX/BuildPhases.h>
+#include <pbxproj/Archive.h>
 #include <plist/String.h>
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::AggregateTarget;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 AggregateTarget::
@@ -41,3 +43,11 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void AggregateTarget::
+archive(Archive &archive)
+{
+    Target::archive(archive);
+
+    archive.value(&_productName);
+}
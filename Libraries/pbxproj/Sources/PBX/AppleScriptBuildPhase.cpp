@@ -7,12 +7,14 @@
  */
 
 #include <pbxproj/PBX/AppleScriptBuildPhase.h>
+#include <pbxproj/Archive.h>
 #include <plist/Boolean.h>
 #include <plist/Dictionary.h>
 #include <plist/String.h>
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::AppleScriptBuildPhase;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 AppleScriptBuildPhase::
@@ -47,3 +49,12 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void AppleScriptBuildPhase::
+archive(Archive &archive)
+{
+    BuildPhase::archive(archive);
+
+    archive.value(&_contextName);
+    archive.value(&_isSharedContext);
+}
@@ -13,12 +13,14 @@
 #include <pbxproj/PBX/FileReference.h>
 #include <pbxproj/PBX/ReferenceProxy.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
 #include <plist/Array.h>
 #include <plist/Dictionary.h>
 #include <plist/String.h>
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::BaseGroup;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 BaseGroup::
@@ -98,3 +100,17 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void BaseGroup::
+archive(Archive &archive)
+{
+    GroupItem::archive(archive);
+
+    archive.objects(&_children);
+
+    for (GroupItem::shared_ptr const &child : _children) {
+        if (child != nullptr) {
+            child->_parent = this;
+        }
+    }
+}
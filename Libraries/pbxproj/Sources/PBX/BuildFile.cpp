@@ -13,6 +13,7 @@
 #include <pbxproj/PBX/VariantGroup.h>
 #include <pbxproj/XC/VersionGroup.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
 #include <pbxsetting/Type.h>
 #include <plist/Array.h>
 #include <plist/Dictionary.h>
@@ -20,6 +21,7 @@
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::BuildFile;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 BuildFile::
@@ -92,3 +94,13 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void BuildFile::
+archive(Archive &archive)
+{
+    Object::archive(archive);
+
+    archive.object(&_fileRef);
+    archive.value(&_compilerFlags);
+    archive.value(&_attributes);
+}
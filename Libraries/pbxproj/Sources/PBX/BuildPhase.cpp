@@ -8,6 +8,7 @@
 
 #include <pbxproj/PBX/BuildPhase.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
 #include <plist/Array.h>
 #include <plist/Boolean.h>
 #include <plist/Dictionary.h>
@@ -16,6 +17,7 @@
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::BuildPhase;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 BuildPhase::
@@ -73,3 +75,14 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void BuildPhase::
+archive(Archive &archive)
+{
+    Object::archive(archive);
+
+    archive.value(&_name);
+    archive.objects(&_files);
+    archive.value(&_runOnlyForDeploymentPostprocessing);
+    archive.value(&_buildActionMask);
+}
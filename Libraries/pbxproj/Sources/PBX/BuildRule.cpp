@@ -7,6 +7,7 @@
  */
 
 #include <pbxproj/PBX/BuildRule.h>
+#include <pbxproj/Archive.h>
 #include <plist/Array.h>
 #include <plist/Boolean.h>
 #include <plist/Dictionary.h>
@@ -14,6 +15,7 @@
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::BuildRule;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 BuildRule::BuildRule() :
@@ -72,3 +74,16 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void BuildRule::
+archive(Archive &archive)
+{
+    Object::archive(archive);
+
+    archive.value(&_compilerSpec);
+    archive.value(&_filePatterns);
+    archive.value(&_fileType);
+    archive.value(&_script);
+    archive.value(&_outputFiles);
+    archive.value(&_isEditable);
+}
@@ -8,11 +8,13 @@
 
 #include <pbxproj/PBX/ContainerItemProxy.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
 #include <plist/Integer.h>
 #include <plist/String.h>
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::ContainerItemProxy;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 ContainerItemProxy::
@@ -65,3 +67,14 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void ContainerItemProxy::
+archive(Archive &archive)
+{
+    Object::archive(archive);
+
+    archive.object(&_containerPortal);
+    archive.value(&_proxyType);
+    archive.value(&_remoteGlobalIDString);
+    archive.value(&_remoteInfo);
+}
@@ -7,12 +7,14 @@
  */
 
 #include <pbxproj/PBX/CopyFilesBuildPhase.h>
+#include <pbxproj/Archive.h>
 #include <plist/Dictionary.h>
 #include <plist/Integer.h>
 #include <plist/String.h>
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::CopyFilesBuildPhase;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 CopyFilesBuildPhase::
@@ -49,3 +51,12 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void CopyFilesBuildPhase::
+archive(Archive &archive)
+{
+    BuildPhase::archive(archive);
+
+    archive.value(&_dstPath);
+    archive.value(&_dstSubfolderSpec);
+}
@@ -7,6 +7,7 @@
  */
 
 #include <pbxproj/PBX/FileReference.h>
+#include <pbxproj/Archive.h>
 #include <plist/Boolean.h>
 #include <plist/Dictionary.h>
 #include <plist/Integer.h>
@@ -14,6 +15,7 @@
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::FileReference;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 FileReference::
@@ -71,3 +73,16 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void FileReference::
+archive(Archive &archive)
+{
+    GroupItem::archive(archive);
+
+    archive.value(&_lastKnownFileType);
+    archive.value(&_explicitFileType);
+    archive.value(&_xcLanguageSpecificationIdentifier);
+    archive.value(&_includeInIndex);
+    archive.value(&_fileEncoding);
+    archive.value(&_lineEnding);
+}
@@ -7,11 +7,13 @@
  */
 
 #include <pbxproj/PBX/Group.h>
+#include <pbxproj/Archive.h>
 #include <plist/Dictionary.h>
 #include <plist/Integer.h>
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::Group;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 Group::
@@ -48,3 +50,12 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void Group::
+archive(Archive &archive)
+{
+    BaseGroup::archive(archive);
+
+    archive.value(&_indentWidth);
+    archive.value(&_tabWidth);
+}
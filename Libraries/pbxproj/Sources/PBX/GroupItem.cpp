@@ -7,11 +7,13 @@
  */
 
 #include <pbxproj/PBX/GroupItem.h>
+#include <pbxproj/Archive.h>
 #include <plist/Dictionary.h>
 #include <plist/String.h>
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::GroupItem;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 GroupItem::
@@ -75,3 +77,13 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void GroupItem::
+archive(Archive &archive)
+{
+    Object::archive(archive);
+
+    archive.value(&_name);
+    archive.value(&_path);
+    archive.value(&_sourceTree);
+}
@@ -8,12 +8,14 @@
 
 #include <pbxproj/PBX/LegacyTarget.h>
 #include <pbxproj/PBX/BuildPhases.h>
+#include <pbxproj/Archive.h>
 #include <plist/Dictionary.h>
 #include <plist/Integer.h>
 #include <plist/String.h>
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::LegacyTarget;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 LegacyTarget::
@@ -59,3 +61,14 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void LegacyTarget::
+archive(Archive &archive)
+{
+    Target::archive(archive);
+
+    archive.value(&_buildWorkingDirectory);
+    archive.value(&_buildToolPath);
+    archive.value(&_buildArgumentsString);
+    archive.value(&_passBuildSettingsInEnvironment);
+}
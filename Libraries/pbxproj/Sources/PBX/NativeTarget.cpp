@@ -9,11 +9,13 @@
 #include <pbxproj/PBX/NativeTarget.h>
 #include <pbxproj/PBX/BuildPhases.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
 #include <plist/Array.h>
 #include <plist/String.h>
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::NativeTarget;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 NativeTarget::
@@ -74,3 +76,14 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void NativeTarget::
+archive(Archive &archive)
+{
+    Target::archive(archive);
+
+    archive.value(&_productType);
+    archive.object(&_productReference);
+    archive.value(&_productInstallPath);
+    archive.objects(&_buildRules);
+}
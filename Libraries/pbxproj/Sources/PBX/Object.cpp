@@ -7,12 +7,14 @@
  */
 
 #include <pbxproj/PBX/Object.h>
+#include <pbxproj/Archive.h>
 #include <plist/Dictionary.h>
 #include <plist/String.h>
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::Object;
 using pbxproj::Context;
+using pbxproj::Archive;
 
 Object::
 Object(std::string const &isa) :
@@ -45,3 +47,8 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
     return true;
 }
 
+void Object::
+archive(Archive &archive)
+{
+    /* The class and identifier are written in the archive's object table. */
+}
@@ -11,6 +11,8 @@
 #include <pbxproj/PBX/LegacyTarget.h>
 #include <pbxproj/PBX/NativeTarget.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
+#include <pbxproj/ProjectCache.h>
 #include <plist/Array.h>
 #include <plist/Boolean.h>
 #include <plist/Integer.h>
@@ -21,7 +23,10 @@
 #include <libutil/FSUtil.h>
 #include <process/Context.h>
 
+#include <algorithm>
+
 using pbxproj::PBX::Project;
+using pbxproj::Archive;
 using pbxproj::Context;
 using libutil::Filesystem;
 using libutil::FSUtil;
@@ -29,8 +34,46 @@ using libutil::FSUtil;
 Project::
 Project() :
     Object                 (Isa()),
-    _hasScannedForEncodings(false)
+    _hasScannedForEncodings(false),
+    _fileReferencesParsed  (false)
+{
+}
+
+Project::
+~Project()
+{
+}
+
+void Project::
+parseDeferred(std::function<void(Context &)> const &parse) const
+{
+    std::unique_lock<std::mutex> lock(_contextMutex);
+    if (_context != nullptr) {
+        parse(*_context);
+    }
+}
+
+pbxproj::PBX::FileReference::vector const &Project::
+fileReferences() const
 {
+    if (!_fileReferencesParsed.load(std::memory_order_acquire)) {
+        /* Some file references are only reached from build files. */
+        for (Target::shared_ptr const &target : _targets) {
+            (void)target->loadBuildPhases();
+        }
+
+        parseDeferred([this](Context &context) {
+            if (!_fileReferencesParsed.load(std::memory_order_relaxed)) {
+                _fileReferences.clear();
+                for (auto const &I : context.fileReferences) {
+                    _fileReferences.push_back(I.second);
+                }
+                _fileReferencesParsed.store(true, std::memory_order_release);
+            }
+        });
+    }
+
+    return _fileReferences;
 }
 
 pbxsetting::Level Project::
@@ -183,8 +226,61 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
     return true;
 }
 
+void Project::
+archive(Archive &archive)
+{
+    Object::archive(archive);
+
+    if (!archive.reading()) {
+        /* Parses every target's build phases, so they can be written. */
+        (void)fileReferences();
+    }
+
+    archive.object(&_buildConfigurationList);
+    archive.value(&_compatibilityVersion);
+    archive.value(&_developmentRegion);
+    archive.value(&_hasScannedForEncodings);
+    archive.value(&_knownRegions);
+    archive.object(&_mainGroup);
+    archive.object(&_productRefGroup);
+    archive.value(&_projectDirPath);
+    archive.value(&_projectRoot);
+
+    size_t projectReferences = _projectReferences.size();
+    archive.size(&projectReferences);
+    _projectReferences.resize(projectReferences);
+    for (ProjectReference &projectReference : _projectReferences) {
+        archive.object(&projectReference._productGroup);
+        archive.object(&projectReference._projectReference);
+    }
+
+    archive.objects(&_targets);
+    archive.objects(&_fileReferences);
+
+    /* Written in a stable order, so unchanged projects write the same archive. */
+    Object::vector blueprints;
+    if (!archive.reading()) {
+        for (auto const &entry : _blueprints) {
+            blueprints.push_back(entry.second);
+        }
+        std::sort(blueprints.begin(), blueprints.end(), [](Object::shared_ptr const &a, Object::shared_ptr const &b) {
+            return a->blueprintIdentifier() < b->blueprintIdentifier();
+        });
+    }
+    archive.objects(&blueprints);
+
+    if (archive.reading()) {
+        for (Object::shared_ptr const &object : blueprints) {
+            if (object != nullptr) {
+                cacheObject(object);
+            }
+        }
+        _fileReferencesParsed.store(true, std::memory_order_release);
+    }
+}
+
 Project::shared_ptr Project::
-Open(Filesystem const *filesystem, std::string const &path)
+Open(Filesystem const *filesystem, std::string const &path, ProjectCache *cache)
 {
     if (path.empty()) {
         fprintf(stderr, "error: project path is empty\n");
@@ -209,6 +305,16 @@ Open(Filesystem const *filesystem, std::string const &path)
         return nullptr;
     }
 
+    //
+    // Load the project from a snapshot, if unchanged since it was stored.
+    //
+    if (cache != nullptr) {
+        if (Project::shared_ptr project = cache->load(realPath, contents)) {
+            project->setPaths(realPath);
+            return project;
+        }
+    }
+
     //
     // Parse property list
     //
@@ -218,7 +324,8 @@ Open(Filesystem const *filesystem, std::string const &path)
         return nullptr;
     }
 
-    plist::Dictionary *plist = plist::CastTo<plist::Dictionary>(result.first.get());
+    std::unique_ptr<plist::Object> root = std::move(result.first);
+    plist::Dictionary *plist = plist::CastTo<plist::Dictionary>(root.get());
     if (plist == nullptr) {
         fprintf(stderr, "error: project file %s is not a dictionary\n", projectFileName.c_str());
         return nullptr;
@@ -269,14 +376,14 @@ Open(Filesystem const *filesystem, std::string const &path)
     //
     // Initialize context
     //
-    Context context;
-    context.objects = Os;
+    auto context = std::make_shared<Context>();
+    context->objects = Os;
 
     //
     // Fetch the project dictionary (root object)
     //
     std::string PID;
-    auto P = context.indirect <Project> (&unpack, "rootObject", &PID);
+    auto P = context->indirect <Project> (&unpack, "rootObject", &PID);
     if (P == nullptr) {
         fprintf(stderr, "error: unable to parse project\n");
         return nullptr;
@@ -292,26 +399,44 @@ Open(Filesystem const *filesystem, std::string const &path)
     //
     // Parse the project dictionary and create the project object.
     //
-    auto project = context.parseObject(context.projects, PID, P);
+    auto project = context->parseObject(context->projects, PID, P);
+    if (project == nullptr) {
+        fprintf(stderr, "error: unable to parse project\n");
+        return nullptr;
+    }
 
     //
     // Save some useful info
     //
-    project->_dataFile    = realPath;
-    project->_projectFile = FSUtil::GetDirectoryName(realPath);
-    project->_basePath    = FSUtil::GetDirectoryName(project->_projectFile);
-    project->_name        = FSUtil::GetBaseNameWithoutExtension(project->_projectFile);
+    project->setPaths(realPath);
 
     //
-    // Transfer all file references from cache.
+    // Keep the project file and context for objects parsed on first use.
+    // The context must not own the project, or neither would be freed.
     //
-    for (auto const &I : context.fileReferences) {
-        project->_fileReferences.push_back(I.second);
+    context->projects.clear();
+    project->_contents = std::move(root);
+    project->_context = context;
+
+    //
+    // Store a snapshot, so the project isn't parsed again until it changes.
+    //
+    if (cache != nullptr) {
+        (void)cache->store(realPath, contents, project);
     }
 
     return project;
 }
 
+void Project::
+setPaths(std::string const &dataFile)
+{
+    _dataFile    = dataFile;
+    _projectFile = FSUtil::GetDirectoryName(dataFile);
+    _basePath    = FSUtil::GetDirectoryName(_projectFile);
+    _name        = FSUtil::GetBaseNameWithoutExtension(_projectFile);
+}
+
 Project::ProjectReference::
 ProjectReference()
 {
@@ -8,8 +8,10 @@
 
 #include <pbxproj/PBX/ReferenceProxy.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
 
 using pbxproj::PBX::ReferenceProxy;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 ReferenceProxy::
@@ -49,3 +51,12 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void ReferenceProxy::
+archive(Archive &archive)
+{
+    GroupItem::archive(archive);
+
+    archive.value(&_fileType);
+    archive.object(&_remoteRef);
+}
@@ -7,6 +7,7 @@
  */
 
 #include <pbxproj/PBX/ShellScriptBuildPhase.h>
+#include <pbxproj/Archive.h>
 #include <plist/Array.h>
 #include <plist/Boolean.h>
 #include <plist/Dictionary.h>
@@ -14,6 +15,7 @@
 #include <plist/Keys/Unpack.h>
 
 using pbxproj::PBX::ShellScriptBuildPhase;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 ShellScriptBuildPhase::
@@ -81,3 +83,16 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void ShellScriptBuildPhase::
+archive(Archive &archive)
+{
+    BuildPhase::archive(archive);
+
+    archive.value(&_name);
+    archive.value(&_shellPath);
+    archive.value(&_shellScript);
+    archive.value(&_inputPaths);
+    archive.value(&_outputPaths);
+    archive.value(&_showEnvVarsInLog);
+}
@@ -8,20 +8,27 @@
 
 #include <pbxproj/PBX/Target.h>
 #include <pbxproj/PBX/NativeTarget.h>
+#include <pbxproj/PBX/Project.h>
 #include <pbxproj/PBX/BuildPhases.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
 #include <plist/Array.h>
 #include <plist/Dictionary.h>
 #include <plist/String.h>
 #include <plist/Keys/Unpack.h>
 
+#include <cassert>
+
 using pbxproj::PBX::Target;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 Target::
 Target(std::string const &isa, Type type) :
-    Object(isa),
-    _type (type)
+    Object            (isa),
+    _type             (type),
+    _buildPhasesParsed(false),
+    _buildPhasesValid (false)
 {
 }
 
@@ -85,70 +92,8 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     if (BPs != nullptr) {
         for (size_t n = 0; n < BPs->count(); n++) {
-            auto ID = BPs->value <plist::String> (n);
-            if (ID == nullptr) {
-                continue;
-            }
-
-            if (auto BPd = context.get <HeadersBuildPhase> (ID)) {
-                auto O = context.parseObject(context.headersBuildPhases, ID->value(), BPd);
-                if (!O) {
-                    return false;
-                }
-
-                _buildPhases.push_back(O);
-            } else if (auto BPd = context.get <SourcesBuildPhase> (ID)) {
-                auto O = context.parseObject(context.sourcesBuildPhases, ID->value(), BPd);
-                if (!O) {
-                    return false;
-                }
-
-                _buildPhases.push_back(O);
-            } else if (auto BPd = context.get <ResourcesBuildPhase> (ID)) {
-                auto O = context.parseObject(context.resourcesBuildPhases, ID->value(), BPd);
-                if (!O) {
-                    return false;
-                }
-
-                _buildPhases.push_back(O);
-            } else if (auto BPd = context.get <FrameworksBuildPhase> (ID)) {
-                auto O = context.parseObject(context.frameworksBuildPhases, ID->value(), BPd);
-                if (!O) {
-                    return false;
-                }
-
-                _buildPhases.push_back(O);
-            } else if (auto BPd = context.get <CopyFilesBuildPhase> (ID)) {
-                auto O = context.parseObject(context.copyFilesBuildPhases, ID->value(), BPd);
-                if (!O) {
-                    return false;
-                }
-
-                _buildPhases.push_back(O);
-            } else if (auto BPd = context.get <ShellScriptBuildPhase> (ID)) {
-                auto O = context.parseObject(context.shellScriptBuildPhases, ID->value(), BPd);
-                if (!O) {
-                    return false;
-                }
-
-                _buildPhases.push_back(O);
-            } else if (auto BPd = context.get <AppleScriptBuildPhase> (ID)) {
-                auto O = context.parseObject(context.appleScriptBuildPhases, ID->value(), BPd);
-                if (!O) {
-                    return false;
-                }
-
-                _buildPhases.push_back(O);
-            } else if (auto BPd = context.get <RezBuildPhase> (ID)) {
-                auto O = context.parseObject(context.rezBuildPhases, ID->value(), BPd);
-                if (!O) {
-                    return false;
-                }
-
-                _buildPhases.push_back(O);
-            } else {
-                fprintf(stderr, "warning: target '%s' contains unsupported build phase reference to '%s'\n",
-                        _name.c_str(), ID->value().c_str());
+            if (auto ID = BPs->value <plist::String> (n)) {
+                _buildPhaseIDs.push_back(ID->value());
             }
         }
     }
@@ -170,3 +115,100 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+pbxproj::PBX::BuildPhase::vector const &Target::
+buildPhases() const
+{
+    (void)loadBuildPhases();
+    return _buildPhases;
+}
+
+bool Target::
+loadBuildPhases() const
+{
+    if (!_buildPhasesParsed.load(std::memory_order_acquire)) {
+        /* Targets are only reachable through their project. */
+        std::shared_ptr<Project> project = _project.lock();
+        assert(project != nullptr);
+
+        project->parseDeferred([this](Context &context) {
+            /* Another thread may have parsed them while waiting. */
+            if (!_buildPhasesParsed.load(std::memory_order_relaxed)) {
+                _buildPhasesValid = parseBuildPhases(context);
+                if (!_buildPhasesValid) {
+                    _buildPhases.clear();
+                }
+                _buildPhasesParsed.store(true, std::memory_order_release);
+            }
+        });
+    }
+
+    return _buildPhasesValid;
+}
+
+bool Target::
+parseBuildPhases(Context &context) const
+{
+    for (std::string const &ID : _buildPhaseIDs) {
+        BuildPhase::shared_ptr O;
+
+        if (auto BPd = context.get <HeadersBuildPhase> (ID)) {
+            O = context.parseObject(context.headersBuildPhases, ID, BPd);
+        } else if (auto BPd = context.get <SourcesBuildPhase> (ID)) {
+            O = context.parseObject(context.sourcesBuildPhases, ID, BPd);
+        } else if (auto BPd = context.get <ResourcesBuildPhase> (ID)) {
+            O = context.parseObject(context.resourcesBuildPhases, ID, BPd);
+        } else if (auto BPd = context.get <FrameworksBuildPhase> (ID)) {
+            O = context.parseObject(context.frameworksBuildPhases, ID, BPd);
+        } else if (auto BPd = context.get <CopyFilesBuildPhase> (ID)) {
+            O = context.parseObject(context.copyFilesBuildPhases, ID, BPd);
+        } else if (auto BPd = context.get <ShellScriptBuildPhase> (ID)) {
+            O = context.parseObject(context.shellScriptBuildPhases, ID, BPd);
+        } else if (auto BPd = context.get <AppleScriptBuildPhase> (ID)) {
+            O = context.parseObject(context.appleScriptBuildPhases, ID, BPd);
+        } else if (auto BPd = context.get <RezBuildPhase> (ID)) {
+            O = context.parseObject(context.rezBuildPhases, ID, BPd);
+        } else {
+            fprintf(stderr, "warning: target '%s' contains unsupported build phase reference to '%s'\n",
+                    _name.c_str(), ID.c_str());
+            continue;
+        }
+
+        if (!O) {
+            fprintf(stderr, "error: target '%s' has an invalid build phase '%s'\n",
+                    _name.c_str(), ID.c_str());
+            return false;
+        }
+
+        _buildPhases.push_back(O);
+    }
+
+    return true;
+}
+
+void Target::
+archive(Archive &archive)
+{
+    Object::archive(archive);
+
+    if (archive.reading()) {
+        _project = archive.project();
+    }
+
+    archive.value(&_name);
+    archive.value(&_productName);
+    archive.object(&_buildConfigurationList);
+    archive.objects(&_dependencies);
+    archive.value(&_buildPhaseIDs);
+
+    if (archive.reading()) {
+        /* Build phases were parsed before they were written. */
+        _buildPhasesValid = true;
+        _buildPhasesParsed.store(true, std::memory_order_release);
+    } else if (!loadBuildPhases()) {
+        archive.invalidate();
+        return;
+    }
+
+    archive.objects(&_buildPhases);
+}
@@ -12,8 +12,10 @@
 #include <pbxproj/PBX/AggregateTarget.h>
 #include <pbxproj/PBX/LegacyTarget.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
 
 using pbxproj::PBX::TargetDependency;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 TargetDependency::
@@ -71,3 +73,13 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void TargetDependency::
+archive(Archive &archive)
+{
+    Object::archive(archive);
+
+    archive.value(&_name);
+    archive.object(&_target);
+    archive.object(&_targetProxy);
+}
@@ -0,0 +1,141 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <pbxproj/ProjectCache.h>
+#include <pbxproj/PBX/Project.h>
+#include <pbxproj/Archive.h>
+#include <libutil/Filesystem.h>
+#include <libutil/FSUtil.h>
+#include <libutil/md5.h>
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+using pbxproj::ProjectCache;
+using pbxproj::Archive;
+namespace PBX = pbxproj::PBX;
+using libutil::Filesystem;
+using libutil::FSUtil;
+
+/*
+ * Snapshots are an archive of the project's objects followed by a trailer
+ * describing the project file it was parsed from. The trailer is at the
+ * end so the archive can be read in place. Bump the version when changing
+ * the trailer or the archive format, including the fields of any object.
+ */
+static char const SnapshotMagic[8] = { 'p', 'b', 'x', 'c', 'a', 'c', 'h', 'e' };
+static uint32_t const SnapshotVersion = 2;
+static size_t const SnapshotDigestSize = 16;
+static size_t const SnapshotTrailerSize = 8 + 8 + SnapshotDigestSize + 4 + sizeof(SnapshotMagic);
+
+ProjectCache::
+ProjectCache(Filesystem *filesystem, std::string const &directory) :
+    _filesystem(filesystem),
+    _directory (directory)
+{
+}
+
+static void
+Digest(std::vector<uint8_t> const &contents, uint8_t digest[SnapshotDigestSize])
+{
+    md5_state_t state;
+    md5_init(&state);
+    md5_append(&state, reinterpret_cast<md5_byte_t const *>(contents.data()), contents.size());
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(digest));
+}
+
+std::string ProjectCache::
+snapshotPath(std::string const &path) const
+{
+    uint8_t digest[SnapshotDigestSize];
+    Digest(std::vector<uint8_t>(path.begin(), path.end()), digest);
+
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (uint8_t c : digest) {
+        ss << std::setw(2) << static_cast<int>(c);
+    }
+
+    return _directory + "/" + FSUtil::GetBaseNameWithoutExtension(FSUtil::GetDirectoryName(path)) + "-" + ss.str() + ".snapshot";
+}
+
+static void
+WriteInteger(std::vector<uint8_t> *trailer, uint64_t value, size_t size)
+{
+    for (size_t n = 0; n < size; n++) {
+        trailer->push_back(static_cast<uint8_t>(value >> (n * 8)));
+    }
+}
+
+static std::vector<uint8_t>
+Trailer(uint64_t size, uint64_t modificationTime, std::vector<uint8_t> const &contents)
+{
+    std::vector<uint8_t> trailer;
+    trailer.reserve(SnapshotTrailerSize);
+
+    WriteInteger(&trailer, size, 8);
+    WriteInteger(&trailer, modificationTime, 8);
+
+    uint8_t digest[SnapshotDigestSize];
+    Digest(contents, digest);
+    trailer.insert(trailer.end(), digest, digest + SnapshotDigestSize);
+
+    WriteInteger(&trailer, SnapshotVersion, 4);
+    trailer.insert(trailer.end(), SnapshotMagic, SnapshotMagic + sizeof(SnapshotMagic));
+    return trailer;
+}
+
+std::shared_ptr<PBX::Project> ProjectCache::
+load(std::string const &path, std::vector<uint8_t> const &contents) const
+{
+    ext::optional<uint64_t> modificationTime = _filesystem->modificationTime(path);
+    if (!modificationTime) {
+        return nullptr;
+    }
+
+    std::vector<uint8_t> snapshot;
+    if (!_filesystem->read(&snapshot, snapshotPath(path)) || snapshot.size() < SnapshotTrailerSize) {
+        return nullptr;
+    }
+
+    /*
+     * Any difference from the project file means it has to be parsed again.
+     */
+    std::vector<uint8_t> trailer = Trailer(contents.size(), *modificationTime, contents);
+    if (::memcmp(snapshot.data() + snapshot.size() - SnapshotTrailerSize, trailer.data(), SnapshotTrailerSize) != 0) {
+        return nullptr;
+    }
+    snapshot.resize(snapshot.size() - SnapshotTrailerSize);
+
+    return Archive::Read(snapshot);
+}
+
+bool ProjectCache::
+store(std::string const &path, std::vector<uint8_t> const &contents, std::shared_ptr<PBX::Project> const &project)
+{
+    ext::optional<uint64_t> modificationTime = _filesystem->modificationTime(path);
+    if (!modificationTime) {
+        return false;
+    }
+
+    std::vector<uint8_t> snapshot;
+    if (!Archive::Write(project, &snapshot)) {
+        return false;
+    }
+
+    std::vector<uint8_t> trailer = Trailer(contents.size(), *modificationTime, contents);
+    snapshot.insert(snapshot.end(), trailer.begin(), trailer.end());
+
+    if (!_filesystem->createDirectory(_directory, true)) {
+        return false;
+    }
+
+    /* Replaced atomically, so concurrent builds never read a partial snapshot. */
+    return _filesystem->writeIfChanged(snapshot, snapshotPath(path));
+}
@@ -8,8 +8,10 @@
 
 #include <pbxproj/XC/BuildConfiguration.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
 
 using pbxproj::XC::BuildConfiguration;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 BuildConfiguration::
@@ -66,3 +68,13 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void BuildConfiguration::
+archive(Archive &archive)
+{
+    Object::archive(archive);
+
+    archive.value(&_name);
+    archive.object(&_baseConfigurationReference);
+    archive.value(&_buildSettings);
+}
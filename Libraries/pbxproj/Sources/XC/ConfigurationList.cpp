@@ -8,6 +8,7 @@
 
 #include <pbxproj/XC/ConfigurationList.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
 #include <plist/Array.h>
 #include <plist/Boolean.h>
 #include <plist/Dictionary.h>
@@ -17,6 +18,7 @@
 #include <cassert>
 
 using pbxproj::XC::ConfigurationList;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 ConfigurationList::
@@ -68,3 +70,13 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void ConfigurationList::
+archive(Archive &archive)
+{
+    Object::archive(archive);
+
+    archive.objects(&_buildConfigurations);
+    archive.value(&_defaultConfigurationName);
+    archive.value(&_defaultConfigurationIsVisible);
+}
@@ -9,8 +9,10 @@
 #include <pbxproj/XC/VersionGroup.h>
 #include <pbxproj/PBX/FileReference.h>
 #include <pbxproj/Context.h>
+#include <pbxproj/Archive.h>
 
 using pbxproj::XC::VersionGroup;
+using pbxproj::Archive;
 using pbxproj::Context;
 
 VersionGroup::
@@ -49,3 +51,12 @@ parse(Context &context, plist::Dictionary const *dict, std::unordered_set<std::s
 
     return true;
 }
+
+void VersionGroup::
+archive(Archive &archive)
+{
+    PBX::BaseGroup::archive(archive);
+
+    archive.object(&_currentVersion);
+    archive.value(&_versionGroupType);
+}
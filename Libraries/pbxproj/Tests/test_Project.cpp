@@ -0,0 +1,88 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxproj/PBX/Project.h>
+#include <pbxproj/PBX/BuildPhases.h>
+#include <pbxproj/PBX/FileReference.h>
+#include <libutil/MemoryFilesystem.h>
+
+#include <algorithm>
+
+using pbxproj::PBX::Project;
+using pbxproj::PBX::Target;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+static std::vector<uint8_t> const ProjectContents = Contents(
+    "// !$*UTF8*$!\n"
+    "{\n"
+    "\tarchiveVersion = 1;\n"
+    "\tclasses = {\n"
+    "\t};\n"
+    "\tobjectVersion = 46;\n"
+    "\tobjects = {\n"
+    "\t\tB1 = {isa = PBXBuildFile; fileRef = F1; };\n"
+    "\t\tB2 = {isa = PBXBuildFile; fileRef = F2; };\n"
+    "\t\tF1 = {isa = PBXFileReference; lastKnownFileType = sourcecode.c.c; path = main.c; sourceTree = \"<group>\"; };\n"
+    "\t\tF2 = {isa = PBXFileReference; lastKnownFileType = sourcecode.c.h; path = other.h; sourceTree = \"<group>\"; };\n"
+    "\t\tG1 = {isa = PBXGroup; children = ( F1, ); sourceTree = \"<group>\"; };\n"
+    "\t\tP1 = {isa = PBXSourcesBuildPhase; files = ( B1, B2, ); };\n"
+    "\t\tC1 = {isa = XCBuildConfiguration; buildSettings = { }; name = Debug; };\n"
+    "\t\tL1 = {isa = XCConfigurationList; buildConfigurations = ( C1, ); defaultConfigurationName = Debug; };\n"
+    "\t\tT1 = {isa = PBXNativeTarget; buildConfigurationList = L1; buildPhases = ( P1, ); dependencies = ( ); name = Used; };\n"
+    "\t\tT2 = {isa = PBXNativeTarget; buildConfigurationList = L1; buildPhases = ( P2, ); dependencies = ( ); name = Missing; };\n"
+    "\t\tR1 = {isa = PBXProject; buildConfigurationList = L1; mainGroup = G1; projectDirPath = \"\"; projectRoot = \"\"; targets = ( T1, T2, ); };\n"
+    "\t};\n"
+    "\trootObject = R1;\n"
+    "}\n");
+
+TEST(Project, DeferredBuildPhases)
+{
+    MemoryFilesystem filesystem = MemoryFilesystem({
+        MemoryFilesystem::Entry::Directory("Test.xcodeproj", {
+            MemoryFilesystem::Entry::File("project.pbxproj", ProjectContents),
+        }),
+    });
+
+    Project::shared_ptr project = Project::Open(&filesystem, filesystem.path("Test.xcodeproj"));
+    ASSERT_NE(nullptr, project);
+    ASSERT_EQ(2, project->targets().size());
+
+    /* Parsed on first use, resolving objects shared with the project. */
+    Target::shared_ptr used = project->targets()[0];
+    EXPECT_TRUE(used->loadBuildPhases());
+    ASSERT_EQ(1, used->buildPhases().size());
+    ASSERT_EQ(2, used->buildPhases()[0]->files().size());
+    EXPECT_EQ(project->mainGroup()->children()[0], used->buildPhases()[0]->files()[0]->fileRef());
+
+    /* Missing phases are skipped, not fatal to the project. */
+    Target::shared_ptr missing = project->targets()[1];
+    EXPECT_TRUE(missing->loadBuildPhases());
+    EXPECT_EQ(0, missing->buildPhases().size());
+
+    /* File references only used by build files are included. */
+    std::vector<std::string> names;
+    for (pbxproj::PBX::FileReference::shared_ptr const &fileReference : project->fileReferences()) {
+        names.push_back(fileReference->name());
+    }
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ(std::vector<std::string>({ "main.c", "other.h" }), names);
+
+    /* The retained project file doesn't keep the project alive. */
+    std::weak_ptr<Project> weak = project;
+    project.reset();
+    used.reset();
+    missing.reset();
+    EXPECT_TRUE(weak.expired());
+}
@@ -0,0 +1,292 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <pbxproj/ProjectCache.h>
+#include <pbxproj/PBX/Project.h>
+#include <pbxproj/PBX/BuildPhases.h>
+#include <pbxproj/PBX/FileReference.h>
+#include <pbxproj/PBX/LegacyTarget.h>
+#include <pbxproj/PBX/NativeTarget.h>
+#include <pbxproj/PBX/ReferenceProxy.h>
+#include <pbxproj/PBX/VariantGroup.h>
+#include <pbxproj/XC/VersionGroup.h>
+#include <libutil/MemoryFilesystem.h>
+
+using pbxproj::ProjectCache;
+using pbxproj::PBX::Project;
+using libutil::MemoryFilesystem;
+namespace PBX = pbxproj::PBX;
+namespace XC = pbxproj::XC;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+/*
+ * Reports a chosen modification time, so it only changes when a test
+ * changes it rather than on every write.
+ */
+class TimedFilesystem : public MemoryFilesystem {
+private:
+    uint64_t _modificationTime;
+
+public:
+    TimedFilesystem(std::vector<MemoryFilesystem::Entry> const &entries) :
+        MemoryFilesystem (entries),
+        _modificationTime(1)
+    {
+    }
+
+public:
+    void setModificationTime(uint64_t modificationTime)
+    { _modificationTime = modificationTime; }
+
+public:
+    virtual ext::optional<uint64_t> modificationTime(std::string const &path) const
+    {
+        return (this->exists(path) ? ext::optional<uint64_t>(_modificationTime) : ext::nullopt);
+    }
+};
+
+/*
+ * A project using every kind of object a snapshot stores.
+ */
+static std::vector<uint8_t> const ProjectContents = Contents(
+    "// !$*UTF8*$!\n"
+    "{\n"
+    "\tarchiveVersion = 1;\n"
+    "\tclasses = {\n"
+    "\t};\n"
+    "\tobjectVersion = 46;\n"
+    "\tobjects = {\n"
+    "\t\tB1 = {isa = PBXBuildFile; fileRef = F1; settings = {COMPILER_FLAGS = \"-DDEBUG=1 -Wall\"; }; };\n"
+    "\t\tB2 = {isa = PBXBuildFile; fileRef = F2; settings = {ATTRIBUTES = (Public, ); }; };\n"
+    "\t\tB3 = {isa = PBXBuildFile; fileRef = V1; };\n"
+    "\t\tB4 = {isa = PBXBuildFile; fileRef = RP1; };\n"
+    "\t\tB5 = {isa = PBXBuildFile; fileRef = F2; };\n"
+    "\t\tB6 = {isa = PBXBuildFile; fileRef = X1; };\n"
+    "\t\tF1 = {isa = PBXFileReference; fileEncoding = 4; lastKnownFileType = sourcecode.c.c; path = main.c; sourceTree = \"<group>\"; };\n"
+    "\t\tF2 = {isa = PBXFileReference; lastKnownFileType = sourcecode.c.h; path = other.h; sourceTree = \"<group>\"; };\n"
+    "\t\tF3 = {isa = PBXFileReference; lastKnownFileType = text.plist.strings; name = Base; path = Base.lproj/Localizable.strings; sourceTree = \"<group>\"; };\n"
+    "\t\tF4 = {isa = PBXFileReference; lastKnownFileType = text.xcconfig; path = Base.xcconfig; sourceTree = SOURCE_ROOT; };\n"
+    "\t\tF5 = {isa = PBXFileReference; lastKnownFileType = \"wrapper.pb-project\"; path = Library/Library.xcodeproj; sourceTree = \"<group>\"; };\n"
+    "\t\tF6 = {isa = PBXFileReference; explicitFileType = wrapper.application; includeInIndex = 0; path = App.app; sourceTree = BUILT_PRODUCTS_DIR; };\n"
+    "\t\tF7 = {isa = PBXFileReference; lastKnownFileType = wrapper.xcdatamodel; path = Model.xcdatamodel; sourceTree = \"<group>\"; };\n"
+    "\t\tV1 = {isa = PBXVariantGroup; children = ( F3, ); name = Localizable.strings; sourceTree = \"<group>\"; };\n"
+    "\t\tX1 = {isa = XCVersionGroup; children = ( F7, ); currentVersion = F7; path = Model.xcdatamodeld; sourceTree = \"<group>\"; versionGroupType = wrapper.xcdatamodel; };\n"
+    "\t\tRP1 = {isa = PBXReferenceProxy; fileType = archive.ar; path = libLibrary.a; remoteRef = CP2; sourceTree = BUILT_PRODUCTS_DIR; };\n"
+    "\t\tCP1 = {isa = PBXContainerItemProxy; containerPortal = F5; proxyType = 1; remoteGlobalIDString = LT1; remoteInfo = Library; };\n"
+    "\t\tCP2 = {isa = PBXContainerItemProxy; containerPortal = F5; proxyType = 2; remoteGlobalIDString = LF1; remoteInfo = Library; };\n"
+    "\t\tD1 = {isa = PBXTargetDependency; name = Library; targetProxy = CP1; };\n"
+    "\t\tD2 = {isa = PBXTargetDependency; target = T3; };\n"
+    "\t\tG1 = {isa = PBXGroup; children = ( F1, F2, V1, X1, F4, F5, G2, ); indentWidth = 2; sourceTree = \"<group>\"; tabWidth = 4; };\n"
+    "\t\tG2 = {isa = PBXGroup; children = ( F6, ); name = Products; sourceTree = \"<group>\"; };\n"
+    "\t\tG3 = {isa = PBXGroup; children = ( RP1, ); name = Products; sourceTree = \"<group>\"; };\n"
+    "\t\tP1 = {isa = PBXSourcesBuildPhase; buildActionMask = 2147483647; files = ( B1, B6, ); runOnlyForDeploymentPostprocessing = 0; };\n"
+    "\t\tP2 = {isa = PBXHeadersBuildPhase; buildActionMask = 2147483647; files = ( B2, ); runOnlyForDeploymentPostprocessing = 0; };\n"
+    "\t\tP3 = {isa = PBXResourcesBuildPhase; buildActionMask = 2147483647; files = ( B3, ); runOnlyForDeploymentPostprocessing = 0; };\n"
+    "\t\tP4 = {isa = PBXFrameworksBuildPhase; buildActionMask = 2147483647; files = ( B4, ); runOnlyForDeploymentPostprocessing = 0; };\n"
+    "\t\tP5 = {isa = PBXCopyFilesBuildPhase; buildActionMask = 8; dstPath = \"$(CONTENTS_FOLDER_PATH)/Headers\"; dstSubfolderSpec = 16; files = ( B5, ); name = \"Copy Headers\"; runOnlyForDeploymentPostprocessing = 1; };\n"
+    "\t\tP6 = {isa = PBXShellScriptBuildPhase; buildActionMask = 2147483647; files = ( ); inputPaths = ( \"$(SRCROOT)/input.txt\", ); name = Generate; outputPaths = ( \"$(DERIVED_FILE_DIR)/output.h\", ); runOnlyForDeploymentPostprocessing = 0; shellPath = /bin/sh; shellScript = \"echo \\\"$(PRODUCT_NAME)\\\"\"; showEnvVarsInLog = 0; };\n"
+    "\t\tBR1 = {isa = PBXBuildRule; compilerSpec = com.apple.compilers.proxy.script; filePatterns = \"*.y\"; fileType = pattern.proxy; isEditable = 1; outputFiles = ( \"$(DERIVED_FILE_DIR)/$(INPUT_FILE_BASE).c\", ); script = \"yacc -o $(SCRIPT_OUTPUT_FILE_0) $(INPUT_FILE_PATH)\"; };\n"
+    "\t\tC1 = {isa = XCBuildConfiguration; baseConfigurationReference = F4; buildSettings = {ARCHS = ( x86_64, arm64, ); OTHER_CFLAGS = \"-DDEBUG $(inherited)\"; \"OTHER_CFLAGS[sdk=iphoneos*][arch=arm64]\" = \"-DDEVICE\"; }; name = Debug; };\n"
+    "\t\tC2 = {isa = XCBuildConfiguration; buildSettings = {PRODUCT_NAME = \"$(TARGET_NAME)\"; }; name = Release; };\n"
+    "\t\tL1 = {isa = XCConfigurationList; buildConfigurations = ( C1, C2, ); defaultConfigurationIsVisible = 0; defaultConfigurationName = Release; };\n"
+    "\t\tT1 = {isa = PBXNativeTarget; buildConfigurationList = L1; buildPhases = ( P1, P2, P3, P4, P5, P6, ); buildRules = ( BR1, ); dependencies = ( D1, D2, ); name = App; productName = App; productReference = F6; productType = \"com.apple.product-type.application\"; };\n"
+    "\t\tT2 = {isa = PBXAggregateTarget; buildConfigurationList = L1; buildPhases = ( ); dependencies = ( ); name = All; productName = All; };\n"
+    "\t\tT3 = {isa = PBXLegacyTarget; buildArgumentsString = \"$(ACTION)\"; buildConfigurationList = L1; buildPhases = ( ); buildToolPath = /usr/bin/make; buildWorkingDirectory = Sources; dependencies = ( ); name = Make; passBuildSettingsInEnvironment = 1; productName = Make; };\n"
+    "\t\tR1 = {isa = PBXProject; buildConfigurationList = L1; compatibilityVersion = \"Xcode 3.2\"; developmentRegion = English; hasScannedForEncodings = 0; knownRegions = ( en, Base, ); mainGroup = G1; productRefGroup = G2; projectDirPath = \"\"; projectReferences = ( {ProductGroup = G3; ProjectRef = F5; }, ); projectRoot = \"\"; targets = ( T1, T2, T3, ); };\n"
+    "\t};\n"
+    "\trootObject = R1;\n"
+    "}\n");
+
+static TimedFilesystem
+ProjectFilesystem()
+{
+    return TimedFilesystem({
+        MemoryFilesystem::Entry::Directory("App.xcodeproj", {
+            MemoryFilesystem::Entry::File("project.pbxproj", ProjectContents),
+        }),
+    });
+}
+
+TEST(ProjectCache, RoundTrip)
+{
+    TimedFilesystem filesystem = ProjectFilesystem();
+    ProjectCache cache = ProjectCache(&filesystem, filesystem.path("cache"));
+    std::string path = filesystem.path("App.xcodeproj/project.pbxproj");
+
+    /* Nothing is loaded before a snapshot is stored. */
+    EXPECT_EQ(nullptr, cache.load(path, ProjectContents));
+
+    /* Opening the project stores a snapshot. */
+    Project::shared_ptr parsed = Project::Open(&filesystem, filesystem.path("App.xcodeproj"), &cache);
+    ASSERT_NE(nullptr, parsed);
+    EXPECT_TRUE(filesystem.exists(cache.snapshotPath(path)));
+
+    std::vector<uint8_t> snapshot;
+    ASSERT_TRUE(filesystem.read(&snapshot, cache.snapshotPath(path)));
+
+    /* Opening it again loads the snapshot, with the paths set. */
+    Project::shared_ptr project = Project::Open(&filesystem, filesystem.path("App.xcodeproj"), &cache);
+    ASSERT_NE(nullptr, project);
+    EXPECT_NE(parsed, project);
+    EXPECT_EQ(parsed->dataFile(), project->dataFile());
+    EXPECT_EQ(parsed->projectFile(), project->projectFile());
+    EXPECT_EQ(parsed->basePath(), project->basePath());
+    EXPECT_EQ("App", project->name());
+
+    /* Storing the loaded project writes the same snapshot, so every field was read back. */
+    ASSERT_TRUE(cache.store(path, ProjectContents, project));
+    std::vector<uint8_t> restored;
+    ASSERT_TRUE(filesystem.read(&restored, cache.snapshotPath(path)));
+    EXPECT_EQ(snapshot, restored);
+
+    /* Project fields. */
+    EXPECT_EQ("Xcode 3.2", project->compatibilityVersion());
+    EXPECT_EQ(std::vector<std::string>({ "en", "Base" }), project->knownRegions());
+    EXPECT_EQ(2, project->mainGroup()->indentWidth());
+    EXPECT_EQ(4, project->mainGroup()->tabWidth());
+    ASSERT_EQ(1, project->projectReferences().size());
+    EXPECT_EQ(project->mainGroup()->children()[5], project->projectReferences()[0].projectReference());
+    EXPECT_EQ(7, project->fileReferences().size());
+
+    /* Groups keep their parents, so paths resolve the same way. */
+    auto variantGroup = std::static_pointer_cast<PBX::VariantGroup>(project->mainGroup()->children()[2]);
+    ASSERT_TRUE(variantGroup->isa<PBX::VariantGroup>());
+    auto parsedVariantGroup = std::static_pointer_cast<PBX::VariantGroup>(parsed->mainGroup()->children()[2]);
+    EXPECT_EQ(parsedVariantGroup->children()[0]->resolve().raw(), variantGroup->children()[0]->resolve().raw());
+    auto versionGroup = std::static_pointer_cast<XC::VersionGroup>(project->mainGroup()->children()[3]);
+    ASSERT_TRUE(versionGroup->isa<XC::VersionGroup>());
+    EXPECT_EQ(versionGroup->children()[0], versionGroup->currentVersion());
+
+    /* Build phases are loaded with the project. */
+    ASSERT_EQ(3, project->targets().size());
+    auto target = std::static_pointer_cast<PBX::NativeTarget>(project->targets()[0]);
+    ASSERT_TRUE(target->isa<PBX::NativeTarget>());
+    EXPECT_TRUE(target->loadBuildPhases());
+    ASSERT_EQ(6, target->buildPhases().size());
+    EXPECT_EQ(project->mainGroup()->children()[0], target->buildPhases()[0]->files()[0]->fileRef());
+    EXPECT_EQ(std::vector<std::string>({ "-DDEBUG=1", "-Wall" }), target->buildPhases()[0]->files()[0]->compilerFlags());
+    EXPECT_EQ(std::vector<std::string>({ "Public" }), target->buildPhases()[1]->files()[0]->attributes());
+
+    auto references = target->buildPhases()[3]->files()[0]->fileRef();
+    ASSERT_TRUE(references->isa<PBX::ReferenceProxy>());
+    EXPECT_EQ("LF1", std::static_pointer_cast<PBX::ReferenceProxy>(references)->remoteRef()->remoteGlobalIDString());
+
+    auto copyFiles = std::static_pointer_cast<PBX::CopyFilesBuildPhase>(target->buildPhases()[4]);
+    EXPECT_EQ("$(CONTENTS_FOLDER_PATH)/Headers", copyFiles->dstPath().raw());
+    EXPECT_EQ(PBX::CopyFilesBuildPhase::kDestinationProducts, copyFiles->dstSubfolderSpec());
+    EXPECT_EQ(8, copyFiles->buildActionMask());
+    EXPECT_TRUE(copyFiles->runOnlyForDeploymentPostprocessing());
+
+    auto shellScript = std::static_pointer_cast<PBX::ShellScriptBuildPhase>(target->buildPhases()[5]);
+    ASSERT_EQ(1, shellScript->inputPaths().size());
+    EXPECT_EQ("$(SRCROOT)/input.txt", shellScript->inputPaths()[0].raw());
+    EXPECT_EQ("echo \"$(PRODUCT_NAME)\"", shellScript->shellScript());
+
+    ASSERT_EQ(1, target->buildRules().size());
+    EXPECT_EQ("*.y", target->buildRules()[0]->filePatterns());
+
+    ASSERT_EQ(2, target->dependencies().size());
+    EXPECT_EQ(nullptr, target->dependencies()[0]->target());
+    EXPECT_EQ("LT1", target->dependencies()[0]->targetProxy()->remoteGlobalIDString());
+    EXPECT_EQ(project->targets()[2], target->dependencies()[1]->target());
+
+    auto legacyTarget = std::static_pointer_cast<PBX::LegacyTarget>(project->targets()[2]);
+    ASSERT_TRUE(legacyTarget->isa<PBX::LegacyTarget>());
+    EXPECT_EQ("$(ACTION)", legacyTarget->buildArgumentsString().raw());
+    EXPECT_TRUE(legacyTarget->passBuildSettingsInEnvironment());
+
+    /* Conditional settings keep their conditions. */
+    auto configuration = project->buildConfigurationList()->buildConfigurations()[0];
+    EXPECT_EQ(project->mainGroup()->children()[4], configuration->baseConfigurationReference());
+    ASSERT_EQ(3, configuration->buildSettings().settings().size());
+    EXPECT_EQ(parsed->buildConfigurationList()->buildConfigurations()[0]->buildSettings().settings()[2].condition().values(), configuration->buildSettings().settings()[2].condition().values());
+
+    /* Build files are still resolvable by identifier. */
+    EXPECT_EQ(target->buildPhases()[0]->files()[0], project->resolveBuildableReference("B1"));
+}
+
+TEST(ProjectCache, ChangedProject)
+{
+    TimedFilesystem filesystem = ProjectFilesystem();
+    ProjectCache cache = ProjectCache(&filesystem, filesystem.path("cache"));
+    std::string path = filesystem.path("App.xcodeproj/project.pbxproj");
+
+    ASSERT_NE(nullptr, Project::Open(&filesystem, filesystem.path("App.xcodeproj"), &cache));
+    ASSERT_NE(nullptr, cache.load(path, ProjectContents));
+
+    /* Different size. */
+    std::vector<uint8_t> longer = ProjectContents;
+    longer.push_back('\n');
+    EXPECT_EQ(nullptr, cache.load(path, longer));
+
+    /* Same size, different contents. */
+    std::vector<uint8_t> changed = ProjectContents;
+    changed[changed.size() - 3] = 'X';
+    ASSERT_EQ(ProjectContents.size(), changed.size());
+    EXPECT_EQ(nullptr, cache.load(path, changed));
+
+    /* Same contents, different modification time. */
+    filesystem.setModificationTime(2);
+    EXPECT_EQ(nullptr, cache.load(path, ProjectContents));
+    filesystem.setModificationTime(1);
+    EXPECT_NE(nullptr, cache.load(path, ProjectContents));
+
+    /* Missing project file. */
+    EXPECT_EQ(nullptr, cache.load(filesystem.path("Other.xcodeproj/project.pbxproj"), ProjectContents));
+}
+
+TEST(ProjectCache, DamagedSnapshot)
+{
+    TimedFilesystem filesystem = ProjectFilesystem();
+    ProjectCache cache = ProjectCache(&filesystem, filesystem.path("cache"));
+    std::string path = filesystem.path("App.xcodeproj/project.pbxproj");
+
+    Project::shared_ptr project = Project::Open(&filesystem, filesystem.path("App.xcodeproj"), &cache);
+    ASSERT_NE(nullptr, project);
+
+    std::vector<uint8_t> snapshot;
+    ASSERT_TRUE(filesystem.read(&snapshot, cache.snapshotPath(path)));
+
+    /* Written by another version of the format: the version is before the 8 byte magic. */
+    std::vector<uint8_t> version = snapshot;
+    version[version.size() - 8 - 4] += 1;
+    ASSERT_TRUE(filesystem.write(version, cache.snapshotPath(path)));
+    EXPECT_EQ(nullptr, cache.load(path, ProjectContents));
+
+    /* Truncated to less than the trailer. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>(snapshot.begin(), snapshot.begin() + 16), cache.snapshotPath(path)));
+    EXPECT_EQ(nullptr, cache.load(path, ProjectContents));
+
+    /* Truncated at the end, losing part of the trailer. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>(snapshot.begin(), snapshot.end() - 1), cache.snapshotPath(path)));
+    EXPECT_EQ(nullptr, cache.load(path, ProjectContents));
+
+    /* Missing part of the archive, with an intact trailer. */
+    std::vector<uint8_t> partial = std::vector<uint8_t>(snapshot.begin() + 8, snapshot.end());
+    ASSERT_TRUE(filesystem.write(partial, cache.snapshotPath(path)));
+    EXPECT_EQ(nullptr, cache.load(path, ProjectContents));
+
+    /* An archive ending early, with an intact trailer: size, time, digest, version and magic. */
+    size_t trailerSize = 8 + 8 + 16 + 4 + 8;
+    std::vector<uint8_t> truncated = snapshot;
+    truncated.erase(truncated.end() - trailerSize - 4, truncated.end() - trailerSize);
+    ASSERT_TRUE(filesystem.write(truncated, cache.snapshotPath(path)));
+    EXPECT_EQ(nullptr, cache.load(path, ProjectContents));
+
+    /* A damaged snapshot is parsed again and replaced. */
+    Project::shared_ptr reopened = Project::Open(&filesystem, filesystem.path("App.xcodeproj"), &cache);
+    ASSERT_NE(nullptr, reopened);
+    EXPECT_EQ(3, reopened->targets().size());
+    EXPECT_NE(nullptr, cache.load(path, ProjectContents));
+}
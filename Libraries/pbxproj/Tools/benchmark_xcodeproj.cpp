@@ -0,0 +1,143 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <pbxproj/PBX/Project.h>
+#include <pbxproj/ProjectCache.h>
+#include <libutil/DefaultFilesystem.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+using libutil::DefaultFilesystem;
+using libutil::Filesystem;
+
+static std::string
+GID(size_t n)
+{
+    char gid[25];
+    snprintf(gid, sizeof(gid), "%024zX", n);
+    return gid;
+}
+
+/*
+ * Generate a project file shaped like a large real one: one target with
+ * a sources phase building every file, and file references in one group,
+ * with comments naming each object.
+ */
+static std::vector<uint8_t>
+GenerateProject(size_t files)
+{
+    std::string contents = "// !$*UTF8*$!\n{\n\tarchiveVersion = 1;\n\tclasses = {\n\t};\n\tobjectVersion = 46;\n\tobjects = {\n";
+    std::string children;
+    std::string buildFiles;
+
+    for (size_t n = 0; n < files; n++) {
+        std::string name = "Source" + std::to_string(n) + ".m";
+        std::string fileGID = GID(100 + n * 2);
+        std::string buildGID = GID(100 + n * 2 + 1);
+
+        contents += "\t\t" + buildGID + " /* " + name + " in Sources */ = {isa = PBXBuildFile; fileRef = " + fileGID + " /* " + name + " */; settings = {COMPILER_FLAGS = \"-DNAME=\\\"" + name + "\\\" -fobjc-arc\"; }; };\n";
+        contents += "\t\t" + fileGID + " /* " + name + " */ = {isa = PBXFileReference; fileEncoding = 4; lastKnownFileType = sourcecode.c.objc; path = Sources/Module/" + name + "; sourceTree = \"<group>\"; };\n";
+        children += "\t\t\t\t" + fileGID + " /* " + name + " */,\n";
+        buildFiles += "\t\t\t\t" + buildGID + " /* " + name + " in Sources */,\n";
+    }
+
+    contents += "\t\t" + GID(1) + " = {isa = PBXGroup; children = (\n" + children + "\t\t\t); sourceTree = \"<group>\"; };\n";
+    contents += "\t\t" + GID(2) + " /* Sources */ = {isa = PBXSourcesBuildPhase; buildActionMask = 2147483647; files = (\n" + buildFiles + "\t\t\t); runOnlyForDeploymentPostprocessing = 0; };\n";
+    contents += "\t\t" + GID(3) + " /* Debug */ = {isa = XCBuildConfiguration; buildSettings = {\n\t\t\t\tPRODUCT_NAME = \"$(TARGET_NAME)\";\n\t\t\t}; name = Debug; };\n";
+    contents += "\t\t" + GID(4) + " = {isa = XCConfigurationList; buildConfigurations = ( " + GID(3) + " /* Debug */, ); defaultConfigurationName = Debug; };\n";
+    contents += "\t\t" + GID(5) + " /* App */ = {isa = PBXNativeTarget; buildConfigurationList = " + GID(4) + "; buildPhases = ( " + GID(2) + " /* Sources */, ); dependencies = ( ); name = App; productName = App; productType = \"com.apple.product-type.tool\"; };\n";
+    contents += "\t\t" + GID(0) + " /* Project object */ = {isa = PBXProject; buildConfigurationList = " + GID(4) + "; compatibilityVersion = \"Xcode 3.2\"; mainGroup = " + GID(1) + "; projectDirPath = \"\"; projectRoot = \"\"; targets = ( " + GID(5) + " /* App */, ); };\n";
+    contents += "\t};\n\trootObject = " + GID(0) + " /* Project object */;\n}\n";
+    return std::vector<uint8_t>(contents.begin(), contents.end());
+}
+
+static double
+Measure(size_t iterations, std::function<bool()> const &open)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < iterations; n++) {
+        if (!open()) {
+            return -1.0;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+int
+main(int argc, char **argv)
+{
+    if (argc > 3 || (argc > 1 && std::string(argv[1]) == "-h")) {
+        fprintf(stderr, "usage: %s [project.xcodeproj] [iterations]\n", argv[0]);
+        fprintf(stderr, "Without a project, a large project is generated.\n");
+        return 1;
+    }
+
+    DefaultFilesystem defaultFilesystem;
+    Filesystem *filesystem = &defaultFilesystem;
+
+    char const *temporaryDirectory = getenv("TMPDIR");
+    std::string directory = std::string(temporaryDirectory != nullptr ? temporaryDirectory : "/tmp") + "/benchmark_xcodeproj";
+    std::string cachePath = directory + "/cache";
+
+    /*
+     * Generated projects are written to disk: snapshots need modification
+     * times that don't change when the snapshot itself is written.
+     */
+    std::string path;
+    if (argc > 1) {
+        path = filesystem->resolvePath(argv[1]);
+    } else {
+        path = directory + "/Generated.xcodeproj";
+        if (!filesystem->createDirectory(path, true) || !filesystem->writeIfChanged(GenerateProject(50000), path + "/project.pbxproj")) {
+            fprintf(stderr, "error: unable to write %s\n", path.c_str());
+            return 1;
+        }
+    }
+
+    size_t iterations = (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5);
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(filesystem, path);
+    if (project == nullptr) {
+        fprintf(stderr, "error: unable to open %s\n", path.c_str());
+        return 1;
+    }
+
+    /* Opening defers build phases; all of them are parsed to list every file reference. */
+    double openTime = Measure(iterations, [filesystem, &path] {
+        return pbxproj::PBX::Project::Open(filesystem, path) != nullptr;
+    });
+    double fullTime = Measure(iterations, [filesystem, &path] {
+        pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(filesystem, path);
+        return project != nullptr && !project->fileReferences().empty();
+    });
+
+    /* Stores the snapshot that the timed opens load. */
+    pbxproj::ProjectCache cache = pbxproj::ProjectCache(filesystem, cachePath);
+    if (pbxproj::PBX::Project::Open(filesystem, path, &cache) == nullptr) {
+        return 1;
+    }
+    double cachedTime = Measure(iterations, [filesystem, &path, &cache] {
+        pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(filesystem, path, &cache);
+        return project != nullptr && !project->fileReferences().empty();
+    });
+
+    printf("%zu targets, %zu file references, %zu iterations\n", project->targets().size(), project->fileReferences().size(), iterations);
+    printf("open:                 %10.2f ms\n", openTime);
+    printf("open, all phases:     %10.2f ms\n", fullTime);
+    printf("open from snapshot:   %10.2f ms\n", cachedTime);
+    return 0;
+}
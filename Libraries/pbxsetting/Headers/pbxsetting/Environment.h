@@ -15,6 +15,7 @@
 #include <list>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace pbxsetting {
 
@@ -52,6 +53,25 @@ public:
     std::string
     expand(Value const &value) const;
 
+public:
+    /*
+     * Determines if expanding a value could use any of the given settings,
+     * either directly or through the settings it references. Conservative:
+     * all bindings of a referenced setting are considered, not just the
+     * one that would be used for the expansion.
+     */
+    bool
+    dependsOn(Value const &value, std::unordered_set<std::string> const &settings) const;
+
+    /*
+     * For each setting referenced in the environment, the settings with a
+     * binding that references it directly. Conservative like `dependsOn()`.
+     * Following these transitively finds the settings whose values could
+     * change if the values of other settings do.
+     */
+    std::unordered_map<std::string, std::unordered_set<std::string>>
+    reverseDependencies() const;
+
 public:
     /*
      * Computes all values for all settings present in the environment.
@@ -89,6 +109,11 @@ private:
     std::string resolveValue(Condition const &condition, Value const &value, InheritanceContext const &context) const;
     std::string resolveInheritance(Condition const &condition, InheritanceContext const &context) const;
     std::string resolveAssignment(Condition const &condition, std::string const &setting) const;
+
+private:
+    void valueReferences(Value const &value, std::unordered_set<std::string> *references) const;
+    bool valueDependsOn(Value const &value, std::unordered_set<std::string> const &settings, std::unordered_set<std::string> *visited) const;
+    bool settingDependsOn(std::string const &setting, std::unordered_set<std::string> const &settings, std::unordered_set<std::string> *visited) const;
 };
 
 }
@@ -213,6 +213,115 @@ resolve(std::string const &setting) const
     return resolve(setting, Condition::Empty());
 }
 
+bool Environment::
+valueDependsOn(Value const &value, std::unordered_set<std::string> const &settings, std::unordered_set<std::string> *visited) const
+{
+    for (auto const &entry : value.entries()) {
+        if (entry.type() != Value::Entry::Type::Value) {
+            continue;
+        }
+
+        /* The name of the setting can itself be an expression. */
+        if (valueDependsOn(*entry.value(), settings, visited)) {
+            return true;
+        }
+
+        /* Since the name doesn't depend on the settings, its expansion is stable. */
+        std::string setting = expand(*entry.value());
+
+        std::string::size_type colon = setting.find(':');
+        if (colon != std::string::npos) {
+            setting = setting.substr(0, colon);
+        }
+
+        /* Inherited values are covered by checking all bindings of the setting. */
+        if (setting == "inherited") {
+            continue;
+        }
+
+        if (settingDependsOn(setting, settings, visited)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Environment::
+settingDependsOn(std::string const &setting, std::unordered_set<std::string> const &settings, std::unordered_set<std::string> *visited) const
+{
+    if (settings.find(setting) != settings.end()) {
+        return true;
+    }
+
+    if (!visited->insert(setting).second) {
+        /* Already checked, or currently being checked further up. */
+        return false;
+    }
+
+    for (Level const &level : _levels) {
+        for (Setting const &binding : level.settings()) {
+            if (binding.name() == setting && valueDependsOn(binding.value(), settings, visited)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool Environment::
+dependsOn(Value const &value, std::unordered_set<std::string> const &settings) const
+{
+    std::unordered_set<std::string> visited;
+    return valueDependsOn(value, settings, &visited);
+}
+
+void Environment::
+valueReferences(Value const &value, std::unordered_set<std::string> *references) const
+{
+    for (auto const &entry : value.entries()) {
+        if (entry.type() != Value::Entry::Type::Value) {
+            continue;
+        }
+
+        /* The name of the setting can itself be an expression. */
+        valueReferences(*entry.value(), references);
+
+        std::string setting = expand(*entry.value());
+
+        std::string::size_type colon = setting.find(':');
+        if (colon != std::string::npos) {
+            setting = setting.substr(0, colon);
+        }
+
+        /* Inherited values are covered by the other bindings of the setting. */
+        if (setting != "inherited") {
+            references->insert(setting);
+        }
+    }
+}
+
+std::unordered_map<std::string, std::unordered_set<std::string>> Environment::
+reverseDependencies() const
+{
+    std::unordered_map<std::string, std::unordered_set<std::string>> dependencies;
+
+    std::unordered_set<std::string> references;
+    for (Level const &level : _levels) {
+        for (Setting const &binding : level.settings()) {
+            references.clear();
+            valueReferences(binding.value(), &references);
+
+            for (std::string const &reference : references) {
+                dependencies[reference].insert(binding.name());
+            }
+        }
+    }
+
+    return dependencies;
+}
+
 std::unordered_map<std::string, std::string> Environment::
 computeValues(Condition const &condition) const
 {
@@ -179,3 +179,59 @@ TEST(Environment, Default)
     EXPECT_EQ(env.resolve("THREE"), "3");
 }
 
+
+TEST(Environment, DependsOn)
+{
+    Environment env;
+    env.insertBack(Level({
+        Setting::Parse("DIRECT", "$(INPUT)"),
+        Setting::Parse("INDIRECT", "prefix $(DIRECT)"),
+        Setting::Parse("NESTED", "$(SUFFIX_$(INPUT))"),
+        Setting::Parse("OPERATION", "$(INPUT:base)"),
+        Setting::Parse("INHERITED", "$(inherited) more"),
+        Setting::Parse("CYCLE", "$(CYCLE) $(OTHER)"),
+        Setting::Parse("OTHER", "other"),
+        Setting::Parse("SELECTOR", "ONE"),
+        Setting::Parse("SELECTED_ONE", "one"),
+        Setting::Parse("SELECTED_TWO", "$(INPUT)"),
+    }), false);
+    env.insertBack(Level({
+        Setting::Parse("INPUT", "input"),
+        Setting::Parse("INHERITED", "$(INPUT)"),
+    }), false);
+
+    std::unordered_set<std::string> settings = { "INPUT" };
+    EXPECT_TRUE(env.dependsOn(Value::Parse("$(DIRECT)"), settings));
+    EXPECT_TRUE(env.dependsOn(Value::Parse("$(INDIRECT)"), settings));
+    EXPECT_TRUE(env.dependsOn(Value::Parse("$(NESTED)"), settings));
+    EXPECT_TRUE(env.dependsOn(Value::Parse("$(OPERATION)"), settings));
+    EXPECT_TRUE(env.dependsOn(Value::Parse("$(INHERITED)"), settings));
+    EXPECT_FALSE(env.dependsOn(Value::Parse("$(CYCLE)"), settings));
+    EXPECT_FALSE(env.dependsOn(Value::Parse("literal"), settings));
+    EXPECT_FALSE(env.dependsOn(Value::Parse("$(SELECTED_$(SELECTOR))"), settings));
+    EXPECT_FALSE(env.dependsOn(Value::Parse("$(UNDEFINED)"), settings));
+}
+
+TEST(Environment, ReverseDependencies)
+{
+    Environment env;
+    env.insertBack(Level({
+        Setting::Parse("DIRECT", "$(INPUT)"),
+        Setting::Parse("INDIRECT", "prefix $(DIRECT)"),
+        Setting::Parse("NESTED", "$(SUFFIX_$(INPUT))"),
+        Setting::Parse("OPERATION", "$(INPUT:base)"),
+        Setting::Parse("INHERITED", "$(inherited) more"),
+        Setting::Parse("OTHER", "other"),
+    }), false);
+    env.insertBack(Level({
+        Setting::Parse("INPUT", "input"),
+        Setting::Parse("INHERITED", "$(INPUT)"),
+    }), false);
+
+    auto dependencies = env.reverseDependencies();
+    EXPECT_EQ(std::unordered_set<std::string>({ "DIRECT", "NESTED", "OPERATION", "INHERITED" }), dependencies["INPUT"]);
+    EXPECT_EQ(std::unordered_set<std::string>({ "INDIRECT" }), dependencies["DIRECT"]);
+    EXPECT_EQ(std::unordered_set<std::string>({ "NESTED" }), dependencies["SUFFIX_input"]);
+    EXPECT_EQ(dependencies.end(), dependencies.find("OTHER"));
+    EXPECT_EQ(dependencies.end(), dependencies.find("inherited"));
+}
@@ -388,8 +388,8 @@ registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string,
 
         switch (*type) {
             case Filesystem::Type::Directory: {
-                filesystem->readDirectory(realPath, true, [&](std::string const &filename) -> bool {
-                    std::string path = realPath + "/" + filename;
+                filesystem->walkDirectory(realPath, true, false, [&](Filesystem::DirectoryEntry const &entry) -> bool {
+                    std::string path = realPath + "/" + entry.path;
 
                     /* Support both *.xcspec and *.pbfilespec as a few of the latter remain in use. */
                     if (FSUtil::GetFileExtension(path) != "xcspec" && FSUtil::GetFileExtension(path) != "pbfilespec") {
@@ -402,7 +402,7 @@ registerDomains(Filesystem const *filesystem, std::vector<std::pair<std::string,
                         defaultType = SpecificationType::FileType;
                     }
 
-                    if (filesystem->type(path) != Filesystem::Type::Directory) {
+                    if (entry.type != Filesystem::Type::Directory) {
 #if 0
                         fprintf(stderr, "importing specification '%s'\n", path.c_str());
 #endif
@@ -13,16 +13,30 @@
 #include <plist/Format/ABPRecordType.h>
 #include <plist/Objects.h>
 
+#include <string>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
 
 class ABPWriter : public ABPContext {
+private:
+    /*
+     * Hash and compare scalar objects by value, so equal values can be
+     * written once and shared. Containers only compare by identity.
+     */
+    struct UniqueHash {
+        size_t operator()(plist::Object const *object) const;
+    };
+    struct UniqueEqual {
+        bool operator()(plist::Object const *a, plist::Object const *b) const;
+    };
+
 private:
     std::unordered_map<plist::Object const *, int>                   _references;
     std::unordered_map<plist::Object const *, plist::Object const *> _mappings;
     std::unordered_set<plist::Object const *>                        _written;
-    std::unordered_map<plist::Dictionary const *, std::unordered_map<int, plist::String *>> _keyStrings;
+    std::unordered_set<plist::Object const *, UniqueHash, UniqueEqual> _uniques;
+    std::unordered_map<std::string, plist::String *>                 _keyStrings;
 
 public:
     std::vector<uint8_t>                                            *_mutableContents;
@@ -81,6 +95,7 @@ private:
     bool writePreflightDictionary(plist::Dictionary const *dict);
 
 private:
+    plist::Object const *uniqueObject(plist::Object const *object);
     bool processObject(plist::Object const **object, uint32_t *refno, bool userProcess);
 };
 
@@ -262,20 +262,21 @@ writeArray(Array const *array)
 }
 
 /*
- * Workaround for Dictionaries not having keys with identity. Map from integer key
- * index to key value to use as the identity when writing the key object out.
+ * Workaround for Dictionaries not having keys with identity. Map from key
+ * value to a string object to use as the identity when writing the key
+ * out; equal keys in different dictionaries share the same object.
  */
 String const *ABPWriter::
 dictionaryKeyString(Dictionary const *dict, int key)
 {
-    std::unordered_map<int, String *> *map = &this->_keyStrings[dict];
+    std::string const &value = dict->key(key);
 
-    auto it = map->find(key);
-    if (it != map->end()) {
+    auto it = this->_keyStrings.find(value);
+    if (it != this->_keyStrings.end()) {
         return it->second;
     } else {
-        auto string = String::New(dict->key(key));
-        map->insert({ key, string.get() });
+        auto string = String::New(value);
+        this->_keyStrings.insert({ value, string.get() });
         return string.release();
     }
 }
@@ -363,6 +364,84 @@ writePreflightDictionary(Dictionary const *dict)
     return true;
 }
 
+/* Uniquing */
+
+static size_t
+HashBytes(uint8_t const *bytes, size_t length)
+{
+    /* FNV-1a. */
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t n = 0; n < length; n++) {
+        hash = (hash ^ bytes[n]) * 0x100000001b3ULL;
+    }
+    return static_cast<size_t>(hash);
+}
+
+static uint64_t
+RealBits(double value)
+{
+    /* Compare bits, so 0.0 and -0.0 stay distinct. */
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+size_t ABPWriter::UniqueHash::
+operator()(Object const *object) const
+{
+    if (auto string = plist::CastTo<String>(object)) {
+        return std::hash<std::string>()(string->value());
+    } else if (auto integer = plist::CastTo<Integer>(object)) {
+        return std::hash<int64_t>()(integer->value());
+    } else if (auto real = plist::CastTo<Real>(object)) {
+        return std::hash<uint64_t>()(RealBits(real->value()));
+    } else if (auto boolean = plist::CastTo<Boolean>(object)) {
+        return std::hash<bool>()(boolean->value());
+    } else if (auto data = plist::CastTo<Data>(object)) {
+        return HashBytes(data->value().data(), data->value().size());
+    } else if (auto date = plist::CastTo<Date>(object)) {
+        return std::hash<uint64_t>()(date->unixTimeValue());
+    } else if (auto uid = plist::CastTo<UID>(object)) {
+        return std::hash<uint32_t>()(uid->value());
+    } else {
+        return std::hash<Object const *>()(object);
+    }
+}
+
+bool ABPWriter::UniqueEqual::
+operator()(Object const *a, Object const *b) const
+{
+    if (a == b) {
+        return true;
+    } else if (a->type() != b->type()) {
+        return false;
+    }
+
+    if (auto real = plist::CastTo<Real>(a)) {
+        return RealBits(real->value()) == RealBits(plist::CastTo<Real>(b)->value());
+    } else if (plist::CastTo<Array>(a) != nullptr || plist::CastTo<Dictionary>(a) != nullptr || plist::CastTo<Null>(a) != nullptr) {
+        return false;
+    } else {
+        return a->equals(b);
+    }
+}
+
+/*
+ * Find the object to write for a value. Equal scalar values, including
+ * dictionary keys, are written once and referenced from everywhere they
+ * appear, as CoreFoundation does.
+ */
+Object const *ABPWriter::
+uniqueObject(Object const *object)
+{
+    ObjectType type = object->type();
+    if (type == Array::Type() || type == Dictionary::Type() || type == Null::Type()) {
+        return object;
+    }
+
+    return *this->_uniques.insert(object).first;
+}
+
 /*
  * Process an object, calls the user callback in order to
  * return a suitable object for the encoding; the object
@@ -383,7 +462,7 @@ processObject(Object const **object, uint32_t *refno, bool userProcess)
     if (mit != this->_mappings.end()) {
         newObject = mit->second;
     } else {
-        newObject = origObject;
+        newObject = this->uniqueObject(origObject);
 
         /* Process the object for mapping. */
         if (userProcess) {
@@ -610,10 +689,8 @@ close()
             return false;
     }
 
-    for (auto const &map : this->_keyStrings) {
-        for (auto const &item : map.second) {
-            item.second->release();
-        }
+    for (auto const &item : this->_keyStrings) {
+        item.second->release();
     }
 
     return true;
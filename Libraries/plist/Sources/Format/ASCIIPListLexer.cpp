@@ -13,6 +13,18 @@
 #include <string.h>
 #include <stdlib.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ASCIIPLIST_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ASCIIPLIST_NEON 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 /*
  * Syntax:
  *
@@ -100,14 +112,144 @@ hex2bin(char ch)
         return (ch - '0');
 }
 
+/** Scanning **/
+
+/*
+ * Nearly all of a property list is long runs of unquoted or quoted string
+ * characters and comments, so those are scanned a vector at a time where
+ * the target supports it. Each scan stops at the end of the buffer; the
+ * scalar loops finish whatever is left over or locate the exact byte.
+ */
+
+#if ASCIIPLIST_SSE2
+static inline int
+firstsetbit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+#if ASCIIPLIST_NEON
+static inline bool
+anyset(uint8x16_t mask)
+{
+    uint64x2_t wide = vreinterpretq_u64_u8(mask);
+    return (vgetq_lane_u64(wide, 0) | vgetq_lane_u64(wide, 1)) != 0;
+}
+#endif
+
+/* Find the first of up to four bytes (pass duplicates for fewer). */
+static inline char const *
+scanuntil(char const *p, char const *end, char a, char b, char c, char d)
+{
+#if ASCIIPLIST_SSE2
+    __m128i const va = _mm_set1_epi8(a);
+    __m128i const vb = _mm_set1_epi8(b);
+    __m128i const vc = _mm_set1_epi8(c);
+    __m128i const vd = _mm_set1_epi8(d);
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((__m128i const *)p);
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)),
+                                 _mm_or_si128(_mm_cmpeq_epi8(v, vc), _mm_cmpeq_epi8(v, vd)));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(m);
+        if (mask != 0) {
+            return p + firstsetbit(mask);
+        }
+        p += 16;
+    }
+#elif ASCIIPLIST_NEON
+    uint8x16_t const va = vdupq_n_u8((uint8_t)a);
+    uint8x16_t const vb = vdupq_n_u8((uint8_t)b);
+    uint8x16_t const vc = vdupq_n_u8((uint8_t)c);
+    uint8x16_t const vd = vdupq_n_u8((uint8_t)d);
+    while (end - p >= 16) {
+        uint8x16_t v = vld1q_u8((uint8_t const *)p);
+        uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, va), vceqq_u8(v, vb)),
+                                vorrq_u8(vceqq_u8(v, vc), vceqq_u8(v, vd)));
+        if (anyset(m)) {
+            break;
+        }
+        p += 16;
+    }
+#endif
+
+    while (p < end && *p != a && *p != b && *p != c && *p != d) {
+        p++;
+    }
+    return p;
+}
+
+static inline bool
+isunquoted(char ch)
+{
+    /*
+     * '$' is encountered in pbxproj files.
+     */
+    return (isalnum((unsigned char)ch) || ch == '_' || ch == '.' || ch == '$' ||
+            ch == '-' || ch == ':' || ch == '/');
+}
+
+/* Find the end of a run of unquoted string characters. */
+static inline char const *
+scanunquoted(char const *p, char const *end)
+{
+    /* Letters (case folded), '-' through ':' (includes digits), '$' and '_'. */
+#if ASCIIPLIST_SSE2
+    __m128i const fold  = _mm_set1_epi8(0x20);
+    __m128i const lower = _mm_set1_epi8('a' - 1);
+    __m128i const upper = _mm_set1_epi8('z' + 1);
+    __m128i const first = _mm_set1_epi8('-' - 1);
+    __m128i const last  = _mm_set1_epi8(':' + 1);
+    __m128i const dollar = _mm_set1_epi8('$');
+    __m128i const under  = _mm_set1_epi8('_');
+    while (end - p >= 16) {
+        /* Signed compares, so bytes with the high bit set never match. */
+        __m128i v = _mm_loadu_si128((__m128i const *)p);
+        __m128i f = _mm_or_si128(v, fold);
+        __m128i m = _mm_and_si128(_mm_cmpgt_epi8(f, lower), _mm_cmplt_epi8(f, upper));
+        m = _mm_or_si128(m, _mm_and_si128(_mm_cmpgt_epi8(v, first), _mm_cmplt_epi8(v, last)));
+        m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, dollar), _mm_cmpeq_epi8(v, under)));
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(m) & 0xffff;
+        if (mask != 0) {
+            return p + firstsetbit(mask);
+        }
+        p += 16;
+    }
+#elif ASCIIPLIST_NEON
+    uint8x16_t const fold = vdupq_n_u8(0x20);
+    while (end - p >= 16) {
+        uint8x16_t v = vld1q_u8((uint8_t const *)p);
+        uint8x16_t f = vorrq_u8(v, fold);
+        uint8x16_t m = vandq_u8(vcgeq_u8(f, vdupq_n_u8('a')), vcleq_u8(f, vdupq_n_u8('z')));
+        m = vorrq_u8(m, vandq_u8(vcgeq_u8(v, vdupq_n_u8('-')), vcleq_u8(v, vdupq_n_u8(':'))));
+        m = vorrq_u8(m, vorrq_u8(vceqq_u8(v, vdupq_n_u8('$')), vceqq_u8(v, vdupq_n_u8('_'))));
+        if (anyset(vmvnq_u8(m))) {
+            break;
+        }
+        p += 16;
+    }
+#endif
+
+    while (p < end && isunquoted(*p)) {
+        p++;
+    }
+    return p;
+}
+
 static int
 ASCIIPListLexerReadInlineComment(ASCIIPListLexer *lexer)
 {
     char const *b, *p = lexer->pointer + 2;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\0' && *p != '\n' && *p != '\r'; p++)
-        ;
+    b = p;
+    p = scanuntil(p, lexer->endBuffer, '\0', '\n', '\r', '\r');
     lexer->tokenLength = p - b;
     lexer->pointer = p;
 
@@ -120,11 +262,11 @@ ASCIIPListLexerReadLongComment(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 2;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\0'; p++) {
+    for (b = p; (p = scanuntil(p, lexer->endBuffer, '\0', '\n', '*', '*')) < lexer->endBuffer && *p != '\0'; p++) {
         if (p[0] == '\n') {
             lexer->line++;
             lexer->lineStart = p + 1;
-        } else if (p[0] == '*' && p[1] == '/') {
+        } else if (p + 1 < lexer->endBuffer && p[1] == '/') {
             lexer->tokenLength = p - b;
             lexer->pointer = p + 2;
             return kASCIIPListLexerTokenLongComment;
@@ -140,14 +282,12 @@ ASCIIPListLexerReadSingleQuotedString(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 1;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\'' && *p != '\0'; p++) {
-        if (*p == '\n') {
-            lexer->line++;
-            lexer->lineStart = p + 1;
-        }
+    for (b = p; (p = scanuntil(p, lexer->endBuffer, '\'', '\0', '\n', '\n')) < lexer->endBuffer && *p == '\n'; p++) {
+        lexer->line++;
+        lexer->lineStart = p + 1;
     }
 
-    if (*p != '\'') {
+    if (p >= lexer->endBuffer || *p != '\'') {
         return kASCIIPListLexerUnterminatedQuotedString;
     }
 
@@ -163,16 +303,16 @@ ASCIIPListLexerReadDoubleQuotedString(ASCIIPListLexer *lexer)
     char const *b, *p = lexer->pointer + 1;
 
     lexer->tokenBegin = (p - lexer->inputBuffer);
-    for (b = p; *p != '\"' && *p != '\0'; p++) {
+    for (b = p; (p = scanuntil(p, lexer->endBuffer, '\"', '\0', '\n', '\\')) < lexer->endBuffer && (*p == '\n' || *p == '\\'); p++) {
         if (*p == '\n') {
             lexer->line++;
             lexer->lineStart = p + 1;
-        } else if (*p == '\\') {
-            p++;
+        } else if (++p >= lexer->endBuffer) {
+            break;
         }
     }
 
-    if (*p != '\"') {
+    if (p >= lexer->endBuffer || *p != '\"') {
         return kASCIIPListLexerUnterminatedQuotedString;
     }
 
@@ -312,17 +452,7 @@ ASCIIPListLexerReadKeyword(ASCIIPListLexer *lexer)
         }
     } else if (lexer->style == kASCIIPListLexerStyleASCII) {
         rc = kASCIIPListLexerTokenUnquotedString;
-        /*
-            * '$' is encountered in pbxproj files.
-            */
-        while (isalnum(*p) || *p == '_' || *p == '.' || *p == '$' ||
-                              *p == '-' || *p == ':' || *p == '/') {
-            if (*p & 0x80) {
-                rc = kASCIIPListLexerInvalidToken;
-                break;
-            }
-            p++;
-        }
+        p = scanunquoted(p, lexer->endBuffer);
     } else {
         rc = kASCIIPListLexerInvalidToken;
     }
@@ -7,14 +7,22 @@
  */
 
 #include <plist/Format/Encoding.h>
-#include <plist/Format/unicode.h>
 
-#include <cassert>
+#include <algorithm>
+#include <cstdlib>
 
 #if defined(__linux__)
 #include <endian.h>
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PLIST_ENCODING_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PLIST_ENCODING_NEON 1
+#endif
+
 using plist::Format::Encoding;
 using plist::Format::Encodings;
 
@@ -131,90 +139,414 @@ EndianSwapBuffer(std::vector<uint8_t> *buffer, Endian src, Endian dest)
     }
 }
 
+/*
+ * Transcoding goes between UTF-8 and the other encodings directly, in the
+ * byte order of the destination. Runs of ASCII, which is most of the text
+ * in property lists and strings files, are converted a vector at a time
+ * where the target supports it; everything else is converted one code
+ * point at a time. Invalid sequences and unpaired surrogates are dropped.
+ */
+
+static inline uint16_t
+LoadUnit16(uint8_t const *p, Endian endian)
+{
+    return (endian == Endian::Little ?
+        static_cast<uint16_t>(p[0] | (p[1] << 8)) :
+        static_cast<uint16_t>((p[0] << 8) | p[1]));
+}
+
+static inline uint8_t *
+StoreUnit16(uint8_t *p, uint16_t value, Endian endian)
+{
+    if (endian == Endian::Little) {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+    } else {
+        p[0] = static_cast<uint8_t>(value >> 8);
+        p[1] = static_cast<uint8_t>(value);
+    }
+    return p + 2;
+}
+
+static inline uint32_t
+LoadUnit32(uint8_t const *p, Endian endian)
+{
+    return (endian == Endian::Little ?
+        (static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24)) :
+        ((static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3])));
+}
+
+static inline uint8_t *
+StoreUnit32(uint8_t *p, uint32_t value, Endian endian)
+{
+    if (endian == Endian::Little) {
+        p = StoreUnit16(p, static_cast<uint16_t>(value), endian);
+        return StoreUnit16(p, static_cast<uint16_t>(value >> 16), endian);
+    } else {
+        p = StoreUnit16(p, static_cast<uint16_t>(value >> 16), endian);
+        return StoreUnit16(p, static_cast<uint16_t>(value), endian);
+    }
+}
+
+static inline bool
+IsContinuation(uint8_t c)
+{
+    return (c & 0xC0) == 0x80;
+}
+
+/*
+ * Decode one code point. Returns the number of bytes used, or zero if the
+ * sequence is invalid, in which case the first byte should be skipped.
+ */
+static inline size_t
+DecodeUTF8(uint8_t const *s, uint8_t const *end, uint32_t *codepoint)
+{
+    uint8_t c = s[0];
+    if (c < 0x80) {
+        *codepoint = c;
+        return 1;
+    } else if (c < 0xC2 || c >= 0xF5) {
+        /* Continuation without a lead byte, overlong, or above U+10FFFF. */
+        return 0;
+    } else if (c < 0xE0) {
+        if (end - s < 2 || !IsContinuation(s[1])) {
+            return 0;
+        }
+        *codepoint = ((c & 0x1F) << 6) | (s[1] & 0x3F);
+        return 2;
+    } else if (c < 0xF0) {
+        if (end - s < 3 || !IsContinuation(s[1]) || !IsContinuation(s[2])) {
+            return 0;
+        }
+        uint32_t value = ((c & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+        if (value < 0x800 || (value >= 0xD800 && value <= 0xDFFF)) {
+            /* Overlong or an encoded surrogate. */
+            return 0;
+        }
+        *codepoint = value;
+        return 3;
+    } else {
+        if (end - s < 4 || !IsContinuation(s[1]) || !IsContinuation(s[2]) || !IsContinuation(s[3])) {
+            return 0;
+        }
+        uint32_t value = ((c & 0x07) << 18) | ((s[1] & 0x3F) << 12) | ((s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+        if (value < 0x10000 || value > 0x10FFFF) {
+            return 0;
+        }
+        *codepoint = value;
+        return 4;
+    }
+}
+
+static inline uint8_t *
+EncodeUTF8(uint8_t *d, uint32_t codepoint)
+{
+    if (codepoint < 0x80) {
+        *d++ = static_cast<uint8_t>(codepoint);
+    } else if (codepoint < 0x800) {
+        *d++ = static_cast<uint8_t>(0xC0 | (codepoint >> 6));
+        *d++ = static_cast<uint8_t>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        *d++ = static_cast<uint8_t>(0xE0 | (codepoint >> 12));
+        *d++ = static_cast<uint8_t>(0x80 | ((codepoint >> 6) & 0x3F));
+        *d++ = static_cast<uint8_t>(0x80 | (codepoint & 0x3F));
+    } else {
+        *d++ = static_cast<uint8_t>(0xF0 | (codepoint >> 18));
+        *d++ = static_cast<uint8_t>(0x80 | ((codepoint >> 12) & 0x3F));
+        *d++ = static_cast<uint8_t>(0x80 | ((codepoint >> 6) & 0x3F));
+        *d++ = static_cast<uint8_t>(0x80 | (codepoint & 0x3F));
+    }
+    return d;
+}
+
+#if PLIST_ENCODING_NEON
+static inline bool
+AnySet(uint8x16_t mask)
+{
+    uint64x2_t wide = vreinterpretq_u64_u8(mask);
+    return (vgetq_lane_u64(wide, 0) | vgetq_lane_u64(wide, 1)) != 0;
+}
+#endif
+
+/* Widen ASCII to UTF-16 while it lasts; returns how many bytes were used. */
+static inline size_t
+WidenASCII(uint8_t const *s, uint8_t const *end, uint8_t *d, Endian endian)
+{
+    uint8_t const *begin = s;
+
+#if PLIST_ENCODING_SSE2
+    __m128i const zero = _mm_setzero_si128();
+    while (end - s >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(s));
+        if (_mm_movemask_epi8(v) != 0) {
+            break;
+        }
+
+        bool little = (endian == Endian::Little);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d), little ? _mm_unpacklo_epi8(v, zero) : _mm_unpacklo_epi8(zero, v));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d + 16), little ? _mm_unpackhi_epi8(v, zero) : _mm_unpackhi_epi8(zero, v));
+        s += 16;
+        d += 32;
+    }
+#elif PLIST_ENCODING_NEON
+    uint8x16_t const zero = vdupq_n_u8(0);
+    while (end - s >= 16) {
+        uint8x16_t v = vld1q_u8(s);
+        if (AnySet(vandq_u8(v, vdupq_n_u8(0x80)))) {
+            break;
+        }
+
+        uint8x16x2_t units = (endian == Endian::Little ? vzipq_u8(v, zero) : vzipq_u8(zero, v));
+        vst1q_u8(d, units.val[0]);
+        vst1q_u8(d + 16, units.val[1]);
+        s += 16;
+        d += 32;
+    }
+#endif
+
+    return s - begin;
+}
+
+/* Narrow ASCII from UTF-16 while it lasts; returns how many units were used. */
+static inline size_t
+NarrowASCII(uint8_t const *s, uint8_t const *end, uint8_t *d, Endian endian)
+{
+    uint8_t const *begin = s;
+
+#if PLIST_ENCODING_SSE2
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const high = _mm_set1_epi16(static_cast<short>(0xFF80));
+    while (end - s >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(s));
+        if (endian == Endian::Big) {
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, high), zero)) != 0xFFFF) {
+            break;
+        }
+
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(d), _mm_packus_epi16(v, v));
+        s += 16;
+        d += 8;
+    }
+#elif PLIST_ENCODING_NEON
+    while (end - s >= 32) {
+        /* Even and odd bytes, so the low and high bytes of each unit. */
+        uint8x16x2_t bytes = vld2q_u8(s);
+        uint8x16_t low = (endian == Endian::Little ? bytes.val[0] : bytes.val[1]);
+        uint8x16_t high = (endian == Endian::Little ? bytes.val[1] : bytes.val[0]);
+        if (AnySet(vorrq_u8(high, vandq_u8(low, vdupq_n_u8(0x80))))) {
+            break;
+        }
+
+        vst1q_u8(d, low);
+        s += 32;
+        d += 16;
+    }
+#endif
+
+    return (s - begin) / sizeof(uint16_t);
+}
+
+static std::vector<uint8_t>
+UTF8ToUTF16(uint8_t const *s, uint8_t const *end, Endian endian)
+{
+    /* At most one unit per byte. */
+    std::vector<uint8_t> result;
+    result.resize((end - s) * sizeof(uint16_t));
+    uint8_t *d = result.data();
+
+    while (s < end) {
+        size_t ascii = WidenASCII(s, end, d, endian);
+        s += ascii;
+        d += ascii * sizeof(uint16_t);
+
+        /* Convert through the block that stopped the vector loop. */
+        uint8_t const *stop = s + std::min<size_t>(end - s, 16);
+        while (s < stop) {
+            uint32_t codepoint;
+            size_t length = DecodeUTF8(s, end, &codepoint);
+            if (length == 0) {
+                s++;
+                continue;
+            }
+            s += length;
+
+            if (codepoint < 0x10000) {
+                d = StoreUnit16(d, static_cast<uint16_t>(codepoint), endian);
+            } else {
+                codepoint -= 0x10000;
+                d = StoreUnit16(d, static_cast<uint16_t>(0xD800 | (codepoint >> 10)), endian);
+                d = StoreUnit16(d, static_cast<uint16_t>(0xDC00 | (codepoint & 0x3FF)), endian);
+            }
+        }
+    }
+
+    result.resize(d - result.data());
+    return result;
+}
+
+static std::vector<uint8_t>
+UTF16ToUTF8(uint8_t const *s, uint8_t const *end, Endian endian)
+{
+    /* Any trailing odd byte is not a unit. */
+    end = s + (end - s) / sizeof(uint16_t) * sizeof(uint16_t);
+
+    /* At most three bytes per unit; pairs take four bytes for two units. */
+    std::vector<uint8_t> result;
+    result.resize((end - s) / sizeof(uint16_t) * 3);
+    uint8_t *d = result.data();
+
+    while (s < end) {
+        size_t ascii = NarrowASCII(s, end, d, endian);
+        s += ascii * sizeof(uint16_t);
+        d += ascii;
+
+        uint8_t const *stop = s + std::min<size_t>(end - s, 32);
+        while (s < stop) {
+            uint32_t codepoint = LoadUnit16(s, endian);
+            s += sizeof(uint16_t);
+
+            if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                uint32_t trail = (s < end ? LoadUnit16(s, endian) : 0);
+                if (trail < 0xDC00 || trail > 0xDFFF) {
+                    /* Unpaired leading surrogate. */
+                    continue;
+                }
+                s += sizeof(uint16_t);
+                codepoint = 0x10000 + (((codepoint & 0x3FF) << 10) | (trail & 0x3FF));
+            } else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+                /* Unpaired trailing surrogate. */
+                continue;
+            }
+
+            d = EncodeUTF8(d, codepoint);
+        }
+    }
+
+    result.resize(d - result.data());
+    return result;
+}
+
+static std::vector<uint8_t>
+UTF8ToUTF32(uint8_t const *s, uint8_t const *end, Endian endian)
+{
+    /* At most one unit per byte. */
+    std::vector<uint8_t> result;
+    result.resize((end - s) * sizeof(uint32_t));
+    uint8_t *d = result.data();
+
+    while (s < end) {
+        uint32_t codepoint;
+        size_t length = DecodeUTF8(s, end, &codepoint);
+        if (length == 0) {
+            s++;
+            continue;
+        }
+        s += length;
+
+        d = StoreUnit32(d, codepoint, endian);
+    }
+
+    result.resize(d - result.data());
+    return result;
+}
+
+static std::vector<uint8_t>
+UTF32ToUTF8(uint8_t const *s, uint8_t const *end, Endian endian)
+{
+    /* Any trailing partial unit is ignored. */
+    end = s + (end - s) / sizeof(uint32_t) * sizeof(uint32_t);
+
+    /* At most four bytes per unit. */
+    std::vector<uint8_t> result;
+    result.resize(end - s);
+    uint8_t *d = result.data();
+
+    for (; s < end; s += sizeof(uint32_t)) {
+        uint32_t codepoint = LoadUnit32(s, endian);
+        if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+            continue;
+        }
+
+        d = EncodeUTF8(d, codepoint);
+    }
+
+    result.resize(d - result.data());
+    return result;
+}
+
+static std::vector<uint8_t>
+FromUTF8(uint8_t const *begin, uint8_t const *end, Encoding to)
+{
+    switch (to) {
+        case Encoding::UTF8:
+            return std::vector<uint8_t>(begin, end);
+        case Encoding::UTF16LE:
+        case Encoding::UTF16BE:
+            return UTF8ToUTF16(begin, end, EncodingEndian(to));
+        case Encoding::UTF32LE:
+        case Encoding::UTF32BE:
+            return UTF8ToUTF32(begin, end, EncodingEndian(to));
+    }
+
+    abort();
+}
+
+static std::vector<uint8_t>
+ToUTF8(uint8_t const *begin, uint8_t const *end, Encoding from)
+{
+    switch (from) {
+        case Encoding::UTF8:
+            return std::vector<uint8_t>(begin, end);
+        case Encoding::UTF16LE:
+        case Encoding::UTF16BE:
+            return UTF16ToUTF8(begin, end, EncodingEndian(from));
+        case Encoding::UTF32LE:
+        case Encoding::UTF32BE:
+            return UTF32ToUTF8(begin, end, EncodingEndian(from));
+    }
+
+    abort();
+}
+
 std::vector<uint8_t> Encodings::
 Convert(std::vector<uint8_t> const &contents, Encoding from, Encoding to)
 {
-    std::vector<uint8_t> input = contents;
+    uint8_t const *begin = contents.data();
+    uint8_t const *end = contents.data() + contents.size();
 
-    /* Remove any BOM at the start. */
+    /* Skip any BOM at the start. */
     std::vector<uint8_t> BOM = Encodings::BOM(from);
-    if (input.size() >= BOM.size() && std::equal(BOM.begin(), BOM.end(), contents.begin())) {
-        input.erase(input.begin(), input.begin() + BOM.size());
+    if (contents.size() >= BOM.size() && std::equal(BOM.begin(), BOM.end(), contents.begin())) {
+        begin += BOM.size();
     }
 
     /* No conversion needed, just byte swap if necessary. */
     if (from == to) {
-        return input;
+        return std::vector<uint8_t>(begin, end);
     } else if ((from == Encoding::UTF16LE && to == Encoding::UTF16BE) ||
                (from == Encoding::UTF16BE && to == Encoding::UTF16LE)) {
-        EndianSwapBuffer<uint16_t>(&input, EncodingEndian(from), EncodingEndian(to));
-        return input;
+        std::vector<uint8_t> result = std::vector<uint8_t>(begin, end);
+        EndianSwapBuffer<uint16_t>(&result, EncodingEndian(from), EncodingEndian(to));
+        return result;
     } else if ((from == Encoding::UTF32LE && to == Encoding::UTF32BE) ||
                (from == Encoding::UTF32BE && to == Encoding::UTF32LE)) {
-        EndianSwapBuffer<uint32_t>(&input, EncodingEndian(from), EncodingEndian(to));
-        return input;
+        std::vector<uint8_t> result = std::vector<uint8_t>(begin, end);
+        EndianSwapBuffer<uint32_t>(&result, EncodingEndian(from), EncodingEndian(to));
+        return result;
     }
 
     /*
-     * Convert to UTF-8 as an intermediate format.
+     * Convert directly to or from UTF-8, otherwise use it as an
+     * intermediate format.
      */
-    std::vector<uint8_t> intermediate;
     if (from == Encoding::UTF8) {
-        intermediate = input;
+        return FromUTF8(begin, end, to);
+    } else if (to == Encoding::UTF8) {
+        return ToUTF8(begin, end, from);
     } else {
-        if (from == Encoding::UTF16LE || from == Encoding::UTF16BE) {
-            EndianSwapBuffer<uint16_t>(&input, EncodingEndian(from), HostEndian);
-
-            intermediate.resize(input.size() * sizeof(uint8_t) * 2);
-            size_t length = ::utf16_to_utf8(
-                reinterpret_cast<char *>(intermediate.data()), intermediate.size() / sizeof(char),
-                reinterpret_cast<uint16_t *>(input.data()), input.size() / sizeof(uint16_t),
-                0, nullptr);
-            intermediate.resize(length);
-        } else if (from == Encoding::UTF32LE || from == Encoding::UTF32BE) {
-            EndianSwapBuffer<uint32_t>(&input, EncodingEndian(from), HostEndian);
-
-            intermediate.resize(input.size() * sizeof(uint8_t));
-            size_t length = ::utf32_to_utf8(
-                reinterpret_cast<char *>(intermediate.data()), intermediate.size() / sizeof(char),
-                reinterpret_cast<uint32_t *>(input.data()), input.size() / sizeof(uint32_t),
-                0, nullptr);
-            intermediate.resize(length);
-        } else {
-            assert(false && "unknown encoding");
-        }
-    }
-
-    /*
-     * Convert to the resulting format.
-     */
-    if (to == Encoding::UTF8) {
-        return intermediate;
-    } else {
-        std::vector<uint8_t> result;
-
-        if (to == Encoding::UTF16LE || to == Encoding::UTF16BE) {
-            result.resize(contents.size() * sizeof(uint16_t) * 3);
-            size_t length = ::utf8_to_utf16(
-                reinterpret_cast<uint16_t *>(result.data()), result.size() / sizeof(uint16_t),
-                reinterpret_cast<char *>(intermediate.data()), intermediate.size() / sizeof(char),
-                0, nullptr);
-            result.resize(length * sizeof(uint16_t));
-
-            EndianSwapBuffer<uint16_t>(&result, HostEndian, EncodingEndian(to));
-        } else if (to == Encoding::UTF32LE || to == Encoding::UTF32BE) {
-            result.resize(intermediate.size() * sizeof(uint32_t));
-            size_t length = ::utf8_to_utf32(
-                reinterpret_cast<uint32_t *>(result.data()), result.size() / sizeof(uint32_t),
-                reinterpret_cast<char *>(intermediate.data()), intermediate.size() / sizeof(char),
-                0, nullptr);
-            result.resize(length * sizeof(uint32_t));
-
-            EndianSwapBuffer<uint32_t>(&result, HostEndian, EncodingEndian(to));
-        } else {
-            assert(false && "unknown encoding");
-        }
-
-        return result;
+        std::vector<uint8_t> intermediate = ToUTF8(begin, end, from);
+        return FromUTF8(intermediate.data(), intermediate.data() + intermediate.size(), to);
     }
 }
@@ -145,3 +145,49 @@ TEST(ASCII, CommentWithStarAndSlash)
     dictionary->set("key", String::New("value"));
     EXPECT_TRUE(deserialize.first->equals(dictionary.get()));
 }
+
+TEST(ASCII, LongTokens)
+{
+    /* Long enough to be scanned in blocks, with the interesting byte at every offset in a block. */
+    for (size_t n = 0; n < 40; n++) {
+        std::string prefix = std::string(n, 'a');
+        std::string unquoted = prefix + "$SRCROOT/Sources-1.0:_Z9";
+        std::string quoted = prefix + "\\\"\\\\" + std::string(n % 17, 'b') + "\\n";
+        std::string single = prefix + "'\"";
+
+        auto contents = Contents(
+            "/* " + prefix + " * /\n " + prefix + " */\n"
+            "{\n"
+            "\t" + unquoted + " = \"" + quoted + "\"; // " + prefix + "\n"
+            "\tsingle = '" + prefix + "\n\"';\n"
+            "\tend = " + unquoted + ";\n"
+            "}\n");
+
+        auto deserialize = ASCII::Deserialize(contents, ASCII::Create(false, Encoding::UTF8));
+        ASSERT_NE(deserialize.first, nullptr) << deserialize.second;
+
+        auto dictionary = Dictionary::New();
+        dictionary->set(unquoted, String::New(prefix + "\"\\" + std::string(n % 17, 'b') + "\n"));
+        dictionary->set("single", String::New(prefix + "\n\""));
+        dictionary->set("end", String::New(unquoted));
+        EXPECT_TRUE(deserialize.first->equals(dictionary.get())) << n;
+    }
+}
+
+TEST(ASCII, LongTokenErrors)
+{
+    std::string prefix = std::string(40, 'a');
+
+    /* Lines are still counted inside comments and strings. */
+    auto comment = ASCII::Deserialize(Contents("/*\n" + prefix + "\n\n" + prefix), ASCII::Create(false, Encoding::UTF8));
+    EXPECT_EQ(nullptr, comment.first);
+    EXPECT_EQ("[line 4] Encountered unterminated long comment", comment.second);
+
+    auto quoted = ASCII::Deserialize(Contents("{\n\tkey = \"" + prefix + "\n" + prefix + "\\\""), ASCII::Create(false, Encoding::UTF8));
+    EXPECT_EQ(nullptr, quoted.first);
+    EXPECT_EQ("[line 3] Encountered unterminated quoted string", quoted.second);
+
+    /* A trailing escape doesn't read past the end. */
+    auto escape = ASCII::Deserialize(Contents("\"" + prefix + "\\"), ASCII::Create(false, Encoding::UTF8));
+    EXPECT_EQ(nullptr, escape.first);
+}
@@ -12,6 +12,9 @@
 
 using plist::Format::Binary;
 using plist::String;
+using plist::Integer;
+using plist::Real;
+using plist::Array;
 using plist::Dictionary;
 
 TEST(Binary, UnicodeString)
@@ -56,3 +59,40 @@ TEST(Binary, UnicodeString)
     EXPECT_EQ(*serialize.first, contents);
 }
 
+
+static uint64_t
+ObjectsCount(std::vector<uint8_t> const &contents)
+{
+    /* Big-endian count in the trailer, after the sizes and filler. */
+    uint64_t count = 0;
+    for (size_t n = contents.size() - 24; n < contents.size() - 16; n++) {
+        count = (count << 8) | contents[n];
+    }
+    return count;
+}
+
+TEST(Binary, UniqueValues)
+{
+    auto array = Array::New();
+    for (int n = 0; n < 3; n++) {
+        auto dict = Dictionary::New();
+        dict->set("name", String::New("name"));
+        dict->set("count", Integer::New(1));
+        dict->set("zero", Real::New(0.0));
+        dict->set("negative", Real::New(-0.0));
+        array->append(std::move(dict));
+    }
+
+    auto serialize = Binary::Serialize(array.get(), Binary::Create());
+    ASSERT_NE(serialize.first, nullptr);
+
+    /*
+     * Equal keys and values are written once: the array, three dictionaries,
+     * four keys (one shared with an equal value), one integer and two reals.
+     */
+    EXPECT_EQ(11, ObjectsCount(*serialize.first));
+
+    auto deserialize = Binary::Deserialize(*serialize.first, Binary::Create());
+    ASSERT_NE(deserialize.first, nullptr);
+    EXPECT_TRUE(deserialize.first->equals(array.get()));
+}
@@ -167,3 +167,76 @@ TEST(Encoding, ConvertStripBOM)
         EXPECT_FALSE(std::equal(BOM.begin(), BOM.end(), converted.begin()));
     }
 }
+
+static std::vector<uint8_t>
+Encode(std::vector<uint32_t> const &codepoints, Encoding encoding)
+{
+    std::vector<uint8_t> result;
+    for (uint32_t c : codepoints) {
+        std::vector<uint32_t> units;
+        if (encoding == Encoding::UTF8) {
+            if (c < 0x80) {
+                result.push_back(c);
+            } else if (c < 0x800) {
+                result.insert(result.end(), { static_cast<uint8_t>(0xC0 | (c >> 6)), static_cast<uint8_t>(0x80 | (c & 0x3F)) });
+            } else if (c < 0x10000) {
+                result.insert(result.end(), { static_cast<uint8_t>(0xE0 | (c >> 12)), static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3F)), static_cast<uint8_t>(0x80 | (c & 0x3F)) });
+            } else {
+                result.insert(result.end(), { static_cast<uint8_t>(0xF0 | (c >> 18)), static_cast<uint8_t>(0x80 | ((c >> 12) & 0x3F)), static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3F)), static_cast<uint8_t>(0x80 | (c & 0x3F)) });
+            }
+            continue;
+        } else if (encoding == Encoding::UTF16LE || encoding == Encoding::UTF16BE) {
+            if (c < 0x10000) {
+                units = { c };
+            } else {
+                units = { 0xD800 | ((c - 0x10000) >> 10), 0xDC00 | ((c - 0x10000) & 0x3FF) };
+            }
+        } else {
+            units = { c };
+        }
+
+        size_t size = (encoding == Encoding::UTF16LE || encoding == Encoding::UTF16BE ? 2 : 4);
+        bool little = (encoding == Encoding::UTF16LE || encoding == Encoding::UTF32LE);
+        for (uint32_t unit : units) {
+            for (size_t i = 0; i < size; i++) {
+                size_t shift = (little ? i : size - 1 - i) * 8;
+                result.push_back(static_cast<uint8_t>(unit >> shift));
+            }
+        }
+    }
+    return result;
+}
+
+TEST(Encoding, ConvertLong)
+{
+    /* Long ASCII runs broken by other characters at every offset in a block. */
+    for (uint32_t n = 0; n < 70; n++) {
+        std::vector<uint32_t> codepoints = std::vector<uint32_t>(n, 'a');
+        codepoints.insert(codepoints.end(), { 0xE9, 'b', 0x4E2D, 0x7F, 0x1F4A9 });
+        codepoints.insert(codepoints.end(), n % 37, 'c');
+        codepoints.insert(codepoints.end(), { 0x10FFFD, 0x80, 0x7FF, 0x800, 0xFFFF, 0x10000 });
+        codepoints.insert(codepoints.end(), n, 'd');
+
+        for (Encoding from : AllEncodings) {
+            for (Encoding to : AllEncodings) {
+                EXPECT_EQ(Encode(codepoints, to), Encodings::Convert(Encode(codepoints, from), from, to)) << n;
+            }
+        }
+    }
+}
+
+TEST(Encoding, ConvertInvalid)
+{
+    /* Invalid UTF-8 is dropped: stray continuation, overlong, surrogate, truncated. */
+    std::vector<uint8_t> UTF8 = { 'a', 0x80, 'b', 0xC0, 0xAF, 'c', 0xED, 0xA0, 0x80, 'd', 0xE4, 0xB8 };
+    EXPECT_EQ(Encode({ 'a', 'b', 'c', 'd' }, Encoding::UTF16LE), Encodings::Convert(UTF8, Encoding::UTF8, Encoding::UTF16LE));
+
+    /* Unpaired surrogates are dropped, as is a trailing odd byte. */
+    std::vector<uint8_t> UTF16 = Encode({ 'a', 0xDC00, 'b', 0xD800, 'c', 0xD800 }, Encoding::UTF16BE);
+    UTF16.push_back('d');
+    EXPECT_EQ(Encode({ 'a', 'b', 'c' }, Encoding::UTF8), Encodings::Convert(UTF16, Encoding::UTF16BE, Encoding::UTF8));
+
+    /* Out of range code points are dropped. */
+    std::vector<uint8_t> UTF32 = Encode({ 'a', 0x110000, 'b', 0xDFFF, 'c' }, Encoding::UTF32LE);
+    EXPECT_EQ(Encode({ 'a', 'b', 'c' }, Encoding::UTF8), Encodings::Convert(UTF32, Encoding::UTF32LE, Encoding::UTF8));
+}
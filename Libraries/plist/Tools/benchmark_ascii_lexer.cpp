@@ -0,0 +1,130 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <plist/Format/ASCIIPListLexer.h>
+#include <libutil/DefaultFilesystem.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using libutil::DefaultFilesystem;
+
+/*
+ * Generate text shaped like a large project file: short dictionaries of
+ * identifiers, paths and quoted strings, each named by a comment.
+ */
+static std::vector<uint8_t>
+GenerateProject(size_t files)
+{
+    std::string contents = "// !$*UTF8*$!\n{\n\tarchiveVersion = 1;\n\tclasses = {\n\t};\n\tobjectVersion = 46;\n\tobjects = {\n";
+
+    char gid[25];
+    for (size_t n = 0; n < files; n++) {
+        std::string name = "Source" + std::to_string(n) + ".m";
+
+        snprintf(gid, sizeof(gid), "%024zX", n * 2);
+        std::string fileGID = gid;
+        snprintf(gid, sizeof(gid), "%024zX", n * 2 + 1);
+        std::string buildGID = gid;
+
+        contents += "\t\t" + buildGID + " /* " + name + " in Sources */ = {isa = PBXBuildFile; fileRef = " + fileGID + " /* " + name + " */; settings = {COMPILER_FLAGS = \"-DNAME=\\\"" + name + "\\\" -fobjc-arc\"; }; };\n";
+        contents += "\t\t" + fileGID + " /* " + name + " */ = {isa = PBXFileReference; fileEncoding = 4; lastKnownFileType = sourcecode.c.objc; path = Sources/Module/" + name + "; sourceTree = \"<group>\"; };\n";
+    }
+
+    contents += "\t};\n\trootObject = 000000000000000000000000;\n}\n";
+    return std::vector<uint8_t>(contents.begin(), contents.end());
+}
+
+/*
+ * Read every token, as the parser would, without building any objects.
+ * Returns the number of tokens, or nothing if lexing failed.
+ */
+static long
+Lex(std::vector<uint8_t> const &contents)
+{
+    ASCIIPListLexer lexer;
+    ASCIIPListLexerInit(&lexer, reinterpret_cast<char const *>(contents.data()), contents.size(), kASCIIPListLexerStyleASCII);
+
+    long tokens = 0;
+    while (true) {
+        int token = ASCIIPListLexerReadToken(&lexer);
+        if (token == kASCIIPListLexerEndOfFile) {
+            return tokens;
+        } else if (token < 0) {
+            return -1;
+        }
+        tokens++;
+    }
+}
+
+static bool
+Benchmark(std::string const &name, std::vector<uint8_t> const &contents, size_t iterations)
+{
+    long tokens = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < iterations; n++) {
+        tokens = Lex(contents);
+        if (tokens < 0) {
+            fprintf(stderr, "error: unable to lex %s\n", name.c_str());
+            return false;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count() / iterations;
+    printf("%s: %zu bytes, %ld tokens, %.2f ms, %.1f MB/s\n", name.c_str(), contents.size(), tokens,
+           seconds * 1000.0, contents.size() / seconds / (1024.0 * 1024.0));
+    return true;
+}
+
+int
+main(int argc, char **argv)
+{
+    size_t iterations = 10;
+    std::vector<std::string> paths;
+
+    for (int n = 1; n < argc; n++) {
+        std::string arg = argv[n];
+        if (arg == "-n" && n + 1 < argc) {
+            iterations = std::strtoul(argv[++n], nullptr, 10);
+        } else if (!arg.empty() && arg[0] == '-') {
+            fprintf(stderr, "usage: %s [-n iterations] [project.pbxproj ...]\n", argv[0]);
+            fprintf(stderr, "Without project files, a large project file is generated.\n");
+            return 1;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    if (paths.empty()) {
+        return Benchmark("generated", GenerateProject(50000), iterations) ? 0 : 1;
+    }
+
+    DefaultFilesystem filesystem = DefaultFilesystem();
+    for (std::string const &path : paths) {
+        std::vector<uint8_t> contents;
+        if (!filesystem.read(&contents, path)) {
+            fprintf(stderr, "error: unable to read %s\n", path.c_str());
+            return 1;
+        }
+
+        if (!Benchmark(path, contents, iterations)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
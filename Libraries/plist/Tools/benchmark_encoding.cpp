@@ -0,0 +1,195 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <plist/Format/Encoding.h>
+#include <plist/Format/unicode.h>
+#include <libutil/DefaultFilesystem.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+using plist::Format::Encoding;
+using plist::Format::Encodings;
+using libutil::DefaultFilesystem;
+
+/*
+ * The transcoding that plist::Format used before: a code unit at a time
+ * through the NetBSD helpers, byte swapping in a separate pass. Kept here
+ * to compare against.
+ */
+static void
+SwapUnits(std::vector<uint8_t> *buffer)
+{
+    for (size_t i = 0; i + 1 < buffer->size(); i += 2) {
+        std::swap((*buffer)[i], (*buffer)[i + 1]);
+    }
+}
+
+static std::vector<uint8_t>
+ReferenceToUTF8(std::vector<uint8_t> input, Encoding from)
+{
+    if (from == Encoding::UTF16BE) {
+        SwapUnits(&input);
+    }
+
+    std::vector<uint8_t> result;
+    result.resize(input.size() * 2);
+    size_t length = ::utf16_to_utf8(
+        reinterpret_cast<char *>(result.data()), result.size(),
+        reinterpret_cast<uint16_t *>(input.data()), input.size() / sizeof(uint16_t),
+        0, nullptr);
+    result.resize(length);
+    return result;
+}
+
+static std::vector<uint8_t>
+ReferenceFromUTF8(std::vector<uint8_t> const &input, Encoding to)
+{
+    std::vector<uint8_t> result;
+    result.resize(input.size() * sizeof(uint16_t) * 3);
+    size_t length = ::utf8_to_utf16(
+        reinterpret_cast<uint16_t *>(result.data()), result.size() / sizeof(uint16_t),
+        reinterpret_cast<char const *>(input.data()), input.size(),
+        0, nullptr);
+    result.resize(length * sizeof(uint16_t));
+
+    if (to == Encoding::UTF16BE) {
+        SwapUnits(&result);
+    }
+    return result;
+}
+
+/*
+ * Generate a strings file: ASCII keys and comments, with values in the
+ * given language. Returns UTF-8.
+ */
+static std::vector<uint8_t>
+GenerateStrings(std::string const &value, size_t size)
+{
+    std::string contents;
+    for (size_t n = 0; contents.size() < size; n++) {
+        std::string key = "SETTINGS_ITEM_" + std::to_string(n) + "_TITLE";
+        contents += "/* Title of settings item " + std::to_string(n) + " in the main list. */\n";
+        contents += "\"" + key + "\" = \"" + value + "\";\n\n";
+    }
+    return std::vector<uint8_t>(contents.begin(), contents.end());
+}
+
+static double
+Measure(size_t iterations, size_t bytes, std::function<size_t()> const &convert)
+{
+    size_t total = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < iterations; n++) {
+        total += convert();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    /* Use the result so the conversion isn't optimized away. */
+    if (total == 0 && bytes != 0) {
+        return 0.0;
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count() / iterations;
+    return bytes / seconds / (1024.0 * 1024.0);
+}
+
+static bool
+Benchmark(std::string const &name, std::vector<uint8_t> const &UTF8, size_t iterations)
+{
+    struct Case {
+        char const *description;
+        Encoding    from;
+        Encoding    to;
+    };
+
+    std::vector<Case> const cases = {
+        { "UTF-16LE -> UTF-8", Encoding::UTF16LE, Encoding::UTF8 },
+        { "UTF-8 -> UTF-16LE", Encoding::UTF8, Encoding::UTF16LE },
+        { "UTF-16BE -> UTF-8", Encoding::UTF16BE, Encoding::UTF8 },
+        { "UTF-8 -> UTF-16BE", Encoding::UTF8, Encoding::UTF16BE },
+    };
+
+    printf("%s (%zu bytes of UTF-8):\n", name.c_str(), UTF8.size());
+
+    for (Case const &c : cases) {
+        std::vector<uint8_t> input = (c.from == Encoding::UTF8 ? UTF8 : Encodings::Convert(UTF8, Encoding::UTF8, c.from));
+
+        auto reference = [&c, &input]() {
+            return (c.to == Encoding::UTF8 ? ReferenceToUTF8(input, c.from) : ReferenceFromUTF8(input, c.to));
+        };
+        auto convert = [&c, &input]() {
+            return Encodings::Convert(input, c.from, c.to);
+        };
+
+        if (reference() != convert()) {
+            fprintf(stderr, "error: %s: %s differs from the reference\n", name.c_str(), c.description);
+            return false;
+        }
+
+        double referenceRate = Measure(iterations, input.size(), [&reference] { return reference().size(); });
+        double convertRate = Measure(iterations, input.size(), [&convert] { return convert().size(); });
+        printf("  %-18s reference %8.1f MB/s, current %8.1f MB/s (%.2fx)\n", c.description, referenceRate, convertRate, convertRate / referenceRate);
+    }
+
+    return true;
+}
+
+int
+main(int argc, char **argv)
+{
+    size_t iterations = 10;
+    std::vector<std::string> paths;
+
+    for (int n = 1; n < argc; n++) {
+        std::string arg = argv[n];
+        if (arg == "-n" && n + 1 < argc) {
+            iterations = std::strtoul(argv[++n], nullptr, 10);
+        } else if (!arg.empty() && arg[0] == '-') {
+            fprintf(stderr, "usage: %s [-n iterations] [Localizable.strings ...]\n", argv[0]);
+            fprintf(stderr, "Without files, strings files in several languages are generated.\n");
+            return 1;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    if (paths.empty()) {
+        size_t size = 4 * 1024 * 1024;
+        bool success = true;
+        success &= Benchmark("English", GenerateStrings("Show notifications when the app is in the background", size), iterations);
+        success &= Benchmark("French", GenerateStrings("Afficher les notifications lorsque l\xe2\x80\x99" "application est en arri\xc3\xa8re-plan", size), iterations);
+        success &= Benchmark("Japanese", GenerateStrings("\xe3\x82\xa2\xe3\x83\x97\xe3\x83\xaa\xe3\x81\x8c\xe3\x83\x90\xe3\x83\x83\xe3\x82\xaf\xe3\x82\xb0\xe3\x83\xa9\xe3\x82\xa6\xe3\x83\xb3\xe3\x83\x89\xe3\x81\xab\xe3\x81\x82\xe3\x82\x8b\xe3\x81\xa8\xe3\x81\x8d\xe3\x81\xab\xe9\x80\x9a\xe7\x9f\xa5\xe3\x82\x92\xe8\xa1\xa8\xe7\xa4\xba", size), iterations);
+        return success ? 0 : 1;
+    }
+
+    DefaultFilesystem filesystem = DefaultFilesystem();
+    for (std::string const &path : paths) {
+        std::vector<uint8_t> contents;
+        if (!filesystem.read(&contents, path)) {
+            fprintf(stderr, "error: unable to read %s\n", path.c_str());
+            return 1;
+        }
+
+        std::vector<uint8_t> UTF8 = Encodings::Convert(contents, Encodings::Detect(contents), Encoding::UTF8);
+        if (!Benchmark(path, UTF8, iterations)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -25,6 +25,7 @@
 #include <libutil/DefaultFilesystem.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/ThreadPool.h>
 #include <process/DefaultContext.h>
 #include <process/Context.h>
 
@@ -35,6 +36,7 @@
 using libutil::Filesystem;
 using libutil::DefaultFilesystem;
 using libutil::FSUtil;
+using libutil::ThreadPool;
 
 class Options {
 public:
@@ -98,10 +100,15 @@ public:
 
 private:
     std::vector<std::string>   _inputs;
+    ext::optional<std::string> _fileList;
+    ext::optional<bool>        _recursive;
     ext::optional<std::string> _output;
     ext::optional<std::string> _extension;
     ext::optional<bool>        _separator;
 
+private:
+    ext::optional<int>         _jobs;
+
 private:
     ext::optional<bool>        _silent;
     ext::optional<bool>        _humanReadable;
@@ -129,6 +136,10 @@ public:
 public:
     std::vector<std::string> const &inputs() const
     { return _inputs; }
+    ext::optional<std::string> const &fileList() const
+    { return _fileList; }
+    bool recursive() const
+    { return _recursive.value_or(false); }
     ext::optional<std::string> const &output() const
     { return _output; }
     ext::optional<std::string> const &extension() const
@@ -140,6 +151,10 @@ public:
     bool humanReadable() const
     { return _humanReadable.value_or(false); }
 
+public:
+    ext::optional<int> const &jobs() const
+    { return _jobs; }
+
 private:
     friend class libutil::Options;
     std::pair<bool, std::string>
@@ -400,6 +415,12 @@ parseArgument(std::vector<std::string> const &args, std::vector<std::string>::co
 
         _convert = format;
         return result;
+    } else if (arg == "-filelist") {
+        return libutil::Options::Next<std::string>(&_fileList, args, it);
+    } else if (arg == "-recursive") {
+        return libutil::Options::Current<bool>(&_recursive, arg);
+    } else if (arg == "-jobs") {
+        return libutil::Options::Next<int>(&_jobs, args, it);
     } else if (arg == "-e") {
         return libutil::Options::Next<std::string>(&_extension, args, it);
     } else if (arg == "-o") {
@@ -438,6 +459,11 @@ Help(std::string const &error = std::string())
     fprintf(stderr, INDENT "-remove <key>\n");
     fprintf(stderr, INDENT "-extract <key> <format>\n");
 
+    fprintf(stderr, "\noptions:\n");
+    fprintf(stderr, INDENT "-filelist <path> (read input paths, one per line)\n");
+    fprintf(stderr, INDENT "-recursive (use .plist, .strings and .stringsdict files in input directories)\n");
+    fprintf(stderr, INDENT "-jobs <count> (files processed in parallel)\n");
+
     fprintf(stderr, "\nvalues:\n");
     fprintf(stderr, INDENT "-bool <YES|NO>\n");
     fprintf(stderr, INDENT "-integer <number>\n");
@@ -458,6 +484,28 @@ Help(std::string const &error = std::string())
     return (error.empty() ? 0 : -1);
 }
 
+/*
+ * What processing an input produced. Inputs are processed in parallel, so
+ * output is collected here and printed in input order afterwards.
+ */
+struct Report {
+    bool                 success;
+    std::vector<uint8_t> output;
+    std::string          errors;
+
+    Report() :
+        success(true)
+    {
+    }
+
+    bool error(std::string const &message)
+    {
+        errors += "error: " + message + "\n";
+        success = false;
+        return false;
+    }
+};
+
 static std::pair<bool, std::vector<uint8_t>>
 Read(Filesystem const *filesystem, std::string const &path = "-")
 {
@@ -477,11 +525,11 @@ Read(Filesystem const *filesystem, std::string const &path = "-")
 }
 
 static bool
-Write(Filesystem *filesystem, std::vector<uint8_t> const &contents, std::string const &path = "-")
+Write(Filesystem *filesystem, Report *report, std::vector<uint8_t> const &contents, std::string const &path = "-")
 {
     if (path == "-") {
         /* - means write to stdout. */
-        std::copy(contents.begin(), contents.end(), std::ostream_iterator<char>(std::cout));
+        report->output.insert(report->output.end(), contents.begin(), contents.end());
     } else {
         /* Read from file. */
         if (!filesystem->write(contents, path)) {
@@ -493,31 +541,30 @@ Write(Filesystem *filesystem, std::vector<uint8_t> const &contents, std::string
 }
 
 static bool
-Lint(Options const &options, std::string const &file)
+Lint(Options const &options, Report *report, std::string const &file)
 {
     if (!options.silent()) {
         /* Already linted by virtue of getting this far. */
-        printf("%s: OK\n", file.c_str());
+        std::string line = file + ": OK\n";
+        report->output.insert(report->output.end(), line.begin(), line.end());
     }
 
     return true;
 }
 
 static bool
-Print(Filesystem *filesystem, Options const &options, std::unique_ptr<plist::Object> object)
+Print(Filesystem *filesystem, Options const &options, Report *report, std::unique_ptr<plist::Object> object)
 {
     /* Convert to ASCII. */
     plist::Format::ASCII out = plist::Format::ASCII::Create(false, plist::Format::Encoding::UTF8);
     auto serialize = plist::Format::ASCII::Serialize(object.get(), out);
     if (serialize.first == nullptr) {
-        fprintf(stderr, "error: %s\n", serialize.second.c_str());
-        return false;
+        return report->error(serialize.second);
     }
 
     /* Print. */
-    if (!Write(filesystem, *serialize.first)) {
-        fprintf(stderr, "error: unable to write\n");
-        return false;
+    if (!Write(filesystem, report, *serialize.first)) {
+        return report->error("unable to write");
     }
 
     return true;
@@ -600,7 +647,7 @@ PerformAdjustment(plist::Object *object, plist::Object **rootObject, std::string
 }
 
 static bool
-Modify(Filesystem *filesystem, Options const &options, std::string const &file, std::unique_ptr<plist::Object> object, Options::Format const &inputFormat)
+Modify(Filesystem *filesystem, Options const &options, Report *report, std::string const &file, std::unique_ptr<plist::Object> object, Options::Format const &inputFormat)
 {
     plist::Object *writeObject = object.get();
 
@@ -630,8 +677,7 @@ Modify(Filesystem *filesystem, Options const &options, std::string const &file,
             }
 
             if (currentObject == nullptr) {
-                fprintf(stderr, "error: invalid key path\n");
-                return false;
+                return report->error("invalid key path");
             }
 
             start = end + 1;
@@ -651,15 +697,119 @@ Modify(Filesystem *filesystem, Options const &options, std::string const &file,
     }
 
     if (serialize.first == nullptr) {
-        fprintf(stderr, "error: %s\n", serialize.second.c_str());
-        return false;
+        return report->error(serialize.second);
     }
 
     /* Write to output. */
     std::string output = OutputPath(options, file);
-    if (!Write(filesystem, *serialize.first, output)) {
-        fprintf(stderr, "error: unable to write\n");
-        return false;
+    if (!Write(filesystem, report, *serialize.first, output)) {
+        return report->error("unable to write");
+    }
+
+    return true;
+}
+
+static bool
+Process(Filesystem *filesystem, Options const &options, Report *report, std::string const &file, bool modify)
+{
+    std::pair<bool, std::vector<uint8_t>> result = Read(filesystem, file);
+    if (!result.first) {
+        return report->error("unable to read " + file);
+    }
+
+    /* Deserialize input, storing input format. */
+    ext::optional<Options::Format> format;
+    std::unique_ptr<plist::Object> root;
+
+    if (auto any = plist::Format::Any::Identify(result.second)) {
+        auto deserialize = plist::Format::Any::Deserialize(result.second, *any);
+        if (deserialize.first != nullptr) {
+            root = std::move(deserialize.first);
+            format = Options::Format(*any);
+        } else {
+            /* Name the file, as there may be many inputs. */
+            return report->error(file + ": " + deserialize.second);
+        }
+    } else {
+        auto json = plist::Format::JSON::Create();
+        auto deserialize = plist::Format::JSON::Deserialize(result.second, json);
+        if (deserialize.first != nullptr) {
+            root = std::move(deserialize.first);
+            format = Options::Format(json);
+        } else {
+            return report->error("input " + file + " not a plist or json");
+        }
+    }
+
+    /* Perform the sepcific action. */
+    if (modify) {
+        return Modify(filesystem, options, report, file, std::move(root), *format);
+    } else if (options.print()) {
+        return Print(filesystem, options, report, std::move(root));
+    } else {
+        return Lint(options, report, file);
+    }
+}
+
+static bool
+IsPropertyListFile(std::string const &path)
+{
+    std::string extension = FSUtil::GetFileExtension(path);
+    return (extension == "plist" || extension == "strings" || extension == "stringsdict");
+}
+
+/*
+ * Expand the command line into the list of files to process: paths from
+ * a file list, and property list files within directories if recursive.
+ */
+static bool
+Inputs(Filesystem const *filesystem, Options const &options, ThreadPool *threadPool, std::vector<std::string> *inputs)
+{
+    std::vector<std::string> paths = options.inputs();
+
+    if (options.fileList()) {
+        std::pair<bool, std::vector<uint8_t>> result = Read(filesystem, *options.fileList());
+        if (!result.first) {
+            fprintf(stderr, "error: unable to read %s\n", options.fileList()->c_str());
+            return false;
+        }
+
+        std::string::size_type start = 0;
+        std::string list = std::string(result.second.begin(), result.second.end());
+        while (start < list.size()) {
+            std::string::size_type end = list.find('\n', start);
+            if (end == std::string::npos) {
+                end = list.size();
+            }
+
+            std::string path = list.substr(start, end - start);
+            if (!path.empty() && path.back() == '\r') {
+                path.pop_back();
+            }
+            if (!path.empty()) {
+                paths.push_back(path);
+            }
+
+            start = end + 1;
+        }
+    }
+
+    for (std::string const &path : paths) {
+        if (!options.recursive() || path == "-" || filesystem->type(path) != Filesystem::Type::Directory) {
+            inputs->push_back(path);
+            continue;
+        }
+
+        bool walked = filesystem->walkDirectory(path, true, false, [&](Filesystem::DirectoryEntry const &entry) {
+            if (entry.type == Filesystem::Type::File && IsPropertyListFile(entry.path)) {
+                inputs->push_back(path + "/" + entry.path);
+            }
+            return true;
+        }, threadPool);
+        if (!walked) {
+            fprintf(stderr, "error: unable to read directory %s\n", path.c_str());
+            return false;
+        }
     }
 
     return true;
@@ -694,53 +844,49 @@ main(int argc, char **argv)
     } else {
         bool success = true;
 
-        if (options.inputs().empty()) {
-            return Help("no input files");
+        /*
+         * A single thread processes inputs on this thread, in order. That's
+         * all a single input needs, and writing every input to the same
+         * output can't be done in parallel.
+         */
+        size_t threads = (options.jobs() && *options.jobs() > 0 ? static_cast<size_t>(*options.jobs()) : 0);
+        bool batch = (options.inputs().size() > 1 || options.fileList() || options.recursive());
+        if (!batch || options.output()) {
+            threads = 1;
         }
+        ThreadPool threadPool(threads);
 
-        /* Actions applied to each input file separately. */
-        for (std::string const &file : options.inputs()) {
-            std::pair<bool, std::vector<uint8_t>> result = Read(&filesystem, file);
-            if (!result.first) {
-                fprintf(stderr, "error: unable to read %s\n", file.c_str());
-                success = false;
-                continue;
-            }
+        std::vector<std::string> inputs;
+        if (!Inputs(&filesystem, options, &threadPool, &inputs)) {
+            return 1;
+        }
 
-            /* Deserialize input, storing input format. */
-            ext::optional<Options::Format> format;
-            std::unique_ptr<plist::Object> root;
+        if (inputs.empty()) {
+            return Help("no input files");
+        }
 
-            if (auto any = plist::Format::Any::Identify(result.second)) {
-                auto deserialize = plist::Format::Any::Deserialize(result.second, *any);
-                if (deserialize.first != nullptr) {
-                    root = std::move(deserialize.first);
-                    format = Options::Format(*any);
-                } else {
-                    fprintf(stderr, "error: %s\n", deserialize.second.c_str());
-                    success = false;
-                    continue;
+        /*
+         * Actions applied to each input file separately. Inputs are handled
+         * in batches so output can be printed in order as it is produced,
+         * without holding the output for every input at once.
+         */
+        size_t batchSize = threadPool.threads() * 8;
+        for (size_t start = 0; start < inputs.size(); start += batchSize) {
+            size_t count = std::min(batchSize, inputs.size() - start);
+
+            std::vector<Report> reports = std::vector<Report>(count);
+            threadPool.apply(count, [&](size_t index) {
+                Process(&filesystem, options, &reports[index], inputs[start + index], modify);
+            });
+
+            for (Report const &report : reports) {
+                std::copy(report.output.begin(), report.output.end(), std::ostream_iterator<char>(std::cout));
+                if (!report.errors.empty()) {
+                    std::cout.flush();
+                    fputs(report.errors.c_str(), stderr);
                 }
-            } else {
-                auto json = plist::Format::JSON::Create();
-                auto deserialize = plist::Format::JSON::Deserialize(result.second, json);
-                if (deserialize.first != nullptr) {
-                    root = std::move(deserialize.first);
-                    format = Options::Format(json);
-                } else {
-                    fprintf(stderr, "error: input %s not a plist or json\n", file.c_str());
-                    success = false;
-                    continue;
-                }
-            }
 
-            /* Perform the sepcific action. */
-            if (modify) {
-                success &= Modify(&filesystem, options, file, std::move(root), *format);
-            } else if (options.print()) {
-                success &= Print(&filesystem, options, std::move(root));
-            } else if (options.lint() || true) {
-                success &= Lint(options, file);
+                success &= report.success;
             }
         }
 
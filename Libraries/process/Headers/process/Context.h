@@ -9,6 +9,7 @@
 #ifndef __process_Context_h
 #define __process_Context_h
 
+#include <cstdio>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -51,6 +52,14 @@ public:
      */
     virtual ext::optional<std::string> environmentVariable(std::string const &variable) const = 0;
 
+public:
+    /*
+     * Where the process writes its output and errors. By default, the
+     * standard output and error of this process.
+     */
+    virtual FILE *standardOutput() const;
+    virtual FILE *standardError() const;
+
 public:
     /*
      * The default environment search paths.
@@ -25,6 +25,7 @@ public:
 
 public:
     virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context);
+    virtual ext::optional<int> exec(libutil::Filesystem *filesystem, Context const *context);
 };
 
 }
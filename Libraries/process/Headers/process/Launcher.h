@@ -31,6 +31,13 @@ public:
      * that launching a process could arbitrarily affect the filesystem.
      */
     virtual ext::optional<int> launch(libutil::Filesystem *filesystem, Context const *context) = 0;
+
+    /*
+     * Replace the current process with a new process, passing through
+     * the standard streams. Only returns if the process could not be
+     * replaced. By default, launches and waits for the process instead.
+     */
+    virtual ext::optional<int> exec(libutil::Filesystem *filesystem, Context const *context);
 };
 
 }
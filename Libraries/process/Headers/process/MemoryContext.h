@@ -25,6 +25,10 @@ private:
     std::vector<std::string> _commandLineArguments;
     std::unordered_map<std::string, std::string> _environmentVariables;
 
+private:
+    FILE *_standardOutput;
+    FILE *_standardError;
+
 public:
     MemoryContext(
         std::string const &executablePath,
@@ -58,6 +62,17 @@ public:
 
     virtual ext::optional<std::string> environmentVariable(std::string const &variable) const;
 
+public:
+    virtual FILE *standardOutput() const
+    { return _standardOutput; }
+    FILE *&standardOutput()
+    { return _standardOutput; }
+
+    virtual FILE *standardError() const
+    { return _standardError; }
+    FILE *&standardError()
+    { return _standardError; }
+
 public:
     virtual ext::optional<std::string> const shellExpand(std::string const &s) const;
 };
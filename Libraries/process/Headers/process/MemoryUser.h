@@ -23,6 +23,9 @@ private:
     std::string _userName;
     std::string _groupName;
 
+private:
+    ext::optional<std::string> _userHomeDirectory;
+
 public:
     MemoryUser(
         std::string const &userID,
@@ -52,6 +55,12 @@ public:
     { return _groupName; }
     std::string &groupName()
     { return _groupName; }
+
+public:
+    virtual ext::optional<std::string> userHomeDirectory() const
+    { return _userHomeDirectory; }
+    ext::optional<std::string> &userHomeDirectory()
+    { return _userHomeDirectory; }
 };
 
 }
@@ -23,6 +23,18 @@ Context::
 {
 }
 
+FILE *Context::
+standardOutput() const
+{
+    return stdout;
+}
+
+FILE *Context::
+standardError() const
+{
+    return stderr;
+}
+
 std::vector<std::string> Context::
 executableSearchPaths() const
 {
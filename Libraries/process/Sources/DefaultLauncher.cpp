@@ -13,6 +13,7 @@
 #if _WIN32
 #include <windows.h>
 #else
+#include <errno.h>
 #include <fcntl.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -267,3 +268,68 @@ launch(Filesystem *filesystem, Context const *context)
     }
 #endif
 }
+
+ext::optional<int> DefaultLauncher::
+exec(Filesystem *filesystem, Context const *context)
+{
+#if _WIN32
+    /* No equivalent to replacing the process; launch and wait instead. */
+    return launch(filesystem, context);
+#else
+    std::string path = context->executablePath();
+    if (!filesystem->isExecutable(path)) {
+        return ext::nullopt;
+    }
+
+    /* Compute command-line arguments. */
+    std::vector<char const *> execArgs;
+    execArgs.push_back(path.c_str());
+
+    std::vector<std::string> const &arguments = context->commandLineArguments();
+    for (std::string const &argument : arguments) {
+        execArgs.push_back(argument.c_str());
+    }
+    execArgs.push_back(nullptr);
+
+    /* Compute environment variables. */
+    std::vector<std::string> envValues;
+    for (auto const &value : context->environmentVariables()) {
+        envValues.push_back(value.first + "=" + value.second);
+    }
+
+    std::vector<char const *> execEnv;
+    for (auto const &value : envValues) {
+        execEnv.push_back(value.c_str());
+    }
+    execEnv.push_back(nullptr);
+
+    /* Keep the current directory to return to if the process isn't replaced. */
+    int previousDirectory = ::open(".", O_RDONLY | O_CLOEXEC);
+    if (previousDirectory == -1) {
+        ::perror("open");
+        return ext::nullopt;
+    }
+
+    if (::chdir(context->currentDirectory().c_str()) == -1) {
+        ::perror("chdir");
+        ::close(previousDirectory);
+        return ext::nullopt;
+    }
+
+    /* Output buffered so far would be lost when the process is replaced. */
+    fflush(stdout);
+    fflush(stderr);
+
+    ::execve(path.c_str(), const_cast<char *const *>(execArgs.data()), const_cast<char *const *>(execEnv.data()));
+    int error = errno;
+
+    if (::fchdir(previousDirectory) == -1) {
+        ::perror("fchdir");
+    }
+    ::close(previousDirectory);
+
+    errno = error;
+    ::perror("execve");
+    return ext::nullopt;
+#endif
+}
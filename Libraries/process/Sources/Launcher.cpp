@@ -7,6 +7,7 @@
  */
 
 #include <process/Launcher.h>
+#include <process/Context.h>
 
 using process::Launcher;
 
@@ -20,3 +21,8 @@ Launcher::
 {
 }
 
+ext::optional<int> Launcher::
+exec(libutil::Filesystem *filesystem, Context const *context)
+{
+    return launch(filesystem, context);
+}
@@ -20,7 +20,9 @@ MemoryContext(
     _executablePath      (executablePath),
     _currentDirectory    (currentDirectory),
     _commandLineArguments(commandLineArguments),
-    _environmentVariables(environmentVariables)
+    _environmentVariables(environmentVariables),
+    _standardOutput      (stdout),
+    _standardError       (stderr)
 {
 }
 
@@ -32,6 +34,8 @@ MemoryContext(Context const *context) :
         context->commandLineArguments(),
         context->environmentVariables())
 {
+    _standardOutput = context->standardOutput();
+    _standardError = context->standardError();
 }
 
 MemoryContext::
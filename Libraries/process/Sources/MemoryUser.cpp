@@ -32,6 +32,7 @@ MemoryUser(User const *user) :
         user->userName(),
         user->groupName())
 {
+    _userHomeDirectory = user->userHomeDirectory();
 }
 
 MemoryUser::
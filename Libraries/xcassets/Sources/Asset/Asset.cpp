@@ -297,10 +297,10 @@ LoadChildren(Filesystem const *filesystem, std::string const &path, FullyQualifi
 {
     bool error = false;
 
-    filesystem->readDirectory(path, false, [&](std::string const &fileName) -> void {
-        std::string child = path + "/" + fileName;
+    filesystem->walkDirectory(path, false, false, [&](Filesystem::DirectoryEntry const &entry) -> bool {
+        std::string child = path + "/" + entry.path;
 
-        if (filesystem->type(child) == Filesystem::Type::Directory) {
+        if (entry.type == Filesystem::Type::Directory) {
             std::vector<std::string> groups = name.groups();
             if (providesNamespace) {
                 // TODO: Should fully qualified names include extensions?
@@ -311,11 +311,13 @@ LoadChildren(Filesystem const *filesystem, std::string const &path, FullyQualifi
             if (asset == nullptr) {
                 fprintf(stderr, "error: failed to load asset: %s\n", child.c_str());
                 error = true;
-                return;
+                return true;
             }
 
             children->push_back(std::move(asset));
         }
+
+        return true;
     });
 
     return error;
@@ -70,7 +70,8 @@ CreateExecutor(
         auto executor = xcexecution::SimpleExecutor::Create(formatter, dryRun, registry);
         return libutil::static_unique_pointer_cast<xcexecution::Executor>(std::move(executor));
     } else if (*executor == "ninja") {
-        auto executor = xcexecution::NinjaExecutor::Create(formatter, dryRun, generate);
+        auto registry = builtin::Registry::Default();
+        auto executor = xcexecution::NinjaExecutor::Create(formatter, dryRun, generate, registry);
         return libutil::static_unique_pointer_cast<xcexecution::Executor>(std::move(executor));
     }
 
@@ -10,8 +10,10 @@
 #define __xcexecution_Executor_h
 
 #include <xcformatter/Formatter.h>
+#include <pbxproj/ProjectCache.h>
 
 #include <memory>
+#include <ext/optional>
 
 namespace libutil { class Filesystem; }
 namespace process { class Context; }
@@ -45,6 +47,14 @@ protected:
 public:
     virtual ~Executor();
 
+protected:
+    /*
+     * Cache of parsed project files, stored in derived data. Not used for
+     * dry runs, as those shouldn't write anything.
+     */
+    ext::optional<pbxproj::ProjectCache>
+    projectCache(libutil::Filesystem *filesystem, pbxbuild::Build::Environment const &buildEnvironment) const;
+
 public:
     /*
      * Abstract build method. Override to implement the build.
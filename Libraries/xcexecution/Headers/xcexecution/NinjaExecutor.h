@@ -13,17 +13,22 @@
 #include <pbxbuild/Tool/AuxiliaryFile.h>
 #include <pbxbuild/Tool/Invocation.h>
 #include <pbxbuild/DirectedGraph.h>
+#include <builtin/Registry.h>
 
 namespace ninja { class Writer; }
 
 namespace xcexecution {
 
 /*
- * Concrete executor that generates Ninja files.
+ * Concrete executor that generates Ninja files. While Ninja runs, builtin
+ * tools are run in a builtin server rather than each in a new process.
  */
 class NinjaExecutor : public Executor {
+private:
+    builtin::Registry _builtins;
+
 public:
-    NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate);
+    NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, builtin::Registry const &builtins);
     ~NinjaExecutor();
 
 public:
@@ -44,6 +49,7 @@ private:
         pbxbuild::Build::Context const &buildContext,
         pbxbuild::DirectedGraph<pbxproj::PBX::Target::shared_ptr> const &targetGraph,
         std::string const &dependencyInfoToolPath,
+        ext::optional<std::string> const &builtinClientPath,
         std::string const &ninjaPath,
         std::string const &configurationHashPath,
         std::string const &intermediatesDirectory);
@@ -55,6 +61,7 @@ private:
         process::Context const *processContext,
         libutil::Filesystem *filesystem,
         std::string const &dependencyInfoToolPath,
+        ext::optional<std::string> const &builtinClientPath,
         pbxproj::PBX::Target::shared_ptr const &target,
         pbxbuild::Target::Environment const &targetEnvironment,
         std::vector<pbxbuild::Tool::AuxiliaryFile> const &auxiliaryFiles,
@@ -67,17 +74,24 @@ private:
         std::string const &after,
         std::string const &temporaryDirectory,
         std::map<std::string, pbxbuild::Tool::AuxiliaryFile::Chunk const *> &auxiliaryFileChunks);
+
+public:
+    /*
+     * Write the Ninja build statement for a single invocation.
+     */
     bool buildInvocation(
         ninja::Writer *writer,
         pbxbuild::Tool::Invocation const &invocation,
         std::string const &executablePath,
         std::string const &dependencyInfoToolPath,
+        ext::optional<std::string> const &builtinClientPath,
         std::string const &temporaryDirectory,
-        std::string const &after);
+        std::string const &after,
+        std::unordered_map<std::unordered_map<std::string, std::string> const *, std::string> *sharedEnvironments);
 
 public:
     static std::unique_ptr<NinjaExecutor>
-    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate);
+    Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, builtin::Registry const &builtins);
 };
 
 }
@@ -111,13 +111,15 @@ public:
 
 public:
     /*
-     * Loads the workspace from the build parameters.
+     * Loads the workspace from the build parameters. Projects are loaded
+     * through the project cache, if provided.
      */
     ext::optional<pbxbuild::WorkspaceContext> loadWorkspace(
         libutil::Filesystem const *filesystem,
         std::string const &userName,
         pbxbuild::Build::Environment const &buildEnvironment,
-        std::string const &workingDirectory) const;
+        std::string const &workingDirectory,
+        pbxproj::ProjectCache *projectCache = nullptr) const;
 
     /*
      * Creates the build context for a specific action.
@@ -7,6 +7,7 @@
  */
 
 #include <xcexecution/Executor.h>
+#include <pbxbuild/Build/Environment.h>
 
 using xcexecution::Executor;
 
@@ -22,3 +23,18 @@ Executor::
 ~Executor()
 {
 }
+
+ext::optional<pbxproj::ProjectCache> Executor::
+projectCache(libutil::Filesystem *filesystem, pbxbuild::Build::Environment const &buildEnvironment) const
+{
+    if (_dryRun) {
+        return ext::nullopt;
+    }
+
+    std::string derivedDataDirectory = buildEnvironment.baseEnvironment().resolve("DERIVED_DATA_DIR");
+    if (derivedDataDirectory.empty()) {
+        return ext::nullopt;
+    }
+
+    return pbxproj::ProjectCache(filesystem, derivedDataDirectory + "/ProjectCache");
+}
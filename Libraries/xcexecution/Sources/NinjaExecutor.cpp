@@ -11,6 +11,8 @@
 #include <xcexecution/Parameters.h>
 #include <pbxbuild/Phase/Environment.h>
 #include <pbxbuild/Phase/PhaseInvocations.h>
+#include <builtin/Client.h>
+#include <builtin/Server.h>
 #include <ninja/Writer.h>
 #include <ninja/Value.h>
 #include <plist/Data.h>
@@ -25,10 +27,15 @@
 
 #include <sstream>
 #include <iomanip>
+#include <cstdlib>
 
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#if !_WIN32
+#include <unistd.h>
+#endif
+
 using xcexecution::NinjaExecutor;
 using xcexecution::Parameters;
 using libutil::Escape;
@@ -36,8 +43,9 @@ using libutil::Filesystem;
 using libutil::FSUtil;
 
 NinjaExecutor::
-NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate) :
-    Executor(formatter, dryRun, generate)
+NinjaExecutor(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, builtin::Registry const &builtins) :
+    Executor (formatter, dryRun, generate),
+    _builtins(builtins)
 {
 }
 
@@ -108,6 +116,20 @@ NinjaDescription(std::string const &description)
     }
 }
 
+static std::string
+NinjaEnvironment(std::unordered_map<std::string, std::string> const &environment)
+{
+    /* Arguments for `env`, escaped for the shell. */
+    std::string result;
+    for (auto it = environment.begin(); it != environment.end(); ++it) {
+        if (it != environment.begin()) {
+            result += " ";
+        }
+        result += it->first + "=" + Escape::Shell(it->second);
+    }
+    return result;
+}
+
 static std::string
 NinjaHash(char const *data, size_t size)
 {
@@ -303,7 +325,7 @@ WriteAuxiliaryFiles(Filesystem *filesystem, std::map<std::string, pbxbuild::Tool
             return false;
         }
 
-        if (!filesystem->write(*it.second->data(), it.first)) {
+        if (!filesystem->writeIfChanged(*it.second->data(), it.first)) {
             return false;
         }
     }
@@ -394,6 +416,11 @@ build(
     std::string executableRoot = FSUtil::GetDirectoryName(processContext->executablePath());
     std::string dependencyInfoToolPath = *NinjaBuiltinExecutablePath(processContext, filesystem, "dependency-info-tool");
 
+    /*
+     * Find the client for the builtin server. Without it, builtin tools run directly.
+     */
+    ext::optional<std::string> builtinClientPath = NinjaBuiltinExecutablePath(processContext, filesystem, "builtin-client");
+
     /*
      * If the Ninja file needs to be generated, generate it.
      */
@@ -404,7 +431,8 @@ build(
          * Load the workspace. This can be quite slow, so only do it if it's needed to generate
          * the Ninja file. Similarly, only resolve dependencies in that case.
          */
-        ext::optional<pbxbuild::WorkspaceContext> workspaceContext = buildParameters.loadWorkspace(filesystem, user->userName(), buildEnvironment, processContext->currentDirectory());
+        ext::optional<pbxproj::ProjectCache> projectCache = this->projectCache(filesystem, buildEnvironment);
+        ext::optional<pbxbuild::WorkspaceContext> workspaceContext = buildParameters.loadWorkspace(filesystem, user->userName(), buildEnvironment, processContext->currentDirectory(), projectCache ? &*projectCache : nullptr);
         if (!workspaceContext) {
             fprintf(stderr, "error: unable to load workspace\n");
             return false;
@@ -433,6 +461,7 @@ build(
             *buildContext,
             *targetGraph,
             dependencyInfoToolPath,
+            builtinClientPath,
             ninjaPath,
             configurationHashPath,
             intermediatesDirectory);
@@ -497,6 +526,29 @@ build(
 
         // TODO(grp): Pass number of jobs if specified.
 
+        /*
+         * Run builtin tools in this process while Ninja runs. The socket goes in the
+         * temporary directory, since socket paths are limited to about 100 bytes. It
+         * is inside a new directory only this user can access, as anyone who can
+         * connect can run tools as this user.
+         */
+        std::unordered_map<std::string, std::string> environment = processContext->environmentVariables();
+        builtin::Server server(_builtins, filesystem);
+        std::string serverDirectory;
+#if !_WIN32
+        if (!_dryRun) {
+            serverDirectory = processContext->environmentVariable("TMPDIR").value_or("/tmp") + "/xcbuild-builtin-XXXXXX";
+            if (::mkdtemp(&serverDirectory[0]) == nullptr) {
+                serverDirectory.clear();
+            } else {
+                std::string socketPath = serverDirectory + "/server.sock";
+                if (server.start(socketPath)) {
+                    environment[builtin::Client::ServerEnvironmentVariable] = socketPath;
+                }
+            }
+        }
+#endif
+
         /*
          * Run Ninja and return if it failed. Ninja itself does the build.
          */
@@ -504,8 +556,14 @@ build(
             *executable,
             intermediatesDirectory,
             arguments,
-            processContext->environmentVariables());
+            environment);
         ext::optional<int> exitCode = processLauncher->launch(filesystem, &ninja);
+        server.stop();
+#if !_WIN32
+        if (!serverDirectory.empty()) {
+            (void)::rmdir(serverDirectory.c_str());
+        }
+#endif
         if (!exitCode || *exitCode != 0) {
             return false;
         }
@@ -523,6 +581,7 @@ buildAction(
     pbxbuild::Build::Context const &buildContext,
     pbxbuild::DirectedGraph<pbxproj::PBX::Target::shared_ptr> const &targetGraph,
     std::string const &dependencyInfoToolPath,
+    ext::optional<std::string> const &builtinClientPath,
     std::string const &ninjaPath,
     std::string const &configurationHashPath,
     std::string const &intermediatesDirectory)
@@ -621,7 +680,7 @@ buildAction(
         /*
          * Write out the Ninja file to build this target.
          */
-        if (!buildTargetInvocations(processContext, filesystem, dependencyInfoToolPath, target, *targetEnvironment, phaseInvocations.auxiliaryFiles(), phaseInvocations.invocations())) {
+        if (!buildTargetInvocations(processContext, filesystem, dependencyInfoToolPath, builtinClientPath, target, *targetEnvironment, phaseInvocations.auxiliaryFiles(), phaseInvocations.invocations())) {
             fprintf(stderr, "error: failed to build target ninja\n");
             return false;
         }
@@ -709,6 +768,7 @@ buildTargetInvocations(
     process::Context const *processContext,
     Filesystem *filesystem,
     std::string const &dependencyInfoToolPath,
+    ext::optional<std::string> const &builtinClientPath,
     pbxproj::PBX::Target::shared_ptr const &target,
     pbxbuild::Target::Environment const &targetEnvironment,
     std::vector<pbxbuild::Tool::AuxiliaryFile> const &auxiliaryFiles,
@@ -777,6 +837,7 @@ buildTargetInvocations(
     /*
      * Add the build command for each invocation.
      */
+    std::unordered_map<std::unordered_map<std::string, std::string> const *, std::string> sharedEnvironments;
     for (pbxbuild::Tool::Invocation const &invocation : invocations) {
         // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
         if (invocation.executable()) {
@@ -789,7 +850,7 @@ buildTargetInvocations(
             }
 
             /* Write invocations to run after auxiliary files. */
-            if (!buildInvocation(&writer, invocation, *executablePath, dependencyInfoToolPath, temporaryDirectory, TargetPhaseNinjaBegin(target, invocation.priority()))) {
+            if (!buildInvocation(&writer, invocation, *executablePath, dependencyInfoToolPath, builtinClientPath, temporaryDirectory, TargetPhaseNinjaBegin(target, invocation.priority()), &sharedEnvironments)) {
                 return false;
             }
         }
@@ -873,20 +934,46 @@ buildAuxiliaryFile(
     return true;
 }
 
+/*
+ * Builtin tools that leave their outputs untouched when the contents would
+ * be the same, or that skip copying files whose stamps haven't changed.
+ * Ninja can skip anything depending on those outputs.
+ */
+static bool
+NinjaBuiltinRestat(std::string const &builtin)
+{
+    return (builtin == "builtin-copy" ||
+            builtin == "builtin-infoPlistUtility" ||
+            builtin == "builtin-copyPlist" ||
+            builtin == "builtin-copyStrings" ||
+            builtin == "builtin-productPackagingUtility");
+}
+
 bool NinjaExecutor::
 buildInvocation(
     ninja::Writer *writer,
     pbxbuild::Tool::Invocation const &invocation,
     std::string const &executablePath,
     std::string const &dependencyInfoToolPath,
+    ext::optional<std::string> const &builtinClientPath,
     std::string const &temporaryDirectory,
-    std::string const &after)
+    std::string const &after,
+    std::unordered_map<std::unordered_map<std::string, std::string> const *, std::string> *sharedEnvironments)
 {
     /*
      * Build the invocation arguments. Must escape for shell arguments as Ninja passes
      * the command string directly to the shell, which would interpret spaces, etc as meaningful.
      */
     std::string exec = Escape::Shell(executablePath);
+
+    /*
+     * Run builtin tools through the client, so they run in the builtin server if one
+     * is running for the build. The client runs the tool directly if not.
+     */
+    if (invocation.executable()->builtin() && builtinClientPath) {
+        exec = Escape::Shell(*builtinClientPath) + " " + exec;
+    }
+
     for (std::string const &arg : invocation.arguments()) {
         exec += " " + Escape::Shell(arg);
     }
@@ -896,12 +983,25 @@ buildInvocation(
      * `env` to avoid Bash-specific limitations on environment variables (some versions of Bash
      * don't allow setting "UID"). Intentionally add to, not replace, the process environment.
      */
-    std::string environment;
-    for (auto it = invocation.environment().begin(); it != invocation.environment().end(); ++it) {
-        if (it != invocation.environment().begin()) {
-            environment += " ";
+    ext::optional<ninja::Value> environment;
+
+    /*
+     * Shared environments are large and used by many invocations, so write each once
+     * into a variable. The invocation's own environment comes after it to override it.
+     */
+    if (auto const &sharedEnvironment = invocation.sharedEnvironment()) {
+        auto it = sharedEnvironments->find(sharedEnvironment.get());
+        if (it == sharedEnvironments->end()) {
+            std::string name = "shared_env_" + std::to_string(sharedEnvironments->size());
+            writer->binding({ name, ninja::Value::String(NinjaEnvironment(*sharedEnvironment)) });
+            it = sharedEnvironments->insert({ sharedEnvironment.get(), name }).first;
         }
-        environment += it->first + "=" + Escape::Shell(it->second);
+
+        environment = ninja::Value::Expression("$" + it->second);
+    }
+    if (!invocation.environment().empty()) {
+        ninja::Value own = ninja::Value::String(NinjaEnvironment(invocation.environment()));
+        environment = (environment ? *environment + ninja::Value::String(" ") + own : own);
     }
 
     /*
@@ -957,8 +1057,8 @@ buildInvocation(
         { "dir", ninja::Value::String(Escape::Shell(invocation.workingDirectory())) },
         { "exec", ninja::Value::String(exec) },
     };
-    if (!environment.empty()) {
-        bindings.push_back({ "env", ninja::Value::String(environment) });
+    if (environment) {
+        bindings.push_back({ "env", *environment });
     }
     if (!dependencyInfoExec.empty()) {
         bindings.push_back({ "depexec", ninja::Value::String(dependencyInfoExec) });
@@ -966,6 +1066,10 @@ buildInvocation(
     if (!dependencyInfoFile.empty()) {
         bindings.push_back({ "depfile", ninja::Value::String(dependencyInfoFile) });
     }
+    if (invocation.executable()->builtin() && NinjaBuiltinRestat(*invocation.executable()->builtin())) {
+        /* Re-check output modification times after running. */
+        bindings.push_back({ "restat", ninja::Value::String("1") });
+    }
 
     /*
      * Build up outputs as literal Ninja values.
@@ -1013,11 +1117,12 @@ buildInvocation(
 }
 
 std::unique_ptr<NinjaExecutor> NinjaExecutor::
-Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate)
+Create(std::shared_ptr<xcformatter::Formatter> const &formatter, bool dryRun, bool generate, builtin::Registry const &builtins)
 {
     return std::unique_ptr<NinjaExecutor>(new NinjaExecutor(
         formatter,
         dryRun,
-        generate
+        generate,
+        builtins
     ));
 }
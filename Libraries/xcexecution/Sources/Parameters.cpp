@@ -114,10 +114,10 @@ canonicalHash() const
 }
 
 static pbxproj::PBX::Project::shared_ptr
-OpenProject(Filesystem const *filesystem, ext::optional<std::string> const &projectPath, std::string const &directory)
+OpenProject(Filesystem const *filesystem, pbxproj::ProjectCache *projectCache, ext::optional<std::string> const &projectPath, std::string const &directory)
 {
     if (projectPath) {
-        return pbxproj::PBX::Project::Open(filesystem, *projectPath);
+        return pbxproj::PBX::Project::Open(filesystem, *projectPath, projectCache);
     } else {
         bool multiple = false;
         std::string projectName;
@@ -141,7 +141,7 @@ OpenProject(Filesystem const *filesystem, ext::optional<std::string> const &proj
             fprintf(stderr, "error: no project found\n");
             return nullptr;
         } else {
-            pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(filesystem, directory + "/" + projectName);
+            pbxproj::PBX::Project::shared_ptr project = pbxproj::PBX::Project::Open(filesystem, directory + "/" + projectName, projectCache);
             if (project == nullptr) {
                 fprintf(stderr, "error: unable to open project '%s'\n", projectName.c_str());
             }
@@ -151,7 +151,7 @@ OpenProject(Filesystem const *filesystem, ext::optional<std::string> const &proj
 }
 
 ext::optional<pbxbuild::WorkspaceContext> Parameters::
-loadWorkspace(Filesystem const *filesystem, std::string const &userName, pbxbuild::Build::Environment const &buildEnvironment, std::string const &workingDirectory) const
+loadWorkspace(Filesystem const *filesystem, std::string const &userName, pbxbuild::Build::Environment const &buildEnvironment, std::string const &workingDirectory, pbxproj::ProjectCache *projectCache) const
 {
     if (_workspace) {
         xcworkspace::XC::Workspace::shared_ptr workspace = xcworkspace::XC::Workspace::Open(filesystem, *_workspace);
@@ -160,14 +160,14 @@ loadWorkspace(Filesystem const *filesystem, std::string const &userName, pbxbuil
             return ext::nullopt;
         }
 
-        return pbxbuild::WorkspaceContext::Workspace(filesystem, userName, buildEnvironment.baseEnvironment(), workspace);
+        return pbxbuild::WorkspaceContext::Workspace(filesystem, userName, buildEnvironment.baseEnvironment(), workspace, projectCache);
     } else {
-        pbxproj::PBX::Project::shared_ptr project = OpenProject(filesystem, _project, workingDirectory);
+        pbxproj::PBX::Project::shared_ptr project = OpenProject(filesystem, projectCache, _project, workingDirectory);
         if (project == nullptr) {
             return ext::nullopt;
         }
 
-        return pbxbuild::WorkspaceContext::Project(filesystem, userName, buildEnvironment.baseEnvironment(), project);
+        return pbxbuild::WorkspaceContext::Project(filesystem, userName, buildEnvironment.baseEnvironment(), project, projectCache);
     }
 }
 
@@ -14,6 +14,8 @@
 #include <pbxbuild/Phase/PhaseInvocations.h>
 #include <libutil/Filesystem.h>
 #include <libutil/FSUtil.h>
+#include <libutil/LookupCache.h>
+#include <libutil/md5.h>
 #include <process/Context.h>
 #include <process/MemoryContext.h>
 #include <process/Launcher.h>
@@ -22,12 +24,16 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <map>
 #include <set>
+#include <unordered_map>
 
 using xcexecution::SimpleExecutor;
 using xcexecution::Parameters;
 using libutil::Filesystem;
 using libutil::FSUtil;
+using libutil::LookupCache;
 using libutil::Permissions;
 
 SimpleExecutor::
@@ -51,7 +57,8 @@ build(
     pbxbuild::Build::Environment const &buildEnvironment,
     Parameters const &buildParameters)
 {
-    ext::optional<pbxbuild::WorkspaceContext> workspaceContext = buildParameters.loadWorkspace(filesystem, user->userName(), buildEnvironment, processContext->currentDirectory());
+    ext::optional<pbxproj::ProjectCache> projectCache = this->projectCache(filesystem, buildEnvironment);
+    ext::optional<pbxbuild::WorkspaceContext> workspaceContext = buildParameters.loadWorkspace(filesystem, user->userName(), buildEnvironment, processContext->currentDirectory(), projectCache ? &*projectCache : nullptr);
     if (!workspaceContext) {
         return false;
     }
@@ -202,7 +209,7 @@ writeAuxiliaryFiles(
                 }
             }
 
-            if (!filesystem->write(data, auxiliaryFile.path())) {
+            if (!filesystem->writeIfChanged(data, auxiliaryFile.path())) {
                 return false;
             }
         }
@@ -225,6 +232,63 @@ writeAuxiliaryFiles(
     return true;
 }
 
+/*
+ * Digest of an invocation's input contents along with everything else it
+ * depends on. Missing inputs are hashed differently from empty ones.
+ */
+static std::string
+ContentDigest(Filesystem const *filesystem, pbxbuild::Tool::Invocation const &invocation)
+{
+    md5_state_t state;
+    md5_init(&state);
+
+    std::string const &digest = invocation.contentHash()->digest();
+    md5_append(&state, reinterpret_cast<md5_byte_t const *>(digest.c_str()), digest.size() + 1);
+
+    for (std::vector<std::string> const *inputs : { &invocation.inputs(), &invocation.phonyInputs() }) {
+        for (std::string const &input : *inputs) {
+            md5_append(&state, reinterpret_cast<md5_byte_t const *>(input.c_str()), input.size() + 1);
+
+            std::vector<uint8_t> contents;
+            md5_byte_t exists = filesystem->read(&contents, input) ? 1 : 0;
+            md5_append(&state, &exists, sizeof(exists));
+
+            uint64_t size = contents.size();
+            md5_append(&state, reinterpret_cast<md5_byte_t const *>(&size), sizeof(size));
+            md5_append(&state, reinterpret_cast<md5_byte_t const *>(contents.data()), contents.size());
+        }
+    }
+
+    uint8_t result[16];
+    md5_finish(&state, reinterpret_cast<md5_byte_t *>(&result));
+
+    static char const hex[] = "0123456789abcdef";
+    std::string string;
+    for (uint8_t byte : result) {
+        string += hex[byte >> 4];
+        string += hex[byte & 0xf];
+    }
+    return string;
+}
+
+/*
+ * Identifies an invocation across builds: what it runs, where, and with
+ * which environment.
+ */
+static std::string
+ContentHashKey(pbxbuild::Tool::Invocation const &invocation)
+{
+    std::vector<std::string> key = invocation.arguments();
+    key.push_back(invocation.workingDirectory());
+
+    std::map<std::string, std::string> environment(invocation.environment().begin(), invocation.environment().end());
+    for (auto const &variable : environment) {
+        key.push_back(variable.first + "=" + variable.second);
+    }
+
+    return LookupCache::Key(key);
+}
+
 std::pair<bool, std::vector<pbxbuild::Tool::Invocation>> SimpleExecutor::
 performInvocations(
     process::Context const *processContext,
@@ -234,6 +298,12 @@ performInvocations(
     std::vector<pbxbuild::Tool::Invocation> const &orderedInvocations,
     bool createProductStructure)
 {
+    /* Tools are looked up once per target, not once per invocation. */
+    std::unordered_map<std::string, std::string> externalPaths;
+
+    /* Content hashes of previous runs, by database. Loaded when first used. */
+    std::unordered_map<std::string, LookupCache> contentHashes;
+
     for (pbxbuild::Tool::Invocation const &invocation : orderedInvocations) {
         // TODO(grp): This should perhaps be a separate flag for a 'phony' invocation.
         if (!invocation.executable()) {
@@ -248,6 +318,36 @@ performInvocations(
         if (!_dryRun) {
             bool success = true;
 
+            /*
+             * Skip if nothing changed since the invocation last succeeded.
+             * Without outputs, there's nothing to show its effects are still
+             * in place, so those always run.
+             */
+            LookupCache *contentHashDatabase = nullptr;
+            std::string contentHashKey;
+            std::string contentDigest;
+            ext::optional<pbxbuild::Tool::Invocation::ContentHash> const &contentHash = invocation.contentHash();
+            if (contentHash && !invocation.outputs().empty()) {
+                auto it = contentHashes.find(contentHash->database());
+                if (it == contentHashes.end()) {
+                    /* Unlimited: every hashed invocation in the target is kept. */
+                    it = contentHashes.insert({ contentHash->database(), LookupCache(0) }).first;
+                    it->second.load(filesystem, contentHash->database());
+                }
+                contentHashDatabase = &it->second;
+
+                contentHashKey = ContentHashKey(invocation);
+                contentDigest = ContentDigest(filesystem, invocation);
+
+                /* The outputs are stamped, so the invocation runs again if they change. */
+                bool outputsExist = std::all_of(invocation.outputs().begin(), invocation.outputs().end(), [filesystem](std::string const &output) {
+                    return filesystem->exists(output);
+                });
+                if (outputsExist && contentHashDatabase->lookup(filesystem, contentHashKey) == std::vector<std::string>({ contentDigest })) {
+                    continue;
+                }
+            }
+
             for (std::string const &output : invocation.outputs()) {
                 std::string directory = FSUtil::GetDirectoryName(output);
 
@@ -261,11 +361,15 @@ performInvocations(
                 if (std::shared_ptr<builtin::Driver> driver = _builtins.driver(*builtin)) {
                     xcformatter::Formatter::Print(_formatter->beginInvocation(invocation, *builtin, createProductStructure));
 
+                    /* Like other tools, builtins see the process environment under the invocation's. */
+                    std::unordered_map<std::string, std::string> environment = invocation.fullEnvironment();
+                    environment.insert(processContext->environmentVariables().begin(), processContext->environmentVariables().end());
+
                     process::MemoryContext context = process::MemoryContext(
                         *builtin,
                         invocation.workingDirectory(),
                         invocation.arguments(),
-                        invocation.environment());
+                        environment);
                     int exitCode = driver->run(&context, filesystem);
                     success = (exitCode == 0);
 
@@ -282,14 +386,20 @@ performInvocations(
                         path = external;
                     }
                 } else {
-                    path = filesystem->findExecutable(*external, executablePaths);
+                    auto it = externalPaths.find(*external);
+                    if (it != externalPaths.end()) {
+                        path = it->second;
+                    } else if ((path = filesystem->findExecutable(*external, executablePaths))) {
+                        /* Only remember found tools; a missing one may be built by a later invocation. */
+                        externalPaths.insert({ *external, *path });
+                    }
                 }
 
                 if (path) {
                     xcformatter::Formatter::Print(_formatter->beginInvocation(invocation, *path, createProductStructure));
 
                     /* Create the execution environment from the process and invocation environments, preferring the invocation. */
-                    std::unordered_map<std::string, std::string> environment = invocation.environment();
+                    std::unordered_map<std::string, std::string> environment = invocation.fullEnvironment();
                     environment.insert(processContext->environmentVariables().begin(), processContext->environmentVariables().end());
 
                     process::MemoryContext context = process::MemoryContext(
@@ -312,6 +422,15 @@ performInvocations(
             if (!success) {
                 return std::make_pair(false, std::vector<pbxbuild::Tool::Invocation>({ invocation }));
             }
+
+            if (contentHashDatabase != nullptr) {
+                /* Recording is best effort; if it fails, the invocation just runs again. */
+                contentHashDatabase->insert(contentHashKey, { contentDigest }, LookupCache::Stamp(filesystem, invocation.outputs()));
+                std::string const &database = invocation.contentHash()->database();
+                if (filesystem->createDirectory(FSUtil::GetDirectoryName(database), true)) {
+                    (void)contentHashDatabase->save(filesystem, database);
+                }
+            }
         }
     }
 
@@ -0,0 +1,47 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <xcexecution/NinjaExecutor.h>
+#include <xcformatter/NullFormatter.h>
+#include <pbxbuild/Tool/Invocation.h>
+#include <builtin/Registry.h>
+#include <ninja/Writer.h>
+
+using xcexecution::NinjaExecutor;
+
+static std::string
+Statement(pbxbuild::Tool::Invocation const &invocation)
+{
+    auto executor = NinjaExecutor::Create(xcformatter::NullFormatter::Create(), false, false, builtin::Registry::Create({ }));
+    std::unordered_map<std::unordered_map<std::string, std::string> const *, std::string> sharedEnvironments;
+
+    ninja::Writer writer;
+    EXPECT_TRUE(executor->buildInvocation(&writer, invocation, "/usr/bin/tool", "/usr/bin/dependency-info-tool", ext::nullopt, "/tmp", "after", &sharedEnvironments));
+    return writer.serialize();
+}
+
+TEST(NinjaExecutor, RestatBatchedCopy)
+{
+    /* Unchanged files in a batch are skipped, so their outputs keep old stamps. */
+    auto copy = pbxbuild::Tool::Invocation();
+    copy.executable() = pbxbuild::Tool::Invocation::Executable::Builtin("builtin-copy");
+    copy.arguments() = { "-stamp-file", "/temp/Copy.stamps", "/in/a", "/in/b", "/out" };
+    copy.workingDirectory() = "/";
+    copy.inputs() = { "/in/a", "/in/b" };
+    copy.outputs() = { "/out/a", "/out/b", "/temp/Copy.stamps" };
+    EXPECT_NE(std::string::npos, Statement(copy).find("restat = 1"));
+
+    /* Tools that always write their outputs are not re-checked. */
+    auto external = pbxbuild::Tool::Invocation();
+    external.executable() = pbxbuild::Tool::Invocation::Executable::External("/usr/bin/tool");
+    external.workingDirectory() = "/";
+    external.inputs() = { "/in/a" };
+    external.outputs() = { "/out/a" };
+    EXPECT_EQ(std::string::npos, Statement(external).find("restat"));
+}
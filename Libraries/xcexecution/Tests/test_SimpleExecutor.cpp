@@ -138,3 +138,102 @@ TEST(SimpleExecutor, PropagateToolResult)
     EXPECT_EQ(fail2.second.size(), 1);
 }
 
+
+/*
+ * The memory filesystem changes every modification time on any write,
+ * which would make stamped outputs always look changed. Keep them fixed.
+ */
+class FixedTimeFilesystem : public MemoryFilesystem {
+public:
+    FixedTimeFilesystem(std::vector<MemoryFilesystem::Entry> const &entries) :
+        MemoryFilesystem(entries)
+    {
+    }
+
+public:
+    virtual ext::optional<uint64_t> modificationTime(std::string const &path) const
+    {
+        return (this->exists(path) ? ext::optional<uint64_t>(0) : ext::nullopt);
+    }
+};
+
+TEST(SimpleExecutor, SkipUnchangedContentHash)
+{
+    auto filesystem = FixedTimeFilesystem({
+        MemoryFilesystem::Entry::File("script", std::vector<uint8_t>()),
+        MemoryFilesystem::Entry::File("input", std::vector<uint8_t>({ 'a' })),
+    });
+
+    std::string output = filesystem.path("output");
+
+    int runs = 0;
+    auto launcher = process::MemoryLauncher({
+        { filesystem.path("script"), [&runs, &output](Filesystem *filesystem, process::Context const *context) -> ext::optional<int> {
+            runs++;
+            return filesystem->write(std::vector<uint8_t>({ 'o' }), output) ? 0 : 1;
+        } },
+    });
+
+    auto context = process::MemoryContext(
+        "",
+        filesystem.path(""),
+        std::vector<std::string>(),
+        std::unordered_map<std::string, std::string>());
+
+    std::string database = filesystem.path("temp/ScriptHashes.db");
+    auto invocation = pbxbuild::Tool::Invocation();
+    invocation.executable() = pbxbuild::Tool::Invocation::Executable::External("script");
+    invocation.phonyInputs() = { filesystem.path("input"), filesystem.path("missing") };
+    invocation.outputs() = { output };
+    invocation.contentHash() = pbxbuild::Tool::Invocation::ContentHash(database, "digest");
+
+    auto formatter = xcformatter::NullFormatter::Create();
+    std::vector<std::string> const executablePaths = { filesystem.path("") };
+    SimpleExecutor executor = SimpleExecutor(formatter, false, builtin::Registry::Create({ }));
+
+    /* Runs the first time, and records the hash. */
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false).first);
+    EXPECT_EQ(1, runs);
+    EXPECT_TRUE(filesystem.exists(database));
+
+    /* Skipped while nothing changed, even in a new build. */
+    SimpleExecutor next = SimpleExecutor(formatter, false, builtin::Registry::Create({ }));
+    EXPECT_TRUE(next.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false).first);
+    EXPECT_EQ(1, runs);
+
+    /* Runs again when an input changes. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>({ 'b' }), filesystem.path("input")));
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false).first);
+    EXPECT_EQ(2, runs);
+
+    /* Or when a missing input is created, even if empty. */
+    ASSERT_TRUE(filesystem.write(std::vector<uint8_t>(), filesystem.path("missing")));
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false).first);
+    EXPECT_EQ(3, runs);
+
+    /* Or when the script or its environment changes. */
+    invocation.contentHash() = pbxbuild::Tool::Invocation::ContentHash(database, "other");
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false).first);
+    EXPECT_EQ(4, runs);
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false).first);
+    EXPECT_EQ(4, runs);
+
+    /* Or when an output is removed. */
+    ASSERT_TRUE(filesystem.removeFile(output));
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false).first);
+    EXPECT_EQ(5, runs);
+
+    /* Or when its environment changes. */
+    invocation.environment()["VARIABLE"] = "value";
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false).first);
+    EXPECT_EQ(6, runs);
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false).first);
+    EXPECT_EQ(6, runs);
+
+    /* Without outputs, its effects can't be checked, so it always runs. */
+    invocation.outputs() = { };
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false).first);
+    EXPECT_EQ(7, runs);
+    EXPECT_TRUE(executor.performInvocations(&context, &launcher, &filesystem, executablePaths, { invocation }, false).first);
+    EXPECT_EQ(8, runs);
+}
@@ -236,7 +236,8 @@ beginInvocation(pbxbuild::Tool::Invocation const &invocation, std::string const
         message += INDENT + "cd " + invocation.workingDirectory() + "\n";
 
         if (invocation.showEnvironmentInLog()) {
-            std::map<std::string, std::string> sortedEnvironment = std::map<std::string, std::string>(invocation.environment().begin(), invocation.environment().end());
+            std::unordered_map<std::string, std::string> environment = invocation.fullEnvironment();
+            std::map<std::string, std::string> sortedEnvironment = std::map<std::string, std::string>(environment.begin(), environment.end());
             for (std::pair<std::string, std::string> const &entry : sortedEnvironment) {
                 message += INDENT + "export " + entry.first + "=" + entry.second + "\n";
             }
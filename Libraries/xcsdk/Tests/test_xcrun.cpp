@@ -0,0 +1,154 @@
+/**
+ Copyright (c) 2015-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <xcsdk/xcrun/Driver.h>
+#include <libutil/MemoryFilesystem.h>
+#include <process/Context.h>
+#include <process/MemoryContext.h>
+#include <process/MemoryLauncher.h>
+#include <process/MemoryUser.h>
+
+using libutil::Filesystem;
+using libutil::MemoryFilesystem;
+
+static std::vector<uint8_t>
+Contents(std::string const &string)
+{
+    return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+/*
+ * Keeps modification times stable across writes, so the saved cache is
+ * not invalidated just by being written.
+ */
+class FixedTimeFilesystem : public MemoryFilesystem {
+public:
+    FixedTimeFilesystem(std::vector<MemoryFilesystem::Entry> const &entries) :
+        MemoryFilesystem(entries)
+    {
+    }
+
+public:
+    virtual ext::optional<uint64_t> modificationTime(std::string const &path) const
+    {
+        return (this->exists(path) ? ext::optional<uint64_t>(0) : ext::nullopt);
+    }
+};
+
+static FixedTimeFilesystem
+DeveloperFilesystem()
+{
+    return FixedTimeFilesystem({
+        MemoryFilesystem::Entry::Directory("tmp", { }),
+        MemoryFilesystem::Entry::Directory("Developer", {
+            MemoryFilesystem::Entry::Directory("Toolchains", {
+                MemoryFilesystem::Entry::Directory("XcodeDefault.xctoolchain", {
+                    MemoryFilesystem::Entry::File("ToolchainInfo.plist", Contents("{ \
+                        Identifier = com.apple.dt.toolchain.XcodeDefault; \
+                    }")),
+                    MemoryFilesystem::Entry::Directory("usr", {
+                        MemoryFilesystem::Entry::Directory("bin", {
+                            MemoryFilesystem::Entry::File("cc", Contents("")),
+                        }),
+                    }),
+                }),
+            }),
+            MemoryFilesystem::Entry::Directory("Platforms", {
+                MemoryFilesystem::Entry::Directory("Test.platform", {
+                    MemoryFilesystem::Entry::File("Info.plist", Contents("{ \
+                        Identifier = test; \
+                        Name = test; \
+                    }")),
+                    MemoryFilesystem::Entry::Directory("Developer", {
+                        MemoryFilesystem::Entry::Directory("SDKs", {
+                            MemoryFilesystem::Entry::Directory("Test.sdk", {
+                                MemoryFilesystem::Entry::File("SDKSettings.plist", Contents("{ \
+                                    CanonicalName = test1.0; \
+                                }")),
+                            }),
+                        }),
+                    }),
+                }),
+            }),
+        }),
+    });
+}
+
+struct Execution {
+    std::string              executable;
+    std::vector<std::string> arguments;
+    std::string              SDKROOT;
+};
+
+static int
+RunXcrun(Filesystem *filesystem, std::vector<std::string> const &arguments, std::vector<Execution> *executions)
+{
+    process::MemoryUser user = process::MemoryUser("501", "20", "user", "staff");
+    process::MemoryContext context = process::MemoryContext(
+        "/usr/bin/xcrun",
+        "/",
+        arguments,
+        {
+            { "DEVELOPER_DIR", "/Developer" },
+            { "TMPDIR", "/tmp" },
+            { "XCSDK_CONFIGURATION_PATH", "/xcsdk_configuration.plist" },
+        });
+
+    process::MemoryLauncher launcher = process::MemoryLauncher({
+        { "/Developer/Toolchains/XcodeDefault.xctoolchain/usr/bin/cc", [&](Filesystem *filesystem, process::Context const *context) -> ext::optional<int> {
+            executions->push_back({
+                context->executablePath(),
+                context->commandLineArguments(),
+                context->environmentVariable("SDKROOT").value_or(""),
+            });
+            return 0;
+        } },
+    });
+
+    return xcsdk::xcrun::Driver::Run(&user, &context, &launcher, filesystem);
+}
+
+TEST(xcrun, ExecuteTool)
+{
+    FixedTimeFilesystem filesystem = DeveloperFilesystem();
+    std::vector<Execution> executions;
+
+    EXPECT_EQ(0, RunXcrun(&filesystem, { "-sdk", "test1.0", "cc", "-c", "main.c" }, &executions));
+    ASSERT_EQ(1, executions.size());
+    EXPECT_EQ("/Developer/Toolchains/XcodeDefault.xctoolchain/usr/bin/cc", executions[0].executable);
+    EXPECT_EQ(std::vector<std::string>({ "-c", "main.c" }), executions[0].arguments);
+    EXPECT_EQ("/Developer/Platforms/Test.platform/Developer/SDKs/Test.sdk", executions[0].SDKROOT);
+
+    /* Unknown tools are not executed. */
+    EXPECT_NE(0, RunXcrun(&filesystem, { "-sdk", "test1.0", "missing" }, &executions));
+    EXPECT_EQ(1, executions.size());
+}
+
+TEST(xcrun, CachedIndex)
+{
+    FixedTimeFilesystem filesystem = DeveloperFilesystem();
+    std::vector<Execution> executions;
+
+    EXPECT_EQ(0, RunXcrun(&filesystem, { "-sdk", "test1.0", "cc" }, &executions));
+    EXPECT_TRUE(filesystem.exists("/tmp/xcrun-xcbuild-501/xcrun_db"));
+
+    /*
+     * Without the toolchain's settings, the toolchain can't be loaded; the
+     * stamps are unchanged, so the indexed search paths are still used.
+     */
+    ASSERT_TRUE(filesystem.removeFile("/Developer/Toolchains/XcodeDefault.xctoolchain/ToolchainInfo.plist"));
+    EXPECT_EQ(0, RunXcrun(&filesystem, { "-sdk", "test1.0", "cc" }, &executions));
+
+    /* Not using the cache loads the developer root again. */
+    EXPECT_NE(0, RunXcrun(&filesystem, { "-n", "-sdk", "test1.0", "cc" }, &executions));
+
+    ASSERT_EQ(2, executions.size());
+    EXPECT_EQ(executions[0].executable, executions[1].executable);
+    EXPECT_EQ(executions[0].SDKROOT, executions[1].SDKROOT);
+}